@@ -37,6 +37,9 @@ Database::Database()
 
 	this->join = NULL;
 
+	this->build_thread_num = Database::BUILD_INDEX_NUM;
+	this->build_memory = IDTripleSorter::DEFAULT_MEMORY;
+
 	//this->resetIDinfo();
 	this->initIDinfo();
 }
@@ -69,6 +72,9 @@ Database::Database(string _name)
 
 	this->join = NULL;
 
+	this->build_thread_num = Database::BUILD_INDEX_NUM;
+	this->build_memory = IDTripleSorter::DEFAULT_MEMORY;
+
 	//this->resetIDinfo();
 	this->initIDinfo();
 }
@@ -456,21 +462,235 @@ Database::load()
 	
 	this->readIDinfo();
 
-	stringstream _internal_path;
-	_internal_path << this->getStorePath() << "/internal_nodes.dat";
-	
-	ifstream _internal_input;
-	_internal_input.open(_internal_path.str().c_str());
-	char* buffer = new char[this->entity_num + 1];
-	_internal_input.read(buffer, this->entity_num);
-	buffer[this->entity_num] = 0;
-	_internal_input.close();
-	this->internal_tag_str = string(buffer);
-	delete[] buffer;
+	//one tag per entity ID, there may be more tags than entities after removals,
+	//and the entities past the tags are not internal
+	this->internal_tags.load(this->getStorePath() + "/internal_nodes.dat");
+
+	this->loadGlobalIDs();
+
+	return true;
+}
+
+//NOTICE:called in build while entity2id and literal2id are still open
+bool
+Database::saveGlobalIDs(const char* _global_id_file)
+{
+	FILE* _fin = fopen(_global_id_file, "rb");
+	if (_fin == NULL)
+	{
+		cerr << "import global IDs failed: " << _global_id_file << endl;
+		return false;
+	}
+
+	vector<int> _entity_global_ids(this->entity_num, -1);
+	vector<int> _literal_global_ids(this->literal_num, -1);
+	int _global_id, _len;
+	string _str;
+	while (fscanf(_fin, "%d\t%d\t", &_global_id, &_len) == 2)
+	{
+		_str.resize(_len);
+		if (_len > 0 && fread(&_str[0], sizeof(char), _len, _fin) != (size_t)_len)
+		{
+			break;
+		}
+		fgetc(_fin);
+
+		int _local_id = -1;
+		if (_global_id >= Util::LITERAL_FIRST_ID)
+		{
+			_local_id = (this->kvstore)->getIDByLiteral(_str);
+			if (_local_id != -1 && _local_id - Util::LITERAL_FIRST_ID < this->literal_num)
+				_literal_global_ids[_local_id - Util::LITERAL_FIRST_ID] = _global_id;
+		}
+		else
+		{
+			_local_id = (this->kvstore)->getIDByEntity(_str);
+			if (_local_id != -1 && _local_id < this->entity_num)
+				_entity_global_ids[_local_id] = _global_id;
+		}
+	}
+	fclose(_fin);
+
+	return this->writeGlobalIDs(_entity_global_ids, _literal_global_ids);
+}
+
+//the global ID of each local ID, in the layout read by loadGlobalIDs
+bool
+Database::writeGlobalIDs(const vector<int>& _entity_global_ids, const vector<int>& _literal_global_ids)
+{
+	string _global_path = this->getStorePath() + "/global_ids.dat";
+	FILE* _fout = fopen(_global_path.c_str(), "wb");
+	if (_fout == NULL)
+	{
+		cerr << "Failed to open : " << _global_path << endl;
+		return false;
+	}
+	//after updates the IDs in use may go beyond entity_num/literal_num
+	int _entity_num = _entity_global_ids.size(), _literal_num = _literal_global_ids.size();
+	fwrite(&_entity_num, sizeof(int), 1, _fout);
+	fwrite(&_literal_num, sizeof(int), 1, _fout);
+	if (_entity_num > 0)
+		fwrite(&_entity_global_ids[0], sizeof(int), _entity_num, _fout);
+	if (_literal_num > 0)
+		fwrite(&_literal_global_ids[0], sizeof(int), _literal_num, _fout);
+	fclose(_fout);
+	cout << this->getStorePath() << " import global IDs to database " << _global_path << " done." << endl;
+
+	return true;
+}
+
+//databases not built by gloadD have no global IDs, then LPMs are shipped with local IDs
+bool
+Database::loadGlobalIDs()
+{
+	this->entity_global_ids.clear();
+	this->literal_global_ids.clear();
+
+	string _global_path = this->getStorePath() + "/global_ids.dat";
+	FILE* _fin = fopen(_global_path.c_str(), "rb");
+	if (_fin == NULL)
+	{
+		return false;
+	}
+
+	int _entity_num = 0, _literal_num = 0;
+	fread(&_entity_num, sizeof(int), 1, _fin);
+	fread(&_literal_num, sizeof(int), 1, _fin);
+	this->entity_global_ids.resize(_entity_num);
+	this->literal_global_ids.resize(_literal_num);
+	if (_entity_num > 0)
+		fread(&this->entity_global_ids[0], sizeof(int), _entity_num, _fin);
+	if (_literal_num > 0)
+		fread(&this->literal_global_ids[0], sizeof(int), _literal_num, _fin);
+	fclose(_fin);
+
+	this->global_local_ids.clear();
+	for (int i = 0; i < _entity_num; ++i)
+	{
+		if (this->entity_global_ids[i] != -1)
+			this->global_local_ids.push_back(make_pair(this->entity_global_ids[i], i));
+	}
+	for (int i = 0; i < _literal_num; ++i)
+	{
+		if (this->literal_global_ids[i] != -1)
+			this->global_local_ids.push_back(make_pair(this->literal_global_ids[i], i + Util::LITERAL_FIRST_ID));
+	}
+	sort(this->global_local_ids.begin(), this->global_local_ids.end());
 
 	return true;
 }
 
+int
+Database::getGlobalID(const string& _str, bool _is_entity)
+{
+	if (_is_entity)
+	{
+		int _id = (this->kvstore)->getIDByEntity(_str);
+		if (_id < 0 || _id >= this->entity_global_ids.size())
+			return -1;
+		return this->entity_global_ids[_id];
+	}
+
+	int _id = (this->kvstore)->getIDByLiteral(_str);
+	if (_id < Util::LITERAL_FIRST_ID || _id - Util::LITERAL_FIRST_ID >= this->literal_global_ids.size())
+		return -1;
+	return this->literal_global_ids[_id - Util::LITERAL_FIRST_ID];
+}
+
+void
+Database::getGlobalIDLimits(int& _entity_limit, int& _literal_limit)
+{
+	_entity_limit = 0;
+	for (int i = 0; i < this->entity_global_ids.size(); ++i)
+	{
+		_entity_limit = max(_entity_limit, this->entity_global_ids[i] + 1);
+	}
+	_literal_limit = Util::LITERAL_FIRST_ID;
+	for (int i = 0; i < this->literal_global_ids.size(); ++i)
+	{
+		_literal_limit = max(_literal_limit, this->literal_global_ids[i] + 1);
+	}
+}
+
+//the vertices new to this database get their local IDs in insert(), and then their global IDs
+//and internal tags are recorded, the tags of existing vertices do not change
+bool
+Database::insert(const TripleWithObjType* _triples, int _triple_num, const vector<int>& _global_ids, const set<string>& _internal_vertices)
+{
+	set<string> _new_entities, _new_literals;
+	for (int i = 0; i < _triple_num; ++i)
+	{
+		if ((this->kvstore)->getIDByEntity(_triples[i].subject) == -1)
+			_new_entities.insert(_triples[i].subject);
+		if (_triples[i].isObjEntity())
+		{
+			if ((this->kvstore)->getIDByEntity(_triples[i].object) == -1)
+				_new_entities.insert(_triples[i].object);
+		}
+		else if ((this->kvstore)->getIDByLiteral(_triples[i].object) == -1)
+		{
+			_new_literals.insert(_triples[i].object);
+		}
+	}
+
+	bool flag = this->insert(_triples, _triple_num);
+
+	bool _has_global_ids = this->hasGlobalIDs() && _global_ids.size() >= 2 * _triple_num;
+	for (int i = 0; i < _triple_num; ++i)
+	{
+		for (int j = 0; j < 2; ++j)
+		{
+			bool _is_entity = (j == 0 || _triples[i].isObjEntity());
+			const string& _str = (j == 0 ? _triples[i].subject : _triples[i].object);
+			if (_is_entity)
+			{
+				int _id = (this->kvstore)->getIDByEntity(_str);
+				if (_id < 0 || _new_entities.find(_str) == _new_entities.end())
+					continue;
+				this->internal_tags.set(_id, _internal_vertices.find(_str) != _internal_vertices.end());
+				if (_has_global_ids)
+				{
+					if (_id >= this->entity_global_ids.size())
+						this->entity_global_ids.resize(_id + 1, -1);
+					this->entity_global_ids[_id] = _global_ids[2 * i + j];
+				}
+			}
+			else if (_has_global_ids && _new_literals.find(_str) != _new_literals.end())
+			{
+				int _id = (this->kvstore)->getIDByLiteral(_str);
+				if (_id < Util::LITERAL_FIRST_ID)
+					continue;
+				_id -= Util::LITERAL_FIRST_ID;
+				if (_id >= this->literal_global_ids.size())
+					this->literal_global_ids.resize(_id + 1, -1);
+				this->literal_global_ids[_id] = _global_ids[2 * i + j];
+			}
+		}
+	}
+
+	return flag;
+}
+
+bool
+Database::saveUpdates()
+{
+	if (!this->vstree->saveTree() || !this->saveDBInfoFile())
+	{
+		return false;
+	}
+	if (this->hasGlobalIDs() && !this->writeGlobalIDs(this->entity_global_ids, this->literal_global_ids))
+	{
+		return false;
+	}
+	return this->writeInternalTags();
+}
+
+bool
+Database::writeInternalTags()
+{
+	return this->internal_tags.save(this->getStorePath() + "/internal_nodes.dat");
+}
+
 bool
 Database::loadInternalVertices(const string _in_file)
 {
@@ -503,14 +723,16 @@ Database::loadInternalVertices(const string _in_file)
             cout << "import internal vertices failed." << endl;
     }
 
-    vector<char> buffer(this->entity_num, '0');
+    this->internal_tags.clear();
+    this->internal_tags.resize(this->entity_num);
     while(getline(infile, buff)){
             buff.erase(0, buff.find_first_not_of("\r\t\n "));
             buff.erase(buff.find_last_not_of("\r\t\n ") + 1);
             //printf("==== %s\n", buff.c_str());
             int _entity_id = (this->kvstore)->getIDByEntity(buff);
             //printf("%d ==== %s\n", _entity_id, buff.c_str());
-            buffer[_entity_id] = '1';
+            if (_entity_id >= 0)
+                this->internal_tags.set(_entity_id);
             /*
             stringstream _ss;
             _ss << _sub_id;
@@ -525,15 +747,10 @@ Database::loadInternalVertices(const string _in_file)
     _internal_path << this->getStorePath() << "/internal_nodes.dat";
     cout << this->getStorePath() << " begin to import internal vertices to database " << _internal_path.str() << endl;
 
-    //FILE * pFile;
-    ofstream _internal_output(_internal_path.str().c_str());
-    //pFile = fopen (_internal_path.str().c_str(), "wb");
-    //fwrite(buffer, sizeof(char), this->entity_num, pFile);
-    //fclose(pFile);
-    for (int i = 0; i < buffer.size(); ++i){
-            _internal_output << buffer[i];
+    if (!this->writeInternalTags())
+    {
+            return false;
     }
-    _internal_output.close();
 	cout << this->getStorePath() << " import internal vertices to database " << _internal_path.str() << " done." << endl;
 
     return true;
@@ -575,10 +792,10 @@ Database::query(const string _query, ResultSet& _result_set, vector<string>& par
     if (general_evaluation.getQueryTree().getUpdateType() == QueryTree::Not_Update)
     {
 		if(general_evaluation.getQueryTree().checkStar() == 0){
-			general_evaluation.doQuery(this->internal_tag_str);
+			general_evaluation.doQuery(this->internal_tags);
 
-			//printf("general_evaluation.getLocalPartialResult(this->internal_tag_str, partialResStrVec);\n");
-			general_evaluation.getLocalPartialResult(this->kvstore, this->internal_tag_str, partialResStrVec);
+			//printf("general_evaluation.getLocalPartialResult(this->internal_tags, partialResStrVec);\n");
+			general_evaluation.getLocalPartialResult(this->kvstore, this->internal_tags, partialResStrVec);
 		}else{
 			general_evaluation.doQuery();
 			general_evaluation.getFinalResult(_result_set);
@@ -659,10 +876,10 @@ Database::queryCrossingEdge(const string _query, ResultSet& _result_set, vector<
     if (general_evaluation.getQueryTree().getUpdateType() == QueryTree::Not_Update)
     {
 		if(general_evaluation.getQueryTree().checkStar() == 0){
-			general_evaluation.doQuery(this->internal_tag_str);
+			general_evaluation.doQuery(this->internal_tags);
 
-			//printf("general_evaluation.getLocalPartialResult(this->internal_tag_str, partialResStrVec);\n");
-			general_evaluation.getCrossingEdges(this->kvstore, this->internal_tag_str, lpm_str_vec, res_crossing_edges_vec, all_crossing_edges_vec);
+			//printf("general_evaluation.getLocalPartialResult(this->internal_tags, partialResStrVec);\n");
+			general_evaluation.getCrossingEdges(this->kvstore, this->internal_tags, lpm_str_vec, res_crossing_edges_vec, all_crossing_edges_vec);
 		}else{
 			general_evaluation.doQuery();
 			general_evaluation.getFinalResult(_result_set);
@@ -675,6 +892,99 @@ Database::queryCrossingEdge(const string _query, ResultSet& _result_set, vector<
 }
 
 
+//hand each chunk of LPMs to the sink of the caller with global IDs and no strings, or with local IDs
+//and their strings in the dictionary, which is also the fallback if some vertex has no global ID
+class PartialResIDSink : public PartialResSink
+{
+public:
+	PartialResIDSink(Database* _db, KVstore* _kvstore, PartialResSink& _sink, bool _global_id)
+		: PartialResSink(_sink.chunk_row_num), db(_db), kvstore(_kvstore), sink(_sink)
+	{
+		this->global_id = _global_id;
+	}
+	virtual void put(PartialResBuffer& _buf)
+	{
+		if (!this->global_id || !this->db->remapToGlobalIDs(_buf))
+			GeneralEvaluation::fillPartialResDict(this->kvstore, _buf);
+		this->sink.put(_buf);
+	}
+
+private:
+	Database* db;
+	KVstore* kvstore;
+	PartialResSink& sink;
+	bool global_id;
+};
+
+bool
+Database::queryCrossingEdge(const string _query, PartialResSink& lpm_sink, bool _global_id, int myRank, FILE* _fp)
+{
+    GeneralEvaluation general_evaluation(this->vstree, this->kvstore, this->stringindex);
+	PartialResIDSink sink(this, this->kvstore, lpm_sink, _global_id);
+
+	if (!general_evaluation.parseQuery(_query))
+		return false;
+
+    //Query
+    if (general_evaluation.getQueryTree().getUpdateType() == QueryTree::Not_Update)
+    {
+		if(general_evaluation.getQueryTree().checkStar() == 0){
+			general_evaluation.doQuery(this->internal_tags);
+			general_evaluation.getCrossingEdges(this->kvstore, this->internal_tags, sink);
+		}else{
+			general_evaluation.doQuery();
+			general_evaluation.getLocalFullMatches(this->kvstore, sink);
+		}
+    }
+
+	return true;
+}
+
+bool
+Database::hasGlobalIDs()
+{
+	return !this->entity_global_ids.empty() || !this->literal_global_ids.empty();
+}
+
+bool
+Database::remapToGlobalIDs(PartialResBuffer& lpm_buf)
+{
+	if (!this->hasGlobalIDs())
+		return false;
+
+	if (!lpm_buf.remapIDs(this->entity_global_ids, this->literal_global_ids))
+	{
+		cerr << "some vertices have no global ID. @Database::remapToGlobalIDs" << endl;
+		return false;
+	}
+
+	return true;
+}
+
+//the coordinator only asks for the strings of the final answers, see Main/gqueryD.cpp
+void
+Database::getGlobalIDStrings(const vector<int>& _global_ids, PartialResBuffer& _dict_buf)
+{
+	vector< pair<int, int> >::iterator it = this->global_local_ids.begin();
+	for (int i = 0; i < _global_ids.size(); ++i)
+	{
+		it = lower_bound(it, this->global_local_ids.end(), make_pair(_global_ids[i], -1));
+		if (it == this->global_local_ids.end())
+			break;
+		if (it->first != _global_ids[i])
+			continue;
+
+		string _str;
+		if (it->second >= Util::LITERAL_FIRST_ID)
+			_str = (this->kvstore)->getLiteralByID(it->second);
+		else
+			_str = (this->kvstore)->getEntityByID(it->second);
+		//the vertices removed by gupdateD keep their global IDs
+		if (!_str.empty())
+			_dict_buf.addDictEntry(_global_ids[i], _str);
+	}
+}
+
 int
 Database::queryPathBMC(const string _query, ResultSet& _result_set, string& final_res_str, int myRank, FILE* _fp)
 {
@@ -713,7 +1023,7 @@ Database::generateCandidate(const string _query, vector< vector<int> >& candidat
     if (general_evaluation.getQueryTree().getUpdateType() == QueryTree::Not_Update)
     {
 		if(general_evaluation.getQueryTree().checkStar() == 0){
-			general_evaluation.findCandidate(this->internal_tag_str, candidates_vec, candidate_id_vec, _query_dir_ad, _query_pre_ad, _query_ad, satellites_set);
+			general_evaluation.findCandidate(this->internal_tags, candidates_vec, candidate_id_vec, _query_dir_ad, _query_pre_ad, _query_ad, satellites_set);
 		}else{
 			general_evaluation.doQuery();
 			general_evaluation.getFinalResult(_result_set);
@@ -864,8 +1174,8 @@ Database::build(const string& _rdf_file)
 	//to support really larger datasets, divide and insert into B+ tree and VStree
 	//(read the value, add list and set; update the signature, remove and reinsert)
 	//the query process is nearly the same
-	//QUERY:build each index in one thread to speed up, but the sorting case?
-	//one sorting order for several indexes
+	//NOTICE:each group of indexes sorts a copy of its own of the id tuples,
+	//and the groups are built in parallel, see buildIndexes()
 
 	// to be switched to new encodeRDF method.
 	//    this->encodeRDF(ret);
@@ -886,14 +1196,10 @@ Database::build(const string& _rdf_file)
 	//cout<<"release kvstore"<<endl;
 
 	//(this->kvstore)->open();
-	string _entry_file = this->getSignatureBFile();
-
-	cout << "begin build VS-Tree on " << ret << "..." << endl;
-	(this->vstree)->buildTree(_entry_file);
+	//the VSTree is built along with the other indexes in encodeRDF_new()
 
 	long tv_build_end = Util::get_cur_time();
 	cout << "after build, used " << (tv_build_end - tv_build_begin) << "ms." << endl;
-	cout << "finish build VS-Tree." << endl;
 	
 	delete this->vstree;
 	this->vstree = NULL;
@@ -917,12 +1223,30 @@ Database::build(const string& _rdf_file)
 //In distributed gStore, each machine's graph should be based on unique encoding IDs,
 //and require that triples in each graph no more than a limit(maybe 10^9)
 bool
-Database::build(const string& _rdf_file, const char* _internal_file)
+Database::build(const string& _rdf_file, const char* _internal_file, const char* _global_id_file)
+{
+	string ret = Util::getExactPath(_rdf_file.c_str());
+	ifstream _fin(ret.c_str());
+	if (!_fin)
+	{
+		cerr << "build: Fail to open : " << ret << endl;
+		return false;
+	}
+
+	cout << "begin encode RDF from : " << ret << " ..." << endl;
+	RDFFileSource _source(_fin);
+	bool flag = this->build(_source, _internal_file, _global_id_file);
+	_fin.close();
+
+	return flag;
+}
+
+bool
+Database::build(TripleSource& _source, const char* _internal_file, const char* _global_id_file)
 {
 	//manage the id for a new database
 	this->resetIDinfo();
 
-	string ret = Util::getExactPath(_rdf_file.c_str());
 	long tv_build_begin = Util::get_cur_time();
 
 	string store_path = this->name;
@@ -937,18 +1261,16 @@ Database::build(const string& _rdf_file, const char* _internal_file)
 	string stringindex_store_path = store_path + "/stringindex_store";
     Util::create_dir(stringindex_store_path);
 
-	cout << "begin encode RDF from : " << ret << " ..." << endl;
-
 	//BETTER+TODO:now require that dataset size < memory
 	//to support really larger datasets, divide and insert into B+ tree and VStree
 	//(read the value, add list and set; update the signature, remove and reinsert)
 	//the query process is nearly the same
-	//QUERY:build each index in one thread to speed up, but the sorting case?
-	//one sorting order for several indexes
+	//NOTICE:each group of indexes sorts a copy of its own of the id tuples,
+	//and the groups are built in parallel, see buildIndexes()
 
 	// to be switched to new encodeRDF method.
 	//    this->encodeRDF(ret);
-	if (!this->encodeRDF_new(ret, _internal_file))	//<-- this->kvstore->id2* trees are closed
+	if (!this->encodeRDF_new(_source, _internal_file, _global_id_file))	//<-- this->kvstore->id2* trees are closed
 	{
 		return false;
 	}
@@ -963,14 +1285,10 @@ Database::build(const string& _rdf_file, const char* _internal_file)
 	//cout<<"release kvstore"<<endl;
 
 	//(this->kvstore)->open();
-	string _entry_file = this->getSignatureBFile();
-
-	cout << "begin build VS-Tree on " << ret << "..." << endl;
-	(this->vstree)->buildTree(_entry_file);
+	//the VSTree is built along with the other indexes in encodeRDF_new()
 
 	long tv_build_end = Util::get_cur_time();
 	cout << "after build, used " << (tv_build_end - tv_build_begin) << "ms." << endl;
-	cout << "finish build VS-Tree." << endl;
 	
 	delete this->vstree;
 	this->vstree = NULL;
@@ -1195,21 +1513,60 @@ Database::exist_triple(int _sub_id, int _pre_id, int _obj_id)
 	return is_exist;
 }
 
+//sort the id tuples in spo order, drop the duplicates and keep the tuples that are in the database if _exist,
+//or those that are not, the sp2o list is read once for all tuples of a <sub, pre>
+int
+Database::selectTuples(int** _id_tuples, int _tuple_num, bool _exist)
+{
+	qsort(_id_tuples, _tuple_num, sizeof(int*), Database::_spo_cmp);
+
+	int* _objidlist = NULL;
+	int _list_len = 0;
+	int _valid_num = 0;
+	for (int i = 0; i < _tuple_num; ++i)
+	{
+		bool _keep = (i == 0 || Database::_spo_cmp(&_id_tuples[i - 1], &_id_tuples[i]) != 0);
+		if (_keep)
+		{
+			if (i == 0 || _id_tuples[i][0] != _id_tuples[i - 1][0] || _id_tuples[i][1] != _id_tuples[i - 1][1])
+			{
+				delete[] _objidlist;
+				_objidlist = NULL;
+				_list_len = 0;
+				(this->kvstore)->getobjIDlistBysubIDpreID(_id_tuples[i][0], _id_tuples[i][1], _objidlist, _list_len);
+			}
+			bool _in_db = (Util::bsearch_int_uporder(_id_tuples[i][2], _objidlist, _list_len) != -1);
+			_keep = (_in_db == _exist);
+		}
+
+		if (_keep)
+		{
+			_id_tuples[_valid_num++] = _id_tuples[i];
+		}
+		else
+		{
+			delete[] _id_tuples[i];
+		}
+	}
+	delete[] _objidlist;
+
+	return _valid_num;
+}
+
 //NOTICE: all constants are transfered to ids in memory
 //this maybe not ok when size is too large!
 bool
-Database::encodeRDF_new(const string _rdf_file, const char* _in_file)
+Database::encodeRDF_new(TripleSource& _source, const char* _in_file, const char* _global_id_file)
 {
 #ifdef DEBUG
 	//cerr<< "now to log!!!" << endl;
 	Util::logging("In encodeRDF_new");
 	//cerr<< "end log!!!" << endl;
 #endif
-	int** _p_id_tuples = NULL;
-	int _id_tuples_max = 0;
+	string _tuples_file = this->getStorePath() + "/id_tuples.dat";
 
 	//map sub2id, pre2id, entity/literal in obj2id, store in kvstore, encode RDF data into signature
-	if (!this->sub2id_pre2id_obj2id_RDFintoSignature(_rdf_file, _p_id_tuples, _id_tuples_max, _in_file))
+	if (!this->sub2id_pre2id_obj2id_RDFintoSignature(_source, _tuples_file, _in_file, _global_id_file))
 	{
 		return false;
 	}
@@ -1231,35 +1588,35 @@ Database::encodeRDF_new(const string _rdf_file, const char* _in_file)
 	/* map subid 2 objid_list  &
 	* subIDpreID 2 objid_list &
 	* subID 2 <preIDobjID>_list */
-	//this->s2o_s2po_sp2o(_p_id_tuples, _id_tuples_max);
+	//this->s2o_s2po_sp2o(_tuples_file);
 
 	/* map objid 2 subid_list  &
 	* objIDpreID 2 subid_list &
 	* objID 2 <preIDsubID>_list */
-	//this->o2s_o2ps_op2s(_p_id_tuples, _id_tuples_max);
+	//this->o2s_o2ps_op2s(_tuples_file);
 
-	//this->s2p_s2po_sp2o(_p_id_tuples, _id_tuples_max);
+	//this->s2p_s2po_sp2o(_tuples_file);
 	//NOTICE:we had better compute the corresponding triple num here
-	this->s2p_s2o_s2po_sp2o(_p_id_tuples, _id_tuples_max);
-	//this->s2p_s2o_s2po_sp2o_sp2n(_p_id_tuples, _id_tuples_max);
-	this->o2p_o2s_o2ps_op2s(_p_id_tuples, _id_tuples_max);
-	//this->o2p_o2s_o2ps_op2s_op2n(_p_id_tuples, _id_tuples_max);
-	this->p2s_p2o_p2so(_p_id_tuples, _id_tuples_max);
-	//this->p2s_p2o_p2so_p2n(_p_id_tuples, _id_tuples_max);
+	//the s2*, o2* and p2* indexes and the VSTree are built at the same time, see buildIndexes()
+	bool flag = this->buildIndexes(_tuples_file);
+	//this->s2p_s2o_s2po_sp2o_sp2n(_tuples_file);
+	//this->o2p_o2s_o2ps_op2s_op2n(_tuples_file);
+	//this->p2s_p2o_p2so_p2n(_tuples_file);
 	//
 	//WARN:this is too costly because s-o key num is too large
 	//100G+ for DBpedia2014
-	//this->so2p_s2o(_p_id_tuples, _id_tuples_max);
+	//this->so2p_s2o(_tuples_file);
+
+	::remove(_tuples_file.c_str());
 
-	//WARN:we must free the memory for id_tuples array
-	//for (int i = 0; i < _id_tuples_max; ++i)
-	for (int i = 0; i < this->triples_num; ++i)
+	//the info file is not saved for the database with some indexes missing
+	if (!flag)
 	{
-		delete[] _p_id_tuples[i];
+		cerr << "error: fail to build the indexes. @Database::encodeRDF_new" << endl;
+		return false;
 	}
-	delete[] _p_id_tuples;
 
-	bool flag = this->saveDBInfoFile();
+	flag = this->saveDBInfoFile();
 	if (!flag)
 	{
 		return false;
@@ -1280,11 +1637,10 @@ Database::encodeRDF_new(const string _rdf_file)
 	Util::logging("In encodeRDF_new");
 	//cerr<< "end log!!!" << endl;
 #endif
-	int** _p_id_tuples = NULL;
-	int _id_tuples_max = 0;
+	string _tuples_file = this->getStorePath() + "/id_tuples.dat";
 
 	//map sub2id, pre2id, entity/literal in obj2id, store in kvstore, encode RDF data into signature
-	if (!this->sub2id_pre2id_obj2id_RDFintoSignature(_rdf_file, _p_id_tuples, _id_tuples_max))
+	if (!this->sub2id_pre2id_obj2id_RDFintoSignature(_rdf_file, _tuples_file))
 	{
 		return false;
 	}
@@ -1306,35 +1662,35 @@ Database::encodeRDF_new(const string _rdf_file)
 	/* map subid 2 objid_list  &
 	* subIDpreID 2 objid_list &
 	* subID 2 <preIDobjID>_list */
-	//this->s2o_s2po_sp2o(_p_id_tuples, _id_tuples_max);
+	//this->s2o_s2po_sp2o(_tuples_file);
 
 	/* map objid 2 subid_list  &
 	* objIDpreID 2 subid_list &
 	* objID 2 <preIDsubID>_list */
-	//this->o2s_o2ps_op2s(_p_id_tuples, _id_tuples_max);
+	//this->o2s_o2ps_op2s(_tuples_file);
 
-	//this->s2p_s2po_sp2o(_p_id_tuples, _id_tuples_max);
+	//this->s2p_s2po_sp2o(_tuples_file);
 	//NOTICE:we had better compute the corresponding triple num here
-	this->s2p_s2o_s2po_sp2o(_p_id_tuples, _id_tuples_max);
-	//this->s2p_s2o_s2po_sp2o_sp2n(_p_id_tuples, _id_tuples_max);
-	this->o2p_o2s_o2ps_op2s(_p_id_tuples, _id_tuples_max);
-	//this->o2p_o2s_o2ps_op2s_op2n(_p_id_tuples, _id_tuples_max);
-	this->p2s_p2o_p2so(_p_id_tuples, _id_tuples_max);
-	//this->p2s_p2o_p2so_p2n(_p_id_tuples, _id_tuples_max);
+	//the s2*, o2* and p2* indexes and the VSTree are built at the same time, see buildIndexes()
+	bool flag = this->buildIndexes(_tuples_file);
+	//this->s2p_s2o_s2po_sp2o_sp2n(_tuples_file);
+	//this->o2p_o2s_o2ps_op2s_op2n(_tuples_file);
+	//this->p2s_p2o_p2so_p2n(_tuples_file);
 	//
 	//WARN:this is too costly because s-o key num is too large
 	//100G+ for DBpedia2014
-	//this->so2p_s2o(_p_id_tuples, _id_tuples_max);
+	//this->so2p_s2o(_tuples_file);
+
+	::remove(_tuples_file.c_str());
 
-	//WARN:we must free the memory for id_tuples array
-	//for (int i = 0; i < _id_tuples_max; ++i)
-	for (int i = 0; i < this->triples_num; ++i)
+	//the info file is not saved for the database with some indexes missing
+	if (!flag)
 	{
-		delete[] _p_id_tuples[i];
+		cerr << "error: fail to build the indexes. @Database::encodeRDF_new" << endl;
+		return false;
 	}
-	delete[] _p_id_tuples;
 
-	bool flag = this->saveDBInfoFile();
+	flag = this->saveDBInfoFile();
 	if (!flag)
 	{
 		return false;
@@ -1346,15 +1702,28 @@ Database::encodeRDF_new(const string _rdf_file)
 }
 
 
+//record the global ID of a local ID, the local IDs are allocated in order in build
+static void
+setGlobalID(vector<int>& _global_ids, int _pos, int _global_id)
+{
+	if (_pos >= (int)_global_ids.size())
+	{
+		_global_ids.resize(2 * _pos + 1, -1);
+	}
+	_global_ids[_pos] = _global_id;
+}
+
 bool
-Database::sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, int**& _p_id_tuples, int & _id_tuples_max, const char* _in_file)
+Database::sub2id_pre2id_obj2id_RDFintoSignature(TripleSource& _source, const string& _tuples_file, const char* _in_file, const char* _global_id_file)
 {
-	int _id_tuples_size;
+	//the ID triples are written to _tuples_file instead of being kept in memory
+	IDTripleWriter _tuples_writer;
+	if (!_tuples_writer.open(_tuples_file))
+	{
+		return false;
+	}
 	{
 		//initial
-		_id_tuples_max = 10 * 1000 * 1000;
-		_p_id_tuples = new int*[_id_tuples_max];
-		_id_tuples_size = 0;
 		this->sub_num = 0;
 		this->pre_num = 0;
 		this->entity_num = 0;
@@ -1371,14 +1740,6 @@ Database::sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, int**& _
 	//Util::logging("finish initial sub2id_pre2id_obj2id");
 	cerr << "finish initial sub2id_pre2id_obj2id" << endl;
 
-	ifstream _fin(_rdf_file.c_str());
-	if (!_fin)
-	{
-		cerr << "sub2id&pre2id&obj2id: Fail to open : " << _rdf_file << endl;
-		//exit(0);
-		return false;
-	}
-
 	string _six_tuples_file = this->getSixTuplesFile();
 	ofstream _six_tuples_fout(_six_tuples_file.c_str());
 	if (!_six_tuples_fout)
@@ -1389,6 +1750,9 @@ Database::sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, int**& _
 	}
 
 	TripleWithObjType* triple_array = new TripleWithObjType[RDFParser::TRIPLE_NUM_PER_GROUP];
+	//the gid pairs handed over by the source, and the global ID of each local ID
+	vector<int> _triple_global_ids, _entity_global_ids, _literal_global_ids;
+	bool _source_global_ids = false;
 
 	//don't know the number of entity
 	//pre allocate entitybitset_max EntityBitSet for storing signature, double the space until the _entity_bitset is used up.
@@ -1401,16 +1765,18 @@ Database::sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, int**& _
 	}
 	EntityBitSet _tmp_bitset;
 
-	//parse a file
-	RDFParser _parser(_fin);
-
 	Util::logging("==> while(true)");
 
 	while (true)
 	{
 		int parse_triple_num = 0;
 
-		_parser.parseFile(triple_array, parse_triple_num);
+		_triple_global_ids.clear();
+		_source.getTriples(triple_array, parse_triple_num, _triple_global_ids);
+		if (!_triple_global_ids.empty())
+		{
+			_source_global_ids = true;
+		}
 
 		{
 			stringstream _ss;
@@ -1430,17 +1796,6 @@ Database::sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, int**& _
 		{
 			this->triples_num++;
 
-			//if the _id_tuples exceeds, double the space
-			if (_id_tuples_size == _id_tuples_max)
-			{
-				int _new_tuples_len = _id_tuples_max * 2;
-				int** _new_id_tuples = new int*[_new_tuples_len];
-				memcpy(_new_id_tuples, _p_id_tuples, sizeof(int*) * _id_tuples_max);
-				delete[] _p_id_tuples;
-				_p_id_tuples = _new_id_tuples;
-				_id_tuples_max = _new_tuples_len;
-			}
-
 			// For subject
 			// (all subject is entity, some object is entity, the other is literal)
 			string _sub = triple_array[i].getSubject();
@@ -1503,12 +1858,18 @@ Database::sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, int**& _
 				}
 			}
 
+			if (!_triple_global_ids.empty())
+			{
+				setGlobalID(_entity_global_ids, _sub_id, _triple_global_ids[2 * i]);
+				if (_obj_id >= Util::LITERAL_FIRST_ID)
+					setGlobalID(_literal_global_ids, _obj_id - Util::LITERAL_FIRST_ID, _triple_global_ids[2 * i + 1]);
+				else
+					setGlobalID(_entity_global_ids, _obj_id, _triple_global_ids[2 * i + 1]);
+			}
+
 			//  For id_tuples
-			_p_id_tuples[_id_tuples_size] = new int[3];
-			_p_id_tuples[_id_tuples_size][0] = _sub_id;
-			_p_id_tuples[_id_tuples_size][1] = _pre_id;
-			_p_id_tuples[_id_tuples_size][2] = _obj_id;
-			_id_tuples_size++;
+			int _id_tuple[3] = {_sub_id, _pre_id, _obj_id};
+			_tuples_writer.write(_id_tuple);
 
 #ifdef DEBUG_PRECISE
 			//  save six tuples
@@ -1564,13 +1925,14 @@ Database::sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, int**& _
 	}
 
 	Util::logging("==> end while(true)");
+	_tuples_writer.close();
 
 	delete[] triple_array;
-	_fin.close();
 	_six_tuples_fout.close();
 	
 	//-------------------------------- begin loading internal uris --------------------------------
-	vector<char> buffer(this->entity_num, '0');
+	this->internal_tags.clear();
+	this->internal_tags.resize(this->entity_num);
 	string buff;
     ifstream infile;
 
@@ -1607,7 +1969,7 @@ Database::sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, int**& _
 			
 			string tmp_uri_str = this->kvstore->getEntityByID(i);
 			if(internal_set.count(tmp_uri_str) != 0){
-				buffer[i] = '1';
+				this->internal_tags.set(i);
 			}
 			
 			delete _sig;
@@ -1626,18 +1988,26 @@ Database::sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, int**& _
     _internal_path << this->getStorePath() << "/internal_nodes.dat";
     cout << this->getStorePath() << " begin to import internal vertices to database " << _internal_path.str() << endl;
 
-    //FILE * pFile;
-    ofstream _internal_output(_internal_path.str().c_str());
-    //pFile = fopen (_internal_path.str().c_str(), "wb");
-    //fwrite(buffer, sizeof(char), this->entity_num, pFile);
-    //fclose(pFile);
-    for (int i = 0; i < buffer.size(); ++i){
-            _internal_output << buffer[i];
+    if (!this->writeInternalTags())
+    {
+            return false;
     }
-    _internal_output.close();
 	cout << this->getStorePath() << " import internal vertices to database " << _internal_path.str() << " done." << endl;
 	//-------------------------------- finish writing internal vertices --------------------------------
 
+	if (_global_id_file != NULL)
+	{
+		if (!this->saveGlobalIDs(_global_id_file))
+			return false;
+	}
+	else if (_source_global_ids)
+	{
+		_entity_global_ids.resize(this->entity_num, -1);
+		_literal_global_ids.resize(this->literal_num, -1);
+		if (!this->writeGlobalIDs(_entity_global_ids, _literal_global_ids))
+			return false;
+	}
+
 	{
 		stringstream _ss;
 		_ss << "finish sub2id pre2id obj2id" << endl;
@@ -1655,14 +2025,16 @@ Database::sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, int**& _
 //NOTICE: below are the the new ones
 
 bool
-Database::sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, int**& _p_id_tuples, int & _id_tuples_max)
+Database::sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, const string& _tuples_file)
 {
-	int _id_tuples_size;
+	//the ID triples are written to _tuples_file instead of being kept in memory
+	IDTripleWriter _tuples_writer;
+	if (!_tuples_writer.open(_tuples_file))
+	{
+		return false;
+	}
 	{
 		//initial
-		_id_tuples_max = 10 * 1000 * 1000;
-		_p_id_tuples = new int*[_id_tuples_max];
-		_id_tuples_size = 0;
 		this->sub_num = 0;
 		this->pre_num = 0;
 		this->entity_num = 0;
@@ -1738,17 +2110,6 @@ Database::sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, int**& _
 		{
 			this->triples_num++;
 
-			//if the _id_tuples exceeds, double the space
-			if (_id_tuples_size == _id_tuples_max)
-			{
-				int _new_tuples_len = _id_tuples_max * 2;
-				int** _new_id_tuples = new int*[_new_tuples_len];
-				memcpy(_new_id_tuples, _p_id_tuples, sizeof(int*) * _id_tuples_max);
-				delete[] _p_id_tuples;
-				_p_id_tuples = _new_id_tuples;
-				_id_tuples_max = _new_tuples_len;
-			}
-
 			// For subject
 			// (all subject is entity, some object is entity, the other is literal)
 			string _sub = triple_array[i].getSubject();
@@ -1812,11 +2173,8 @@ Database::sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, int**& _
 			}
 
 			//  For id_tuples
-			_p_id_tuples[_id_tuples_size] = new int[3];
-			_p_id_tuples[_id_tuples_size][0] = _sub_id;
-			_p_id_tuples[_id_tuples_size][1] = _pre_id;
-			_p_id_tuples[_id_tuples_size][2] = _obj_id;
-			_id_tuples_size++;
+			int _id_tuple[3] = {_sub_id, _pre_id, _obj_id};
+			_tuples_writer.write(_id_tuple);
 
 #ifdef DEBUG_PRECISE
 			//  save six tuples
@@ -1872,6 +2230,7 @@ Database::sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, int**& _
 	}
 
 	Util::logging("==> end while(true)");
+	_tuples_writer.close();
 
 	delete[] triple_array;
 	_fin.close();
@@ -1919,541 +2278,337 @@ Database::sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, int**& _
 
 //NOTICE: below are the the new ones
 bool
-Database::s2p_s2o_s2po_sp2o(int** _p_id_tuples, int _id_tuples_max)
-//Database::s2p_s2o_s2po_sp2o_sp2n(int** _p_id_tuples, int _id_tuples_max)
+Database::s2p_s2o_s2po_sp2o(const string& _tuples_file)
+//Database::s2p_s2o_s2po_sp2o_sp2n(const string& _tuples_file)
 {
-	qsort(_p_id_tuples, this->triples_num, sizeof(int*), Database::_spo_cmp);
-
-	int* _oidlist_s = NULL;
-	int* _pidlist_s = NULL;
-	int* _oidlist_sp = NULL;
-	int* _pidoidlist_s = NULL;
-
-	int _oidlist_s_len = 0;
-	int _pidlist_s_len = 0;
-	int _oidlist_sp_len = 0;
-	int _pidoidlist_s_len = 0;
-
-	// only _oidlist_s will be assigned with space, _oidlist_sp is always a part of _oidlist_s, just a pointer is enough
-	int _pidlist_max = 0;
-	int _pidoidlist_max = 0;
-	int _oidlist_max = 0;
-
-	//true means next sub is a different one from the previous one
-	bool _sub_change = true;
-	//true means next <sub,pre> is different from the previous pair
-	bool _sub_pre_change = true;
-	//true means next pre is different from the previous one
-	bool _pre_change = true;
+	//the tuples are read in spo order from a sorted copy of _tuples_file
+	string _sorted_file = _tuples_file + ".spo";
+	IDTripleSorter _sorter(this->getSortMemory());
+	if (!_sorter.sort(_tuples_file, _sorted_file, IDTripleSorter::SPO))
+	{
+		return false;
+	}
+	//the fields of a tuple in the keys and lists
+	int _s[] = { 0 };
+	int _p[] = { 1 };
+	int _o[] = { 2 };
+	int _sp[] = { 0, 1 };
+	int _po[] = { 1, 2 };
+	IDListReader _reader;
+	int _key[2];
+	const int* _list;
+	int _list_len;
 
 	//Util::logging("finish s2p_sp2o_s2po initial");
 	cerr << "finish s2p_sp2o_s2po initial" << endl;
 
+	//the lists keyed by sub come in ascending order of sub, so each of these trees
+	//is bulk-loaded in a pass of its own over the sorted tuples
 	(this->kvstore)->open_subID2objIDlist(KVstore::CREATE_MODE);
-	(this->kvstore)->open_subID2preIDlist(KVstore::CREATE_MODE);
-	(this->kvstore)->open_subIDpreID2objIDlist(KVstore::CREATE_MODE);
-	(this->kvstore)->open_subID2preIDobjIDlist(KVstore::CREATE_MODE);
-
-	//(this->kvstore)->open_subIDpreID2num(KVstore::CREATE_MODE);
-
-	for (int i = 0; i < this->triples_num; i++)
-		if (i + 1 == this->triples_num || (_p_id_tuples[i][0] != _p_id_tuples[i + 1][0] || _p_id_tuples[i][1] != _p_id_tuples[i + 1][1] || _p_id_tuples[i][2] != _p_id_tuples[i + 1][2]))
-		{
-			//cout<<"this is the "<<i<<"th loop"<<endl;
-			if (_sub_change)
-			{
-				//cout<<"subject changed!"<<endl;
-				//
-				//QUERY:pidlist and oidlist maybe different size, not always use 1000 as start?
-				//
-				//pidlist
-				_pidlist_max = 1000;
-				_pidlist_s = new int[_pidlist_max];
-				_pidlist_s_len = 0;
-				//pidoidlist
-				//_pidoidlist_max = 1000 * 2;
-				//_pidoidlist_s = new int[_pidoidlist_max];
-				//_pidoidlist_s_len = 0;
-
-				//NOTICE:when debug, can change 1000 to 10 to discover problem
-				//oidlist
-				_oidlist_max = 1000;
-				_oidlist_s = new int[_oidlist_max];
-				_oidlist_sp = _oidlist_s;
-				_oidlist_s_len = 0;
-				_oidlist_sp_len = 0;
-				/* pidoidlist */
-				_pidoidlist_max = 1000 * 2;
-				_pidoidlist_s = new int[_pidoidlist_max];
-				_pidoidlist_s_len = 0;
-			}
-			//if(_sub_pre_change)
-			//{
-			////oidlist
-			//_oidlist_max = 1000;
-			//_oidlist_sp = new int[_oidlist_max];
-			//_oidlist_sp_len = 0;
-			//}
-
-			//enlarge the space when needed
-			if (_pidlist_s_len == _pidlist_max)
-			{
-				_pidlist_max *= 10;
-				int* _new_pidlist_s = new int[_pidlist_max];
-				memcpy(_new_pidlist_s, _pidlist_s, sizeof(int) * _pidlist_s_len);
-				delete[] _pidlist_s;
-				_pidlist_s = _new_pidlist_s;
-			}
-
-			//enlarge the space when needed
-			if (_oidlist_s_len == _oidlist_max)
-			{
-				//cout<<"s2o need to enlarge"<<endl;
-				_oidlist_max *= 10;
-				int * _new_oidlist_s = new int[_oidlist_max];
-				memcpy(_new_oidlist_s, _oidlist_s, sizeof(int) * _oidlist_s_len);
-				/* (_oidlist_sp-_oidlist_s) is the offset of _oidlist_sp */
-				_oidlist_sp = _new_oidlist_s + (_oidlist_sp - _oidlist_s);
-				delete[] _oidlist_s;
-				_oidlist_s = _new_oidlist_s;
-			}
-			//enalrge the space when needed
-			//if(_oidlist_sp_len == _oidlist_max)
-			//{
-			//	_oidlist_max *= 10;
-			//	int* _new_oidlist_sp = new int[_oidlist_max];
-			//	memcpy(_new_oidlist_sp, _oidlist_sp, sizeof(int) * _oidlist_sp_len);
-			//	delete[] _oidlist_sp;
-			//	_oidlist_sp = _new_oidlist_sp;
-			//}
-
-			//enlarge the space when needed
-			if (_pidoidlist_s_len == _pidoidlist_max)
-			{
-				_pidoidlist_max *= 10;
-				int* _new_pidoidlist_s = new int[_pidoidlist_max];
-				memcpy(_new_pidoidlist_s, _pidoidlist_s, sizeof(int) * _pidoidlist_s_len);
-				delete[] _pidoidlist_s;
-				_pidoidlist_s = _new_pidoidlist_s;
-			}
-
-			int _sub_id = _p_id_tuples[i][0];
-			int _pre_id = _p_id_tuples[i][1];
-			int _obj_id = _p_id_tuples[i][2];
-			//		{
-			//			stringstream _ss;
-			//			_ss << _sub_id << "\t" << _pre_id << "\t" << _obj_id << endl;
-			//			Util::logging(_ss.str());
-			//		}
-
-			_oidlist_s[_oidlist_s_len] = _obj_id;
-			if (_sub_pre_change)
-			{
-				_oidlist_sp = _oidlist_s + _oidlist_s_len;
-			}
-			_oidlist_s_len++;
-			_oidlist_sp_len++;
-
-			//add objid to list
-			//_oidlist_sp[_oidlist_sp_len++] = _obj_id;
-			//WARN:this is wrong!
-
-			//add <preid, objid> to list
-			_pidoidlist_s[_pidoidlist_s_len] = _pre_id;
-			_pidoidlist_s[_pidoidlist_s_len + 1] = _obj_id;
-			_pidoidlist_s_len += 2;
-
-			//add preid to list
-			_pidlist_s[_pidlist_s_len++] = _pre_id;
-			//NOTICE:this should not be placed in sub_pre_change clause
-			//because it may cause error when removing
-
-			//whether sub in new triple changes or not
-			_sub_change = (i + 1 == this->triples_num) ||
-				(_p_id_tuples[i][0] != _p_id_tuples[i + 1][0]);
-
-			//whether pre in new triple changes or not
-			_pre_change = (i + 1 == this->triples_num) ||
-				(_p_id_tuples[i][1] != _p_id_tuples[i + 1][1]);
-
-			//whether <sub,pre> in new triple changes or not
-			_sub_pre_change = _sub_change || _pre_change;
+	//NOTICE+WARN:not ok to remove duplicates here
+	//s p1 o; s p2 o   the case is rare
+	//and if we remove duplicates, we can only see one in s2o
+	//This can cause error when remove triples, because we can not know if we should remove the oid
+	//And we can not know if the node is isolate when removing a triple
+	_reader.open(_sorted_file, 1, _s, 1, _o, true);
+	(this->kvstore)->loadobjIDlistBysubID(_reader);
+	_reader.close();
+	(this->kvstore)->close_subID2objIDlist();
 
-			if (_sub_pre_change)
-			{
-				//map subid&preid 2 triple num
-				//(this->kvstore)->setNumBysubIDpreID(_sub_id, _pre_id, _oidlist_sp_len);
-				//
-				//map subid&preid 2 objidlist
-				(this->kvstore)->addobjIDlistBysubIDpreID(_sub_id, _pre_id, _oidlist_sp, _oidlist_sp_len);
-				//if not use s2o memory
-				//delete[] _oidlist_sp;
-				_oidlist_sp = NULL;
-				_oidlist_sp_len = 0;
-			}
+	(this->kvstore)->open_subID2preIDlist(KVstore::CREATE_MODE);
+	_reader.open(_sorted_file, 1, _s, 1, _p);
+	(this->kvstore)->loadpreIDlistBysubID(_reader);
+	_reader.close();
+	(this->kvstore)->close_subID2preIDlist();
 
-			if (_sub_change)
-			{
-				(this->kvstore)->addpreIDlistBysubID(_sub_id, _pidlist_s, _pidlist_s_len);
-				delete[] _pidlist_s;
-				_pidlist_s = NULL;
-				_pidlist_s_len = 0;
-				//map subid 2 preid&objidlist
-				(this->kvstore)->addpreIDobjIDlistBysubID(_sub_id, _pidoidlist_s, _pidoidlist_s_len);
-				delete[] _pidoidlist_s;
-				_pidoidlist_s = NULL;
-				_pidoidlist_s_len = 0;
-
-				Util::sort(_oidlist_s, _oidlist_s_len);
-				//NOTICE+WARN:not ok to remove duplicates here
-				//s p1 o; s p2 o   the case is rare
-				//and if we remove duplicates, we can only see one in s2o
-				//This can cause error when remove triples, because we can not know if we should remove the oid
-				//And we can not know if the node is isolate when removing a triple
-				//_oidlist_s_len = Util::removeDuplicate(_oidlist_s, _oidlist_s_len);
-				(this->kvstore)->addobjIDlistBysubID(_sub_id, _oidlist_s, _oidlist_s_len);
-				delete[] _oidlist_s;
-				_oidlist_sp = _oidlist_s = NULL;
-				_oidlist_sp_len = _oidlist_s_len = 0;
-			}
+	(this->kvstore)->open_subID2preIDobjIDlist(KVstore::CREATE_MODE);
+	_reader.open(_sorted_file, 1, _s, 2, _po);
+	(this->kvstore)->loadpreIDobjIDlistBysubID(_reader);
+	_reader.close();
+	(this->kvstore)->close_subID2preIDobjIDlist();
 
-		}//end for( 0 to this->triple_num)
+	//<sub,pre> keys are compared byte by byte in the tree, which is not the order of the ids
+	(this->kvstore)->open_subIDpreID2objIDlist(KVstore::CREATE_MODE);
+	_reader.open(_sorted_file, 2, _sp, 1, _o);
+	while (_reader.read(_key, _list, _list_len))
+	{
+		(this->kvstore)->addobjIDlistBysubIDpreID(_key[0], _key[1], _list, _list_len);
+	}
+	_reader.close();
+	(this->kvstore)->close_subIDpreID2objIDlist();
+	::remove(_sorted_file.c_str());
 
 		 //Util::logging("OUT s2po...");
 	cerr << "OUT s2po..." << endl;
 
-	(this->kvstore)->close_subID2objIDlist();
-	(this->kvstore)->close_subID2preIDlist();
-	(this->kvstore)->close_subIDpreID2objIDlist();
-	(this->kvstore)->close_subID2preIDobjIDlist();
-
 	return true;
 }
 
 bool
-Database::o2p_o2s_o2ps_op2s(int** _p_id_tuples, int _id_tuples_max)
-//Database::o2p_o2s_o2ps_op2s_op2n(int** _p_id_tuples, int _id_tuples_max)
+Database::o2p_o2s_o2ps_op2s(const string& _tuples_file)
+//Database::o2p_o2s_o2ps_op2s_op2n(const string& _tuples_file)
 {
 	//Util::logging("IN o2ps...");
 	cerr << "IN o2ps..." << endl;
 
-	qsort(_p_id_tuples, this->triples_num, sizeof(int**), Database::_ops_cmp);
-	int* _sidlist_o = NULL;
-	int* _sidlist_op = NULL;
-	int* _pidsidlist_o = NULL;
-	int* _pidlist_o = NULL;
-	int _sidlist_o_len = 0;
-	int _sidlist_op_len = 0;
-	int _pidsidlist_o_len = 0;
-	int _pidlist_o_len = 0;
-
-	//only _sidlist_o will be assigned with space _sidlist_op is always a part of _sidlist_o just a pointer is enough
-	int _sidlist_max = 0;
-	int _pidsidlist_max = 0;
-	int _pidlist_max = 0;
-
-	//true means next obj is a different one from the previous one
-	bool _obj_change = true;
-
-	//true means next pre is a different one from the previous one
-	bool _pre_change = true;
-
-	//true means next <obj,pre> is different from the previous pair
-	bool _obj_pre_change = true;
-
+	//the tuples are read in ops order from a sorted copy of _tuples_file
+	string _sorted_file = _tuples_file + ".ops";
+	IDTripleSorter _sorter(this->getSortMemory());
+	if (!_sorter.sort(_tuples_file, _sorted_file, IDTripleSorter::OPS))
+	{
+		return false;
+	}
+	//the fields of a tuple in the keys and lists
+	int _s[] = { 0 };
+	int _p[] = { 1 };
+	int _o[] = { 2 };
+	int _op[] = { 2, 1 };
+	int _ps[] = { 1, 0 };
+	IDListReader _reader;
+	int _key[2];
+	const int* _list;
+	int _list_len;
+
+	//the lists keyed by obj come in ascending order of obj, see s2p_s2o_s2po_sp2o()
 	(this->kvstore)->open_objID2subIDlist(KVstore::CREATE_MODE);
-	(this->kvstore)->open_objIDpreID2subIDlist(KVstore::CREATE_MODE);
-	(this->kvstore)->open_objID2preIDsubIDlist(KVstore::CREATE_MODE);
-	(this->kvstore)->open_objID2preIDlist(KVstore::CREATE_MODE);
-
-	//(this->kvstore)->open_objIDpreID2num(KVstore::CREATE_MODE);
-
-	for (int i = 0; i < this->triples_num; i++)
-		if (i + 1 == this->triples_num || (_p_id_tuples[i][0] != _p_id_tuples[i + 1][0] || _p_id_tuples[i][1] != _p_id_tuples[i + 1][1] || _p_id_tuples[i][2] != _p_id_tuples[i + 1][2]))
-		{
-			if (_obj_change)
-			{
-				//sidlist
-				_sidlist_max = 1000;
-				_sidlist_o = new int[_sidlist_max];
-				_sidlist_op = _sidlist_o;
-				_sidlist_o_len = 0;
-				_sidlist_op_len = 0;
-				//pidsidlist
-				_pidsidlist_max = 1000 * 2;
-				_pidsidlist_o = new int[_pidsidlist_max];
-				_pidsidlist_o_len = 0;
-				//pidlist
-				_pidlist_max = 1000;
-				_pidlist_o = new int[_pidlist_max];
-				_pidlist_o_len = 0;
-			}
-
-			//enlarge the space when needed
-			if (_sidlist_o_len == _sidlist_max)
-			{
-				_sidlist_max *= 10;
-				int * _new_sidlist_o = new int[_sidlist_max];
-				memcpy(_new_sidlist_o, _sidlist_o, sizeof(int)*_sidlist_o_len);
-				/* (_sidlist_op-_sidlist_o) is the offset of _sidlist_op */
-				_sidlist_op = _new_sidlist_o + (_sidlist_op - _sidlist_o);
-				delete[] _sidlist_o;
-				_sidlist_o = _new_sidlist_o;
-			}
-
-			//enlarge the space when needed
-			if (_pidsidlist_o_len == _pidsidlist_max)
-			{
-				_pidsidlist_max *= 10;
-				int* _new_pidsidlist_o = new int[_pidsidlist_max];
-				memcpy(_new_pidsidlist_o, _pidsidlist_o, sizeof(int) * _pidsidlist_o_len);
-				delete[] _pidsidlist_o;
-				_pidsidlist_o = _new_pidsidlist_o;
-			}
-
-			//enlarge the space when needed
-			if (_pidlist_o_len == _pidlist_max)
-			{
-				_pidlist_max *= 10;
-				int* _new_pidlist_o = new int[_pidlist_max];
-				memcpy(_new_pidlist_o, _pidlist_o, sizeof(int) * _pidlist_o_len);
-				delete[] _pidlist_o;
-				_pidlist_o = _new_pidlist_o;
-			}
-
-			int _sub_id = _p_id_tuples[i][0];
-			int _pre_id = _p_id_tuples[i][1];
-			int _obj_id = _p_id_tuples[i][2];
-
-			//add subid to list
-			_sidlist_o[_sidlist_o_len] = _sub_id;
-
-			//if <objid, preid> changes, _sidlist_op should be adjusted
-			if (_obj_pre_change)
-			{
-				_sidlist_op = _sidlist_o + _sidlist_o_len;
-			}
-
-			_sidlist_o_len++;
-			_sidlist_op_len++;
-
-			//add <preid, subid> to list
-			_pidsidlist_o[_pidsidlist_o_len] = _pre_id;
-			_pidsidlist_o[_pidsidlist_o_len + 1] = _sub_id;;
-			_pidsidlist_o_len += 2;
-
-			//add preid to list
-			_pidlist_o[_pidlist_o_len++] = _pre_id;
-			//NOTICE:this should not be placed in sub_pre_change clause
-			//because it may cause error when removing
-
-			//whether sub in new triple changes or not
-			_obj_change = (i + 1 == this->triples_num) ||
-				(_p_id_tuples[i][2] != _p_id_tuples[i + 1][2]);
-
-			//whether pre in new triple changes or not
-			_pre_change = (i + 1 == this->triples_num) ||
-				(_p_id_tuples[i][1] != _p_id_tuples[i + 1][1]);
-
-			//whether <sub,pre> in new triple changes or not
-			_obj_pre_change = _obj_change || _pre_change;
-
-			if (_obj_pre_change)
-			{
-				//map objid&preid 2 triple num
-				//(this->kvstore)->setNumByobjIDpreID(_obj_id, _pre_id, _sidlist_op_len);
-				//
-				//map objid&preid 2 subidlist
-				(this->kvstore)->addsubIDlistByobjIDpreID(_obj_id, _pre_id, _sidlist_op, _sidlist_op_len);
-				_sidlist_op = NULL;
-				_sidlist_op_len = 0;
-			}
+	_reader.open(_sorted_file, 1, _o, 1, _s, true);
+	(this->kvstore)->loadsubIDlistByobjID(_reader);
+	_reader.close();
+	(this->kvstore)->close_objID2subIDlist();
 
-			if (_obj_change)
-			{
-				//map objid 2 subidlist
-				Util::sort(_sidlist_o, _sidlist_o_len);
-				//NOTICE+WARN:the same reason as in s2o index
-				//_sidlist_o_len = Util::removeDuplicate(_sidlist_o, _sidlist_o_len);
-				(this->kvstore)->addsubIDlistByobjID(_obj_id, _sidlist_o, _sidlist_o_len);
-				delete[] _sidlist_o;
-				_sidlist_o = NULL;
-				_sidlist_op = NULL;
-				_sidlist_o_len = 0;
-
-				//map objid 2 preid&subidlist
-				(this->kvstore)->addpreIDsubIDlistByobjID(_obj_id, _pidsidlist_o, _pidsidlist_o_len);
-				delete[] _pidsidlist_o;
-				_pidsidlist_o = NULL;
-				_pidsidlist_o_len = 0;
-
-				//map objid 2 preidlist
-				(this->kvstore)->addpreIDlistByobjID(_obj_id, _pidlist_o, _pidlist_o_len);
-				delete[] _pidlist_o;
-				_pidlist_o = NULL;
-				_pidlist_o_len = 0;
-			}
+	(this->kvstore)->open_objID2preIDsubIDlist(KVstore::CREATE_MODE);
+	_reader.open(_sorted_file, 1, _o, 2, _ps);
+	(this->kvstore)->loadpreIDsubIDlistByobjID(_reader);
+	_reader.close();
+	(this->kvstore)->close_objID2preIDsubIDlist();
 
-		}//end for( 0 to this->triple_num)
+	(this->kvstore)->open_objID2preIDlist(KVstore::CREATE_MODE);
+	_reader.open(_sorted_file, 1, _o, 1, _p);
+	(this->kvstore)->loadpreIDlistByobjID(_reader);
+	_reader.close();
+	(this->kvstore)->close_objID2preIDlist();
 
+	(this->kvstore)->open_objIDpreID2subIDlist(KVstore::CREATE_MODE);
+	_reader.open(_sorted_file, 2, _op, 1, _s);
+	while (_reader.read(_key, _list, _list_len))
+	{
+		(this->kvstore)->addsubIDlistByobjIDpreID(_key[0], _key[1], _list, _list_len);
+	}
+	_reader.close();
+	(this->kvstore)->close_objIDpreID2subIDlist();
+	::remove(_sorted_file.c_str());
 
 		 //Util::logging("OUT o2ps...");
 	cerr << "OUT o2ps..." << endl;
 
-	(this->kvstore)->close_objID2subIDlist();
-	(this->kvstore)->close_objIDpreID2subIDlist();
-	(this->kvstore)->close_objID2preIDsubIDlist();
-	(this->kvstore)->close_objID2preIDlist();
-
 	return true;
 }
 
 bool
-Database::p2s_p2o_p2so(int** _p_id_tuples, int _id_tuples_max)
-//Database::p2s_p2o_p2so_p2n(int** _p_id_tuples, int _id_tuples_max)
+Database::p2s_p2o_p2so(const string& _tuples_file)
+//Database::p2s_p2o_p2so_p2n(const string& _tuples_file)
 {
-	qsort(_p_id_tuples, this->triples_num, sizeof(int*), Database::_pso_cmp);
-	int* _sidlist_p = NULL;
-	int* _oidlist_p = NULL;
-	int* _sidoidlist_p = NULL;
-	int _sidlist_p_len = 0;
-	int _oidlist_p_len = 0;
-	int _sidoidlist_p_len = 0;
-	int _sidlist_max = 0;
-	int _sidoidlist_max = 0;
-	int _oidlist_max = 0;
-
-	//true means next pre is different from the previous one
-	bool _pre_change = true;
-	bool _sub_change = true;
-	//bool _pre_sub_change = true;
+	//the tuples are read in pso order from a sorted copy of _tuples_file
+	string _sorted_file = _tuples_file + ".pso";
+	IDTripleSorter _sorter(this->getSortMemory());
+	if (!_sorter.sort(_tuples_file, _sorted_file, IDTripleSorter::PSO))
+	{
+		return false;
+	}
+	//the fields of a tuple in the keys and lists
+	int _s[] = { 0 };
+	int _p[] = { 1 };
+	int _o[] = { 2 };
+	int _so[] = { 0, 2 };
+	IDListReader _reader;
 
 	//Util::logging("finish p2s_p2o_p2so initial");
 	cerr << "finish p2s_p2o_p2so initial" << endl;
 
+	//the lists keyed by pre come in ascending order of pre, see s2p_s2o_s2po_sp2o()
 	(this->kvstore)->open_preID2subIDlist(KVstore::CREATE_MODE);
+	_reader.open(_sorted_file, 1, _p, 1, _s);
+	(this->kvstore)->loadsubIDlistBypreID(_reader);
+	_reader.close();
+	(this->kvstore)->close_preID2subIDlist();
+
 	(this->kvstore)->open_preID2objIDlist(KVstore::CREATE_MODE);
-	(this->kvstore)->open_preID2subIDobjIDlist(KVstore::CREATE_MODE);
+	_reader.open(_sorted_file, 1, _p, 1, _o, true);
+	(this->kvstore)->loadobjIDlistBypreID(_reader);
+	_reader.close();
+	(this->kvstore)->close_preID2objIDlist();
 
-	//(this->kvstore)->open_preID2num(KVstore::CREATE_MODE);
+	(this->kvstore)->open_preID2subIDobjIDlist(KVstore::CREATE_MODE);
+	_reader.open(_sorted_file, 1, _p, 2, _so);
+	(this->kvstore)->loadsubIDobjIDlistBypreID(_reader);
+	_reader.close();
+	(this->kvstore)->close_preID2subIDobjIDlist();
 
-	for (int i = 0; i < this->triples_num; i++)
-		if (i + 1 == this->triples_num || (_p_id_tuples[i][0] != _p_id_tuples[i + 1][0] || _p_id_tuples[i][1] != _p_id_tuples[i + 1][1] || _p_id_tuples[i][2] != _p_id_tuples[i + 1][2]))
+	//the stats of each predicate for the join order, saved along with the kvstore
+	_reader.open(_sorted_file, 1, _p, 2, _so);
+	{
+		int _pre_id;
+		const int* _so_list;
+		int _so_len;
+		vector<int> _obj_list;
+		while (_reader.read(&_pre_id, _so_list, _so_len))
 		{
-			if (_pre_change)
-			{
-				//sidlist
-				_sidlist_max = 1000;
-				_sidlist_p = new int[_sidlist_max];
-				_sidlist_p_len = 0;
-				//sidoidlist
-				_sidoidlist_max = 1000 * 2;
-				_sidoidlist_p = new int[_sidoidlist_max];
-				_sidoidlist_p_len = 0;
-				//oidlist
-				_oidlist_max = 1000;
-				_oidlist_p = new int[_oidlist_max];
-				_oidlist_p_len = 0;
-			}
-
-			//enlarge the space when needed
-			if (_sidlist_p_len == _sidlist_max)
+			int _sub_num = 0;
+			_obj_list.clear();
+			for (int i = 0; i < _so_len; i += 2)
 			{
-				_sidlist_max *= 10;
-				int* _new_sidlist_p = new int[_sidlist_max];
-				memcpy(_new_sidlist_p, _sidlist_p, sizeof(int) * _sidlist_p_len);
-				delete[] _sidlist_p;
-				_sidlist_p = _new_sidlist_p;
-			}
-
-			//enalrge the space when needed
-			if (_oidlist_p_len == _oidlist_max)
-			{
-				_oidlist_max *= 10;
-				int* _new_oidlist_p = new int[_oidlist_max];
-				memcpy(_new_oidlist_p, _oidlist_p, sizeof(int) * _oidlist_p_len);
-				delete[] _oidlist_p;
-				_oidlist_p = _new_oidlist_p;
-			}
-
-			//enlarge the space when needed
-			if (_sidoidlist_p_len == _sidoidlist_max)
-			{
-				_sidoidlist_max *= 10;
-				int* _new_sidoidlist_p = new int[_sidoidlist_max];
-				memcpy(_new_sidoidlist_p, _sidoidlist_p, sizeof(int) * _sidoidlist_p_len);
-				delete[] _sidoidlist_p;
-				_sidoidlist_p = _new_sidoidlist_p;
+				if (i == 0 || _so_list[i] != _so_list[i - 2])
+				{
+					_sub_num++;
+				}
+				_obj_list.push_back(_so_list[i + 1]);
 			}
+			sort(_obj_list.begin(), _obj_list.end());
+			(this->kvstore)->setNumBypreID(_pre_id, _so_len / 2);
+			(this->kvstore)->setSubNumBypreID(_pre_id, _sub_num);
+			(this->kvstore)->setObjNumBypreID(_pre_id, unique(_obj_list.begin(), _obj_list.end()) - _obj_list.begin());
+		}
+	}
+	_reader.close();
+	::remove(_sorted_file.c_str());
 
-			int _sub_id = _p_id_tuples[i][0];
-			int _pre_id = _p_id_tuples[i][1];
-			int _obj_id = _p_id_tuples[i][2];
-			//		{
-			//			stringstream _ss;
-			//			_ss << _sub_id << "\t" << _pre_id << "\t" << _obj_id << endl;
-			//			Util::logging(_ss.str());
-			//		}
+		 //Util::logging("OUT p2so...");
+	cerr << "OUT p2so..." << endl;
 
-			//add objid to list
-			_oidlist_p[_oidlist_p_len++] = _obj_id;
+	return true;
+}
 
-			//add <subid, objid> to list
-			_sidoidlist_p[_sidoidlist_p_len] = _sub_id;
-			_sidoidlist_p[_sidoidlist_p_len + 1] = _obj_id;
-			_sidoidlist_p_len += 2;
+//the arguments of the threads of buildIndexes()
+struct BuildIndexPool
+{
+	Database* db;
+	const string* tuples_file;
+	pthread_mutex_t lock;
+	int next_index;
+	vector<char> flags;
+};
+
+void*
+Database::buildIndexThread(void* _pool)
+{
+	BuildIndexPool* pool = (BuildIndexPool*)_pool;
+	while (true)
+	{
+		pthread_mutex_lock(&pool->lock);
+		int index = pool->next_index++;
+		pthread_mutex_unlock(&pool->lock);
+		if (index >= Database::BUILD_INDEX_NUM)
+		{
+			break;
+		}
+		pool->flags[index] = pool->db->buildIndex(index, *pool->tuples_file);
+	}
+	return NULL;
+}
 
-			//whether sub in new triple changes or not
-			_pre_change = (i + 1 == this->triples_num) || (_p_id_tuples[i][1] != _p_id_tuples[i + 1][1]);
-			_sub_change = (i + 1 == this->triples_num) || (_p_id_tuples[i][0] != _p_id_tuples[i + 1][0]);
-			//_pre_sub_change = _pre_change || _sub_change;
+//each index has trees of its own and the s2*, o2* and p2* ones sort their own copies
+//of _tuples_file, so nothing is shared between the threads but the file read
+bool
+Database::buildIndexes(const string& _tuples_file)
+{
+	int thread_num = min(this->build_thread_num, (int)Database::BUILD_INDEX_NUM);
+	BuildIndexPool pool;
+	pool.db = this;
+	pool.tuples_file = &_tuples_file;
+	pthread_mutex_init(&pool.lock, NULL);
+	pool.next_index = 0;
+	pool.flags.assign(Database::BUILD_INDEX_NUM, 0);
+
+	//the calling thread is one of the pool
+	vector<pthread_t> threads(thread_num);
+	vector<char> started(thread_num, 0);
+	for (int i = 1; i < thread_num; i++)
+	{
+		if (pthread_create(&threads[i], NULL, Database::buildIndexThread, &pool) == 0)
+		{
+			started[i] = 1;
+		}
+		else
+		{
+			cerr << "error: fail to create thread. @Database::buildIndexes" << endl;
+		}
+	}
+	Database::buildIndexThread(&pool);
+	for (int i = 1; i < thread_num; i++)
+	{
+		if (started[i])
+		{
+			pthread_join(threads[i], NULL);
+		}
+	}
+	pthread_mutex_destroy(&pool.lock);
 
-			//if(_pre_sub_change)
-			//{
-			//add subid to list
-			_sidlist_p[_sidlist_p_len++] = _sub_id;
-			//}
+	for (int i = 0; i < Database::BUILD_INDEX_NUM; i++)
+	{
+		if (!pool.flags[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
 
-			if (_pre_change)
-			{
-				//map preid 2 subidlist
-				(this->kvstore)->addsubIDlistBypreID(_pre_id, _sidlist_p, _sidlist_p_len);
-				delete[] _sidlist_p;
-				_sidlist_p = NULL;
-				_sidlist_p_len = 0;
-				//map preid 2 objidlist
-				Util::sort(_oidlist_p, _oidlist_p_len);
-				//_oidlist_p_len = Util::removeDuplicate(_oidlist_p, _oidlist_p_len);
-				(this->kvstore)->addobjIDlistBypreID(_pre_id, _oidlist_p, _oidlist_p_len);
-				delete[] _oidlist_p;
-				_oidlist_p = NULL;
-				_oidlist_p_len = 0;
-				//map preid 2 triple num
-				//(this->kvstore)->setNumBypreID(_pre_id, _sidoidlist_p_len/2);
-				//
-				//map preid 2 subid&objidlist
-				(this->kvstore)->addsubIDobjIDlistBypreID(_pre_id, _sidoidlist_p, _sidoidlist_p_len);
-				delete[] _sidoidlist_p;
-				_sidoidlist_p = NULL;
-				_sidoidlist_p_len = 0;
-			}
+bool
+Database::buildIndex(int _index, const string& _tuples_file)
+{
+	if (_index == Database::SUB_INDEXES)
+	{
+		return this->s2p_s2o_s2po_sp2o(_tuples_file);
+	}
+	if (_index == Database::OBJ_INDEXES)
+	{
+		return this->o2p_o2s_o2ps_op2s(_tuples_file);
+	}
+	if (_index == Database::PRE_INDEXES)
+	{
+		return this->p2s_p2o_p2so(_tuples_file);
+	}
 
-		}//end for( 0 to this->triple_num)
+	string _entry_file = this->getSignatureBFile();
+	cout << "begin build VS-Tree on " << _entry_file << "..." << endl;
+	bool flag = (this->vstree)->buildTree(_entry_file, this->build_thread_num);
+	cout << "finish build VS-Tree." << endl;
+	return flag;
+}
 
-		 //Util::logging("OUT p2so...");
-	cerr << "OUT p2so..." << endl;
+//the sorts of the s2*, o2* and p2* indexes may run at the same time
+long long
+Database::getSortMemory() const
+{
+	int sort_num = min(this->build_thread_num, 3);
+	return this->build_memory / max(sort_num, 1);
+}
 
-	(this->kvstore)->close_preID2subIDlist();
-	(this->kvstore)->close_preID2objIDlist();
-	(this->kvstore)->close_preID2subIDobjIDlist();
+void
+Database::setBuildThreadNum(int _thread_num)
+{
+	this->build_thread_num = max(_thread_num, 1);
+}
 
-	return true;
+void
+Database::setBuildMemory(long long _memory)
+{
+	this->build_memory = _memory;
 }
 
 bool
-Database::so2p_s2o(int** _p_id_tuples, int _id_tuples_max)
+Database::so2p_s2o(const string& _tuples_file)
 {
-	qsort(_p_id_tuples, this->triples_num, sizeof(int*), Database::_sop_cmp);
+	//the tuples are read in sop order from a sorted copy of _tuples_file
+	string _sorted_file = _tuples_file + ".sop";
+	IDTripleSorter _sorter;
+	IDTripleReader _reader;
+	if (!_sorter.sort(_tuples_file, _sorted_file, IDTripleSorter::SOP) || !_reader.open(_sorted_file))
+	{
+		return false;
+	}
+	int _tuple[3], _next_tuple[3];
+	bool _has_next = _reader.read(_next_tuple);
 	int* _pidlist_so = NULL;
 	int* _oidlist_s = NULL;
 	int _pidlist_so_len = 0;
@@ -2476,8 +2631,11 @@ Database::so2p_s2o(int** _p_id_tuples, int _id_tuples_max)
 	(this->kvstore)->open_subIDobjID2preIDlist(KVstore::CREATE_MODE);
 	(this->kvstore)->open_subID2objIDlist(KVstore::CREATE_MODE);
 
-	for (int i = 0; i < this->triples_num; i++)
-		if (i + 1 == this->triples_num || (_p_id_tuples[i][0] != _p_id_tuples[i + 1][0] || _p_id_tuples[i][1] != _p_id_tuples[i + 1][1] || _p_id_tuples[i][2] != _p_id_tuples[i + 1][2]))
+	while (_has_next)
+	{
+		memcpy(_tuple, _next_tuple, sizeof(_tuple));
+		_has_next = _reader.read(_next_tuple);
+		if (!_has_next || (_tuple[0] != _next_tuple[0] || _tuple[1] != _next_tuple[1] || _tuple[2] != _next_tuple[2]))
 		{
 			if (_sub_change)
 			{
@@ -2514,9 +2672,9 @@ Database::so2p_s2o(int** _p_id_tuples, int _id_tuples_max)
 				_oidlist_s = _new_oidlist_s;
 			}
 
-			int _sub_id = _p_id_tuples[i][0];
-			int _pre_id = _p_id_tuples[i][1];
-			int _obj_id = _p_id_tuples[i][2];
+			int _sub_id = _tuple[0];
+			int _pre_id = _tuple[1];
+			int _obj_id = _tuple[2];
 #ifdef DEBUG
 			//cout << kvstore->getEntityByID(_sub_id) << endl;
 			//cout << kvstore->getPredicateByID(_pre_id) << endl;
@@ -2527,15 +2685,15 @@ Database::so2p_s2o(int** _p_id_tuples, int _id_tuples_max)
 #endif
 
 			//whether sub in new triple changes or not
-			_sub_change = (i + 1 == this->triples_num) ||
-				(_p_id_tuples[i][0] != _p_id_tuples[i + 1][0]);
+			_sub_change = (!_has_next) ||
+				(_tuple[0] != _next_tuple[0]);
 
 			//whether pre in new triple changes or not
-			_obj_change = (i + 1 == this->triples_num) ||
-				(_p_id_tuples[i][2] != _p_id_tuples[i + 1][2]);
+			_obj_change = (!_has_next) ||
+				(_tuple[2] != _next_tuple[2]);
 
-			_pre_change = (i + 1 == this->triples_num) ||
-				(_p_id_tuples[i][1] != _p_id_tuples[i + 1][1]);
+			_pre_change = (!_has_next) ||
+				(_tuple[1] != _next_tuple[1]);
 
 			//whether <sub,pre> in new triple changes or not
 			_sub_obj_change = _sub_change || _obj_change;
@@ -2571,7 +2729,10 @@ Database::so2p_s2o(int** _p_id_tuples, int _id_tuples_max)
 				_oidlist_s = NULL;
 				_oidlist_s_len = 0;
 			}
-		}//end for( 0 to this->triple_num)
+		}
+	}//end while(_has_next)
+	_reader.close();
+	::remove(_sorted_file.c_str());
 		 //int* list = NULL;
 		 //int len = 0;
 		 //kvstore->getpreIDlistBysubIDobjID(4, 1000000004, list, len);
@@ -3211,63 +3372,48 @@ Database::insert(const TripleWithObjType* _triples, int _triple_num)
 #ifdef USE_GROUP_INSERT
 	//NOTICE:this is called by insert(file) or query()(but can not be too large),
 	//assume that db is loaded already
+	//each id tuple keeps the index of its triple at [3], for the signatures
 	int** id_tuples = new int*[_triple_num];
 	int valid_num = 0;
 	int i = 0;
-	//for(i = 0; i < _triple_num; ++i)
-	//{
-	//id_tuples[i] = new int[3];
-	//}
-	map<int, EntityBitSet> old_sigmap;
-	map<int, EntityBitSet> new_sigmap;
 	set<int> new_entity;
-	map<int, EntityBitSet>::iterator it;
-	EntityBitSet tmpset;
-	tmpset.reset();
 
 	int subid, objid, preid;
-	bool is_obj_entity;
 	for (i = 0; i < _triple_num; ++i)
 	{
-		bool is_new_sub = false, is_new_pre = false, is_new_obj = false;
-
 		string sub = _triples[i].getSubject();
 		subid = this->kvstore->getIDByEntity(sub);
 		if (subid == -1)
 		{
-			is_new_sub = true;
 			subid = this->allocEntityID();
-			cout<<"this is a new subject: "<<sub<<" "<<subid<<endl;
 			this->sub_num++;
 			this->kvstore->setIDByEntity(sub, subid);
 			this->kvstore->setEntityByID(subid, sub);
 			new_entity.insert(subid);
+			_vertices.push_back(subid);
 		}
 
 		string pre = _triples[i].getPredicate();
 		preid = this->kvstore->getIDByPredicate(pre);
 		if (preid == -1)
 		{
-			is_new_pre = true;
 			preid = this->allocPredicateID();
 			this->kvstore->setIDByPredicate(pre, preid);
 			this->kvstore->setPredicateByID(preid, pre);
+			_predicates.push_back(preid);
 		}
 
-		is_obj_entity = _triples[i].isObjEntity();
 		string obj = _triples[i].getObject();
-		if (is_obj_entity)
+		if (_triples[i].isObjEntity())
 		{
 			objid = this->kvstore->getIDByEntity(obj);
 			if (objid == -1)
 			{
-				is_new_obj = true;
 				objid = this->allocEntityID();
-				cout<<"this is a new object: "<<obj<<" "<<objid<<endl;
-				//this->obj_num++;
 				this->kvstore->setIDByEntity(obj, objid);
 				this->kvstore->setEntityByID(objid, obj);
 				new_entity.insert(objid);
+				_vertices.push_back(objid);
 			}
 		}
 		else //isObjLiteral
@@ -3275,134 +3421,50 @@ Database::insert(const TripleWithObjType* _triples, int _triple_num)
 			objid = this->kvstore->getIDByLiteral(obj);
 			if (objid == -1)
 			{
-				is_new_obj = true;
 				objid = this->allocLiteralID();
-				//this->obj_num++;
 				this->kvstore->setIDByLiteral(obj, objid);
 				this->kvstore->setLiteralByID(objid, obj);
+				_vertices.push_back(objid);
 			}
 		}
 
-		bool triple_exist = false;
-		if (!is_new_sub && !is_new_pre && !is_new_obj)
-		{
-			triple_exist = this->exist_triple(subid, preid, objid);
-		}
-		if (triple_exist)
-		{
-			cout<<"this triple exist"<<endl;
-			continue;
-		}
-		cout<<"this triple not exist"<<endl;
-
-		id_tuples[valid_num] = new int[3];
+		id_tuples[valid_num] = new int[4];
 		id_tuples[valid_num][0] = subid;
 		id_tuples[valid_num][1] = preid;
 		id_tuples[valid_num][2] = objid;
-		this->triples_num++;
+		id_tuples[valid_num][3] = i;
 		valid_num++;
+	}
 
-		tmpset.reset();
-		Signature::encodePredicate2Entity(preid, tmpset, Util::EDGE_OUT);
-		Signature::encodeStr2Entity(obj.c_str(), tmpset);
-		if(new_entity.find(subid) != new_entity.end())
-		{
-			it = new_sigmap.find(subid);
-			if (it != new_sigmap.end())
-			{
-				it->second |= tmpset;
-			}
-			else
-			{
-				new_sigmap[subid] = tmpset;
-			}
-		}
-		else
-		{
-			it = old_sigmap.find(subid);
-			if (it != old_sigmap.end())
-			{
-				it->second |= tmpset;
-			}
-			else
-			{
-				old_sigmap[subid] = tmpset;
-			}
-		}
+	//duplicates in the group and triples already in the database are dropped, the tuples are in spo order then
+	valid_num = this->selectTuples(id_tuples, valid_num, false);
+	this->triples_num += valid_num;
 
-		if (is_obj_entity)
+	//the signature bits of all new triples of an entity are gathered, to update its entry once
+	map<int, EntityBitSet> sigmap;
+	map<int, EntityBitSet>::iterator it;
+	EntityBitSet tmpset;
+	for (i = 0; i < valid_num; ++i)
+	{
+		const TripleWithObjType& triple = _triples[id_tuples[i][3]];
+		tmpset.reset();
+		this->encodeTriple2SubEntityBitSet(tmpset, &triple);
+		sigmap[id_tuples[i][0]] |= tmpset;
+		if (triple.isObjEntity())
 		{
 			tmpset.reset();
-			Signature::encodePredicate2Entity(preid, tmpset, Util::EDGE_IN);
-			Signature::encodeStr2Entity(sub.c_str(), tmpset);
-			if(new_entity.find(objid) != new_entity.end())
-			{
-				it = new_sigmap.find(objid);
-				if (it != new_sigmap.end())
-				{
-					it->second |= tmpset;
-				}
-				else
-				{
-					new_sigmap[objid] = tmpset;
-				}
-			}
-			else
-			{
-				it = old_sigmap.find(objid);
-				if (it != old_sigmap.end())
-				{
-					it->second |= tmpset;
-				}
-				else
-				{
-					old_sigmap[objid] = tmpset;
-				}
-			}
+			this->encodeTriple2ObjEntityBitSet(tmpset, &triple);
+			sigmap[id_tuples[i][2]] |= tmpset;
 		}
 	}
 
-	cout<<"old sigmap size: "<<old_sigmap.size()<<endl;
-	cout<<"new sigmap size: "<<new_sigmap.size()<<endl;
-	cout<<"valid num: "<<valid_num<<endl;
-
-	//NOTICE:need to sort and remove duplicates, update the valid num
-	//Notice that duplicates in a group can csuse problem
-	//We finish this by spo cmp
-
-	//this->kvstore->updateTupleslist_insert(_sub_id, _pre_id, _obj_id);
-	//sort and update kvstore: 11 indexes
+	//sort and update kvstore: 11 indexes, the new elements of a key are merged into its list at a time
 	//
 	//BETTER:maybe also use int* here with a size to start
 	//NOTICE:all kvtrees are opened now, one by one if memory is bottleneck
 	//
 	//spo cmp: s2p s2o s2po sp2o
 	{
-		cout << "INSRET PROCESS: to spo cmp and update" << endl;
-		qsort(id_tuples, valid_num, sizeof(int*), Database::_spo_cmp);
-
-		//To remove duplicates
-		//int ti = 1, tj = 1;
-		//while(tj < valid_num)
-		//{
-			//if(id_tuples[tj][0] != id_tuples[tj-1][0] || id_tuples[tj][1] != id_tuples[tj-1][1] || id_tuples[tj][2] != id_tuples[tj-1][2])
-			//{
-				//id_tuples[ti][0] = id_tuples[tj][0];
-				//id_tuples[ti][1] = id_tuples[tj][1];
-				//id_tuples[ti][2] = id_tuples[tj][2];
-				//ti++;
-			//}
-			//tj++;
-		//}
-		//for(tj = ti; tj < valid_num; ++tj)
-		//{
-			//delete[] id_tuples[tj];
-			//id_tuples[tj] = NULL;
-		//}
-		//valid_num = ti;
-		//
-		//Notice that below already consider duplicates in loop
-
 		vector<int> oidlist_s;
 		vector<int> pidlist_s;
 		vector<int> oidlist_sp;
@@ -3413,54 +3475,44 @@ Database::insert(const TripleWithObjType* _triples, int _triple_num)
 		bool _pre_change = true;
 
 		for (int i = 0; i < valid_num; ++i)
-			if (i + 1 == valid_num || (id_tuples[i][0] != id_tuples[i + 1][0] || id_tuples[i][1] != id_tuples[i + 1][1] || id_tuples[i][2] != id_tuples[i + 1][2]))
-			{
-				int _sub_id = id_tuples[i][0];
-				int _pre_id = id_tuples[i][1];
-				int _obj_id = id_tuples[i][2];
-
-				oidlist_s.push_back(_obj_id);
-				oidlist_sp.push_back(_obj_id);
-				pidoidlist_s.push_back(_pre_id);
-				pidoidlist_s.push_back(_obj_id);
-				pidlist_s.push_back(_pre_id);
+		{
+			int _sub_id = id_tuples[i][0];
+			int _pre_id = id_tuples[i][1];
+			int _obj_id = id_tuples[i][2];
+
+			oidlist_s.push_back(_obj_id);
+			oidlist_sp.push_back(_obj_id);
+			pidoidlist_s.push_back(_pre_id);
+			pidoidlist_s.push_back(_obj_id);
+			pidlist_s.push_back(_pre_id);
+
+			_sub_change = (i + 1 == valid_num) || (id_tuples[i][0] != id_tuples[i + 1][0]);
+			_pre_change = (i + 1 == valid_num) || (id_tuples[i][1] != id_tuples[i + 1][1]);
+			_sub_pre_change = _sub_change || _pre_change;
 
-				_sub_change = (i + 1 == valid_num) || (id_tuples[i][0] != id_tuples[i + 1][0]);
-				_pre_change = (i + 1 == valid_num) || (id_tuples[i][1] != id_tuples[i + 1][1]);
-				_sub_pre_change = _sub_change || _pre_change;
+			if (_sub_pre_change)
+			{
+				this->kvstore->updateInsert_sp2o(_sub_id, _pre_id, oidlist_sp);
+				oidlist_sp.clear();
+			}
 
-				if (_sub_pre_change)
-				{
-					cout<<"update sp2o: "<<_sub_id<<" "<<_pre_id<<" "<<oidlist_sp.size()<<endl;
-					cout<<this->kvstore->getEntityByID(_sub_id)<<endl;
-					cout<<this->kvstore->getPredicateByID(_pre_id)<<endl;
-					this->kvstore->updateInsert_sp2o(_sub_id, _pre_id, oidlist_sp);
-					oidlist_sp.clear();
-				}
+			if (_sub_change)
+			{
+				this->kvstore->updateInsert_s2p(_sub_id, pidlist_s);
+				pidlist_s.clear();
 
-				if (_sub_change)
-				{
-					cout<<"update s2p: "<<_sub_id<<" "<<pidlist_s.size()<<endl;
-					this->kvstore->updateInsert_s2p(_sub_id, pidlist_s);
-					pidlist_s.clear();
-
-					cout<<"update s2po: "<<_sub_id<<" "<<pidoidlist_s.size()<<endl;
-					this->kvstore->updateInsert_s2po(_sub_id, pidoidlist_s);
-					pidoidlist_s.clear();
-
-					cout<<"update s2o: "<<_sub_id<<" "<<oidlist_s.size()<<endl;
-					sort(oidlist_s.begin(), oidlist_s.end());
-					this->kvstore->updateInsert_s2o(_sub_id, oidlist_s);
-					oidlist_s.clear();
-				}
+				this->kvstore->updateInsert_s2po(_sub_id, pidoidlist_s);
+				pidoidlist_s.clear();
 
+				sort(oidlist_s.begin(), oidlist_s.end());
+				this->kvstore->updateInsert_s2o(_sub_id, oidlist_s);
+				oidlist_s.clear();
 			}
-		cerr << "INSERT PROCESS: OUT s2po..." << endl;
+		}
 	}
 	//ops cmp: o2p o2s o2ps op2s
 	{
-		cout << "INSRET PROCESS: to ops cmp and update" << endl;
-		qsort(id_tuples, valid_num, sizeof(int**), Database::_ops_cmp);
+		qsort(id_tuples, valid_num, sizeof(int*), Database::_ops_cmp);
 		vector<int> sidlist_o;
 		vector<int> sidlist_op;
 		vector<int> pidsidlist_o;
@@ -3471,110 +3523,95 @@ Database::insert(const TripleWithObjType* _triples, int _triple_num)
 		bool _obj_pre_change = true;
 
 		for (int i = 0; i < valid_num; ++i)
-			if (i + 1 == valid_num || (id_tuples[i][0] != id_tuples[i + 1][0] || id_tuples[i][1] != id_tuples[i + 1][1] || id_tuples[i][2] != id_tuples[i + 1][2]))
-			{
-				int _sub_id = id_tuples[i][0];
-				int _pre_id = id_tuples[i][1];
-				int _obj_id = id_tuples[i][2];
+		{
+			int _sub_id = id_tuples[i][0];
+			int _pre_id = id_tuples[i][1];
+			int _obj_id = id_tuples[i][2];
+
+			sidlist_o.push_back(_sub_id);
+			sidlist_op.push_back(_sub_id);
+			pidsidlist_o.push_back(_pre_id);
+			pidsidlist_o.push_back(_sub_id);
+			pidlist_o.push_back(_pre_id);
+
+			_obj_change = (i + 1 == valid_num) || (id_tuples[i][2] != id_tuples[i + 1][2]);
+			_pre_change = (i + 1 == valid_num) || (id_tuples[i][1] != id_tuples[i + 1][1]);
+			_obj_pre_change = _obj_change || _pre_change;
 
-				sidlist_o.push_back(_sub_id);
-				sidlist_op.push_back(_sub_id);
-				pidsidlist_o.push_back(_pre_id);
-				pidsidlist_o.push_back(_sub_id);
-				pidlist_o.push_back(_pre_id);
+			if (_obj_pre_change)
+			{
+				this->kvstore->updateInsert_op2s(_obj_id, _pre_id, sidlist_op);
+				sidlist_op.clear();
+			}
 
-				_obj_change = (i + 1 == valid_num) || (id_tuples[i][2] != id_tuples[i + 1][2]);
-				_pre_change = (i + 1 == valid_num) || (id_tuples[i][1] != id_tuples[i + 1][1]);
-				_obj_pre_change = _obj_change || _pre_change;
+			if (_obj_change)
+			{
+				sort(sidlist_o.begin(), sidlist_o.end());
+				this->kvstore->updateInsert_o2s(_obj_id, sidlist_o);
+				sidlist_o.clear();
 
-				if (_obj_pre_change)
-				{
-					cout<<"update op2s: "<<_obj_id<<" "<<_pre_id<<" "<<sidlist_op.size()<<endl;
-					this->kvstore->updateInsert_op2s(_obj_id, _pre_id, sidlist_op);
-					sidlist_op.clear();
-				}
-
-				if (_obj_change)
-				{
-					cout<<"update o2s: "<<_obj_id<<" "<<sidlist_o.size()<<endl;
-					sort(sidlist_o.begin(), sidlist_o.end());
-					this->kvstore->updateInsert_o2s(_obj_id, sidlist_o);
-					sidlist_o.clear();
-
-					cout<<"update o2ps: "<<_obj_id<<" "<<pidsidlist_o.size()<<endl;
-					this->kvstore->updateInsert_o2ps(_obj_id, pidsidlist_o);
-					pidsidlist_o.clear();
-
-					cout<<"update o2p: "<<_obj_id<<" "<<pidlist_o.size()<<endl;
-					this->kvstore->updateInsert_o2p(_obj_id, pidlist_o);
-					pidlist_o.clear();
-				}
+				this->kvstore->updateInsert_o2ps(_obj_id, pidsidlist_o);
+				pidsidlist_o.clear();
 
+				this->kvstore->updateInsert_o2p(_obj_id, pidlist_o);
+				pidlist_o.clear();
 			}
-		cerr << "INSERT PROCESS: OUT o2ps..." << endl;
+		}
 	}
 	//pso cmp: p2s p2o p2so
 	{
-		cout << "INSRET PROCESS: to pso cmp and update" << endl;
 		qsort(id_tuples, valid_num, sizeof(int*), Database::_pso_cmp);
 		vector<int> sidlist_p;
 		vector<int> oidlist_p;
 		vector<int> sidoidlist_p;
 
 		bool _pre_change = true;
-		bool _sub_change = true;
-		//bool _pre_sub_change = true;
 
 		for (int i = 0; i < valid_num; i++)
-			if (i + 1 == valid_num || (id_tuples[i][0] != id_tuples[i + 1][0] || id_tuples[i][1] != id_tuples[i + 1][1] || id_tuples[i][2] != id_tuples[i + 1][2]))
-			{
-				int _sub_id = id_tuples[i][0];
-				int _pre_id = id_tuples[i][1];
-				int _obj_id = id_tuples[i][2];
+		{
+			int _sub_id = id_tuples[i][0];
+			int _pre_id = id_tuples[i][1];
+			int _obj_id = id_tuples[i][2];
 
-				oidlist_p.push_back(_obj_id);
-				sidoidlist_p.push_back(_sub_id);
-				sidoidlist_p.push_back(_obj_id);
-				sidlist_p.push_back(_sub_id);
+			oidlist_p.push_back(_obj_id);
+			sidoidlist_p.push_back(_sub_id);
+			sidoidlist_p.push_back(_obj_id);
+			sidlist_p.push_back(_sub_id);
 
-				_pre_change = (i + 1 == valid_num) || (id_tuples[i][1] != id_tuples[i + 1][1]);
-				_sub_change = (i + 1 == valid_num) || (id_tuples[i][0] != id_tuples[i + 1][0]);
-				//_pre_sub_change = _pre_change || _sub_change;
+			_pre_change = (i + 1 == valid_num) || (id_tuples[i][1] != id_tuples[i + 1][1]);
 
-				if (_pre_change)
-				{
-					cout<<"update p2s: "<<_pre_id<<" "<<sidlist_p.size()<<endl;
-					this->kvstore->updateInsert_p2s(_pre_id, sidlist_p);
-					sidlist_p.clear();
-
-					cout<<"update p2o: "<<_pre_id<<" "<<oidlist_p.size()<<endl;
-					sort(oidlist_p.begin(), oidlist_p.end());
-					this->kvstore->updateInsert_p2o(_pre_id, oidlist_p);
-					oidlist_p.clear();
-
-					cout<<"update p2so: "<<_pre_id<<" "<<sidoidlist_p.size()<<endl;
-					this->kvstore->updateInsert_p2so(_pre_id, sidoidlist_p);
-					sidoidlist_p.clear();
-				}
+			if (_pre_change)
+			{
+				this->kvstore->updateInsert_p2s(_pre_id, sidlist_p);
+				sidlist_p.clear();
+
+				sort(oidlist_p.begin(), oidlist_p.end());
+				this->kvstore->updateInsert_p2o(_pre_id, oidlist_p);
+				oidlist_p.clear();
+
+				this->kvstore->updateInsert_p2so(_pre_id, sidoidlist_p);
+				sidoidlist_p.clear();
 			}
-		cerr << "INSERT PROCESS: OUT p2so..." << endl;
+		}
 	}
 
-
 	for (int i = 0; i < valid_num; ++i)
 	{
 		delete[] id_tuples[i];
 	}
 	delete[] id_tuples;
 
-	for (it = old_sigmap.begin(); it != old_sigmap.end(); ++it)
-	{
-		this->vstree->updateEntry(it->first, it->second);
-	}
-	for (it = new_sigmap.begin(); it != new_sigmap.end(); ++it)
+	for (it = sigmap.begin(); it != sigmap.end(); ++it)
 	{
-		SigEntry _sig(it->first, it->second);
-		this->vstree->insertEntry(_sig);
+		if (new_entity.find(it->first) != new_entity.end())
+		{
+			SigEntry _sig(it->first, it->second);
+			this->vstree->insertEntry(_sig);
+		}
+		else
+		{
+			this->vstree->updateEntry(it->first, it->second);
+		}
 	}
 #else
 	//NOTICE:we deal with insertions one by one here
@@ -3603,67 +3640,47 @@ Database::remove(const TripleWithObjType* _triples, int _triple_num)
 	int** id_tuples = new int*[_triple_num];
 	int valid_num = 0;
 	int i = 0;
-	//for(i = 0; i < _triple_num; ++i)
-	//{
-	//id_tuples[i] = new int[3];
-	//}
-	//map<int, EntityBitSet> sigmap;
-	//map<int, EntityBitSet>::iterator it;
-	EntityBitSet tmpset;
-	tmpset.reset();
 
 	int subid, objid, preid;
-	bool is_obj_entity;
 	for (i = 0; i < _triple_num; ++i)
 	{
-		string sub = _triples[i].getSubject();
-		subid = this->kvstore->getIDByEntity(sub);
-		string pre = _triples[i].getPredicate();
-		preid = this->kvstore->getIDByPredicate(pre);
-
-		is_obj_entity = _triples[i].isObjEntity();
-		string obj = _triples[i].getObject();
-		if (is_obj_entity)
+		subid = this->kvstore->getIDByEntity(_triples[i].getSubject());
+		preid = this->kvstore->getIDByPredicate(_triples[i].getPredicate());
+		if (_triples[i].isObjEntity())
 		{
-			objid = this->kvstore->getIDByEntity(obj);
+			objid = this->kvstore->getIDByEntity(_triples[i].getObject());
 		}
 		else //isObjLiteral
 		{
-			objid = this->kvstore->getIDByLiteral(obj);
+			objid = this->kvstore->getIDByLiteral(_triples[i].getObject());
 		}
 
 		if (subid == -1 || preid == -1 || objid == -1)
 		{
 			continue;
 		}
-		bool _exist_triple = this->exist_triple(subid, preid, objid);
-		if (!_exist_triple)
-		{
-			continue;
-		}
 
-		id_tuples[valid_num] = new int[3];
+		id_tuples[valid_num] = new int[4];
 		id_tuples[valid_num][0] = subid;
 		id_tuples[valid_num][1] = preid;
 		id_tuples[valid_num][2] = objid;
-		this->triples_num--;
+		id_tuples[valid_num][3] = i;
 		valid_num++;
 	}
 
-	//NOTICE:sort and remove duplicates, update the valid num
-	//Notice that duplicates in a group can cause problem
+	//duplicates in the group and triples not in the database are dropped, the tuples are in spo order then
+	valid_num = this->selectTuples(id_tuples, valid_num, true);
+	this->triples_num -= valid_num;
 
-	int sub_degree, obj_degree, pre_degree;
-	string tmpstr;
-	//sort and update kvstore: 11 indexes
+	//the vertices and predicates are freed or get their signatures recalculated after all indexes are updated
+	set<int> subjects, objects, predicates;
+	//sort and update kvstore: 11 indexes, the removed elements of a key are merged out of its list at a time
 	//
 	//BETTER:maybe also use int* here with a size to start
 	//NOTICE:all kvtrees are opened now, one by one if memory is bottleneck
 	//
 	//spo cmp: s2p s2o s2po sp2o
 	{
-		cout << "INSRET PROCESS: to spo cmp and update" << endl;
-		qsort(id_tuples, valid_num, sizeof(int*), Database::_spo_cmp);
 		vector<int> oidlist_s;
 		vector<int> pidlist_s;
 		vector<int> oidlist_sp;
@@ -3674,64 +3691,46 @@ Database::remove(const TripleWithObjType* _triples, int _triple_num)
 		bool _pre_change = true;
 
 		for (int i = 0; i < valid_num; ++i)
-			if (i + 1 == valid_num || (id_tuples[i][0] != id_tuples[i + 1][0] || id_tuples[i][1] != id_tuples[i + 1][1] || id_tuples[i][2] != id_tuples[i + 1][2]))
-			{
-				int _sub_id = id_tuples[i][0];
-				int _pre_id = id_tuples[i][1];
-				int _obj_id = id_tuples[i][2];
+		{
+			int _sub_id = id_tuples[i][0];
+			int _pre_id = id_tuples[i][1];
+			int _obj_id = id_tuples[i][2];
+
+			oidlist_s.push_back(_obj_id);
+			oidlist_sp.push_back(_obj_id);
+			pidoidlist_s.push_back(_pre_id);
+			pidoidlist_s.push_back(_obj_id);
+			pidlist_s.push_back(_pre_id);
+
+			_sub_change = (i + 1 == valid_num) || (id_tuples[i][0] != id_tuples[i + 1][0]);
+			_pre_change = (i + 1 == valid_num) || (id_tuples[i][1] != id_tuples[i + 1][1]);
+			_sub_pre_change = _sub_change || _pre_change;
 
-				oidlist_s.push_back(_obj_id);
-				oidlist_sp.push_back(_obj_id);
-				pidoidlist_s.push_back(_pre_id);
-				pidoidlist_s.push_back(_obj_id);
-				pidlist_s.push_back(_pre_id);
+			if (_sub_pre_change)
+			{
+				this->kvstore->updateRemove_sp2o(_sub_id, _pre_id, oidlist_sp);
+				oidlist_sp.clear();
+			}
 
-				_sub_change = (i + 1 == valid_num) || (id_tuples[i][0] != id_tuples[i + 1][0]);
-				_pre_change = (i + 1 == valid_num) || (id_tuples[i][1] != id_tuples[i + 1][1]);
-				_sub_pre_change = _sub_change || _pre_change;
+			if (_sub_change)
+			{
+				this->kvstore->updateRemove_s2p(_sub_id, pidlist_s);
+				pidlist_s.clear();
 
-				if (_sub_pre_change)
-				{
-					this->kvstore->updateRemove_sp2o(_sub_id, _pre_id, oidlist_sp);
-					oidlist_sp.clear();
-				}
+				this->kvstore->updateRemove_s2po(_sub_id, pidoidlist_s);
+				pidoidlist_s.clear();
 
-				if (_sub_change)
-				{
-					this->kvstore->updateRemove_s2p(_sub_id, pidlist_s);
-					pidlist_s.clear();
-					this->kvstore->updateRemove_s2po(_sub_id, pidoidlist_s);
-					pidoidlist_s.clear();
-
-					sort(oidlist_s.begin(), oidlist_s.end());
-					this->kvstore->updateRemove_s2o(_sub_id, oidlist_s);
-					oidlist_s.clear();
-
-					sub_degree = (this->kvstore)->getEntityDegree(_sub_id);
-					if (sub_degree == 0)
-					{
-						tmpstr = this->kvstore->getEntityByID(_sub_id);
-						this->kvstore->subEntityByID(_sub_id);
-						this->kvstore->subIDByEntity(tmpstr);
-						(this->vstree)->removeEntry(_sub_id);
-						this->freeEntityID(_sub_id);
-						this->sub_num--;
-					}
-					else
-					{
-						tmpset.reset();
-						this->calculateEntityBitSet(_sub_id, tmpset);
-						this->vstree->replaceEntry(_sub_id, tmpset);
-					}
-				}
+				sort(oidlist_s.begin(), oidlist_s.end());
+				this->kvstore->updateRemove_s2o(_sub_id, oidlist_s);
+				oidlist_s.clear();
 
+				subjects.insert(_sub_id);
 			}
-		cerr << "INSERT PROCESS: OUT s2po..." << endl;
+		}
 	}
 	//ops cmp: o2p o2s o2ps op2s
 	{
-		cout << "INSRET PROCESS: to ops cmp and update" << endl;
-		qsort(id_tuples, valid_num, sizeof(int**), Database::_ops_cmp);
+		qsort(id_tuples, valid_num, sizeof(int*), Database::_ops_cmp);
 		vector<int> sidlist_o;
 		vector<int> sidlist_op;
 		vector<int> pidsidlist_o;
@@ -3742,133 +3741,141 @@ Database::remove(const TripleWithObjType* _triples, int _triple_num)
 		bool _obj_pre_change = true;
 
 		for (int i = 0; i < valid_num; ++i)
-			if (i + 1 == valid_num || (id_tuples[i][0] != id_tuples[i + 1][0] || id_tuples[i][1] != id_tuples[i + 1][1] || id_tuples[i][2] != id_tuples[i + 1][2]))
-			{
-				int _sub_id = id_tuples[i][0];
-				int _pre_id = id_tuples[i][1];
-				int _obj_id = id_tuples[i][2];
+		{
+			int _sub_id = id_tuples[i][0];
+			int _pre_id = id_tuples[i][1];
+			int _obj_id = id_tuples[i][2];
+
+			sidlist_o.push_back(_sub_id);
+			sidlist_op.push_back(_sub_id);
+			pidsidlist_o.push_back(_pre_id);
+			pidsidlist_o.push_back(_sub_id);
+			pidlist_o.push_back(_pre_id);
+
+			_obj_change = (i + 1 == valid_num) || (id_tuples[i][2] != id_tuples[i + 1][2]);
+			_pre_change = (i + 1 == valid_num) || (id_tuples[i][1] != id_tuples[i + 1][1]);
+			_obj_pre_change = _obj_change || _pre_change;
 
-				sidlist_o.push_back(_sub_id);
-				sidlist_op.push_back(_sub_id);
-				pidsidlist_o.push_back(_pre_id);
-				pidsidlist_o.push_back(_sub_id);
-				pidlist_o.push_back(_pre_id);
+			if (_obj_pre_change)
+			{
+				this->kvstore->updateRemove_op2s(_obj_id, _pre_id, sidlist_op);
+				sidlist_op.clear();
+			}
 
-				_obj_change = (i + 1 == valid_num) || (id_tuples[i][2] != id_tuples[i + 1][2]);
-				_pre_change = (i + 1 == valid_num) || (id_tuples[i][1] != id_tuples[i + 1][1]);
-				_obj_pre_change = _obj_change || _pre_change;
+			if (_obj_change)
+			{
+				sort(sidlist_o.begin(), sidlist_o.end());
+				this->kvstore->updateRemove_o2s(_obj_id, sidlist_o);
+				sidlist_o.clear();
 
-				if (_obj_pre_change)
-				{
-					this->kvstore->updateRemove_op2s(_obj_id, _pre_id, sidlist_op);
-					sidlist_op.clear();
-				}
+				this->kvstore->updateRemove_o2ps(_obj_id, pidsidlist_o);
+				pidsidlist_o.clear();
 
-				if (_obj_change)
-				{
-					sort(sidlist_o.begin(), sidlist_o.end());
-					this->kvstore->updateRemove_o2s(_obj_id, sidlist_o);
-					sidlist_o.clear();
-					this->kvstore->updateRemove_o2ps(_obj_id, pidsidlist_o);
-					pidsidlist_o.clear();
-
-					this->kvstore->updateRemove_o2p(_obj_id, pidlist_o);
-					pidlist_o.clear();
-
-					is_obj_entity = this->objIDIsEntityID(_obj_id);
-					if(is_obj_entity) 
-					{
-						obj_degree = this->kvstore->getEntityDegree(_obj_id);
-						if (obj_degree == 0)
-						{
-							tmpstr = this->kvstore->getEntityByID(_obj_id);
-							this->kvstore->subEntityByID(_obj_id);
-							this->kvstore->subIDByEntity(tmpstr);
-							(this->vstree)->removeEntry(_obj_id);
-							this->freeEntityID(_obj_id);
-						}
-						else
-						{
-							tmpset.reset();
-							this->calculateEntityBitSet(_obj_id, tmpset);
-							this->vstree->replaceEntry(_obj_id, tmpset);
-						}
-					}
-					else
-					{
-						obj_degree = this->kvstore->getLiteralDegree(_obj_id);
-						if (obj_degree == 0)
-						{
-							tmpstr = this->kvstore->getLiteralByID(_obj_id);
-							this->kvstore->subLiteralByID(_obj_id);
-							this->kvstore->subIDByLiteral(tmpstr);
-							this->freeLiteralID(_obj_id);
-						}
-					}
-				}
+				this->kvstore->updateRemove_o2p(_obj_id, pidlist_o);
+				pidlist_o.clear();
 
+				objects.insert(_obj_id);
 			}
-		cerr << "INSERT PROCESS: OUT o2ps..." << endl;
+		}
 	}
 	//pso cmp: p2s p2o p2so
 	{
-		cout << "INSRET PROCESS: to pso cmp and update" << endl;
 		qsort(id_tuples, valid_num, sizeof(int*), Database::_pso_cmp);
 		vector<int> sidlist_p;
 		vector<int> oidlist_p;
 		vector<int> sidoidlist_p;
 
 		bool _pre_change = true;
-		bool _sub_change = true;
-		//bool _pre_sub_change = true;
 
 		for (int i = 0; i < valid_num; i++)
-			if (i + 1 == valid_num || (id_tuples[i][0] != id_tuples[i + 1][0] || id_tuples[i][1] != id_tuples[i + 1][1] || id_tuples[i][2] != id_tuples[i + 1][2]))
+		{
+			int _sub_id = id_tuples[i][0];
+			int _pre_id = id_tuples[i][1];
+			int _obj_id = id_tuples[i][2];
+
+			oidlist_p.push_back(_obj_id);
+			sidoidlist_p.push_back(_sub_id);
+			sidoidlist_p.push_back(_obj_id);
+			sidlist_p.push_back(_sub_id);
+
+			_pre_change = (i + 1 == valid_num) || (id_tuples[i][1] != id_tuples[i + 1][1]);
+
+			if (_pre_change)
 			{
-				int _sub_id = id_tuples[i][0];
-				int _pre_id = id_tuples[i][1];
-				int _obj_id = id_tuples[i][2];
+				this->kvstore->updateRemove_p2s(_pre_id, sidlist_p);
+				sidlist_p.clear();
 
-				oidlist_p.push_back(_obj_id);
-				sidoidlist_p.push_back(_sub_id);
-				sidoidlist_p.push_back(_obj_id);
-				sidlist_p.push_back(_sub_id);
+				sort(oidlist_p.begin(), oidlist_p.end());
+				this->kvstore->updateRemove_p2o(_pre_id, oidlist_p);
+				oidlist_p.clear();
 
-				_pre_change = (i + 1 == valid_num) || (id_tuples[i][1] != id_tuples[i + 1][1]);
-				_sub_change = (i + 1 == valid_num) || (id_tuples[i][0] != id_tuples[i + 1][0]);
-				//_pre_sub_change = _pre_change || _sub_change;
+				this->kvstore->updateRemove_p2so(_pre_id, sidoidlist_p);
+				sidoidlist_p.clear();
 
-				if (_pre_change)
-				{
-					this->kvstore->updateRemove_p2s(_pre_id, sidlist_p);
-					sidlist_p.clear();
-
-					sort(oidlist_p.begin(), oidlist_p.end());
-					this->kvstore->updateRemove_p2o(_pre_id, oidlist_p);
-					oidlist_p.clear();
-
-					this->kvstore->updateRemove_p2so(_pre_id, sidoidlist_p);
-					sidoidlist_p.clear();
-
-					pre_degree = this->kvstore->getPredicateDegree(_pre_id);
-					if (pre_degree == 0)
-					{
-						tmpstr = this->kvstore->getPredicateByID(_pre_id);
-						this->kvstore->subPredicateByID(_pre_id);
-						this->kvstore->subIDByPredicate(tmpstr);
-						this->freePredicateID(_pre_id);
-					}
-				}
+				predicates.insert(_pre_id);
 			}
-		cerr << "INSERT PROCESS: OUT p2so..." << endl;
+		}
 	}
 
-
 	for (int i = 0; i < valid_num; ++i)
 	{
 		delete[] id_tuples[i];
 	}
 	delete[] id_tuples;
+
+	//an entity is both subject and object maybe, but its entry is removed or replaced only once
+	set<int> entities(subjects);
+	string tmpstr;
+	EntityBitSet tmpset;
+	for (set<int>::iterator it = objects.begin(); it != objects.end(); ++it)
+	{
+		if (this->objIDIsEntityID(*it))
+		{
+			entities.insert(*it);
+		}
+		else if (this->kvstore->getLiteralDegree(*it) == 0)
+		{
+			tmpstr = this->kvstore->getLiteralByID(*it);
+			this->kvstore->subLiteralByID(*it);
+			this->kvstore->subIDByLiteral(tmpstr);
+			this->freeLiteralID(*it);
+			_vertices.push_back(*it);
+		}
+	}
+	for (set<int>::iterator it = entities.begin(); it != entities.end(); ++it)
+	{
+		if (this->kvstore->getEntityDegree(*it) == 0)
+		{
+			tmpstr = this->kvstore->getEntityByID(*it);
+			this->kvstore->subEntityByID(*it);
+			this->kvstore->subIDByEntity(tmpstr);
+			this->vstree->removeEntry(*it);
+			this->freeEntityID(*it);
+			if (subjects.find(*it) != subjects.end())
+			{
+				this->sub_num--;
+			}
+			_vertices.push_back(*it);
+		}
+		else
+		{
+			//NOTICE:can not use updateEntry as insert because this is in remove
+			tmpset.reset();
+			this->calculateEntityBitSet(*it, tmpset);
+			this->vstree->replaceEntry(*it, tmpset);
+		}
+	}
+	for (set<int>::iterator it = predicates.begin(); it != predicates.end(); ++it)
+	{
+		if (this->kvstore->getPredicateDegree(*it) == 0)
+		{
+			tmpstr = this->kvstore->getPredicateByID(*it);
+			this->kvstore->subPredicateByID(*it);
+			this->kvstore->subIDByPredicate(tmpstr);
+			this->freePredicateID(*it);
+			_predicates.push_back(*it);
+		}
+	}
 #else
 	//NOTICE:we deal with deletions one by one here
 	//Callers should save the vstree(node and info) after calling this function
@@ -4186,241 +4193,3 @@ Database::test_build_sig()
 	Util::logging("\n\n");
 	Util::logging("candidate:\n\n" + _q.candidate_str());
 }
-
-bool
-Database::locallyJoin(vector< vector<int> >& candidates_vec, vector< set<int> >& can_set_list, vector<string>& lpm_str_vec, vector< vector<int> >& res_crossing_edges_vec, vector<int>& all_crossing_edges_vec, vector< vector<int> > &_query_dir_ad, vector< vector<int> > &_query_pre_ad, vector< vector<int> > &_query_ad, set<int>& satellites_set, int myRank, vector< set<int> >& internal_can_set_list)
-{
-	int this_var_num = _query_ad.size();
-	set<RecordType> cur_partial_matches;
-	TableType this_current_table;
-	for(int _start_idx = 0; _start_idx < this_var_num; _start_idx++){
-		
-		if(satellites_set.count(_start_idx) != 0){
-			continue;
-		}
-		
-		int this_start_id = _start_idx;
-		//vector<bool> this_dealed_triple(this_edge_num, false);
-		stack<RecordType> this_mystack;
-		for(int i = 0; i < candidates_vec[this_start_id].size(); ++i)
-		{
-			int ele = candidates_vec[this_start_id][i];
-			if(ele >= Util::LITERAL_FIRST_ID || this->internal_tag_str.at(ele) == '1'){
-				RecordType record(this_var_num, -1);
-				record[this_start_id] = ele;
-				this_mystack.push(record);
-			}
-		}
-		
-		while(!this_mystack.empty()){
-			
-			RecordType record = this_mystack.top();
-			this_mystack.pop();
-			
-			set<int> dealed_id;
-			int next_id = this->choose_next_node(record, _query_ad, dealed_id);
-			if(next_id == -1){
-				this_current_table.push_back(record);
-				continue;
-			}
-			
-			IDList* valid_ans_list = NULL;
-			bool matched = true;
-			
-			for(int i = 0; i < _query_ad[next_id].size(); i++){
-				
-				if(dealed_id.count(_query_ad[next_id][i]) != 0){
-					if(_query_pre_ad[next_id][i] == -1){
-						matched = false;
-						break;
-					}
-					
-					int ele = record[_query_ad[next_id][i]];
-					
-					int* id_list;
-					int id_list_len = -1;
-					if(_query_dir_ad[next_id][i] == 0){
-						if(_query_pre_ad[next_id][i] == -2)
-							this->kvstore->getsubIDlistByobjID(ele, id_list, id_list_len);
-						else if(_query_pre_ad[next_id][i] >= 0)
-							this->kvstore->getsubIDlistByobjIDpreID(ele, _query_pre_ad[next_id][i], id_list, id_list_len);
-															
-						//this->kvstore->getsubIDlistByobjIDpreID(ele, _query_pre_ad[next_id][i], id_list, id_list_len);
-					}else{
-						if(_query_pre_ad[next_id][i] == -2)
-							this->kvstore->getobjIDlistBysubID(ele, id_list, id_list_len);
-						else if(_query_pre_ad[next_id][i] >= 0)
-							this->kvstore->getobjIDlistBysubIDpreID(ele, _query_pre_ad[next_id][i], id_list, id_list_len);
-						
-						//this->kvstore->getobjIDlistBysubIDpreID(ele, _query_pre_ad[next_id][i], id_list, id_list_len);
-					}
-					
-					if(id_list_len == -1 || id_list_len == 0)
-					{
-						matched = false;
-						break;
-					}
-					
-					if(valid_ans_list == NULL)
-					{
-						valid_ans_list = new IDList;
-						for(int i = 0; i < id_list_len; ++i){
-							valid_ans_list->addID(id_list[i]);
-						}	
-					}else{
-						valid_ans_list->intersectList(id_list, id_list_len);
-					}
-					
-					if(valid_ans_list->size() == 0)
-					{
-						matched = false;
-						break;
-					}
-					
-					delete[] id_list;
-				}
-			}
-			
-			if(matched)
-			{
-				for(int i = 0; i < valid_ans_list->size(); ++i)
-				{
-					RecordType tmp(record);
-					tmp[next_id] = (*valid_ans_list)[i];
-					
-					if(tmp[next_id] >= Util::LITERAL_FIRST_ID || internal_tag_str.at(tmp[next_id]) == '1'){
-						if(internal_can_set_list[next_id].count(tmp[next_id]) != 0)
-							this_mystack.push(tmp);
-					}else{
-						string tmp_extended_node_str = (this->kvstore)->getEntityByID(tmp[next_id]);
-						int tmp_hash_val = Util::BKDRHash(tmp_extended_node_str.c_str());
-						if(tmp_hash_val < 0)
-							tmp_hash_val *= -1;
-						tmp_hash_val = tmp_hash_val % Util::MAX_CROSSING_EDGE_HASH_SIZE;
-						
-						if(can_set_list[next_id].count(tmp_hash_val) != 0){
-							this_mystack.push(tmp);
-						}
-					}
-				}
-			}
-			delete valid_ans_list;
-			valid_ans_list = NULL;
-		}
-		cur_partial_matches.insert(this_current_table.begin(), this_current_table.end());
-		
-		this_current_table.clear();
-	}
-	this_current_table.assign(cur_partial_matches.begin(), cur_partial_matches.end());
-	//printf("In Client %d, there are %d local partial matches\n", myRank, this_current_table.size());
-	
-	for(TableIterator it0 = this_current_table.begin(); it0 != this_current_table.end(); ++it0)
-	{
-		RecordType cur_record = *it0;
-		int size = cur_record.size();
-		
-		vector<int> tmp_crossing_edge_vec;
-		vector<string> tmp_res_vec(size, "");
-		vector<char> tmp_res_tag_vec(size, '0');
-		
-		//printf("result_str2id.size() = %d\n", result_str2id.size());
-		for (int v = 0; v < cur_record.size(); ++v)
-		{
-			if (cur_record[v] != -1)
-			{	
-				if(cur_record[v] >= Util::LITERAL_FIRST_ID){
-					tmp_res_tag_vec[v] = '1';
-					tmp_res_vec[v] = (this->kvstore)->getLiteralByID(cur_record[v]);
-				}else if(internal_tag_str.at(cur_record[v]) == 1){
-					tmp_res_tag_vec[v] = '1';
-					tmp_res_vec[v] = (this->kvstore)->getEntityByID(cur_record[v]);
-				}else{
-					if(satellites_set.count(v) == 0){
-						tmp_res_tag_vec[v] = internal_tag_str.at(cur_record[v]);
-						tmp_res_vec[v] = (this->kvstore)->getEntityByID(cur_record[v]);
-					}else{
-						tmp_res_tag_vec[v] = '1';
-						tmp_res_vec[v] = (this->kvstore)->getEntityByID(cur_record[v]);
-					}
-				}
-			}else{
-				tmp_res_tag_vec[v] = '2';
-				tmp_res_vec[v] = "-1";
-			}
-		}
-		
-		stringstream partial_res_ss;
-		for (int v = 0; v < cur_record.size(); ++v){
-			int var_id = v;
-			if(tmp_res_tag_vec[var_id] != '2')
-				partial_res_ss << tmp_res_tag_vec[var_id];
-			partial_res_ss << tmp_res_vec[var_id] << "\t";
-			
-			if(tmp_res_tag_vec[var_id] != '1'){
-				continue;
-			}
-			
-			for (int k = 0; k < _query_ad[v].size(); k++){
-				int var_id2 = _query_ad[v][k];
-				
-				if (var_id2 == -1)
-				{
-					continue;
-				}
-				
-				if(tmp_res_vec[var_id2].compare("-1") != 0){
-					if(tmp_res_tag_vec[var_id2] == '0' && satellites_set.count(var_id2) == 0){
-						stringstream crossing_edge_ss;
-						
-						if(var_id < var_id2){
-							crossing_edge_ss << var_id << "\t" << var_id2 << "\t" << tmp_res_vec[var_id] << "\t" << tmp_res_vec[var_id2] << "\t";
-						}else{
-							crossing_edge_ss << var_id2 << "\t" << var_id << "\t" << tmp_res_vec[var_id2] << "\t" << tmp_res_vec[var_id] << "\t";
-						}
-						
-						int tmp_hash_val = Util::BKDRHash(crossing_edge_ss.str().c_str());
-						if(tmp_hash_val < 0)
-							tmp_hash_val *= -1;
-						
-						all_crossing_edges_vec.push_back((tmp_hash_val % Util::MAX_CROSSING_EDGE_HASH_SIZE));
-						tmp_crossing_edge_vec.push_back((tmp_hash_val % Util::MAX_CROSSING_EDGE_HASH_SIZE));
-						
-						//log_output_partial << crossing_edge_ss.str() << "=" << (tmp_hash_val % Util::MAX_CROSSING_EDGE_HASH_SIZE) << "\t";
-					}
-				}
-			}
-		}
-		res_crossing_edges_vec.push_back(tmp_crossing_edge_vec);
-		partial_res_ss << endl;
-		lpm_str_vec.push_back(partial_res_ss.str());
-	}
-	
-    return true;
-}
-
-
-int
-Database::choose_next_node(RecordType& record, vector< vector<int> > &_query_ad, set<int>& dealed_id)
-{
-	set<int> matched_id;
-	for(int i = 0; i < _query_ad.size(); i++){
-		if(record[i] != -1){
-			if(record[i] >= Util::LITERAL_FIRST_ID || this->internal_tag_str.at(record[i]) == '1'){
-				dealed_id.insert(i);
-			}
-			matched_id.insert(i);
-		}
-	}
-	
-	for(int i = 0; i < _query_ad.size(); i++){
-		if(dealed_id.count(i) != 0){
-			for(int j = 0; j < _query_ad[i].size(); j++){
-				if(matched_id.count(_query_ad[i][j]) == 0){
-					return _query_ad[i][j];
-				}
-			}
-		}
-	}
-	
-    return -1;
-}
\ No newline at end of file
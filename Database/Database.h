@@ -11,6 +11,7 @@
 
 #include "../Util/Util.h"
 #include "../Util/Triple.h"
+#include "../Util/IDTripleFile.h"
 #include "Join.h"
 #include "../Query/IDList.h"
 #include "../Query/ResultSet.h"
@@ -51,9 +52,15 @@ public:
 	bool query(const string _query, ResultSet& _result_set, vector<string>& partialResStrVec, int myRank, FILE* _fp = stdout);
 	int queryPathBMC(const string _query, ResultSet& _result_set, string& res_str_vec, int myRank, FILE* _fp = stdout);
 	bool queryCrossingEdge(const string _query, ResultSet& _result_set, vector<string>& lpm_str_vec, vector< vector<int> >& res_crossing_edges_vec, vector<int>& all_crossing_edges_vec, int myRank, FILE* _fp = stdout);
+	//binary version used by gqueryD, see Util/PartialResBuffer.h, the LPMs are handed to lpm_sink
+	//chunk by chunk, with global IDs and no strings if _global_id, and with local IDs and their strings otherwise
+	bool queryCrossingEdge(const string _query, PartialResSink& lpm_sink, bool _global_id, int myRank, FILE* _fp = stdout);
+	//whether global_ids.dat is built by gloadD, the LPMs of all sites must be remapped or none of them
+	bool hasGlobalIDs();
+	bool remapToGlobalIDs(PartialResBuffer& lpm_buf);
+	//add the strings of the vertices of this database among _global_ids(sorted) to the dictionary of _dict_buf
+	void getGlobalIDStrings(const vector<int>& _global_ids, PartialResBuffer& _dict_buf);
 	bool generateCandidate(const string _query, vector< vector<int> >& candidates_vec, vector< vector<int> > &_query_dir_ad, vector< vector<int> > &_query_pre_ad, vector< vector<int> > &_query_ad, set<int>& satellites_set, ResultSet& _result_set, vector<string>& lpm_str_vec, vector< vector<int> >& candidate_id_vec);
-	bool locallyJoin(vector< vector<int> >& candidates_vec, vector< set<int> >& can_set_list, vector<string>& lpm_str_vec, vector< vector<int> >& res_crossing_edges_vec, vector<int>& all_crossing_edges_vec, vector< vector<int> > &_query_dir_ad, vector< vector<int> > &_query_pre_ad, vector< vector<int> > &_query_ad, set<int>& satellites_set, int myRank, vector< set<int> >& internal_can_set_list);
-	int choose_next_node(RecordType& record, vector< vector<int> > &_query_ad, set<int>& dealed_id);
 	
 	 //1. if subject of _triple doesn't exist,
 		//then assign a new subid, and insert a new SigEntry
@@ -61,10 +68,23 @@ public:
 	 //3. if subject exist, update SigEntry, and update spo, ops... etc. if needed
 
     bool build(const string& _rdf_file);
-	bool build(const string& _rdf_file, const char* _internal_file);
+	//_global_id_file gives the IDs assigned by the global dictionary of gloadD, one "ID\tlength\tstring" per line
+	bool build(const string& _rdf_file, const char* _internal_file, const char* _global_id_file = NULL);
+	//build from the triples of _source, the global IDs come from _global_id_file if given, and from the source otherwise
+	bool build(TripleSource& _source, const char* _internal_file, const char* _global_id_file = NULL);
 	//interfaces to insert/delete from given rdf file
 	bool insert(std::string _rdf_file);
 	bool remove(std::string _rdf_file);
+	//updates of a loaded database built by gloadD, see Main/gupdateD.cpp: _global_ids holds the gids of the
+	//subject and object of each triple as in TripleBatch, and _internal_vertices the vertices internal to this site
+	bool insert(const TripleWithObjType* _triples, int _triple_num, const vector<int>& _global_ids, const set<string>& _internal_vertices);
+	bool remove(const TripleWithObjType* _triples, int _triple_num);
+	//the global ID of a vertex of this database, -1 if it is not here or has none
+	int getGlobalID(const string& _str, bool _is_entity);
+	//one more than the largest global ID of the entities/literals of this database
+	void getGlobalIDLimits(int& _entity_limit, int& _literal_limit);
+	//write the VS-Tree, the database info, the global IDs and the internal tags after insert/remove
+	bool saveUpdates();
 
 	/* name of this DB*/
 	string getName();
@@ -79,6 +99,12 @@ public:
 	
 	bool loadInternalVertices(const string _in_file);
 
+	//the indexes of a build are built by up to _thread_num threads at the same time
+	void setBuildThreadNum(int _thread_num);
+	//bytes for sorting the id tuples of a build, shared by the sorts running at the same time;
+	//the VSTree is built with the signatures of all entities in memory besides, see VSTree::buildTree()
+	void setBuildMemory(long long _memory);
+
 private:
 	string name;
 	bool is_active;
@@ -95,6 +121,9 @@ private:
 	StringIndex* stringindex;
 	Join* join;
 
+	int build_thread_num;
+	long long build_memory;
+
 	 //metadata of this database: sub_num, pre_num, obj_num, literal_num, etc. 
     string db_info_file;
 
@@ -103,7 +132,15 @@ private:
 	 //B means binary 
 	string signature_binary_file;
 	
-	string internal_tag_str;
+	//one bit per entity ID, set if the entity is internal to this site
+	MappedBitmap internal_tags;
+	//global ID of each local entity/literal(indexed by ID - LITERAL_FIRST_ID), empty if not built by gloadD
+	vector<int> entity_global_ids;
+	vector<int> literal_global_ids;
+	//(global ID, local ID) of all vertices sorted by global ID, built by loadGlobalIDs
+	vector< pair<int, int> > global_local_ids;
+	bool loadGlobalIDs();
+	bool writeInternalTags();
 	
 	//triple num per group for insert/delete
 	//can not be too high, otherwise the heap will over
@@ -156,6 +193,7 @@ private:
 	 //check whether the relative 3-tuples exist
 	 //usually, through sp2olist 
 	bool exist_triple(int _sub_id, int _pre_id, int _obj_id);
+	int selectTuples(int** _id_tuples, int _tuple_num, bool _exist);
 
 	 //* _rdf_file denotes the path of the RDF file, where stores the rdf data
 	 //* there are many step in this function, each one responds to an sub-function
@@ -168,7 +206,7 @@ private:
 	//encodeRDF_new invoke new rdfParser to solve task 1 & 2 in one time scan.
 	bool encodeRDF(const string _rdf_file);
 	bool encodeRDF_new(const string _rdf_file);
-	bool encodeRDF_new(const string _rdf_file, const char* _in_file);
+	bool encodeRDF_new(TripleSource& _source, const char* _in_file, const char* _global_id_file = NULL);
 
 	//insert and delete, notice that modify is not needed here
 	//we can read from file or use sparql syntax
@@ -177,24 +215,39 @@ private:
 	//NOTICE:one by one is too costly, sort and insert/delete at a time will be better
 	bool insert(const TripleWithObjType* _triples, int _triple_num);
 	//bool insert(const vector<TripleWithObjType>& _triples, vector<int>& _vertices, vector<int>& _predicates);
-	bool remove(const TripleWithObjType* _triples, int _triple_num);
 	//bool remove(const vector<TripleWithObjType>& _triples, vector<int>& _vertices, vector<int>& _predicates);
 
-	bool sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, int**& _p_id_tuples, int & _id_tuples_max);
-	bool sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, int**& _p_id_tuples, int & _id_tuples_max, const char* _in_file);
+	//the ID triples are written to _tuples_file, see Util/IDTripleFile.h
+	bool sub2id_pre2id_obj2id_RDFintoSignature(const string _rdf_file, const string& _tuples_file);
+	bool sub2id_pre2id_obj2id_RDFintoSignature(TripleSource& _source, const string& _tuples_file, const char* _in_file, const char* _global_id_file = NULL);
+	bool saveGlobalIDs(const char* _global_id_file);
+	bool writeGlobalIDs(const vector<int>& _entity_global_ids, const vector<int>& _literal_global_ids);
 	bool literal2id_RDFintoSignature(const string _rdf_file, int** _p_id_tuples, int _id_tuples_max);
 	
 	bool s2o_s2po_sp2o(int** _p_id_tuples, int _id_tuples_max);
 	bool o2s_o2ps_op2s(int** _p_id_tuples, int _id_tuples_max);
 	//NOTICE: below is the new one
 	//bool s2p_s2po_sp2o(int** _p_id_tuples, int _id_tuples_max);
-	bool s2p_s2o_s2po_sp2o(int** _p_id_tuples, int _id_tuples_max);
+	//each of them sorts a copy of _tuples_file in its own order and reads it as a stream
+	bool s2p_s2o_s2po_sp2o(const string& _tuples_file);
 	//bool s2p_s2o_s2po_sp2o_sp2n(int** _p_id_tuples, int _id_tuples_max);
-	bool o2p_o2s_o2ps_op2s(int** _p_id_tuples, int _id_tuples_max);
+	bool o2p_o2s_o2ps_op2s(const string& _tuples_file);
 	//bool o2p_o2s_o2ps_op2s_op2n(int** _p_id_tuples, int _id_tuples_max);
-	bool p2s_p2o_p2so(int** _p_id_tuples, int _id_tuples_max);
+	bool p2s_p2o_p2so(const string& _tuples_file);
 	//bool p2s_p2o_p2so_p2n(int** _p_id_tuples, int _id_tuples_max);
-	bool so2p_s2o(int** _p_id_tuples, int _id_tuples_max);
+	bool so2p_s2o(const string& _tuples_file);
+
+	//the indexes built from the id tuples and the signature file, independent of each other
+	static const int SUB_INDEXES = 0;
+	static const int OBJ_INDEXES = 1;
+	static const int PRE_INDEXES = 2;
+	static const int VSTREE_INDEX = 3;
+	static const int BUILD_INDEX_NUM = 4;
+	//build all of them with a pool of build_thread_num threads, each taking the next index in turn
+	bool buildIndexes(const string& _tuples_file);
+	bool buildIndex(int _index, const string& _tuples_file);
+	static void* buildIndexThread(void* _pool);
+	long long getSortMemory() const;
 
 	static int _spo_cmp(const void* _a, const void* _b);
 	static int _ops_cmp(const void* _a, const void* _b);
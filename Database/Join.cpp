@@ -7,6 +7,8 @@
 =============================================================================*/
 
 #include "Join.h"
+#include "TrieJoin.h"
+#include "../Util/ListIntersect.h"
 
 using namespace std;
 
@@ -27,6 +29,16 @@ Join::~Join()
 	//noting to do necessarily
 }
 
+bool Join::explain = false;
+string Join::explain_label;
+
+void
+Join::setExplain(bool _explain, const string& _label)
+{
+	Join::explain = _explain;
+	Join::explain_label = _label;
+}
+
 void
 Join::init(BasicQuery* _basic_query)
 {
@@ -46,6 +58,7 @@ Join::init(BasicQuery* _basic_query)
 	this->id_pos = 0;
 
 	this->start_id = -1;
+	this->plan_rank.assign(this->var_num, 0);
 	int triple_num = this->basic_query->getTripleNum();
 	this->dealed_triple = (bool*)calloc(triple_num, sizeof(bool));
 	this->index_lists = NULL;
@@ -60,6 +73,7 @@ Join::clear()
 	free(this->pos2id);
 	//NOTICE:maybe many BasicQuery
 	this->current_table.clear();
+	this->match_table.clear();
 	while (this->mystack.empty() == false) this->mystack.pop();
 	free(this->dealed_triple);
 	//NULL if using multi-join method
@@ -76,6 +90,56 @@ Join::score_node(unsigned _degree, unsigned _size)
 	return Join::PARAM_DEGREE * (double)_degree + Join::PARAM_SIZE / (double)_size;
 }
 
+void
+Join::init_planner(JoinPlanner& _planner)
+{
+	for (int i = 0; i < this->var_num; ++i)
+	{
+		//the candidates of a literal variable are added later
+		if (this->basic_query->isReady(i) || !this->is_literal_var(i))
+			_planner.setCandidateNum(i, this->basic_query->getCandidateSize(i));
+
+		//satellites which are not retrieved
+		if (!this->basic_query->if_need_retrieve(i))
+			continue;
+		for (int j = 0; j < this->basic_query->getVarDegree(i); ++j)
+		{
+			//each edge once from the smaller vertex, and the self loops only filter the candidates
+			int var_id2 = this->basic_query->getEdgeNeighborID(i, j);
+			if (var_id2 <= i || !this->basic_query->if_need_retrieve(var_id2))
+				continue;
+			int pre_id = this->basic_query->getEdgePreID(i, j);
+			if (this->basic_query->getEdgeType(i, j) == Util::EDGE_IN)
+				_planner.addEdge(var_id2, i, pre_id);
+			else
+				_planner.addEdge(i, var_id2, pre_id);
+		}
+	}
+}
+
+void
+Join::set_plan(const vector<int>& _order, const vector<double>& _rows, double _cost)
+{
+	this->plan_rank.assign(this->var_num, this->var_num);
+	for (int i = 0; i < _order.size(); ++i)
+	{
+		this->plan_rank[_order[i]] = i;
+	}
+	if (!Join::explain)
+		return;
+
+	stringstream buf;
+	if (!Join::explain_label.empty())
+		buf << Join::explain_label << " ";
+	buf << "join order from " << this->basic_query->getVarName(_order[0]) << ":";
+	for (int i = 0; i < _order.size(); ++i)
+	{
+		buf << " " << this->basic_query->getVarName(_order[i]) << "(" << _rows[i] << " rows)";
+	}
+	buf << ", cost " << _cost;
+	cout << buf.str() << endl;
+}
+
 int
 Join::judge(int _smallest, int _biggest)
 {
@@ -98,8 +162,13 @@ void
 Join::select()
 {
 	//NOTICE: only consider vars in select here
-	double max = 0;
-	int maxi = -1;
+	//the start of the join order of the least cost
+	double min_cost = 0;
+	int mini = -1;
+	vector<int> order, min_order;
+	vector<double> rows, min_rows;
+	JoinPlanner planner(this->kvstore, this->var_num);
+	this->init_planner(planner);
 	//int border = this->basic_query->getVarNum();
 	for(int i = 0; i < this->var_num; ++i)
 	{
@@ -109,20 +178,24 @@ Join::select()
 			continue;
 		}
 
-		double tmp = this->score_node(this->basic_query->getVarDegree(i), this->basic_query->getCandidateSize(i));
-		if (tmp > max)
+		double cost = planner.plan(i, -1, order, rows);
+		//the order must bind all the vertices joined
+		if (mini == -1 || order.size() > min_order.size() || (order.size() == min_order.size() && cost < min_cost))
 		{
-			max = tmp;
-			maxi = i;
+			min_cost = cost;
+			mini = i;
+			min_order.swap(order);
+			min_rows.swap(rows);
 		}
 	}
-	if (maxi == -1)
+	if (mini == -1)
 	{
 		cout << "error to select the first one to join" << endl;
 	}
 	else
 	{
-		this->start_id = maxi;
+		this->start_id = mini;
+		this->set_plan(min_order, min_rows, min_cost);
 	}
 #ifdef DEBUG_JOIN
 	//printf("the start id is: %d\n", this->start_id);
@@ -150,7 +223,7 @@ Join::join_sparql(SPARQLquery& _sparql_query)
 }
 
 bool
-Join::join_pe(BasicQuery* _basic_query, string &internal_tag_str)
+Join::join_pe(BasicQuery* _basic_query, const MappedBitmap& internal_tags)
 {
 	this->init(_basic_query);
 	
@@ -171,7 +244,7 @@ Join::join_pe(BasicQuery* _basic_query, string &internal_tag_str)
 		return false;
 	}
 
-	bool ret3 = this->join(internal_tag_str);
+	bool ret3 = this->join(internal_tags);
 	
 	if (!ret3)
 	{
@@ -182,14 +255,11 @@ Join::join_pe(BasicQuery* _basic_query, string &internal_tag_str)
 	//this->pre_var_handler();
 	
 	vector<int*>* res_pointer = this->basic_query->getResultListPointer();
-	for(TableIterator it0 = this->current_table.begin(); it0 != this->current_table.end(); it0++){
-		int* tmp_res = new int[it0->size()];
-		int i = 0;
-		for(RecordIterator it1 = it0->begin(); it1 != it0->end(); ++it1, ++i){
-			tmp_res[i] = *it1;
-			//cout << tmp_res[i] << " ";
-		}
-		//cout << endl;
+	int width = this->match_table.getWidth();
+	res_pointer->reserve(res_pointer->size() + this->match_table.size());
+	for(int i = 0; i < this->match_table.size(); ++i){
+		int* tmp_res = new int[width];
+		memcpy(tmp_res, this->match_table.getRow(i), sizeof(int) * width);
 		res_pointer->push_back(tmp_res);
 	}
 	
@@ -198,7 +268,7 @@ Join::join_pe(BasicQuery* _basic_query, string &internal_tag_str)
 }
 
 bool
-Join::join_can(BasicQuery* _basic_query, string &internal_tag_str, vector< vector<int> >& candidates_vec, vector< vector<int> >& candidates_id_vec)
+Join::join_can(BasicQuery* _basic_query, const MappedBitmap& internal_tags, vector< vector<int> >& candidates_vec, vector< vector<int> >& candidates_id_vec)
 {
 	this->init(_basic_query);
 	
@@ -235,7 +305,7 @@ Join::join_can(BasicQuery* _basic_query, string &internal_tag_str, vector< vecto
 			string can_str;
 			if(ele >= Util::LITERAL_FIRST_ID){
 				can_str = (this->kvstore)->getLiteralByID(ele);
-			}else if(internal_tag_str.at(ele) == '1'){
+			}else if(internal_tags.test(ele)){
 				can_str = (this->kvstore)->getEntityByID(ele);
 			}else{
 				continue;
@@ -964,7 +1034,7 @@ Join::choose_next_node(int id)
 	//choose a child to search deeply
 	int degree = this->basic_query->getVarDegree(id);
 	int maxi = -1;
-	double max = 0;
+	int min_rank = 0;
 	for (int i = 0; i < degree; ++i)
 	{
 		int var_id2 = this->basic_query->getEdgeNeighborID(id, i);
@@ -986,11 +1056,10 @@ Join::choose_next_node(int id)
 			continue;
 		}
 
-		//NTC:not using updated degrees, other not the whole loop
-		double tmp = this->score_node(this->basic_query->getVarDegree(var_id2), this->basic_query->getCandidateSize(var_id2));
-		if (max < tmp)
+		//the neighbor first in the join order
+		if (maxi == -1 || this->plan_rank[var_id2] < min_rank)
 		{
-			max = tmp;
+			min_rank = this->plan_rank[var_id2];
 			maxi = i;
 		}
 	}
@@ -2835,7 +2904,7 @@ Join::only_pre_filter_after_join()
 }
 
 bool
-Join::join(string &internal_tag_str)
+Join::join(const MappedBitmap& internal_tags)
 {
     this->toStartJoin();
 
@@ -2846,32 +2915,39 @@ Join::join(string &internal_tag_str)
     //    return false;  //empty result
     int biggest = this->basic_query->getVarID_MaxCandidateList();
 	
-	vector< set<int> > can_set_list;
+	vector<IDBitmap> can_set_list(this->var_num);
 	for(int j = 0; j < this->var_num; ++j){
-		set<int> cur_can_set;
+		IDBitmap& cur_can_set = can_set_list[j];
 		IDList& cur_table = this->basic_query->getCandidateList(j);
 		int cur_size = this->basic_query->getCandidateSize(j);
 		//printf("variable %d has %d internal and extended candidates.\n", j, cur_size);
-		for(int i = cur_size - 1; i >= 0; i--)
+		//in increasing order, which the bitmap appends to
+		for(int i = 0; i < cur_size; i++)
 		{
 			int ele = cur_table.getID(i);
-			if(ele >= Util::LITERAL_FIRST_ID || internal_tag_str.at(ele) == '1'){
-				cur_can_set.insert(ele);
+			if(ele >= Util::LITERAL_FIRST_ID || internal_tags.test(ele)){
+				cur_can_set.add(ele);
 			}
 		}
 		//printf("variable %d has %d internal candidates.\n", j, cur_can_set.size());
-		can_set_list.push_back(cur_can_set);
 	}
 
     int method = this->judge(smallest, biggest);
+	//multi_join closes a cycle only after the rows of a path are built, and they may blow up, so
+	//the queries small enough for the trie join to enumerate their internal sets use it instead
+	if(method == 0 && this->basic_query->getVarNum() <= TrieJoin::MAX_VAR_NUM && TrieJoin::isCyclic(this->basic_query))
+		method = 2;
     bool ret = true;
     switch(method)
     {
     case 0:
         //printf("use multi-join here!\n");
         //cerr<<"use multi-join here!"<<endl;
-        ret = this->multi_join(internal_tag_str, can_set_list);
+        ret = this->multi_join(internal_tags, can_set_list);
         break;
+	case 2:
+		ret = TrieJoin(this->kvstore, this->basic_query, internal_tags).run(can_set_list, this->match_table);
+		break;
     case 1:
         //printf("use index-join here!\n");
         cerr<<"use index-join here!"<<endl;
@@ -2887,7 +2963,7 @@ Join::join(string &internal_tag_str)
 }
 
 bool
-Join::multi_join(string &internal_tag_str, vector< set<int> >& can_set_list)
+Join::multi_join(const MappedBitmap& internal_tags, vector<IDBitmap>& can_set_list)
 {
     //this->select();
 	
@@ -2895,7 +2971,11 @@ Join::multi_join(string &internal_tag_str, vector< set<int> >& can_set_list)
 		this->add_id_pos_mapping(i);
 	}
 	
-	set<RecordType> cur_partial_matches;
+	//the matches from all start vertices, sorted and without duplicates at last
+	JoinTable cur_partial_matches(this->var_num);
+	this->match_table.init(this->var_num);
+	JoinPlanner planner(this->kvstore, this->var_num);
+	this->init_planner(planner);
 	for(int _start_idx = 0; _start_idx < this->var_num; _start_idx++){
 
 		if(this->basic_query->getVarDegree(_start_idx) == 1){
@@ -2906,32 +2986,23 @@ Join::multi_join(string &internal_tag_str, vector< set<int> >& can_set_list)
 		vector<int> dealed_id;
 		dealed_id.push_back(_start_idx);
 		
-		IDList& start_table = this->basic_query->getCandidateList(this->start_id);
-		int start_size = this->basic_query->getCandidateSize(this->start_id);
-		
-		for(int i = 0; i < start_size; ++i)
+		//the candidates internal here(or literals) are already in the bitmap of the start
+		vector<int> start_table;
+		can_set_list[this->start_id].getIDs(start_table);
+		for(int i = 0; i < start_table.size(); ++i)
 		{
-			int ele = start_table.getID(i);
-			if(ele >= Util::LITERAL_FIRST_ID || internal_tag_str.at(ele) == '1'){
-				RecordType record(this->var_num, -1);
-				record[this->start_id] = ele;
-				this->current_table.push_back(record);
-			}
+			this->match_table.addRow()[this->start_id] = start_table[i];
 		}
 		
-		this->mystack.push(this->start_id);	
+		//the vertices are bound in the join order of the least rows estimated from the start
+		vector<int> order;
+		vector<double> rows;
+		double cost = planner.plan(this->start_id, can_set_list[this->start_id].size(), order, rows);
+		this->set_plan(order, rows, cost);
 
-		while(!this->mystack.empty() && this->current_table.size() != 0)
+		for(int k = 1; k < order.size() && !this->match_table.empty(); ++k)
 		{
-			int id = this->mystack.top();
-
-			int maxi = this->choose_next_node(id);
-			if(maxi == -1) //all edges of this node are dealed
-			{
-				this->mystack.pop();	
-				continue;
-			}
-			int id2 = this->basic_query->getEdgeNeighborID(id, maxi);
+			int id2 = order[k];
 
 			vector<int> edges; //the edge index for table column in id2
 			// the outer is node-loop, inner is canlist-loop
@@ -2939,7 +3010,7 @@ Join::multi_join(string &internal_tag_str, vector< set<int> >& can_set_list)
 			vector< vector<int> > id_lists_len;
 			//int* tmp_id_list;
 			//int tmp_id_list_len;
-			set<int> can_list = can_set_list.at(id2);
+			IDBitmap& can_list = can_set_list.at(id2);
 			int can_list_size = can_list.size();
 
 			for(int i = 0; i < dealed_id.size(); ++i)
@@ -2956,82 +3027,92 @@ Join::multi_join(string &internal_tag_str, vector< set<int> >& can_set_list)
 			}
 
 			bool flag = false;
-			//printf("before new_join_with_multi_vars_not_prepared, id = %d and dealed_id.size() = %d and id2 = %d and can_list_size = %d and can_list.size() = %d and edges.size() = %d, and this->current_table.size() = %d\n", id, dealed_id.size(), id2, can_list_size, can_list.size(), edges.size(), this->current_table.size());
+			//printf("before new_join_with_multi_vars_not_prepared, id = %d and dealed_id.size() = %d and id2 = %d and can_list_size = %d and can_list.size() = %d and edges.size() = %d, and this->match_table.size() = %d\n", id, dealed_id.size(), id2, can_list_size, can_list.size(), edges.size(), this->match_table.size());
 			
-			flag = this->new_join_with_multi_vars_not_prepared(edges, can_list, can_list_size, id2, is_literal, internal_tag_str, dealed_id);
+			flag = this->new_join_with_multi_vars_not_prepared(edges, can_list, can_list_size, id2, is_literal, internal_tags, dealed_id);
 			
-			//printf("after new_join_with_multi_vars_not_prepared, this->current_table.size() = %d\n", this->current_table.size());
+			//printf("after new_join_with_multi_vars_not_prepared, this->match_table.size() = %d\n", this->match_table.size());
 
-			for(int i = 0; i < dealed_id.size(); ++i)
-			{
-				int edge_index = edges[i];
-				if(edge_index != -1)
+			dealed_id.push_back(id2);
+		}
+		
+		//a vertex is left unbound if its bound neighbors are all extended when it is joined, and on a
+		//cycle one of its neighbors joined later may be internal, then the vertices are joined again
+		//with all the others until no row changes
+		bool joined = TrieJoin::isCyclic(this->basic_query);
+		while(joined && !this->match_table.empty())
+		{
+			joined = false;
+			for(int k = 1; k < order.size(); ++k)
+			{
+				int id2 = order[k];
+				vector<int> edges, other_id;
+				for(int i = 0; i < order.size(); ++i)
 				{
-					int edge_id = this->basic_query->getEdgeID(id2, edge_index);
-					dealed_triple[edge_id] = true;
+					if(i != k)
+					{
+						other_id.push_back(order[i]);
+						edges.push_back(this->basic_query->getEdgeIndex(id2, order[i]));
+					}
 				}
+				IDBitmap& can_list = can_set_list.at(id2);
+				if(this->new_join_with_multi_vars_not_prepared(edges, can_list, can_list.size(), id2, this->is_literal_var(id2), internal_tags, other_id))
+					joined = true;
 			}
-
-			this->mystack.push(id2);
-			dealed_id.push_back(id2);
 		}
-		cur_partial_matches.insert(this->current_table.begin(), this->current_table.end());
+		cur_partial_matches.append(this->match_table);
 		
-		//printf("---------------after multi-join, _start_idx = %d and current_table.size() = %d and cur_partial_matches.size() = %d\n", _start_idx, this->current_table.size(), cur_partial_matches.size());
+		//printf("---------------after multi-join, _start_idx = %d and match_table.size() = %d and cur_partial_matches.size() = %d\n", _start_idx, this->match_table.size(), cur_partial_matches.size());
 		
-		this->current_table.clear();
-		
-		for(int i = 0; i < this->basic_query->getTripleNum(); i++){
-			this->dealed_triple[i] = false;
-		}
+		this->match_table.clear();
 	}
-	this->current_table.assign(cur_partial_matches.begin(), cur_partial_matches.end());
-	//printf("~~~~~~~~~~~~~after multi-join, current_table.size() = %d\n", cur_partial_matches.size());
+	cur_partial_matches.sortUnique();
+	this->match_table.swap(cur_partial_matches);
+	//printf("~~~~~~~~~~~~~after multi-join, match_table.size() = %d\n", this->match_table.size());
 	
     return true;
 }
 
+//the rows where _id is unbound and some bound neighbor in dealed_id is internal(or a literal) are
+//extended by the candidates of _id joined to all its bound neighbors, or dropped if there is none,
+//the other rows stay; return whether some row is joined
 bool
-Join::new_join_with_multi_vars_not_prepared(vector<int>& _edges, set<int>& _can_list, int _can_list_size, int _id, bool _is_literal, string &internal_tag_str, vector<int> dealed_id)
+Join::new_join_with_multi_vars_not_prepared(vector<int>& _edges, IDBitmap& _can_list, int _can_list_size, int _id, bool _is_literal, const MappedBitmap& internal_tags, vector<int> dealed_id)
 {
 	_is_literal = false;
 	
     bool found = false;
-	TableType new_table;
+	//the rows not joined on _id stay in place, and the rows extended by the candidates of _id are appended after them
+	JoinTable extended_rows(this->match_table.getWidth());
+	vector<int> kept_rows;
 	int tag = 0, ele = -1;
 		
-	for(TableIterator it0 = this->current_table.begin(); it0 != this->current_table.end(); ++it0)
+	for(int row_id = 0; row_id < this->match_table.size(); ++row_id)
 	{
+		const int* row = this->match_table.getRow(row_id);
 		tag = 0;
-		for(int id_idx = 0; id_idx < dealed_id.size(); id_idx++){
+		for(int id_idx = 0; id_idx < dealed_id.size() && row[_id] == -1; id_idx++){
 			int edge_index = _edges[id_idx];
 			if(edge_index == -1)
 			{
 				continue;
 			}
-			ele = it0->at(dealed_id[id_idx]);
-			if((ele != -1) && (ele >= Util::LITERAL_FIRST_ID || internal_tag_str.at(ele) == '1')){
+			ele = row[dealed_id[id_idx]];
+			if((ele != -1) && (ele >= Util::LITERAL_FIRST_ID || internal_tags.test(ele))){
 				tag = 1;
 			}
 		}
 		if(tag == 0){
-			new_table.push_back(*it0);
+			kept_rows.push_back(row_id);
 			continue;
 		}
-		/*
-		{
-			stringstream record_ss;
-			for(RecordIterator it1 = it0->begin(); it1 != it0->end(); ++it1)
-			{
-				//printf(" %d", *it1);
-				record_ss<<" "<<*it1;
-			}
-			printf("%s\n", record_ss.str().c_str());
-		}
-		*/
-		IDList* valid_ans_list = NULL;
+		found = true;
+		//the lists of the internal neighbors are complete and their intersection gives the candidates,
+		//while an extended neighbor only has its edges to the internal vertices of this site, so it
+		//filters the candidates internal here and keeps the others as they are
+		vector<int*> internal_lists, extended_lists;
+		vector<int> internal_lens, extended_lens;
 		bool matched = true;
-		
 		for(int id_idx = 0; id_idx < dealed_id.size(); id_idx++){
 			int edge_index = _edges[id_idx];
 			if(edge_index == -1)
@@ -3040,51 +3121,16 @@ Join::new_join_with_multi_vars_not_prepared(vector<int>& _edges, set<int>& _can_
 			}
 			//update the valid id num according to restrictions by multi vars
 			//also ordered while id_list and can_list are ordered
-			//IDList valid_ans_list;
 			//NOTICE:we can generate cans from either direction, but this way is convenient and better
-			ele = it0->at(dealed_id[id_idx]);
-			/*
-			{
-				stringstream record_ss;
-				for(RecordIterator it1 = it0->begin(); it1 != it0->end(); ++it1)
-				{
-					//printf(" %d", *it1);
-					record_ss<<" "<<*it1;
-				}
-				printf("_id = %d next_id = %d %s\n", _id, dealed_id[id_idx], record_ss.str().c_str());
-			}
-			*/
+			ele = row[dealed_id[id_idx]];
 			if(ele == -1){
-				//new_table.push_back(*it0);
 				continue;
 			}
-			/*
-			{
-				stringstream record_ss;
-				for(RecordIterator it1 = it0->begin(); it1 != it0->end(); ++it1)
-				{
-					//printf(" %d", *it1);
-					record_ss<<" "<<*it1;
-				}
-				printf("begin join %s\n", record_ss.str().c_str());
-			}			
-			*/
+			bool is_internal = ele >= Util::LITERAL_FIRST_ID || internal_tags.test(ele);
 			int edge_type = this->basic_query->getEdgeType(_id, edge_index);
 			int pre_id = this->basic_query->getEdgePreID(_id, edge_index);
 
-			if(pre_id == -2)    //predicate var
-			{
-				//if(valid_ans_list == NULL)
-				//{
-				//valid_ans_list = IDList::intersect(_can_list, NULL, 0);
-				//}
-				//else
-				//{
-				//}
-				//continue;
-			}
-
-			int* id_list;
+			int* id_list = NULL;
 			int id_list_len = -1;
 			if(edge_type == Util::EDGE_IN)
 			{
@@ -3102,96 +3148,61 @@ Join::new_join_with_multi_vars_not_prepared(vector<int>& _edges, set<int>& _can_
 					this->kvstore->getsubIDlistByobjIDpreID(ele, pre_id, id_list, id_list_len);
 			}
 			
-			if((id_list_len == -1 || id_list_len == 0) && (ele >= Util::LITERAL_FIRST_ID || internal_tag_str.at(ele) == '1'))
+			if(is_internal)
 			{
-				//id_list == NULL in this case, no need to free
-				matched = false;
-				continue;
-			}
-			
-			if(valid_ans_list == NULL)
-			{
-				valid_ans_list = new IDList;
-				for(int i = 0; i < id_list_len; ++i){
-					if((id_list[i] < Util::LITERAL_FIRST_ID && internal_tag_str.at(id_list[i]) == '0') || (_can_list.count(id_list[i]) != 0)){
-						valid_ans_list->addID(id_list[i]);
-					}
-				}
-				/*
-				if(it0->at(2) == 50568){
-					printf("valid_ans_list == NULL and valid_ans_list.size() == %d\n", valid_ans_list->size());
-				}
-				*/
-			}else{
-				if((ele >= Util::LITERAL_FIRST_ID || internal_tag_str.at(ele) == '1')){
-					valid_ans_list->intersectList(id_list, id_list_len);
-				}else{
-					set<int> tmp_neighbor_set;
-					for(int i = 0; i < id_list_len; ++i){
-						tmp_neighbor_set.insert(id_list[i]);
-					}
-					/*
-					if(it0->at(2) == 50568){
-						printf("~~~~~valid_ans_list.size() == %d\n", valid_ans_list->size());
-					}
-					*/
-					vector<int> _new_idlist;
-					for(int i = 0; i < valid_ans_list->size(); i++){
-						if((valid_ans_list->getID(i) < Util::LITERAL_FIRST_ID &&internal_tag_str.at(valid_ans_list->getID(i)) == '0') || tmp_neighbor_set.count(valid_ans_list->getID(i)) != 0){
-							_new_idlist.push_back(valid_ans_list->getID(i));
-						}
-					}
-					
-					valid_ans_list->copy(_new_idlist);
-					/*
-					for(int i = 0; i < valid_ans_list->size(); i++){
-						if(valid_ans_list->getID(i) == 51162){
-							printf("right!!!!!!!!\n");
-						}
-					}
-					*/
+				internal_lists.push_back(id_list);
+				internal_lens.push_back(max(id_list_len, 0));
+				if(id_list_len <= 0)
+				{
+					//id_list == NULL in this case
+					matched = false;
+					break;
 				}
 			}
-			
-			delete[] id_list;
-			if(valid_ans_list->size() == 0)
+			else
 			{
-				matched = false;
-				break;
+				extended_lists.push_back(id_list);
+				extended_lens.push_back(max(id_list_len, 0));
 			}
 		}
 
+		//the candidates internal here(or literals) and the others, both in increasing order
+		vector<int> internal_ids, extended_ids;
 		if(matched)
 		{
-			found = true;
-
-			for(int i = 0; i < valid_ans_list->size(); ++i)
-			{
-				//WARN+NOTICE:this strategy may cause that duplicates are not together!
-				RecordType tmp(*it0);
-				tmp[_id] = (*valid_ans_list)[i];
-				new_table.push_back(tmp);
+			vector<int> ids(*min_element(internal_lens.begin(), internal_lens.end()));
+			ids.resize(ListIntersect::intersect(&internal_lists[0], &internal_lens[0], internal_lists.size(), &ids[0]));
+			for(int i = 0; i < ids.size(); ++i){
+				if(ids[i] >= Util::LITERAL_FIRST_ID || internal_tags.test(ids[i]))
+					internal_ids.push_back(ids[i]);
+				else
+					extended_ids.push_back(ids[i]);
 			}
-			/*
-			{
-				stringstream record_ss;
-				//TableIterator it2 = new_table.end();
-				for(TableIterator it2 = new_table.begin(); it2 != new_table.end(); it2++){
-					for(RecordIterator it1 = it2->begin(); it1 != it2->end(); ++it1)
-					{
-						record_ss<<" "<<*it1;
-					}
-					printf("after join %s\n", record_ss.str().c_str());
-				}
+			if(!internal_ids.empty())
+				internal_ids.resize(_can_list.intersect(&internal_ids[0], internal_ids.size(), &internal_ids[0]));
+			for(int i = 0; i < extended_lists.size() && !internal_ids.empty(); ++i){
+				ListIntersect::intersect(internal_ids, extended_lists[i], extended_lens[i]);
 			}
-			*/			
 		}
-		delete valid_ans_list;
-		valid_ans_list = NULL;
+		for(int i = 0; i < internal_lists.size(); ++i){
+			delete[] internal_lists[i];
+		}
+		for(int i = 0; i < extended_lists.size(); ++i){
+			delete[] extended_lists[i];
+		}
+
+		if(!internal_ids.empty() || !extended_ids.empty())
+		{
+			vector<int> valid_ans_list(internal_ids.size() + extended_ids.size());
+			merge(internal_ids.begin(), internal_ids.end(), extended_ids.begin(), extended_ids.end(), valid_ans_list.begin());
+			//WARN+NOTICE:this strategy may cause that duplicates are not together!
+			extended_rows.addRows(row, _id, &valid_ans_list[0], valid_ans_list.size());
+		}
 	}
 	
-	this->current_table.assign(new_table.begin(), new_table.end());
-	//printf("after join this->current_table.size() = %d \n", this->current_table.size());
+	this->match_table.select(kept_rows);
+	this->match_table.append(extended_rows);
+	//printf("after join this->match_table.size() = %d \n", this->match_table.size());
 	
     return found;
 }
\ No newline at end of file
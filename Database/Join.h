@@ -14,6 +14,10 @@
 #include "../Query/SPARQLquery.h"
 #include "../KVstore/KVstore.h"
 #include "../Util/Util.h"
+#include "../Util/MappedBitmap.h"
+#include "../Util/JoinTable.h"
+#include "../Util/IDBitmap.h"
+#include "JoinPlanner.h"
 
 //BETTER?:place multi_join and index_join in separated files
 
@@ -122,6 +126,8 @@ private:
 	//BETTER?:predefine size to avoid copy cost
 	TableType current_table;
 	TableIterator new_start;   //keep to end() as default
+	//the rows of the distributed join(join_pe), one column per query vertex
+	JoinTable match_table;
 	//list<bool> table_row_new;
 	
 	//keep the mapping for disordered ids in vector<int> table
@@ -135,6 +141,11 @@ private:
 	vector<Satellite> satellites;
 	int* record;
 	int record_len;
+	//the position of each vertex in the join order, the vertices out of it are at var_num
+	vector<int> plan_rank;
+	//print each join order chosen, after the label
+	static bool explain;
+	static string explain_label;
 
 	void init(BasicQuery* _basic_query);
 	void clear();
@@ -155,6 +166,12 @@ private:
 	//score the node according to degree and size
 	double score_node(unsigned _degree, unsigned _size);
 
+	//add the candidate nums and the edges of the query to _planner, which orders the vertices to
+	//bind by the rows estimated with the predicate stats, built once for all the starts of a query
+	void init_planner(JoinPlanner& _planner);
+	//keep the order for choose_next_node()
+	void set_plan(const vector<int>& _order, const vector<double>& _rows, double _cost);
+
 	void toStartJoin();
 
 	bool filter_before_join();
@@ -189,8 +206,8 @@ private:
 
 	bool multi_join();
 	
-	bool multi_join(string &internal_tag_str, vector< set<int> >& can_set_list);
-	bool new_join_with_multi_vars_not_prepared(vector<int>& _edges, set<int>& _can_list, int _can_list_size, int _id, bool _is_literal, string &internal_tag_str, vector<int> dealed_id);
+	bool multi_join(const MappedBitmap& internal_tags, vector<IDBitmap>& can_set_list);
+	bool new_join_with_multi_vars_not_prepared(vector<int>& _edges, IDBitmap& _can_list, int _can_list_size, int _id, bool _is_literal, const MappedBitmap& internal_tags, vector<int> dealed_id);
 	bool distributed_filter_before_join();
 	void distributed_add_literal_candidate();
 
@@ -227,16 +244,18 @@ private:
 
 	//NOTICE:this is only used to join a BasicQuery
 	bool join();
-	bool join(string &internal_tag_str);
+	bool join(const MappedBitmap& internal_tags);
 
 public:
 	Join();
 	Join(KVstore* _kvstore);
+	//print the join orders chosen from now on, each after _label
+	static void setExplain(bool _explain, const string& _label = "");
 	//these functions can be called by Database
 	bool join_sparql(SPARQLquery& _sparql_query);
 	bool join_basic(BasicQuery* _basic_query);
-	bool join_pe(BasicQuery* _basic_query, string &internal_tag_str);
-	bool join_can(BasicQuery* _basic_query, string &internal_tag_str, vector< vector<int> >& candidates_vec, vector< vector<int> >& candidates_id_vec);
+	bool join_pe(BasicQuery* _basic_query, const MappedBitmap& internal_tags);
+	bool join_can(BasicQuery* _basic_query, const MappedBitmap& internal_tags, vector< vector<int> >& candidates_vec, vector< vector<int> >& candidates_id_vec);
 	~Join();
 };
 
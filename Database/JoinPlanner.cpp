@@ -0,0 +1,263 @@
+/*=============================================================================
+# Filename: JoinPlanner.cpp
+# Last Modified: 2026-10-17
+# Description: implement functions in JoinPlanner.h
+=============================================================================*/
+
+#include "JoinPlanner.h"
+
+using namespace std;
+
+JoinPlanner::JoinPlanner(KVstore* _kvstore, int _var_num)
+{
+	this->kvstore = _kvstore;
+	this->var_num = _var_num;
+	this->candidate_nums.assign(_var_num, -1);
+	this->var_edges.resize(_var_num);
+}
+
+void
+JoinPlanner::setCandidateNum(int _var, int _num)
+{
+	this->candidate_nums[_var] = _num;
+}
+
+//the stats of a database built by older versions are all 0, then the triple num is the length
+//of the p2s list and each subject or object is taken as in as few triples as possible
+void
+JoinPlanner::getPredicateStats(int _pre_id, double& _triple_num, double& _sub_num, double& _obj_num)
+{
+	double entity_num = max(Util::entity_num, 1), node_num = max(Util::entity_num + Util::literal_num, 1);
+	if (_pre_id == -2)
+	{
+		_triple_num = Util::triple_num;
+		_sub_num = entity_num;
+		_obj_num = node_num;
+		return;
+	}
+	_triple_num = _sub_num = _obj_num = 0;
+	if (_pre_id < 0)
+	{
+		return;
+	}
+	_triple_num = this->kvstore->getNumBypreID(_pre_id);
+	_sub_num = this->kvstore->getSubNumBypreID(_pre_id);
+	_obj_num = this->kvstore->getObjNumBypreID(_pre_id);
+	if (_triple_num <= 0)
+	{
+		_triple_num = this->kvstore->getPredicateDegree(_pre_id);
+		_sub_num = min(_triple_num, entity_num);
+		_obj_num = min(_triple_num, node_num);
+	}
+}
+
+void
+JoinPlanner::addEdge(int _sub_var, int _obj_var, int _pre_id)
+{
+	double triple_num, sub_num, obj_num;
+	this->getPredicateStats(_pre_id, triple_num, sub_num, obj_num);
+
+	Edge edge;
+	edge.sub_var = _sub_var;
+	edge.obj_var = _obj_var;
+	edge.selectivity = triple_num > 0 ? triple_num / (max(sub_num, 1.0) * max(obj_num, 1.0)) : 0;
+	this->var_edges[_sub_var].push_back(this->edges.size());
+	if (_obj_var != _sub_var)
+	{
+		this->var_edges[_obj_var].push_back(this->edges.size());
+	}
+	this->edges.push_back(edge);
+
+	//the estimated num of a vertex of unknown candidates, by the predicate most selective on it
+	for (int i = 0; i < 2; ++i)
+	{
+		int var = i == 0 ? _sub_var : _obj_var;
+		int num = (int)(i == 0 ? sub_num : obj_num);
+		if (this->candidate_nums[var] < 0 && (this->estimated_nums.count(var) == 0 || num < this->estimated_nums[var]))
+		{
+			this->estimated_nums[var] = num;
+		}
+	}
+}
+
+double
+JoinPlanner::getCandidateNum(int _var)
+{
+	if (this->candidate_nums[_var] >= 0)
+	{
+		return this->candidate_nums[_var];
+	}
+	map<int, int>::const_iterator it = this->estimated_nums.find(_var);
+	if (it != this->estimated_nums.end())
+	{
+		return it->second;
+	}
+	return Util::entity_num + Util::literal_num;
+}
+
+double
+JoinPlanner::estimateRows(const vector<char>& _in_set)
+{
+	double rows = 1;
+	for (int i = 0; i < this->var_num; ++i)
+	{
+		if (_in_set[i])
+		{
+			rows *= this->getCandidateNum(i);
+		}
+	}
+	for (int i = 0; i < this->edges.size(); ++i)
+	{
+		if (_in_set[this->edges[i].sub_var] && _in_set[this->edges[i].obj_var])
+		{
+			rows *= this->edges[i].selectivity;
+		}
+	}
+	return rows;
+}
+
+bool
+JoinPlanner::isNeighbor(int _var, const vector<char>& _in_set)
+{
+	for (int i = 0; i < this->var_edges[_var].size(); ++i)
+	{
+		const Edge& edge = this->edges[this->var_edges[_var][i]];
+		if (_in_set[edge.sub_var] || _in_set[edge.obj_var])
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+//dynamic programming over the connected sets of vertices with _start, each set is bound last
+//by the vertex that makes the least cost to bind the set
+double
+JoinPlanner::planAll(const vector<int>& _vars, int _start, vector<int>& _order)
+{
+	int num = _vars.size(), start_pos = find(_vars.begin(), _vars.end(), _start) - _vars.begin();
+	vector<double> costs(1 << num, -1);
+	vector<int> lasts(1 << num, -1);
+	vector<char> in_set(this->var_num, 0);
+	costs[1 << start_pos] = this->getCandidateNum(_start);
+	for (int mask = 1 << start_pos; mask < (1 << num); ++mask)
+	{
+		if (costs[mask] < 0)
+		{
+			continue;
+		}
+		for (int i = 0; i < num; ++i)
+		{
+			in_set[_vars[i]] = (mask >> i) & 1;
+		}
+		for (int i = 0; i < num; ++i)
+		{
+			if (((mask >> i) & 1) || !this->isNeighbor(_vars[i], in_set))
+			{
+				continue;
+			}
+			in_set[_vars[i]] = 1;
+			double cost = costs[mask] + this->estimateRows(in_set);
+			in_set[_vars[i]] = 0;
+			int next_mask = mask | (1 << i);
+			if (costs[next_mask] < 0 || cost < costs[next_mask])
+			{
+				costs[next_mask] = cost;
+				lasts[next_mask] = i;
+			}
+		}
+	}
+
+	_order.clear();
+	for (int mask = (1 << num) - 1; mask != (1 << start_pos); mask ^= 1 << lasts[mask])
+	{
+		_order.push_back(_vars[lasts[mask]]);
+	}
+	_order.push_back(_start);
+	reverse(_order.begin(), _order.end());
+	return costs[(1 << num) - 1];
+}
+
+//each time the neighbor with the least rows after it is bound
+double
+JoinPlanner::planGreedy(const vector<int>& _vars, int _start, vector<int>& _order)
+{
+	vector<char> in_set(this->var_num, 0);
+	in_set[_start] = 1;
+	_order.assign(1, _start);
+	double cost = this->getCandidateNum(_start);
+	while (_order.size() < _vars.size())
+	{
+		int next = -1;
+		double next_rows = 0;
+		for (int i = 0; i < _vars.size(); ++i)
+		{
+			int var = _vars[i];
+			if (in_set[var] || !this->isNeighbor(var, in_set))
+			{
+				continue;
+			}
+			in_set[var] = 1;
+			double rows = this->estimateRows(in_set);
+			in_set[var] = 0;
+			if (next == -1 || rows < next_rows || (rows == next_rows && this->getCandidateNum(var) < this->getCandidateNum(next)))
+			{
+				next = var;
+				next_rows = rows;
+			}
+		}
+		in_set[next] = 1;
+		_order.push_back(next);
+		cost += next_rows;
+	}
+	return cost;
+}
+
+double
+JoinPlanner::plan(int _start, int _start_num, vector<int>& _order, vector<double>& _rows)
+{
+	int start_num = this->candidate_nums[_start];
+	if (_start_num >= 0)
+	{
+		this->candidate_nums[_start] = _start_num;
+	}
+
+	//the vertices connected to _start
+	vector<int> vars(1, _start);
+	vector<char> in_set(this->var_num, 0);
+	in_set[_start] = 1;
+	for (int i = 0; i < vars.size(); ++i)
+	{
+		for (int j = 0; j < this->var_edges[vars[i]].size(); ++j)
+		{
+			const Edge& edge = this->edges[this->var_edges[vars[i]][j]];
+			int var = edge.sub_var == vars[i] ? edge.obj_var : edge.sub_var;
+			if (!in_set[var])
+			{
+				in_set[var] = 1;
+				vars.push_back(var);
+			}
+		}
+	}
+	sort(vars.begin(), vars.end());
+
+	double cost;
+	if (vars.size() <= JoinPlanner::DP_MAX_VAR_NUM)
+	{
+		cost = this->planAll(vars, _start, _order);
+	}
+	else
+	{
+		cost = this->planGreedy(vars, _start, _order);
+	}
+
+	_rows.clear();
+	in_set.assign(this->var_num, 0);
+	for (int i = 0; i < _order.size(); ++i)
+	{
+		in_set[_order[i]] = 1;
+		_rows.push_back(this->estimateRows(in_set));
+	}
+	this->candidate_nums[_start] = start_num;
+	return cost;
+}
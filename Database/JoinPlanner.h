@@ -0,0 +1,62 @@
+/*=============================================================================
+# Filename: JoinPlanner.h
+# Last Modified: 2026-10-17
+# Description: choose the order to bind the vertices of a query graph in a
+join, by the rows estimated from the candidate nums of the vertices and the
+stats of the predicates of the edges in the KVstore. The order of the least
+sum of the rows after each vertex is bound is searched among all the orders
+for small queries, and built greedily for the others.
+=============================================================================*/
+
+#ifndef _DATABASE_JOINPLANNER_H
+#define _DATABASE_JOINPLANNER_H
+
+#include "../KVstore/KVstore.h"
+#include "../Util/Util.h"
+
+//NOTICE:the rows of a set of vertices are the product of their candidate nums and the
+//selectivities of the edges among them, triple_num / (sub_num * obj_num) for a predicate,
+//so they do not depend on the order the vertices are bound in
+class JoinPlanner
+{
+public:
+	//the queries with more vertices connected to the start are ordered greedily
+	static const int DP_MAX_VAR_NUM = 8;
+
+	JoinPlanner(KVstore* _kvstore, int _var_num);
+	//-1 if the candidates are not known, e.g. for a literal variable not ready, then the num is
+	//estimated by the subjects or objects of the predicates of its edges
+	void setCandidateNum(int _var, int _num);
+	//_pre_id is -2 for a predicate variable and -1 for a predicate not in the database
+	void addEdge(int _sub_var, int _obj_var, int _pre_id);
+	//the order to bind the vertices connected to _start, from _start, and the rows estimated after
+	//each of them is bound, the cost(the sum of the rows) is returned. The candidate num of _start
+	//is _start_num for this plan only, or the one set before if _start_num is -1
+	double plan(int _start, int _start_num, std::vector<int>& _order, std::vector<double>& _rows);
+
+private:
+	struct Edge
+	{
+		int sub_var;
+		int obj_var;
+		double selectivity;
+	};
+	KVstore* kvstore;
+	int var_num;
+	std::vector<int> candidate_nums;
+	//of the vertices of unknown candidates
+	std::map<int, int> estimated_nums;
+	std::vector<Edge> edges;
+	//the edges of each vertex, by the index in edges
+	std::vector< std::vector<int> > var_edges;
+
+	void getPredicateStats(int _pre_id, double& _triple_num, double& _sub_num, double& _obj_num);
+	double getCandidateNum(int _var);
+	//the rows of the vertices in _in_set
+	double estimateRows(const std::vector<char>& _in_set);
+	bool isNeighbor(int _var, const std::vector<char>& _in_set);
+	double planAll(const std::vector<int>& _vars, int _start, std::vector<int>& _order);
+	double planGreedy(const std::vector<int>& _vars, int _start, std::vector<int>& _order);
+};
+
+#endif //_DATABASE_JOINPLANNER_H
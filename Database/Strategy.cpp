@@ -42,7 +42,7 @@ Strategy::~Strategy()
 //however, this can be dealed due to several basicquery and linking
 
 bool
-Strategy::handleCandidate(SPARQLquery& _query, string &internal_tag_str, vector< vector<int> >& candidates_vec, vector< vector<int> >& candidates_id_vec, vector< vector<int> > &_query_dir_ad, vector< vector<int> > &_query_pre_ad, vector< vector<int> > &_query_ad, set<int> &satellites_set, ResultFilter* _result_filter)
+Strategy::handleCandidate(SPARQLquery& _query, const MappedBitmap& internal_tags, vector< vector<int> >& candidates_vec, vector< vector<int> >& candidates_id_vec, vector< vector<int> > &_query_dir_ad, vector< vector<int> > &_query_pre_ad, vector< vector<int> > &_query_ad, set<int> &satellites_set, ResultFilter* _result_filter)
 {
 #ifdef MULTI_INDEX
 	Util::logging("IN GeneralEvaluation::handle");
@@ -158,7 +158,7 @@ Strategy::handleCandidate(SPARQLquery& _query, string &internal_tag_str, vector<
 			switch (this->method)
 			{
 			case 0:
-				this->handler0_1(*iter, candidates_vec, internal_tag_str, candidates_id_vec, _result_filter);
+				this->handler0_1(*iter, candidates_vec, internal_tags, candidates_id_vec, _result_filter);
 				break;
 			case 1:
 				this->handler1(*iter, result_list);
@@ -250,7 +250,7 @@ Strategy::handleCandidate(SPARQLquery& _query, string &internal_tag_str, vector<
 }
 
 bool
-Strategy::handle(SPARQLquery& _query, string &internal_tag_str, ResultFilter* _result_filter)
+Strategy::handle(SPARQLquery& _query, const MappedBitmap& internal_tags, ResultFilter* _result_filter)
 {
 #ifdef MULTI_INDEX
 	Util::logging("IN GeneralEvaluation::handle");
@@ -366,7 +366,7 @@ Strategy::handle(SPARQLquery& _query, string &internal_tag_str, ResultFilter* _r
 		switch (this->method)
 		{
 		case 0:
-			this->handler0_0(*iter, internal_tag_str, result_list, _result_filter);
+			this->handler0_0(*iter, internal_tags, result_list, _result_filter);
 			break;
 		case 1:
 			this->handler1(*iter, result_list);
@@ -556,7 +556,7 @@ Strategy::handle(SPARQLquery& _query, ResultFilter* _result_filter)
 }
 
 void
-Strategy::handler0_0(BasicQuery* _bq, string& internal_tag_str, vector<int*>& _result_list, ResultFilter* _result_filter)
+Strategy::handler0_0(BasicQuery* _bq, const MappedBitmap& internal_tags, vector<int*>& _result_list, ResultFilter* _result_filter)
 {
 	int star_flag = 0;
 	if(star_flag == 0){
@@ -593,7 +593,7 @@ Strategy::handler0_0(BasicQuery* _bq, string& internal_tag_str, vector<int*>& _r
     	_result_filter->candFilterWithResultHashTable(*_bq);
 		
 	Join *join = new Join(kvstore);
-	join->join_pe(_bq, internal_tag_str);
+	join->join_pe(_bq, internal_tags);
 		
 	delete join;
 
@@ -602,7 +602,7 @@ Strategy::handler0_0(BasicQuery* _bq, string& internal_tag_str, vector<int*>& _r
 }
 
 void
-Strategy::handler0_1(BasicQuery* _bq, vector< vector<int> >& candidates_vec, string& internal_tag_str, vector< vector<int> >& candidates_id_vec, ResultFilter* _result_filter)
+Strategy::handler0_1(BasicQuery* _bq, vector< vector<int> >& candidates_vec, const MappedBitmap& internal_tags, vector< vector<int> >& candidates_id_vec, ResultFilter* _result_filter)
 {
 	int star_flag = 0;
 	if(star_flag == 0){
@@ -639,7 +639,7 @@ Strategy::handler0_1(BasicQuery* _bq, vector< vector<int> >& candidates_vec, str
     	_result_filter->candFilterWithResultHashTable(*_bq);
 		
 	Join *join = new Join(kvstore);
-	join->join_can(_bq, internal_tag_str, candidates_vec, candidates_id_vec);
+	join->join_can(_bq, internal_tags, candidates_vec, candidates_id_vec);
 		
 	delete join;
 
@@ -0,0 +1,287 @@
+/*=============================================================================
+# Filename: TrieJoin.cpp
+# Last Modified: 2026-10-17
+# Description: implement functions in TrieJoin.h
+=============================================================================*/
+
+#include "TrieJoin.h"
+#include "../Util/ListIntersect.h"
+
+using namespace std;
+
+TrieJoin::TrieJoin(KVstore* _kvstore, BasicQuery* _basic_query, const MappedBitmap& _internal_tags)
+	: internal_tags(_internal_tags)
+{
+	this->kvstore = _kvstore;
+	this->basic_query = _basic_query;
+	this->var_num = _basic_query->getVarNum();
+}
+
+static int
+findRoot(vector<int>& _parents, int _id)
+{
+	while(_parents[_id] != _id){
+		_parents[_id] = _parents[_parents[_id]];
+		_id = _parents[_id];
+	}
+	return _id;
+}
+
+bool
+TrieJoin::isCyclic(BasicQuery* _basic_query)
+{
+	int var_num = _basic_query->getVarNum();
+	vector<int> parents(var_num);
+	for(int i = 0; i < var_num; ++i){
+		parents[i] = i;
+	}
+	//each edge between two vertices is seen from both ends, so only from the smaller one
+	for(int i = 0; i < var_num; ++i){
+		for(int j = 0; j < _basic_query->getVarDegree(i); ++j){
+			int var_id2 = _basic_query->getEdgeNeighborID(i, j);
+			if(var_id2 == i)
+				return true;
+			if(var_id2 < i)
+				continue;
+			int root1 = findRoot(parents, i), root2 = findRoot(parents, var_id2);
+			if(root1 == root2)
+				return true;
+			parents[root1] = root2;
+		}
+	}
+	return false;
+}
+
+bool
+TrieJoin::isInternal(int _id) const
+{
+	return _id >= Util::LITERAL_FIRST_ID || this->internal_tags.test(_id);
+}
+
+bool
+TrieJoin::isSatellite(int _var)
+{
+	return this->basic_query->getVarDegree(_var) == 1;
+}
+
+bool
+TrieJoin::plan(int _mask)
+{
+	this->roles.assign(this->var_num, TrieJoin::UNBOUND);
+	int first = -1;
+	for(int i = 0; i < this->var_num; ++i){
+		if((_mask >> i & 1) == 0)
+			continue;
+		if(this->isSatellite(i) || (*this->can_sets)[i].empty())
+			return false;
+		this->roles[i] = TrieJoin::INTERNAL;
+		if(first == -1 || (*this->can_sets)[i].size() < (*this->can_sets)[first].size())
+			first = i;
+	}
+
+	//the internal set is bound first, each vertex next to those bound before, with the most
+	//edges to them, then the extended vertices and the satellites around it
+	this->order.clear();
+	this->order.push_back(first);
+	vector<bool> placed(this->var_num, false);
+	placed[first] = true;
+	while(true){
+		int next = -1, next_edge_num = 0;
+		for(int i = 0; i < this->var_num; ++i){
+			if(this->roles[i] != TrieJoin::INTERNAL || placed[i])
+				continue;
+			int edge_num = 0;
+			for(int j = 0; j < this->basic_query->getVarDegree(i); ++j){
+				int var_id2 = this->basic_query->getEdgeNeighborID(i, j);
+				if(var_id2 != -1 && placed[var_id2])
+					edge_num++;
+			}
+			if(edge_num > next_edge_num || (edge_num > 0 && edge_num == next_edge_num && (*this->can_sets)[i].size() < (*this->can_sets)[next].size())){
+				next = i;
+				next_edge_num = edge_num;
+			}
+		}
+		if(next == -1)
+			break;
+		this->order.push_back(next);
+		placed[next] = true;
+	}
+	//not connected
+	if(this->order.size() != __builtin_popcount(_mask))
+		return false;
+
+	for(int i = 0; i < this->order.size(); ++i){
+		int var_id = this->order[i];
+		for(int j = 0; j < this->basic_query->getVarDegree(var_id); ++j){
+			int var_id2 = this->basic_query->getEdgeNeighborID(var_id, j);
+			if(var_id2 == -1)
+				continue;
+			//the predicate is not in this site
+			if(this->basic_query->getEdgePreID(var_id, j) == -1)
+				return false;
+			if(this->roles[var_id2] == TrieJoin::UNBOUND)
+				this->roles[var_id2] = this->isSatellite(var_id2) ? TrieJoin::SATELLITE : TrieJoin::EXTENDED;
+		}
+	}
+	for(int role = TrieJoin::EXTENDED; role <= TrieJoin::SATELLITE; ++role){
+		for(int i = 0; i < this->var_num; ++i){
+			if(this->roles[i] == role)
+				this->order.push_back(i);
+		}
+	}
+
+	//an edge is matched when its second end is bound, if either end is internal
+	this->constraints.assign(this->order.size(), vector<Constraint>());
+	for(int i = 0; i < this->order.size(); ++i){
+		int var_id = this->order[i];
+		for(int j = 0; j < this->basic_query->getVarDegree(var_id); ++j){
+			int var_id2 = this->basic_query->getEdgeNeighborID(var_id, j);
+			if(var_id2 == -1 || (this->roles[var_id] != TrieJoin::INTERNAL && this->roles[var_id2] != TrieJoin::INTERNAL))
+				continue;
+			if(var_id2 != var_id && find(this->order.begin(), this->order.begin() + i, var_id2) == this->order.begin() + i)
+				continue;
+			Constraint constraint;
+			constraint.neighbor = var_id2;
+			constraint.pre_id = this->basic_query->getEdgePreID(var_id, j);
+			constraint.edge_type = this->basic_query->getEdgeType(var_id, j);
+			this->constraints[i].push_back(constraint);
+		}
+	}
+	return true;
+}
+
+//the neighbors of _ele along the edge of a constraint, in increasing order
+static void
+getNeighbors(KVstore* _kvstore, int _ele, int _pre_id, char _edge_type, int*& _list, int& _len)
+{
+	_list = NULL;
+	_len = 0;
+	if(_edge_type == Util::EDGE_IN){
+		if(_pre_id == -2)
+			_kvstore->getobjIDlistBysubID(_ele, _list, _len);
+		else
+			_kvstore->getobjIDlistBysubIDpreID(_ele, _pre_id, _list, _len);
+	}else{
+		if(_pre_id == -2)
+			_kvstore->getsubIDlistByobjID(_ele, _list, _len);
+		else
+			_kvstore->getsubIDlistByobjIDpreID(_ele, _pre_id, _list, _len);
+	}
+}
+
+void
+TrieJoin::search(int _level, JoinTable& _table)
+{
+	if(_level == this->order.size()){
+		_table.addRow(&this->record[0]);
+		return;
+	}
+	int var_id = this->order[_level];
+	int role = this->roles[var_id];
+	const vector<Constraint>& cur_constraints = this->constraints[_level];
+
+	vector<const int*> lists;
+	vector<int> lens;
+	vector<int*> owned_lists;
+	vector<Constraint> self_loops;
+	bool empty = false;
+	for(int i = 0; i < cur_constraints.size() && !empty; ++i){
+		if(cur_constraints[i].neighbor == var_id){
+			self_loops.push_back(cur_constraints[i]);
+			continue;
+		}
+		int* id_list;
+		int id_list_len;
+		getNeighbors(this->kvstore, this->record[cur_constraints[i].neighbor], cur_constraints[i].pre_id, cur_constraints[i].edge_type, id_list, id_list_len);
+		if(id_list != NULL)
+			owned_lists.push_back(id_list);
+		if(id_list == NULL || id_list_len <= 0){
+			empty = true;
+			break;
+		}
+		lists.push_back(id_list);
+		lens.push_back(id_list_len);
+	}
+	const IDBitmap& can_set = (*this->can_sets)[var_id];
+
+	//the candidates are the last relation of an internal vertex, probed for the IDs of the others
+	vector<int> values;
+	if(!empty && lists.empty()){
+		can_set.getIDs(values);
+	}else if(!empty){
+		values.resize(*min_element(lens.begin(), lens.end()));
+		values.resize(ListIntersect::intersectLeapfrog(&lists[0], &lens[0], lists.size(), &values[0]));
+		if(role == TrieJoin::INTERNAL && !values.empty())
+			values.resize(can_set.intersect(&values[0], values.size(), &values[0]));
+	}
+	for(int i = 0; i < owned_lists.size(); ++i){
+		delete[] owned_lists[i];
+	}
+
+	for(int i = 0; i < values.size(); ++i){
+		int ele = values[i];
+		//the internal vertices come from the candidates only, and the extended vertices need no check here
+		if(role == TrieJoin::EXTENDED && this->isInternal(ele))
+			continue;
+		if(role == TrieJoin::SATELLITE && this->isInternal(ele) && !can_set.contains(ele))
+			continue;
+		bool matched = true;
+		for(int j = 0; j < self_loops.size() && matched; ++j){
+			int* id_list;
+			int id_list_len;
+			getNeighbors(this->kvstore, ele, self_loops[j].pre_id, self_loops[j].edge_type, id_list, id_list_len);
+			matched = id_list_len > 0 && Util::bsearch_int_uporder(ele, id_list, id_list_len) != -1;
+			delete[] id_list;
+		}
+		if(!matched)
+			continue;
+
+		this->record[var_id] = ele;
+		this->search(_level + 1, _table);
+	}
+	this->record[var_id] = -1;
+}
+
+bool
+TrieJoin::run(const vector<IDBitmap>& _can_set_list, JoinTable& _table)
+{
+	_table.init(this->var_num);
+	this->can_sets = &_can_set_list;
+	this->record.assign(this->var_num, -1);
+
+	//each match has a single internal set, so the sets are searched one by one; an internal set is connected
+	//and has no satellites, so only such sets are enumerated, each from its smallest vertex
+	this->neighbor_masks.assign(this->var_num, 0);
+	int vars = 0;
+	for(int i = 0; i < this->var_num; ++i){
+		if(!this->isSatellite(i) && !_can_set_list[i].empty())
+			vars |= 1 << i;
+	}
+	for(int i = 0; i < this->var_num; ++i){
+		for(int j = 0; j < this->basic_query->getVarDegree(i); ++j){
+			int var_id2 = this->basic_query->getEdgeNeighborID(i, j);
+			if(var_id2 != -1 && var_id2 != i)
+				this->neighbor_masks[i] |= 1 << var_id2 & vars;
+		}
+	}
+	for(int i = 0; i < this->var_num; ++i){
+		if(vars >> i & 1)
+			this->extend(1 << i, this->neighbor_masks[i] & ~((2 << i) - 1), 1 << i | this->neighbor_masks[i], i, _table);
+	}
+	_table.sortUnique();
+	return true;
+}
+
+//each connected set is reached once: a vertex joins the extension only where it is first next to the set
+void
+TrieJoin::extend(int _mask, int _ext, int _closed, int _start, JoinTable& _table)
+{
+	if(this->plan(_mask))
+		this->search(0, _table);
+	while(_ext != 0){
+		int var_id = __builtin_ctz(_ext);
+		_ext &= ~(1 << var_id);
+		int next_ext = _ext | (this->neighbor_masks[var_id] & ~_closed & ~((2 << _start) - 1));
+		this->extend(_mask | 1 << var_id, next_ext, _closed | this->neighbor_masks[var_id], _start, _table);
+	}
+}
@@ -0,0 +1,74 @@
+/*=============================================================================
+# Filename: TrieJoin.h
+# Last Modified: 2026-10-17
+# Description: worst-case optimal search of the local partial matches of a
+site, for query graphs with cycles. The query vertices are bound one at a
+time, and the values of a vertex are found by leapfrogging over the sorted
+adjacency lists from all its bound neighbors together with its candidates,
+so a cycle is closed while a vertex is bound instead of after the rows of
+a path are built.
+=============================================================================*/
+
+#ifndef _DATABASE_TRIEJOIN_H
+#define _DATABASE_TRIEJOIN_H
+
+#include "../Query/BasicQuery.h"
+#include "../KVstore/KVstore.h"
+#include "../Util/Util.h"
+#include "../Util/MappedBitmap.h"
+#include "../Util/JoinTable.h"
+#include "../Util/IDBitmap.h"
+
+//NOTICE:a local partial match binds a set of vertices connected in the query graph to internal
+//vertices or literals, called the internal set, and each other neighbor of them to an extended
+//vertex, or to any local neighbor for a vertex of degree 1(a satellite). The edges from the
+//internal set are all matched locally, the other vertices are -1.
+//The satellites are never in the internal set, as in Join::multi_join.
+class TrieJoin
+{
+public:
+	//the internal sets of a larger query may be too many to search one by one, it is left to Join::multi_join
+	static const int MAX_VAR_NUM = 16;
+
+	TrieJoin(KVstore* _kvstore, BasicQuery* _basic_query, const MappedBitmap& _internal_tags);
+	//if there is a cycle in the query graph, including two edges between the same vertices
+	static bool isCyclic(BasicQuery* _basic_query);
+	//_can_set_list keeps the internal vertices and literals among the candidates of each vertex,
+	//_table is filled with the local partial matches, sorted
+	bool run(const std::vector<IDBitmap>& _can_set_list, JoinTable& _table);
+
+private:
+	struct Constraint
+	{
+		int neighbor;
+		int pre_id;
+		//Util::EDGE_IN if the vertex bound is the object
+		char edge_type;
+	};
+	KVstore* kvstore;
+	BasicQuery* basic_query;
+	const MappedBitmap& internal_tags;
+	int var_num;
+
+	//by the level of the search, the vertex bound and the edges to the vertices bound before it
+	std::vector<int> order;
+	std::vector< std::vector<Constraint> > constraints;
+	//the role of each vertex in the internal set of the search
+	enum { UNBOUND, INTERNAL, EXTENDED, SATELLITE };
+	std::vector<int> roles;
+	const std::vector<IDBitmap>* can_sets;
+	std::vector<int> record;
+	//the neighbors of each vertex that may be in an internal set, as a mask of vertices
+	std::vector<int> neighbor_masks;
+
+	bool isInternal(int _id) const;
+	bool isSatellite(int _var);
+	//the order and the constraints for the internal set _mask, false if it can not be matched
+	bool plan(int _mask);
+	void search(int _level, JoinTable& _table);
+	//search the internal set _mask, and those grown from it by the vertices in _ext and the neighbors
+	//of them out of _closed(_mask and its neighbors) and after _start, the smallest vertex of the sets
+	void extend(int _mask, int _ext, int _closed, int _start, JoinTable& _table);
+};
+
+#endif //_DATABASE_TRIEJOIN_H
@@ -23,6 +23,7 @@ ISTree::ISTree()
 	transfer_size[0] = transfer_size[1] = transfer_size[2] = 0;
 	this->stream = NULL;
 	this->request = 0;
+	pthread_mutex_init(&this->search_mutex, NULL);
 }
 
 ISTree::ISTree(string _storepath, string _filename, string _mode)
@@ -43,6 +44,7 @@ ISTree::ISTree(string _storepath, string _filename, string _mode)
 	this->transfer_size[0] = this->transfer_size[1] = this->transfer_size[2] = Util::TRANSFER_SIZE;		//initialied to 1M
 	this->stream = NULL;
 	this->request = 0;
+	pthread_mutex_init(&this->search_mutex, NULL);
 }
 
 string
@@ -112,19 +114,24 @@ ISTree::search(int _key, char*& _str, int& _len)
 		return false;
 	}
 
+	pthread_mutex_lock(&this->search_mutex);
 	this->request = 0;
 	int store;
 	ISNode* ret = this->find(_key, &store, false);
 	if (ret == NULL || store == -1 || _key != ret->getKey(store))	//tree is empty or not found
 	{
+		pthread_mutex_unlock(&this->search_mutex);
 		return false;
 	}
 
+	//copied before the request, which may swap the node out
 	const Bstr* val = ret->getValue(store);
-	this->CopyToTransfer(val->getStr(), val->getLen(), 0);		//not sum to request
-	_str = this->transfer[0].getStr();
-	_len = this->transfer[0].getLen();
+	_len = val->getLen();
+	_str = new char[_len + 1];
+	memcpy(_str, val->getStr(), _len);
+	_str[_len] = '\0';
 	this->TSM->request(request);
+	pthread_mutex_unlock(&this->search_mutex);
 	return true;
 }
 
@@ -548,6 +555,140 @@ ISTree::range_query(int _key1, int _key2)
 	return true;
 }
 
+//the tree is built bottom-up: leaves are packed in key order, and each level is written
+//out as soon as it is complete, so the blocks of the tree are allocated in file order
+bool
+ISTree::bulkLoad(ISIterator& _iter, unsigned _fill)
+{
+	if (this->root != NULL)
+	{
+		printf("error in ISTree-bulkLoad: tree is not empty\n");
+		return false;
+	}
+	unsigned key_max = ISNode::MAX_KEY_NUM * _fill / 100;
+	if (key_max < ISNode::MIN_CHILD_NUM)
+		key_max = ISNode::MIN_CHILD_NUM;
+	else if (key_max > ISNode::MAX_KEY_NUM)
+		key_max = ISNode::MAX_KEY_NUM;
+	unsigned child_max = ISNode::MAX_CHILD_NUM * _fill / 100;
+	if (child_max < ISNode::MIN_CHILD_NUM)
+		child_max = ISNode::MIN_CHILD_NUM;
+	else if (child_max > ISNode::MAX_CHILD_NUM)
+		child_max = ISNode::MAX_CHILD_NUM;
+
+	//nodes of the current level and the least key below each of them
+	vector<ISNode*> level;
+	vector<int> mins;
+	//the last full leaf is kept in memory, to share keys with a short last leaf
+	ISNode* leaf = NULL;
+	ISNode* prev = NULL;
+	bool sorted = true;
+	int key;
+	const char* str;
+	unsigned len;
+	while (_iter.next(key, str, len))
+	{
+		if (key < 0 || (leaf != NULL && key <= leaf->getKey(leaf->getNum() - 1)))
+		{
+			printf("error in ISTree-bulkLoad: keys are not ascending\n");
+			sorted = false;
+			break;
+		}
+		if (leaf != NULL && leaf->getNum() == key_max)
+		{
+			if (prev != NULL)
+				this->bulkWrite(prev);
+			prev = leaf;
+			leaf = NULL;
+		}
+		if (leaf == NULL)
+		{
+			leaf = new ISLeafNode;
+			leaf->setHeight(1);
+			if (prev != NULL)
+			{
+				prev->setNext(leaf);
+				leaf->setPrev(prev);
+			}
+			else
+				this->leaves_head = leaf;
+			level.push_back(leaf);
+			mins.push_back(key);
+		}
+		this->CopyToTransfer(str, len, 2);
+		int i = leaf->getNum();
+		leaf->addKey(key, i);
+		leaf->addValue(&transfer[2], i, true);
+		leaf->addNum();
+	}
+	if (leaf == NULL)
+		return sorted;
+	if (prev != NULL && leaf->getNum() < ISNode::MIN_CHILD_NUM)
+	{
+		//move the tail of the full leaf, so that both are at least half full
+		int move = (prev->getNum() - leaf->getNum()) / 2;
+		for (; move > 0; --move)
+		{
+			int i = prev->getNum() - 1;
+			leaf->addKey(prev->getKey(i), 0);
+			leaf->addValue(prev->getValue(i), 0);
+			leaf->addNum();
+			prev->subNum();
+		}
+		mins.back() = leaf->getKey(0);
+	}
+	if (prev != NULL)
+		this->bulkWrite(prev);
+	this->bulkWrite(leaf);
+	this->leaves_tail = leaf;
+	this->height = 1;
+
+	//spread the nodes of a level evenly over as few parents as possible
+	while (level.size() > 1)
+	{
+		vector<ISNode*> parents;
+		vector<int> parent_mins;
+		unsigned num = level.size();
+		unsigned parent_num = (num + child_max - 1) / child_max;
+		unsigned i = 0;
+		for (unsigned j = 0; j < parent_num; ++j)
+		{
+			unsigned child_num = num / parent_num + (j < num % parent_num ? 1 : 0);
+			ISNode* p = new ISIntlNode;
+			p->setHeight(this->height + 1);
+			p->addChild(level[i], 0);
+			for (unsigned k = 1; k < child_num; ++k)
+			{
+				p->addKey(mins[i + k], k - 1);
+				p->addChild(level[i + k], k);
+				p->addNum();
+			}
+			this->bulkWrite(p);
+			parents.push_back(p);
+			parent_mins.push_back(mins[i]);
+			i += child_num;
+		}
+		level.swap(parents);
+		mins.swap(parent_mins);
+		this->height++;
+	}
+
+	//the root is kept in memory, just as preRead() leaves it
+	this->root = level[0];
+	long long memory = 0;
+	this->TSM->readNode(this->root, &memory);
+	this->TSM->request(memory);
+	return sorted;
+}
+
+void
+ISTree::bulkWrite(ISNode* _np)
+{
+	_np->setDirty();
+	this->TSM->writeNode(_np);
+	_np->Virtual();
+}
+
 bool
 ISTree::save()	//save the whole tree to disk
 {
@@ -577,6 +718,7 @@ ISTree::release(ISNode* _np) const
 
 ISTree::~ISTree()
 {
+	pthread_mutex_destroy(&this->search_mutex);
 	delete this->stream;   //maybe NULL
 	delete TSM;
 #ifdef DEBUG_KVSTORE
@@ -15,6 +15,16 @@
 #include "node/IntlNode.h"
 #include "node/LeafNode.h"
 #include "storage/Storage.h"
+#include <pthread.h>
+
+//pairs given to ISTree::bulkLoad(), keys must be strictly ascending
+class ISIterator
+{
+public:
+	//return false at the end, the value is valid until the next call
+	virtual bool next(int& _key, const char*& _str, unsigned& _len) = 0;
+	virtual ~ISIterator() {};
+};
 
 class ISTree
 {					
@@ -32,12 +42,12 @@ protected:
 	//to get a real string, instead of new and copy
 	//other operations will be harmful to search, so store value in
 	//transfer temporally, while length adjusted.
-	//TODO: in multi-user case, multiple-search will cause problem,
-	//so lock is a must. Add lock to transfer is better than to add 
-	//lock to every key/value. However, modify requires a lock for a
-	//key/value, and multiple search for different keys are ok!!!
+	//NOTICE: a search also reads nodes into the storage and swaps others
+	//out, so the searches of several threads are serialized by search_mutex.
+	//A tree is only modified while no search runs on it.
 	Bstr transfer[3];	//0:transfer value searched; 1:copy key-data from const char*; 2:copy val-data from const char*
 	unsigned transfer_size[3];
+	pthread_mutex_t search_mutex;
 
 	//tree's operations should be atom(if read nodes)
 	//sum the request and send to ISStorage at last
@@ -51,6 +61,7 @@ protected:
 	std::string getFilePath();	//in UNIX system
 	void CopyToTransfer(const char* _str, unsigned _len, unsigned _index);
 	void release(ISNode* _np) const;
+	void bulkWrite(ISNode* _np);
 
 public:
 	ISTree();				//always need to initial transfer
@@ -60,6 +71,7 @@ public:
 	ISNode* getRoot() const;
 	//void setRoot(Node* _root);
 	//insert, search, remove, set
+	//the value is copied to _str, allocated by new[] with a '\0' after it and freed by the caller
 	bool search(int _key, char*& _str, int& _len);
 	bool insert(int _key, const char* _str, unsigned _len);
 	bool modify(int _key, const char* _str, unsigned _len);
@@ -68,6 +80,8 @@ public:
 	const Bstr* getRangeValue();
 	void resetStream();
 	bool range_query(int  _key1, int _key2);
+	//build an empty tree from sorted pairs, with each node filled to _fill percent
+	bool bulkLoad(ISIterator& _iter, unsigned _fill = Util::BULK_FILL_PERCENT);
 	bool save(); 			
 	~ISTree();
 	void print(std::string s);			//DEBUG(print the tree)
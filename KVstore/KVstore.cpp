@@ -476,7 +476,7 @@ KVstore::updateInsert_p2so(int _preid, const std::vector<int>& _sidoidlist)
 	int* _p2solist = NULL;
 	int _p2so_len = 0;
 	this->getsubIDobjIDlistBypreID(_preid, _p2solist, _p2so_len);
-	bool insert = this->insertList_x(_p2solist, _p2so_len, _sidoidlist);
+	bool insert = this->insertList_xy(_p2solist, _p2so_len, _sidoidlist);
 
 	if (insert)
 	{
@@ -486,6 +486,7 @@ KVstore::updateInsert_p2so(int _preid, const std::vector<int>& _sidoidlist)
 	{
 		this->addsubIDobjIDlistBypreID(_preid, _p2solist, _p2so_len);
 	}
+	this->setNumBypreID(_preid, _p2so_len / 2);
 	delete[] _p2solist;
 	_p2solist = NULL;
 	_p2so_len = 0;
@@ -499,7 +500,7 @@ KVstore::updateRemove_p2so(int _preid, const std::vector<int>& _sidoidlist)
 	int* _p2solist = NULL;
 	int _p2so_len = 0;
 	this->getsubIDobjIDlistBypreID(_preid, _p2solist, _p2so_len);
-	bool remove = this->removeList_x(_p2solist, _p2so_len, _sidoidlist);
+	bool remove = this->removeList_xy(_p2solist, _p2so_len, _sidoidlist);
 
 	if (remove)
 	{
@@ -510,6 +511,7 @@ KVstore::updateRemove_p2so(int _preid, const std::vector<int>& _sidoidlist)
 		//this->subsubIDobjIDlistBypreID(_preid, _p2solist, _p2so_len);
 		this->removeKey(this->preID2subIDobjIDlist, _preid);
 	}
+	this->setNumBypreID(_preid, _p2so_len / 2);
 	delete[] _p2solist;
 	_p2solist = NULL;
 	_p2so_len = 0;
@@ -533,6 +535,7 @@ KVstore::updateInsert_p2s(int _preid, const std::vector<int>& _sidlist)
 	{
 		this->addsubIDlistBypreID(_preid, _p2slist, _p2s_len);
 	}
+	this->setSubNumBypreID(_preid, KVstore::countDistinct(_p2slist, _p2s_len));
 	delete[] _p2slist;
 	_p2slist = NULL;
 	_p2s_len = 0;
@@ -557,6 +560,7 @@ KVstore::updateRemove_p2s(int _preid, const std::vector<int>& _sidlist)
 		//this->subsubIDlistBypreID(_preid, _p2slist, _p2s_len);
 		this->removeKey(this->preID2subIDlist, _preid);
 	}
+	this->setSubNumBypreID(_preid, KVstore::countDistinct(_p2slist, _p2s_len));
 	delete[] _p2slist;
 	_p2slist = NULL;
 	_p2s_len = 0;
@@ -574,12 +578,13 @@ KVstore::updateInsert_p2o(int _preid, const std::vector<int>& _oidlist)
 
 	if (insert)
 	{
-		this->setsubIDlistBypreID(_preid, _p2olist, _p2o_len);
+		this->setobjIDlistBypreID(_preid, _p2olist, _p2o_len);
 	}
 	else
 	{
-		this->addsubIDlistBypreID(_preid, _p2olist, _p2o_len);
+		this->addobjIDlistBypreID(_preid, _p2olist, _p2o_len);
 	}
+	this->setObjNumBypreID(_preid, KVstore::countDistinct(_p2olist, _p2o_len));
 	delete[] _p2olist;
 	_p2olist = NULL;
 	_p2o_len = 0;
@@ -597,13 +602,14 @@ KVstore::updateRemove_p2o(int _preid, const std::vector<int>& _oidlist)
 
 	if (remove)
 	{
-		this->setsubIDlistBypreID(_preid, _p2olist, _p2o_len);
+		this->setobjIDlistBypreID(_preid, _p2olist, _p2o_len);
 	}
 	else
 	{
 		//this->subsubIDlistBypreID(_preid, _p2olist, _p2o_len);
 		this->removeKey(this->preID2objIDlist, _preid);
 	}
+	this->setObjNumBypreID(_preid, KVstore::countDistinct(_p2olist, _p2o_len));
 	delete[] _p2olist;
 	_p2olist = NULL;
 	_p2o_len = 0;
@@ -864,6 +870,7 @@ KVstore::updateTupleslist_insert(int _sub_id, int _pre_id, int _obj_id)
 			this->addsubIDlistBypreID(_pre_id, _p2slist, _p2s_len);
 		}
 		//updateListLen += _p2s_len;
+		this->setSubNumBypreID(_pre_id, KVstore::countDistinct(_p2slist, _p2s_len));
 		delete[] _p2slist;
 		_p2slist = NULL;
 		_p2s_len = 0;
@@ -910,6 +917,7 @@ KVstore::updateTupleslist_insert(int _sub_id, int _pre_id, int _obj_id)
 			this->addobjIDlistBypreID(_pre_id, _p2olist, _p2o_len);
 		}
 		//updateListLen += _p2o_len;
+		this->setObjNumBypreID(_pre_id, KVstore::countDistinct(_p2olist, _p2o_len));
 		delete[] _p2olist;
 		_p2olist = NULL;
 		_p2o_len = 0;
@@ -953,6 +961,7 @@ KVstore::updateTupleslist_insert(int _sub_id, int _pre_id, int _obj_id)
 			this->addsubIDobjIDlistBypreID(_pre_id, _p2solist, _p2so_len);
 		}
 		//updateListLen += _p2so_len;
+		this->setNumBypreID(_pre_id, _p2so_len / 2);
 		delete[] _p2solist;
 		_p2solist = NULL;
 		_p2so_len = 0;
@@ -1148,6 +1157,7 @@ KVstore::updateTupleslist_remove(int _sub_id, int _pre_id, int _obj_id)
 			this->removeKey(this->preID2subIDlist, _pre_id);
 		}
 		//cout<<"to delete"<<endl;
+		this->setSubNumBypreID(_pre_id, KVstore::countDistinct(_p2slist, _p2s_len));
 		delete[] _p2slist;
 		//cout<<"delete ok"<<endl;
 	}
@@ -1187,6 +1197,7 @@ KVstore::updateTupleslist_remove(int _sub_id, int _pre_id, int _obj_id)
 		{
 			this->removeKey(this->preID2objIDlist, _pre_id);
 		}
+		this->setObjNumBypreID(_pre_id, KVstore::countDistinct(_p2olist, _p2o_len));
 		delete[] _p2olist;
 	}
 	//cout<<"remove in p2o"<<endl;
@@ -1228,6 +1239,7 @@ KVstore::updateTupleslist_remove(int _sub_id, int _pre_id, int _obj_id)
 			this->removeKey(this->preID2subIDobjIDlist, _pre_id);
 		}
 
+		this->setNumBypreID(_pre_id, _p2so_len / 2);
 		delete[] _p2solist;
 	}
 	//cout<<"remove in p2so"<<endl;
@@ -1828,7 +1840,7 @@ KVstore::getEntityByID(int _id)
 		}
 	}
 	string _ret = string(_tmp);
-	//delete[] _tmp;	DEBUG
+	delete[] _tmp;
 
 	return _ret;
 }
@@ -1935,7 +1947,7 @@ KVstore::getPredicateByID(int _id)
 		}
 	}
 	string _ret = string(_tmp);
-	//delete[] _tmp;
+	delete[] _tmp;
 
 	return _ret;
 }
@@ -2044,7 +2056,7 @@ KVstore::getLiteralByID(int _id)
 		}
 	}
 	string _ret = string(_tmp);
-	//	delete[] _tmp;
+	delete[] _tmp;
 
 	return _ret;
 }
@@ -2103,7 +2115,7 @@ KVstore::getobjIDlistBysubID(int _subid, int*& _objidlist, int& _list_len, bool
 		_objidlist = new int[_list_len];
 		memcpy((char*)_objidlist, _tmp, sizeof(int)*_list_len);
 	}
-	//	delete[] _tmp;
+	delete[] _tmp;
 
 	if(_no_duplicate)
 	{
@@ -2127,6 +2139,12 @@ KVstore::setobjIDlistBysubID(int _subid, const int* _objidlist, int _list_len)
 		(this->subID2objIDlist, _subid, (char*)_objidlist, _list_len * sizeof(int));
 }
 
+bool
+KVstore::loadobjIDlistBysubID(IDListReader& _reader)
+{
+	return this->bulkLoad(this->subID2objIDlist, _reader);
+}
+
 //for objID2subIDlist
 //_mode is either KVstore::CREATE_MODE or KVstore::READ_WRITE_MODE
 bool
@@ -2167,7 +2185,7 @@ KVstore::getsubIDlistByobjID(int _objid, int*& _subidlist, int& _list_len, bool
 		_subidlist = new int[_list_len];
 		memcpy((char*)_subidlist, _tmp, sizeof(int)*_list_len);
 	}
-	//delete[] _tmp;
+	delete[] _tmp;
 
 	if(_no_duplicate)
 	{
@@ -2191,6 +2209,12 @@ KVstore::setsubIDlistByobjID(int _objid, const int* _subidlist, int _list_len)
 		(this->objID2subIDlist, _objid, (char*)_subidlist, _list_len * sizeof(int));
 }
 
+bool
+KVstore::loadsubIDlistByobjID(IDListReader& _reader)
+{
+	return this->bulkLoad(this->objID2subIDlist, _reader);
+}
+
 //for subID&preID2objIDlist
 //_mode is either KVstore::CREATE_MODE or KVstore::READ_WRITE_MODE
 bool
@@ -2235,7 +2259,7 @@ KVstore::getobjIDlistBysubIDpreID(int _subid, int _preid, int*& _objidlist, int&
 		_objidlist = new int[_list_len];
 		memcpy((char*)_objidlist, _tmp, sizeof(int)*_list_len);
 	}
-	//delete[] _tmp;
+	delete[] _tmp;
 
 	if(_no_duplicate)
 	{
@@ -2331,7 +2355,7 @@ KVstore::getsubIDlistByobjIDpreID(int _objid, int _preid, int*& _subidlist, int&
 		_subidlist = new int[_list_len];
 		memcpy((char*)_subidlist, _tmp, sizeof(int)*_list_len);
 	}
-	//delete[] _tmp;
+	delete[] _tmp;
 
 	if(_no_duplicate)
 	{
@@ -2418,7 +2442,7 @@ KVstore::getpreIDobjIDlistBysubID(int _subid, int*& _preid_objidlist, int& _list
 		_preid_objidlist = new int[_list_len];
 		memcpy((char*)_preid_objidlist, _tmp, sizeof(int)*_list_len);
 	}
-	//delete[] _tmp;
+	delete[] _tmp;
 
 	//NOTICE:Util::removeDuplicate is not ok to deal with 2-ele list
 	//But 2-ele list guarantees taht no duplicates exist:)
@@ -2441,6 +2465,12 @@ KVstore::setpreIDobjIDlistBysubID(int _subid, const int* _preid_objidlist, int _
 		(this->subID2preIDobjIDlist, _subid, (char*)_preid_objidlist, _list_len * sizeof(int));
 }
 
+bool
+KVstore::loadpreIDobjIDlistBysubID(IDListReader& _reader)
+{
+	return this->bulkLoad(this->subID2preIDobjIDlist, _reader);
+}
+
 //for objID 2 preID&subIDlist 
 bool
 KVstore::open_objID2preIDsubIDlist(int _mode)
@@ -2480,7 +2510,7 @@ KVstore::getpreIDsubIDlistByobjID(int _objid, int*& _preid_subidlist, int& _list
 		_preid_subidlist = new int[_list_len];
 		memcpy((char*)_preid_subidlist, _tmp, sizeof(int)*_list_len);
 	}
-	//delete[] _tmp;
+	delete[] _tmp;
 
 	//NOTICE:Util::removeDuplicate is not ok to deal with 2-ele list
 	//But 2-ele list guarantees taht no duplicates exist:)
@@ -2502,6 +2532,12 @@ KVstore::setpreIDsubIDlistByobjID(int _objid, const int* _preid_subidlist, int _
 		(this->objID2preIDsubIDlist, _objid, (char*)_preid_subidlist, _list_len * sizeof(int));
 }
 
+bool
+KVstore::loadpreIDsubIDlistByobjID(IDListReader& _reader)
+{
+	return this->bulkLoad(this->objID2preIDsubIDlist, _reader);
+}
+
 //for subID 2 preIDlist
 bool
 KVstore::open_subID2preIDlist(int _mode)
@@ -2541,7 +2577,7 @@ KVstore::getpreIDlistBysubID(int _subid, int*& _preidlist, int& _list_len, bool
 		_preidlist = new int[_list_len];
 		memcpy((char*)_preidlist, _tmp, sizeof(int)*_list_len);
 	}
-	//delete[] _tmp;
+	delete[] _tmp;
 
 	if(_no_duplicate)
 	{
@@ -2565,6 +2601,12 @@ KVstore::setpreIDlistBysubID(int _subid, const int* _preidlist, int _list_len)
 		(this->subID2preIDlist, _subid, (char*)_preidlist, _list_len * sizeof(int));
 }
 
+bool
+KVstore::loadpreIDlistBysubID(IDListReader& _reader)
+{
+	return this->bulkLoad(this->subID2preIDlist, _reader);
+}
+
 //for preID 2 subIDlist
 bool
 KVstore::open_preID2subIDlist(int _mode)
@@ -2604,7 +2646,7 @@ KVstore::getsubIDlistBypreID(int _preid, int*& _subidlist, int& _list_len, bool
 		_subidlist = new int[_list_len];
 		memcpy((char*)_subidlist, _tmp, sizeof(int)*_list_len);
 	}
-	//delete[] _tmp;
+	delete[] _tmp;
 
 	if(_no_duplicate)
 	{
@@ -2628,6 +2670,12 @@ KVstore::setsubIDlistBypreID(int _preid, const int* _subidlist, int _list_len)
 		(this->preID2subIDlist, _preid, (char*)_subidlist, _list_len * sizeof(int));
 }
 
+bool
+KVstore::loadsubIDlistBypreID(IDListReader& _reader)
+{
+	return this->bulkLoad(this->preID2subIDlist, _reader);
+}
+
 //for objID 2 preIDlist
 bool
 KVstore::open_objID2preIDlist(int _mode)
@@ -2667,7 +2715,7 @@ KVstore::getpreIDlistByobjID(int _objid, int*& _preidlist, int& _list_len, bool
 		_preidlist = new int[_list_len];
 		memcpy((char*)_preidlist, _tmp, sizeof(int)*_list_len);
 	}
-	//delete[] _tmp;
+	delete[] _tmp;
 
 	if(_no_duplicate)
 	{
@@ -2691,6 +2739,12 @@ KVstore::setpreIDlistByobjID(int _objid, const int* _preidlist, int _list_len)
 		(this->objID2preIDlist, _objid, (char*)_preidlist, _list_len * sizeof(int));
 }
 
+bool
+KVstore::loadpreIDlistByobjID(IDListReader& _reader)
+{
+	return this->bulkLoad(this->objID2preIDlist, _reader);
+}
+
 //for preID 2 objIDlist
 bool
 KVstore::open_preID2objIDlist(int _mode)
@@ -2730,7 +2784,7 @@ KVstore::getobjIDlistBypreID(int _preid, int*& _objidlist, int& _list_len, bool
 		_objidlist = new int[_list_len];
 		memcpy((char*)_objidlist, _tmp, sizeof(int)*_list_len);
 	}
-	//delete[] _tmp;
+	delete[] _tmp;
 
 	if(_no_duplicate)
 	{
@@ -2754,6 +2808,12 @@ KVstore::setobjIDlistBypreID(int _preid, const int* _objidlist, int _list_len)
 		(this->preID2objIDlist, _preid, (char*)_objidlist, _list_len * sizeof(int));
 }
 
+bool
+KVstore::loadobjIDlistBypreID(IDListReader& _reader)
+{
+	return this->bulkLoad(this->preID2objIDlist, _reader);
+}
+
 //for subID&objID2preIDlist  _mode is either KVstore::CREATE_MODE or KVstore::READ_WRITE_MODE
 bool
 KVstore::open_subIDobjID2preIDlist(int _mode)
@@ -2785,7 +2845,7 @@ KVstore::getpreIDlistBysubIDobjID(int _subid, int _objid, int*& _preidlist, int&
 		_preidlist = new int[_list_len];
 		memcpy((char*)_preidlist, _tmp, sizeof(int)*_list_len);
 	}
-	//delete[] _tmp;
+	delete[] _tmp;
 #else
 	//WARN+TODO:this maybe not correct
 	//s p o2 and s2 p o
@@ -2874,7 +2934,7 @@ KVstore::getsubIDobjIDlistBypreID(int _preid, int*& _subid_objidlist, int& _list
 		_subid_objidlist = new int[_list_len];
 		memcpy((char*)_subid_objidlist, _tmp, sizeof(int)*_list_len);
 	}
-	//delete[] _tmp;
+	delete[] _tmp;
 
 	//NOTICE:Util::removeDuplicate is not ok to deal with 2-ele list
 	//But 2-ele list guarantees taht no duplicates exist:)
@@ -2897,6 +2957,12 @@ KVstore::setsubIDobjIDlistBypreID(int _preid, const int* _subid_objidlist, int _
 		(this->preID2subIDobjIDlist, _preid, (char*)_subid_objidlist, _list_len * sizeof(int));
 }
 
+bool
+KVstore::loadsubIDobjIDlistBypreID(IDListReader& _reader)
+{
+	return this->bulkLoad(this->preID2subIDobjIDlist, _reader);
+}
+
 //====================================================================================================================================
 //Below are for s/p/o2tripleNum, wasteful to implement unique trees
 //However, if using original tree to get num, sometimes maybe very costly?
@@ -2909,27 +2975,26 @@ KVstore::open_preID2num(int _mode)
 	return this->open(this->preID2num, KVstore::s_pID2num, _mode);
 }
 
+//NOTICE:the triple num of a predicate is kept in preID2stats instead of the preID2num tree
 int
 KVstore::getNumBypreID(int _preid)
 {
-	//TODO
-	int tmp = 0;
-	//bool _get = this->getValueByKey(this->preID2num, _preid, &tmp);
-	//if(!_get)
-	//{
-	//return 0;
-	//}
-
-	//return _tmp[0];
-	return tmp;
+	if (_preid < 0 || _preid >= (int)this->preID2stats.size())
+	{
+		return 0;
+	}
+	return this->preID2stats[_preid].triple_num;
 }
 
 bool
 KVstore::setNumBypreID(int _preid, int _tripleNum)
 {
-	//TODO
-	//return this->setValueByKey(this->preID2num, (char*)&_preid, sizeof(int), (char*)&_tripleNum, sizeof(int));
-	return false;
+	if (_preid < 0)
+	{
+		return false;
+	}
+	this->getPredicateStats(_preid).triple_num = _tripleNum;
+	return true;
 }
 
 //subIDpreID2num
@@ -3016,6 +3081,131 @@ KVstore::setNumByobjIDpreID(int _objid, int _preid, int _tripleNum)
 	return true;
 }
 
+//preID2stats
+KVstore::PredicateStats&
+KVstore::getPredicateStats(int _preid)
+{
+	if (_preid >= (int)this->preID2stats.size())
+	{
+		PredicateStats empty_stats = { 0, 0, 0 };
+		this->preID2stats.resize(_preid + 1, empty_stats);
+	}
+	this->pre_stats_changed = true;
+	return this->preID2stats[_preid];
+}
+
+int
+KVstore::getSubNumBypreID(int _preid)
+{
+	if (_preid < 0 || _preid >= (int)this->preID2stats.size())
+	{
+		return 0;
+	}
+	return this->preID2stats[_preid].sub_num;
+}
+
+bool
+KVstore::setSubNumBypreID(int _preid, int _subNum)
+{
+	if (_preid < 0)
+	{
+		return false;
+	}
+	this->getPredicateStats(_preid).sub_num = _subNum;
+	return true;
+}
+
+int
+KVstore::getObjNumBypreID(int _preid)
+{
+	if (_preid < 0 || _preid >= (int)this->preID2stats.size())
+	{
+		return 0;
+	}
+	return this->preID2stats[_preid].obj_num;
+}
+
+bool
+KVstore::setObjNumBypreID(int _preid, int _objNum)
+{
+	if (_preid < 0)
+	{
+		return false;
+	}
+	this->getPredicateStats(_preid).obj_num = _objNum;
+	return true;
+}
+
+int
+KVstore::countDistinct(const int* _list, int _list_len)
+{
+	int num = 0;
+	for (int i = 0; i < _list_len; ++i)
+	{
+		if (i == 0 || _list[i] != _list[i - 1])
+		{
+			num++;
+		}
+	}
+	return num;
+}
+
+//the file is the predicate num and then the triple num, subject num and object num of each predicate,
+//a database built by older versions has no such file, and all the stats are 0
+bool
+KVstore::loadPredicateStats()
+{
+	this->preID2stats.clear();
+	this->pre_stats_changed = false;
+	FILE* fp = fopen((this->store_path + "/" + KVstore::s_pID2stats).c_str(), "rb");
+	if (fp == NULL)
+	{
+		return false;
+	}
+	int pre_num = 0;
+	bool flag = fread(&pre_num, sizeof(int), 1, fp) == 1 && pre_num >= 0;
+	if (flag)
+	{
+		this->preID2stats.resize(pre_num);
+		for (int i = 0; i < pre_num && flag; ++i)
+		{
+			PredicateStats& stats = this->preID2stats[i];
+			flag = fread(&stats.triple_num, sizeof(int), 1, fp) == 1 && fread(&stats.sub_num, sizeof(int), 1, fp) == 1
+				&& fread(&stats.obj_num, sizeof(int), 1, fp) == 1;
+		}
+	}
+	fclose(fp);
+	if (!flag)
+	{
+		cerr << "error, the predicate stats are broken. @KVstore::loadPredicateStats" << endl;
+		this->preID2stats.clear();
+	}
+	return flag;
+}
+
+bool
+KVstore::savePredicateStats()
+{
+	FILE* fp = fopen((this->store_path + "/" + KVstore::s_pID2stats).c_str(), "wb");
+	if (fp == NULL)
+	{
+		cerr << "error, can not create the predicate stats file. @KVstore::savePredicateStats" << endl;
+		return false;
+	}
+	int pre_num = this->preID2stats.size();
+	fwrite(&pre_num, sizeof(int), 1, fp);
+	for (int i = 0; i < pre_num; ++i)
+	{
+		const PredicateStats& stats = this->preID2stats[i];
+		fwrite(&stats.triple_num, sizeof(int), 1, fp);
+		fwrite(&stats.sub_num, sizeof(int), 1, fp);
+		fwrite(&stats.obj_num, sizeof(int), 1, fp);
+	}
+	fclose(fp);
+	this->pre_stats_changed = false;
+	return true;
+}
+
 //==========================================================================================================================
 
 
@@ -3054,6 +3244,8 @@ KVstore::KVstore(string _store_path) {
 	this->preID2num = NULL;
 	this->subIDpreID2num = NULL;
 	this->objIDpreID2num = NULL;
+
+	this->pre_stats_changed = false;
 }
 
 //release all the memory used in this KVstore
@@ -3150,6 +3342,11 @@ KVstore::flush()
 	//this->flush(this->preID2num);
 	//this->flush(this->subIDpreID2num);
 	//this->flush(this->objIDpreID2num);
+
+	if (this->pre_stats_changed)
+	{
+		this->savePredicateStats();
+	}
 }
 
 //================================================================================================================
@@ -3250,6 +3447,8 @@ KVstore::open()
 	//this->open(this->preID2num, KVstore::s_pID2num, KVstore::READ_WRITE_MODE);
 	//this->open(this->subIDpreID2num, KVstore::s_sIDpID2num, KVstore::READ_WRITE_MODE);
 	//this->open(this->objIDpreID2num, KVstore::s_oIDpID2num, KVstore::READ_WRITE_MODE);
+
+	this->loadPredicateStats();
 }
 
 //Open a btree according the mode
@@ -3378,6 +3577,37 @@ KVstore::setValueByKey(ISTree* _p_btree, int _key, const char* _val, int _vlen)
 
 //==========================================================================================================
 
+//the id lists of a reader, as the sorted pairs of an ISTree
+class IDListIterator : public ISIterator
+{
+public:
+	IDListIterator(IDListReader& _reader) : reader(_reader) {}
+	bool next(int& _key, const char*& _str, unsigned& _len)
+	{
+		const int* list;
+		int list_len;
+		if (!this->reader.read(&_key, list, list_len))
+		{
+			return false;
+		}
+		_str = (const char*)list;
+		_len = list_len * sizeof(int);
+		return true;
+	}
+
+private:
+	IDListReader& reader;
+};
+
+bool
+KVstore::bulkLoad(ISTree* _p_btree, IDListReader& _reader)
+{
+	IDListIterator iter(_reader);
+	return _p_btree->bulkLoad(iter);
+}
+
+//==========================================================================================================
+
 bool
 KVstore::getValueByKey(Tree* _p_btree, const char* _key, int _klen, char*& _val, int& _vlen)
 {
@@ -3468,3 +3698,5 @@ string KVstore::s_pID2sIDoIDlist = "s_pID2sIDoIDlist";
 string KVstore::s_pID2num = "s_pID2num";
 string KVstore::s_sIDpID2num = "s_sIDpID2num";
 string KVstore::s_oIDpID2num = "s_oIDpID2num";
+
+string KVstore::s_pID2stats = "s_pID2stats";
@@ -10,6 +10,7 @@
 #define _KVSTORE_KVSTORE_H
 
 #include "../Util/Util.h"
+#include "../Util/IDTripleFile.h"
 #include "Tree.h"
 
 //TODO:add debug instruction, control if using the so2p index, which is really costly
@@ -136,6 +137,7 @@ public:
 	bool getobjIDlistBysubID(int _subid, int*& _objidlist, int& _list_len, bool _no_duplicate = false);
 	bool addobjIDlistBysubID(int _subid, const int* _objidlist, int _list_len);
 	bool setobjIDlistBysubID(int _subid, const int* _objidlist, int _list_len);
+	bool loadobjIDlistBysubID(IDListReader& _reader);
 
 	 //for objID 2 subIDlist 
 	bool open_objID2subIDlist(int _mode);
@@ -143,6 +145,7 @@ public:
 	bool getsubIDlistByobjID(int _objid, int*& _subidlist, int& _list_len, bool _no_duplicate = false);
 	bool addsubIDlistByobjID(int _objid, const int* _subidlist, int _list_len);
 	bool setsubIDlistByobjID(int _objid, const int* _subidlist, int _list_len);
+	bool loadsubIDlistByobjID(IDListReader& _reader);
 
 	 //for subID&preID 2 objIDlist 
 	bool open_subIDpreID2objIDlist(int _mode);
@@ -164,6 +167,7 @@ public:
 	bool getpreIDobjIDlistBysubID(int _subid, int*& _preid_objidlist, int& _list_len, bool _no_duplicate = false);
 	bool addpreIDobjIDlistBysubID(int _subid, const int* _preid_objidlist, int _list_len);
 	bool setpreIDobjIDlistBysubID(int _subid, const int* _preid_objidlist, int _list_len);
+	bool loadpreIDobjIDlistBysubID(IDListReader& _reader);
 
 	 //for objID 2 preID&subIDlist 
 	bool open_objID2preIDsubIDlist(int _mode);
@@ -171,6 +175,7 @@ public:
 	bool getpreIDsubIDlistByobjID(int _objid, int*& _preid_subidlist, int& _list_len, bool _no_duplicate = false);
 	bool addpreIDsubIDlistByobjID(int _objid, const int* _preid_subidlist, int _list_len);
 	bool setpreIDsubIDlistByobjID(int _objid, const int* _preid_subidlist, int _list_len);
+	bool loadpreIDsubIDlistByobjID(IDListReader& _reader);
 
 	//for subID 2 preIDlist
 	bool open_subID2preIDlist(int _mode);
@@ -178,6 +183,7 @@ public:
 	bool getpreIDlistBysubID(int _subid, int*& _preidlist, int& _list_len, bool _no_duplicate = false);
 	bool addpreIDlistBysubID(int _subid, const int* _preidlist, int _list_len);
 	bool setpreIDlistBysubID(int _subid, const int* _preidlist, int _list_len);
+	bool loadpreIDlistBysubID(IDListReader& _reader);
 
 	//for preID 2 subIDlist
 	bool open_preID2subIDlist(int _mode);
@@ -185,6 +191,7 @@ public:
 	bool getsubIDlistBypreID(int _preid, int*& _subidlist, int& _list_len, bool _no_duplicate = false);
 	bool addsubIDlistBypreID(int _preid, const int* _subidlist, int _list_len);
 	bool setsubIDlistBypreID(int _preid, const int* _subidlist, int _list_len);
+	bool loadsubIDlistBypreID(IDListReader& _reader);
 
 	//for objID 2 preIDlist
 	bool open_objID2preIDlist(int _mode);
@@ -192,6 +199,7 @@ public:
 	bool getpreIDlistByobjID(int _objid, int*& _preidlist, int& _list_len, bool _no_duplicate = false);
 	bool addpreIDlistByobjID(int _objid, const int* _preidlist, int _list_len);
 	bool setpreIDlistByobjID(int _objid, const int* _preidlist, int _list_len);
+	bool loadpreIDlistByobjID(IDListReader& _reader);
 
 	//for preID 2 objIDlist
 	bool open_preID2objIDlist(int _mode);
@@ -199,6 +207,7 @@ public:
 	bool getobjIDlistBypreID(int _preid, int*& _objidlist, int& _list_len, bool _no_duplicate = false);
 	bool addobjIDlistBypreID(int _preid, const int* _objidlist, int _list_len);
 	bool setobjIDlistBypreID(int _preid, const int* _objidlist, int _list_len);
+	bool loadobjIDlistBypreID(IDListReader& _reader);
 
 	//for subID&objID 2 preIDlist
 	bool open_subIDobjID2preIDlist(int _mode);
@@ -213,6 +222,7 @@ public:
 	bool getsubIDobjIDlistBypreID(int _preid, int*& _subid_objidlist, int& _list_len, bool _no_duplicate = false);
 	bool addsubIDobjIDlistBypreID(int _preid, const int* _subid_objidlist, int _list_len);
 	bool setsubIDobjIDlistBypreID(int _preid, const int* _subid_objidlist, int _list_len);
+	bool loadsubIDobjIDlistBypreID(IDListReader& _reader);
 
 	//QUERY:is the below 3 indexes needed?
 	//In fact, p2so can compute the num of triples if dividing so_len by 2
@@ -236,6 +246,16 @@ public:
 	int getNumByobjIDpreID(int _objid, int _preid);
 	bool setNumByobjIDpreID(int _objid, int _preid, int _tripleNum);
 
+	//the statistics of each predicate for the join order: its triple num(getNumBypreID above)
+	//and the num of distinct subjects and objects, 0 for a predicate not found.
+	//They are set while the p2* lists are built or updated, and kept in s_pID2stats
+	int getSubNumBypreID(int _preid);
+	bool setSubNumBypreID(int _preid, int _subNum);
+	int getObjNumBypreID(int _preid);
+	bool setObjNumBypreID(int _preid, int _objNum);
+	bool loadPredicateStats();
+	bool savePredicateStats();
+
 	KVstore(std::string _store_path = ".");
 	~KVstore();
 	void flush();
@@ -300,6 +320,21 @@ private:
 	static std::string s_sIDpID2num;
 	static std::string s_oIDpID2num;
 
+	struct PredicateStats
+	{
+		int triple_num;
+		int sub_num;
+		int obj_num;
+	};
+	//indexed by preID, saved by flush() if changed
+	std::vector<PredicateStats> preID2stats;
+	bool pre_stats_changed;
+	static std::string s_pID2stats;
+	//the stats of _preid, added if not found
+	PredicateStats& getPredicateStats(int _preid);
+	//the num of distinct IDs in a list in ascending order
+	static int countDistinct(const int* _list, int _list_len);
+
 	void flush(Tree* _p_btree);
 	void flush(SITree* _p_btree);
 	void flush(ISTree* _p_btree);
@@ -312,6 +347,9 @@ private:
 	bool setValueByKey(SITree* _p_btree, const char* _key, int _klen, int _val);
 	bool setValueByKey(ISTree* _p_btree, int _key, const char* _val, int _vlen);
 
+	//the lists must come in ascending order of their keys, into an empty tree
+	bool bulkLoad(ISTree* _p_btree, IDListReader& _reader);
+
 	bool getValueByKey(Tree* _p_btree, const char* _key, int _klen, char*& _val, int& _vlen);
 	bool getValueByKey(SITree* _p_btree, const char* _key, int _klen, int* _val);
 	bool getValueByKey(ISTree* _p_btree, int _key, char*& _val, int& _vlen);
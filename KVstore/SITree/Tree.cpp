@@ -22,6 +22,7 @@ SITree::SITree()
 	filename = "";
 	transfer_size[0] = transfer_size[1] = transfer_size[2] = 0;
 	this->request = 0;
+	pthread_mutex_init(&this->search_mutex, NULL);
 }
 
 SITree::SITree(string _storepath, string _filename, string _mode)
@@ -41,6 +42,7 @@ SITree::SITree(string _storepath, string _filename, string _mode)
 	this->transfer[2].setStr((char*)malloc(Util::TRANSFER_SIZE));
 	this->transfer_size[0] = this->transfer_size[1] = this->transfer_size[2] = Util::TRANSFER_SIZE;		//initialied to 1M
 	this->request = 0;
+	pthread_mutex_init(&this->search_mutex, NULL);
 }
 
 string
@@ -110,6 +112,7 @@ SITree::search(const char* _str, unsigned _len, int* _val)
 		*_val = -1;
 		return false;
 	}
+	pthread_mutex_lock(&this->search_mutex);
 	this->CopyToTransfer(_str, _len, 1);
 
 	request = 0;
@@ -119,11 +122,13 @@ SITree::search(const char* _str, unsigned _len, int* _val)
 	if (ret == NULL || store == -1 || bstr != *(ret->getKey(store)))	//tree is empty or not found
 	{
 		bstr.clear();
+		pthread_mutex_unlock(&this->search_mutex);
 		return false;
 	}
 	*_val = ret->getValue(store);
 	this->TSM->request(request);
 	bstr.clear();
+	pthread_mutex_unlock(&this->search_mutex);
 	return true;
 }
 
@@ -390,6 +395,142 @@ SITree::remove(const char* _str, unsigned _len)
 	return flag;		//i == j, not found		
 }
 
+//the tree is built bottom-up: leaves are packed in key order, and each level is written
+//out as soon as it is complete, so the blocks of the tree are allocated in file order
+bool
+SITree::bulkLoad(SIIterator& _iter, unsigned _fill)
+{
+	if (this->root != NULL)
+	{
+		printf("error in SITree-bulkLoad: tree is not empty\n");
+		return false;
+	}
+	unsigned key_max = SINode::MAX_KEY_NUM * _fill / 100;
+	if (key_max < SINode::MIN_CHILD_NUM)
+		key_max = SINode::MIN_CHILD_NUM;
+	else if (key_max > SINode::MAX_KEY_NUM)
+		key_max = SINode::MAX_KEY_NUM;
+	unsigned child_max = SINode::MAX_CHILD_NUM * _fill / 100;
+	if (child_max < SINode::MIN_CHILD_NUM)
+		child_max = SINode::MIN_CHILD_NUM;
+	else if (child_max > SINode::MAX_CHILD_NUM)
+		child_max = SINode::MAX_CHILD_NUM;
+
+	//nodes of the current level and the least key below each of them
+	vector<SINode*> level;
+	vector<string> mins;
+	//the last full leaf is kept in memory, to share keys with a short last leaf
+	SINode* leaf = NULL;
+	SINode* prev = NULL;
+	bool sorted = true;
+	const char* str;
+	unsigned len;
+	int val;
+	while (_iter.next(str, len, val))
+	{
+		const Bstr* last = (leaf == NULL ? NULL : leaf->getKey(leaf->getNum() - 1));
+		if (str == NULL || len == 0 || (last != NULL && Util::compare(str, len, last->getStr(), last->getLen()) <= 0))
+		{
+			printf("error in SITree-bulkLoad: keys are not ascending\n");
+			sorted = false;
+			break;
+		}
+		if (leaf != NULL && leaf->getNum() == key_max)
+		{
+			if (prev != NULL)
+				this->bulkWrite(prev);
+			prev = leaf;
+			leaf = NULL;
+		}
+		if (leaf == NULL)
+		{
+			leaf = new SILeafNode;
+			leaf->setHeight(1);
+			if (prev != NULL)
+			{
+				prev->setNext(leaf);
+				leaf->setPrev(prev);
+			}
+			else
+				this->leaves_head = leaf;
+			level.push_back(leaf);
+			mins.push_back(string(str, len));
+		}
+		this->CopyToTransfer(str, len, 1);
+		int i = leaf->getNum();
+		leaf->addKey(&transfer[1], i, true);
+		leaf->addValue(val, i);
+		leaf->addNum();
+	}
+	if (leaf == NULL)
+		return sorted;
+	if (prev != NULL && leaf->getNum() < SINode::MIN_CHILD_NUM)
+	{
+		//move the tail of the full leaf, so that both are at least half full
+		int move = (prev->getNum() - leaf->getNum()) / 2;
+		for (; move > 0; --move)
+		{
+			int i = prev->getNum() - 1;
+			leaf->addKey(prev->getKey(i), 0);
+			leaf->addValue(prev->getValue(i), 0);
+			leaf->addNum();
+			prev->subNum();
+		}
+		mins.back() = string(leaf->getKey(0)->getStr(), leaf->getKey(0)->getLen());
+	}
+	if (prev != NULL)
+		this->bulkWrite(prev);
+	this->bulkWrite(leaf);
+	this->leaves_tail = leaf;
+	this->height = 1;
+
+	//spread the nodes of a level evenly over as few parents as possible
+	while (level.size() > 1)
+	{
+		vector<SINode*> parents;
+		vector<string> parent_mins;
+		unsigned num = level.size();
+		unsigned parent_num = (num + child_max - 1) / child_max;
+		unsigned i = 0;
+		for (unsigned j = 0; j < parent_num; ++j)
+		{
+			unsigned child_num = num / parent_num + (j < num % parent_num ? 1 : 0);
+			SINode* p = new SIIntlNode;
+			p->setHeight(this->height + 1);
+			p->addChild(level[i], 0);
+			for (unsigned k = 1; k < child_num; ++k)
+			{
+				this->CopyToTransfer(mins[i + k].data(), mins[i + k].length(), 1);
+				p->addKey(&transfer[1], k - 1, true);
+				p->addChild(level[i + k], k);
+				p->addNum();
+			}
+			this->bulkWrite(p);
+			parents.push_back(p);
+			parent_mins.push_back(mins[i]);
+			i += child_num;
+		}
+		level.swap(parents);
+		mins.swap(parent_mins);
+		this->height++;
+	}
+
+	//the root is kept in memory, just as preRead() leaves it
+	this->root = level[0];
+	long long memory = 0;
+	this->TSM->readNode(this->root, &memory);
+	this->TSM->request(memory);
+	return sorted;
+}
+
+void
+SITree::bulkWrite(SINode* _np)
+{
+	_np->setDirty();
+	this->TSM->writeNode(_np);
+	_np->Virtual();
+}
+
 bool
 SITree::save()	//save the whole tree to disk
 {
@@ -419,6 +560,7 @@ SITree::release(SINode* _np) const
 
 SITree::~SITree()
 {
+	pthread_mutex_destroy(&this->search_mutex);
 	delete TSM;
 #ifdef DEBUG_KVSTORE
 	printf("already empty the buffer, now to delete all nodes in tree!\n");
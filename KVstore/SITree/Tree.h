@@ -15,9 +15,19 @@
 #include "node/IntlNode.h"
 #include "node/LeafNode.h"
 #include "storage/Storage.h"
+#include <pthread.h>
 
 //NOTICE:not use Stream for this tree, and no need for range query 
 
+//pairs given to SITree::bulkLoad(), keys must be strictly ascending
+class SIIterator
+{
+public:
+	//return false at the end, the strings are valid until the next call
+	virtual bool next(const char*& _str, unsigned& _len, int& _val) = 0;
+	virtual ~SIIterator() {};
+};
+
 class SITree
 {					
 private:
@@ -32,18 +42,19 @@ private:
 	//to get a real string, instead of new and copy
 	//other operations will be harmful to search, so store value in
 	//transfer temporally, while length adjusted.
-	//TODO: in multi-user case, multiple-search will cause problem,
-	//so lock is a must. Add lock to transfer is better than to add 
-	//lock to every key/value. However, modify requires a lock for a
-	//key/value, and multiple search for different keys are ok!!!
+	//NOTICE: a search also reads nodes into the storage and swaps others
+	//out, so the searches of several threads are serialized by search_mutex.
+	//A tree is only modified while no search runs on it.
 	Bstr transfer[3];	//0:transfer value searched; 1:copy key-data from const char*; 2:copy val-data from const char*
 	unsigned transfer_size[3];
+	pthread_mutex_t search_mutex;
 	std::string storepath;
 	std::string filename;      	//ok for user to change
 	/* some private functions */
 	std::string getFilePath();	//in UNIX system
 	void CopyToTransfer(const char* _str, unsigned _len, unsigned _index);
 	void release(SINode* _np) const;
+	void bulkWrite(SINode* _np);
 
 	//tree's operations should be atom(if read nodes)
 	//sum the request and send to Storage at last
@@ -63,6 +74,8 @@ public:
 	bool modify(const char* _str, unsigned _len, int _val);
 	SINode* find(const Bstr* _key, int* store, bool ifmodify);
 	bool remove(const char* _str, unsigned _len);
+	//build an empty tree from sorted pairs, with each node filled to _fill percent
+	bool bulkLoad(SIIterator& _iter, unsigned _fill = Util::BULK_FILL_PERCENT);
 	bool save(); 			
 	~SITree();
 	void print(std::string s);			//DEBUG(print the tree)
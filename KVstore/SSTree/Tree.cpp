@@ -23,6 +23,7 @@ Tree::Tree()
 	transfer_size[0] = transfer_size[1] = transfer_size[2] = 0;
 	this->stream = NULL;
 	this->request = 0;
+	pthread_mutex_init(&this->search_mutex, NULL);
 }
 
 Tree::Tree(string _storepath, string _filename, string _mode)
@@ -43,6 +44,7 @@ Tree::Tree(string _storepath, string _filename, string _mode)
 	this->transfer_size[0] = this->transfer_size[1] = this->transfer_size[2] = Util::TRANSFER_SIZE;		//initialied to 1M
 	this->stream = NULL;
 	this->request = 0;
+	pthread_mutex_init(&this->search_mutex, NULL);
 }
 
 string
@@ -112,13 +114,17 @@ Tree::search(const char* _str1, unsigned _len1, char*& _str2, int& _len2)
 		printf("error in Tree-search: empty string\n");
 		return false;
 	}
+	pthread_mutex_lock(&this->search_mutex);
 	this->CopyToTransfer(_str1, _len1, 1);
 	bool ret = this->search(&transfer[1], value);
 	if (ret)
 	{
-		_str2 = value->getStr();
 		_len2 = value->getLen();
+		_str2 = new char[_len2 + 1];
+		memcpy(_str2, value->getStr(), _len2);
+		_str2[_len2] = '\0';
 	}
+	pthread_mutex_unlock(&this->search_mutex);
 	return ret;
 }
 
@@ -583,6 +589,144 @@ Tree::range_query(const Bstr* _key1, const Bstr* _key2)
 	return true;
 }
 
+//the tree is built bottom-up: leaves are packed in key order, and each level is written
+//out as soon as it is complete, so the blocks of the tree are allocated in file order
+bool
+Tree::bulkLoad(KVIterator& _iter, unsigned _fill)
+{
+	if (this->root != NULL)
+	{
+		printf("error in Tree-bulkLoad: tree is not empty\n");
+		return false;
+	}
+	unsigned key_max = Node::MAX_KEY_NUM * _fill / 100;
+	if (key_max < Node::MIN_CHILD_NUM)
+		key_max = Node::MIN_CHILD_NUM;
+	else if (key_max > Node::MAX_KEY_NUM)
+		key_max = Node::MAX_KEY_NUM;
+	unsigned child_max = Node::MAX_CHILD_NUM * _fill / 100;
+	if (child_max < Node::MIN_CHILD_NUM)
+		child_max = Node::MIN_CHILD_NUM;
+	else if (child_max > Node::MAX_CHILD_NUM)
+		child_max = Node::MAX_CHILD_NUM;
+
+	//nodes of the current level and the least key below each of them
+	vector<Node*> level;
+	vector<string> mins;
+	//the last full leaf is kept in memory, to share keys with a short last leaf
+	Node* leaf = NULL;
+	Node* prev = NULL;
+	bool sorted = true;
+	const char* str;
+	unsigned len;
+	const char* val;
+	unsigned val_len;
+	while (_iter.next(str, len, val, val_len))
+	{
+		const Bstr* last = (leaf == NULL ? NULL : leaf->getKey(leaf->getNum() - 1));
+		if (str == NULL || len == 0 || (last != NULL && Util::compare(str, len, last->getStr(), last->getLen()) <= 0))
+		{
+			printf("error in Tree-bulkLoad: keys are not ascending\n");
+			sorted = false;
+			break;
+		}
+		if (leaf != NULL && leaf->getNum() == key_max)
+		{
+			if (prev != NULL)
+				this->bulkWrite(prev);
+			prev = leaf;
+			leaf = NULL;
+		}
+		if (leaf == NULL)
+		{
+			leaf = new LeafNode;
+			leaf->setHeight(1);
+			if (prev != NULL)
+			{
+				prev->setNext(leaf);
+				leaf->setPrev(prev);
+			}
+			else
+				this->leaves_head = leaf;
+			level.push_back(leaf);
+			mins.push_back(string(str, len));
+		}
+		this->CopyToTransfer(str, len, 1);
+		int i = leaf->getNum();
+		leaf->addKey(&transfer[1], i, true);
+		this->CopyToTransfer(val, val_len, 2);
+		leaf->addValue(&transfer[2], i, true);
+		leaf->addNum();
+	}
+	if (leaf == NULL)
+		return sorted;
+	if (prev != NULL && leaf->getNum() < Node::MIN_CHILD_NUM)
+	{
+		//move the tail of the full leaf, so that both are at least half full
+		int move = (prev->getNum() - leaf->getNum()) / 2;
+		for (; move > 0; --move)
+		{
+			int i = prev->getNum() - 1;
+			leaf->addKey(prev->getKey(i), 0);
+			leaf->addValue(prev->getValue(i), 0);
+			leaf->addNum();
+			prev->subNum();
+		}
+		mins.back() = string(leaf->getKey(0)->getStr(), leaf->getKey(0)->getLen());
+	}
+	if (prev != NULL)
+		this->bulkWrite(prev);
+	this->bulkWrite(leaf);
+	this->leaves_tail = leaf;
+	this->height = 1;
+
+	//spread the nodes of a level evenly over as few parents as possible
+	while (level.size() > 1)
+	{
+		vector<Node*> parents;
+		vector<string> parent_mins;
+		unsigned num = level.size();
+		unsigned parent_num = (num + child_max - 1) / child_max;
+		unsigned i = 0;
+		for (unsigned j = 0; j < parent_num; ++j)
+		{
+			unsigned child_num = num / parent_num + (j < num % parent_num ? 1 : 0);
+			Node* p = new IntlNode;
+			p->setHeight(this->height + 1);
+			p->addChild(level[i], 0);
+			for (unsigned k = 1; k < child_num; ++k)
+			{
+				this->CopyToTransfer(mins[i + k].data(), mins[i + k].length(), 1);
+				p->addKey(&transfer[1], k - 1, true);
+				p->addChild(level[i + k], k);
+				p->addNum();
+			}
+			this->bulkWrite(p);
+			parents.push_back(p);
+			parent_mins.push_back(mins[i]);
+			i += child_num;
+		}
+		level.swap(parents);
+		mins.swap(parent_mins);
+		this->height++;
+	}
+
+	//the root is kept in memory, just as preRead() leaves it
+	this->root = level[0];
+	long long memory = 0;
+	this->TSM->readNode(this->root, &memory);
+	this->TSM->request(memory);
+	return sorted;
+}
+
+void
+Tree::bulkWrite(Node* _np)
+{
+	_np->setDirty();
+	this->TSM->writeNode(_np);
+	_np->Virtual();
+}
+
 bool
 Tree::save()	//save the whole tree to disk
 {
@@ -612,6 +756,7 @@ Tree::release(Node* _np) const
 
 Tree::~Tree()
 {
+	pthread_mutex_destroy(&this->search_mutex);
 	delete this->stream;   //maybe NULL
 	delete TSM;
 #ifdef DEBUG_KVSTORE
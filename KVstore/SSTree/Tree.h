@@ -15,6 +15,16 @@
 #include "node/IntlNode.h"
 #include "node/LeafNode.h"
 #include "storage/Storage.h"
+#include <pthread.h>
+
+//pairs given to Tree::bulkLoad(), keys must be strictly ascending
+class KVIterator
+{
+public:
+	//return false at the end, the strings are valid until the next call
+	virtual bool next(const char*& _str1, unsigned& _len1, const char*& _str2, unsigned& _len2) = 0;
+	virtual ~KVIterator() {};
+};
 
 class Tree
 {					
@@ -32,12 +42,12 @@ private:
 	//to get a real string, instead of new and copy
 	//other operations will be harmful to search, so store value in
 	//transfer temporally, while length adjusted.
-	//TODO: in multi-user case, multiple-search will cause problem,
-	//so lock is a must. Add lock to transfer is better than to add 
-	//lock to every key/value. However, modify requires a lock for a
-	//key/value, and multiple search for different keys are ok!!!
+	//NOTICE: a search also reads nodes into the storage and swaps others
+	//out, so the searches of several threads are serialized by search_mutex.
+	//A tree is only modified while no search runs on it.
 	Bstr transfer[3];	//0:transfer value searched; 1:copy key-data from const char*; 2:copy val-data from const char*
 	unsigned transfer_size[3];
+	pthread_mutex_t search_mutex;
 
 	std::string storepath;
 	std::string filename;      	//ok for user to change
@@ -45,6 +55,7 @@ private:
 	std::string getFilePath();	//in UNIX system
 	void CopyToTransfer(const char* _str, unsigned _len, unsigned _index);
 	void release(Node* _np) const;
+	void bulkWrite(Node* _np);
 
 	//tree's operations should be atom(if read nodes)
 	//sum the request and send to Storage at last
@@ -60,6 +71,7 @@ public:
 	Node* getRoot() const;
 	//void setRoot(Node* _root);
 	//insert, search, remove, set
+	//the value is copied to _str2, allocated by new[] with a '\0' after it and freed by the caller
 	bool search(const char* _str1, unsigned _len1, char*& _str2, int& _len2);
 	bool search(const Bstr* _key1, const Bstr*& _value);
 	bool insert(const Bstr* _key, const Bstr* _value);
@@ -73,6 +85,8 @@ public:
 	const Bstr* getRangeValue();
 	void resetStream();
 	bool range_query(const Bstr* _key1, const Bstr* _key2);
+	//build an empty tree from sorted pairs, with each node filled to _fill percent
+	bool bulkLoad(KVIterator& _iter, unsigned _fill = Util::BULK_FILL_PERCENT);
 	bool save(); 			
 	~Tree();
 	void print(std::string s);			//DEBUG(print the tree)
@@ -198,11 +198,12 @@ Storage::AllocBlock()
 	BlockInfo* p = this->freelist->next;
 	if(p == NULL)	
 	{
-		for(unsigned i = 0; i < SET_BLOCK_INC; ++i)
+		//pushed from the last one, so that new blocks are handed out in file order
+		for(unsigned i = SET_BLOCK_INC; i > 0; --i)
 		{
-			cur_block_num++;	//BETTER: check if > MAX_BLOCK_NUM
-			this->FreeBlock(cur_block_num);
+			this->FreeBlock(cur_block_num + i);	//BETTER: check if > MAX_BLOCK_NUM
 		}
+		cur_block_num += SET_BLOCK_INC;
 		p = this->freelist->next;
 	}
 	unsigned t = p->num;
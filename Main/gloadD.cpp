@@ -4,23 +4,750 @@
 # Mail: 1181955272@qq.com
 # Last Modified: 2015-10-24 19:27
 # Description: firstly written by liyouhuan, modified by zengli
+1. ./gloadD db_folder rdf_path internal_path       the triples are parsed and dispatched by rank 0 to the sites
+2. ./gloadD db_folder rdf_path internal_path --parse-threads=N
+                                                   parse the RDF file with N threads, the file must hold one triple
+                                                   per line(N-Triples, with @prefix lines allowed)
+3. ./gloadD db_folder rdf_path internal_path --parallel-load
+                                                   every rank reads and routes its own byte range of both files,
+                                                   which must hold one triple/vertex per line and be seen by all ranks
+4. ./gloadD db_folder rdf_path internal_path --build-threads=N --build-memory=MB
+                                                   each site builds its indexes with N threads(at most 4), and the id
+                                                   tuples are sorted within MB megabytes in total, while the VS-Tree
+                                                   is built with the signatures of all entities in memory besides
+5. ./gloadD db_folder rdf_path internal_path --partition=MODE
+                                                   partition the entities of the RDF file first and write them to
+                                                   internal_path, MODE is hash, ldg, fennel or semantic, or best to try
+                                                   all of them and keep the one with the fewest crossing edges
 TODO: add -h/--help for help message
 =============================================================================*/
 
 #include "../Util/Util.h"
+#include "../Util/TripleBatch.h"
+#include "../Util/GraphPartitioner.h"
 #include "../Database/Database.h"
 #include <mpi.h>
+#include <tr1/unordered_map>
 
 using namespace std;
 
-//[0]./gload [1]data_folder_path  [2]rdf_file_path
+//URI/literal -> global ID, there are as many entries as vertices in the whole dataset
+typedef std::tr1::unordered_map<string, int> GlobalIDMap;
+
+//the bytes of triples for a site are sent once the batch has so many
+#define TRIPLE_BATCH_SIZE (16 * 1024 * 1024)
+//lines of the RDF file parsed by one thread at a time, with --parse-threads
+#define PARSE_CHUNK_LINE_NUM (256 * 1024)
+//bytes of its range read by each rank in a round, with --parallel-load
+#define LOAD_ROUND_SIZE (16 * 1024 * 1024)
+
+//the global dictionary: entities get IDs from 0, literals from Util::LITERAL_FIRST_ID
+int
+getGlobalID(GlobalIDMap& _global_map, const string& _str, int _first_id)
+{
+	GlobalIDMap::iterator it = _global_map.find(_str);
+	if(it == _global_map.end()){
+		it = _global_map.insert(make_pair(_str, _first_id + (int)_global_map.size())).first;
+	}
+	return it->second;
+}
+
+//the batches of each site are sent without blocking, the batch being filled is swapped with
+//the one in flight once the send of the latter is done, and an empty message ends the triples of the site
+class TripleBatchSender
+{
+public:
+	TripleBatchSender(int _site_num)
+		: batches(_site_num), sending(_site_num), requests(_site_num, MPI_REQUEST_NULL)
+	{
+		this->batch_num = 0;
+	}
+	void add(int _site, const TripleWithObjType& _triple, int _sub_gid, int _obj_gid)
+	{
+		this->batches[_site].add(_triple, _sub_gid, _obj_gid);
+		if(this->batches[_site].getSize() >= TRIPLE_BATCH_SIZE)
+			this->send(_site);
+	}
+	void finish()
+	{
+		MPI_Status status;
+		for(int i = 0; i < this->batches.size(); i++){
+			if(this->batches[i].getTripleNum() > 0)
+				this->send(i);
+		}
+		for(int i = 0; i < this->batches.size(); i++){
+			MPI_Wait(&this->requests[i], &status);
+			MPI_Send(NULL, 0, MPI_CHAR, i + 1, 10, MPI_COMM_WORLD);
+		}
+	}
+	int getBatchNum() const
+	{
+		return this->batch_num;
+	}
+
+private:
+	vector<TripleBatch> batches;
+	vector< vector<char> > sending;
+	vector<MPI_Request> requests;
+	int batch_num;
+
+	void send(int _site)
+	{
+		MPI_Status status;
+		MPI_Wait(&this->requests[_site], &status);
+		this->batches[_site].swapOut(this->sending[_site]);
+		MPI_Isend(&this->sending[_site][0], this->sending[_site].size(), MPI_CHAR, _site + 1, 10, MPI_COMM_WORLD, &this->requests[_site]);
+		this->batch_num++;
+	}
+};
+
+//the triples from rank 0, received batch by batch while the site builds its database
+class TripleBatchReceiver : public TripleSource
+{
+public:
+	TripleBatchReceiver()
+	{
+		this->finished = false;
+	}
+	virtual void getTriples(TripleWithObjType* _triple_array, int& _triple_num, vector<int>& _global_ids)
+	{
+		int size = this->recvBatch();
+		_triple_num = TripleBatch::unpack(&this->bytes[0], size, _triple_array, _global_ids);
+	}
+	//the batches left if the build stops early, rank 0 waits for all of them to be received
+	void drain()
+	{
+		while(!this->finished){
+			this->recvBatch();
+		}
+	}
+
+private:
+	vector<char> bytes;
+	bool finished;
+
+	int recvBatch()
+	{
+		MPI_Status status;
+		int size = 0;
+		if(this->finished)
+			return 0;
+		MPI_Probe(0, 10, MPI_COMM_WORLD, &status);
+		MPI_Get_count(&status, MPI_CHAR, &size);
+		this->bytes.resize(size + 1);
+		MPI_Recv(&this->bytes[0], size, MPI_CHAR, 0, 10, MPI_COMM_WORLD, &status);
+		this->finished = (size == 0);
+		return size;
+	}
+};
+
+//a triple goes to the partitions of its subject and object, or to all of them if neither is internal anywhere
+void
+getTripleSites(int _sub_partition_id, int _obj_partition_id, int _site_num, vector<int>& _sites)
+{
+	_sites.clear();
+	if(_sub_partition_id != -1)
+		_sites.push_back(_sub_partition_id);
+	if(_obj_partition_id != -1 && _obj_partition_id != _sub_partition_id)
+		_sites.push_back(_obj_partition_id);
+	if(_sub_partition_id == -1 && _obj_partition_id == -1){
+		for(int j = 0; j < _site_num; j++){
+			_sites.push_back(j);
+		}
+	}
+}
+
+//the vertices of a triple are looked up in the global dictionary, where the partition of each
+//internal vertex is kept too
+void
+dispatchTriples(const TripleWithObjType* _triple_array, int _triple_num, GlobalIDMap& _global_entity_map, GlobalIDMap& _global_literal_map,
+		const vector<int>& _entity_partitions, TripleBatchSender& _sender, int _site_num)
+{
+	vector<int> sites;
+	for(int i = 0; i < _triple_num; i++){
+		const TripleWithObjType& triple = _triple_array[i];
+		int sub_gid = getGlobalID(_global_entity_map, triple.getSubject(), 0);
+		int obj_gid = -1;
+		int sub_partition_id = -1, obj_partition_id = -1;
+		if(sub_gid < _entity_partitions.size())
+			sub_partition_id = _entity_partitions[sub_gid];
+		if(triple.isObjEntity()){
+			obj_gid = getGlobalID(_global_entity_map, triple.getObject(), 0);
+			if(obj_gid < _entity_partitions.size())
+				obj_partition_id = _entity_partitions[obj_gid];
+		}else{
+			obj_gid = getGlobalID(_global_literal_map, triple.getObject(), Util::LITERAL_FIRST_ID);
+		}
+
+		getTripleSites(sub_partition_id, obj_partition_id, _site_num, sites);
+		for(int j = 0; j < sites.size(); j++){
+			_sender.add(sites[j], triple, sub_gid, obj_gid);
+		}
+	}
+}
+
+//a chunk of lines of the RDF file, parsed by a thread of its own
+struct ParseChunk
+{
+	string text;
+	int line_num;
+	vector<TripleWithObjType> triples;
+	int triple_num;
+	pthread_t tid;
+};
+
+void*
+parseChunk(void* _arg)
+{
+	ParseChunk* chunk = (ParseChunk*)_arg;
+	RDFParser parser;
+	int capacity = chunk->line_num + 1;
+	chunk->triple_num = 0;
+	if(chunk->triples.size() < capacity)
+		chunk->triples.resize(capacity);
+	parser.parseString(chunk->text, &chunk->triples[0], chunk->triple_num, capacity);
+	//more than one triple in a line
+	while(chunk->triple_num == capacity){
+		capacity *= 2;
+		chunk->triples.resize(capacity);
+		parser.parseFile(&chunk->triples[0], chunk->triple_num, capacity);
+	}
+	return NULL;
+}
+
+//the @prefix and @base lines met so far are put before the lines of each chunk, return false at the end of the file
+bool
+readChunk(ifstream& _fin, string& _prefixes, ParseChunk& _chunk)
+{
+	string line;
+	_chunk.text = _prefixes;
+	_chunk.line_num = 0;
+	while(_chunk.line_num < PARSE_CHUNK_LINE_NUM && getline(_fin, line)){
+		if(line.size() > 0 && line[0] == '@'){
+			_prefixes += line;
+			_prefixes += '\n';
+		}
+		_chunk.text += line;
+		_chunk.text += '\n';
+		_chunk.line_num++;
+	}
+	return _chunk.line_num > 0;
+}
+
+//parse the chunks of the next round while the triples of this round are dispatched
+long long
+parseAndDispatch(ifstream& _fin, int _parse_thread_num, GlobalIDMap& _global_entity_map, GlobalIDMap& _global_literal_map,
+		const vector<int>& _entity_partitions, TripleBatchSender& _sender, int _site_num)
+{
+	long long triple_num = 0;
+	string prefixes;
+	vector<ParseChunk> chunks[2];
+	int chunk_nums[2] = {0, 0};
+	chunks[0].resize(_parse_thread_num);
+	chunks[1].resize(_parse_thread_num);
+
+	int cur = 0;
+	while(true){
+		//launch the next round
+		int next = cur ^ 1;
+		chunk_nums[next] = 0;
+		while(chunk_nums[next] < _parse_thread_num && readChunk(_fin, prefixes, chunks[next][chunk_nums[next]])){
+			ParseChunk& chunk = chunks[next][chunk_nums[next]];
+			pthread_create(&chunk.tid, NULL, parseChunk, (void*)&chunk);
+			chunk_nums[next]++;
+		}
+
+		for(int i = 0; i < chunk_nums[cur]; i++){
+			ParseChunk& chunk = chunks[cur][i];
+			dispatchTriples(&chunk.triples[0], chunk.triple_num, _global_entity_map, _global_literal_map, _entity_partitions, _sender, _site_num);
+			triple_num += chunk.triple_num;
+		}
+		if(chunk_nums[cur] > 0)
+			printf("parse and communicate %lld triples!\n", triple_num);
+
+		for(int i = 0; i < chunk_nums[next]; i++){
+			pthread_join(chunks[next][i].tid, NULL);
+		}
+		if(chunk_nums[next] == 0)
+			break;
+		cur = next;
+	}
+
+	return triple_num;
+}
+
+//send _send_bytes[i] to rank i, the bytes from rank i are put at _recv_displs[i] of _recv_bytes
+void
+exchangeBytes(vector< vector<char> >& _send_bytes, vector<char>& _recv_bytes, vector<int>& _recv_displs)
+{
+	int p = _send_bytes.size();
+	vector<int> send_counts(p), send_displs(p), recv_counts(p);
+	vector<char> send_bytes;
+	for(int i = 0; i < p; i++){
+		send_counts[i] = _send_bytes[i].size();
+		send_displs[i] = send_bytes.size();
+		send_bytes.insert(send_bytes.end(), _send_bytes[i].begin(), _send_bytes[i].end());
+		_send_bytes[i].clear();
+	}
+	MPI_Alltoall(&send_counts[0], 1, MPI_INT, &recv_counts[0], 1, MPI_INT, MPI_COMM_WORLD);
+	_recv_displs.assign(p + 1, 0);
+	for(int i = 0; i < p; i++){
+		_recv_displs[i + 1] = _recv_displs[i] + recv_counts[i];
+	}
+	_recv_bytes.resize(_recv_displs[p] + 1);
+	send_bytes.resize(send_bytes.size() + 1);
+	MPI_Alltoallv(&send_bytes[0], &send_counts[0], &send_displs[0], MPI_CHAR,
+			&_recv_bytes[0], &recv_counts[0], &_recv_displs[0], MPI_CHAR, MPI_COMM_WORLD);
+}
+
+void
+appendInt(vector<char>& _bytes, int _val)
+{
+	const char* p = (const char*)&_val;
+	_bytes.insert(_bytes.end(), p, p + sizeof(int));
+}
+
+int
+readInt(const char*& _p)
+{
+	int val;
+	memcpy(&val, _p, sizeof(int));
+	_p += sizeof(int);
+	return val;
+}
+
+void
+appendStr(vector<char>& _bytes, const string& _str)
+{
+	appendInt(_bytes, _str.size());
+	_bytes.insert(_bytes.end(), _str.begin(), _str.end());
+}
+
+void
+readStr(const char*& _p, string& _str)
+{
+	int len = readInt(_p);
+	_str.assign(_p, len);
+	_p += len;
+}
+
+//the lines of a file between two byte offsets, the line across the begin offset belongs to the range before
+class FileRange
+{
+public:
+	FileRange()
+	{
+		this->pos = this->end = 0;
+	}
+	bool open(const char* _path, int _rank, int _range_num)
+	{
+		this->fin.open(_path, ios::binary);
+		if(!this->fin)
+			return false;
+		this->fin.seekg(0, ios::end);
+		long long file_size = this->fin.tellg();
+		long long begin = file_size * _rank / _range_num;
+		this->end = file_size * (_rank + 1) / _range_num;
+		this->fin.seekg(begin > 0 ? begin - 1 : 0, ios::beg);
+		string line;
+		if(begin > 0)
+			getline(this->fin, line);
+		this->pos = this->fin.tellg();
+		return true;
+	}
+	//@prefix and @base lines at the head of the file, for the ranges after the first one
+	void readPrefixes(const char* _path, string& _prefixes)
+	{
+		ifstream head(_path);
+		string line;
+		while(getline(head, line)){
+			if(line.size() == 0)
+				continue;
+			if(line[0] != '@')
+				break;
+			_prefixes += line;
+			_prefixes += '\n';
+		}
+	}
+	//the lines beginning in the range, about _max_bytes at a time, return false at the end of the range
+	bool readLines(string& _text, int& _line_num, int _max_bytes)
+	{
+		string line;
+		int byte_num = 0;
+		_line_num = 0;
+		while(byte_num < _max_bytes && this->pos < this->end && getline(this->fin, line)){
+			_text += line;
+			_text += '\n';
+			byte_num += line.size() + 1;
+			this->pos += line.size() + 1;
+			_line_num++;
+		}
+		return _line_num > 0;
+	}
+
+private:
+	ifstream fin;
+	long long pos;
+	long long end;
+};
+
+//--parallel-load: every rank reads its own byte range of the RDF file and of the internal vertices file,
+//the global dictionary is spread over the ranks by the hash of the strings, and each owner gives
+//the IDs of its strings as count * p + rank, then the triples are routed to the sites with MPI_Alltoallv,
+//round by round, while the sites build their databases from them
+class ShardLoader : public TripleSource
+{
+public:
+	ShardLoader(int _rank, int _p)
+	{
+		this->rank = _rank;
+		this->p = _p;
+		this->recv_pos = _p;
+		this->triple_num = 0;
+		this->finished = false;
+	}
+
+	//the internal vertices of the site are returned, one per line
+	bool loadInternalVertices(const char* _internal_file, string& _site_vertices)
+	{
+		FileRange range;
+		if(!range.open(_internal_file, this->rank, this->p)){
+			cout << "import internal vertices failed." << endl;
+		}
+		vector< vector<char> > owner_bytes(this->p), site_bytes(this->p);
+		vector<char> recv_bytes;
+		vector<int> recv_displs;
+		string text, vertex;
+		while(true){
+			int line_num = 0;
+			text.clear();
+			if(!this->anyLeft(range.readLines(text, line_num, LOAD_ROUND_SIZE)))
+				break;
+
+			vector<string> lines = Util::split(text, "\n");
+			for(int i = 0; i < lines.size(); i++){
+				vector<string> resVec = Util::split(lines[i], "\t");
+				if(resVec.size() < 2)
+					continue;
+				int partition_id = atoi(resVec[1].c_str());
+				vector<char>& bytes = owner_bytes[this->getOwner(resVec[0])];
+				appendInt(bytes, partition_id);
+				appendStr(bytes, resVec[0]);
+				appendStr(site_bytes[partition_id + 1], resVec[0]);
+			}
+
+			//register the partitions at the owners
+			exchangeBytes(owner_bytes, recv_bytes, recv_displs);
+			const char* p = &recv_bytes[0];
+			const char* end = p + recv_displs[this->p];
+			while(p < end){
+				int partition_id = readInt(p);
+				readStr(p, vertex);
+				int index = this->getEntityIndex(vertex);
+				this->entity_partitions[index] = partition_id;
+			}
+
+			exchangeBytes(site_bytes, recv_bytes, recv_displs);
+			p = &recv_bytes[0];
+			end = p + recv_displs[this->p];
+			while(p < end){
+				readStr(p, vertex);
+				_site_vertices += vertex;
+				_site_vertices += '\n';
+			}
+		}
+		return true;
+	}
+
+	bool open(const char* _rdf_file)
+	{
+		if(this->rank > 0)
+			this->rdf_range.readPrefixes(_rdf_file, this->prefixes);
+		return this->rdf_range.open(_rdf_file, this->rank, this->p);
+	}
+
+	//one round of parsing and routing, return false once all ranks have read all their ranges
+	bool exchangeRound()
+	{
+		if(this->finished)
+			return false;
+		ParseChunk chunk;
+		chunk.text = this->prefixes;
+		chunk.triple_num = 0;
+		if(!this->anyLeft(this->rdf_range.readLines(chunk.text, chunk.line_num, LOAD_ROUND_SIZE))){
+			this->finished = true;
+			return false;
+		}
+		if(chunk.line_num > 0)
+			parseChunk((void*)&chunk);
+		this->triple_num += chunk.triple_num;
+
+		//the distinct vertices of the round are asked to their owners
+		GlobalIDMap query_map;
+		vector<int> query_owners, query_indexes;
+		vector<int> triple_queries(2 * chunk.triple_num);
+		vector< vector<char> > send_bytes(this->p);
+		vector<int> owner_query_nums(this->p, 0);
+		for(int i = 0; i < chunk.triple_num; i++){
+			const TripleWithObjType& triple = chunk.triples[i];
+			triple_queries[2 * i] = this->addQuery('E', triple.getSubject(), query_map, query_owners, query_indexes, owner_query_nums, send_bytes);
+			triple_queries[2 * i + 1] = this->addQuery(triple.isObjEntity() ? 'E' : 'L', triple.getObject(), query_map, query_owners, query_indexes, owner_query_nums, send_bytes);
+		}
+
+		vector<char> recv_bytes;
+		vector<int> recv_displs;
+		exchangeBytes(send_bytes, recv_bytes, recv_displs);
+
+		//the owners answer the global ID and the partition of each vertex, in the order asked
+		string str;
+		for(int i = 0; i < this->p; i++){
+			const char* p = &recv_bytes[0] + recv_displs[i];
+			const char* end = &recv_bytes[0] + recv_displs[i + 1];
+			while(p < end){
+				char kind = *p;
+				p++;
+				readStr(p, str);
+				if(kind == 'E'){
+					int index = this->getEntityIndex(str);
+					appendInt(send_bytes[i], index * this->p + this->rank);
+					appendInt(send_bytes[i], this->entity_partitions[index]);
+				}else{
+					appendInt(send_bytes[i], Util::LITERAL_FIRST_ID + this->getLiteralIndex(str) * this->p + this->rank);
+					appendInt(send_bytes[i], -1);
+				}
+			}
+		}
+		exchangeBytes(send_bytes, recv_bytes, recv_displs);
+
+		vector<TripleBatch> batches(this->p - 1);
+		vector<int> sites;
+		for(int i = 0; i < chunk.triple_num; i++){
+			int answers[2][2];
+			for(int j = 0; j < 2; j++){
+				int query = triple_queries[2 * i + j];
+				const char* p = &recv_bytes[0] + recv_displs[query_owners[query]] + query_indexes[query] * 2 * sizeof(int);
+				answers[j][0] = readInt(p);
+				answers[j][1] = readInt(p);
+			}
+			getTripleSites(answers[0][1], answers[1][1], this->p - 1, sites);
+			for(int j = 0; j < sites.size(); j++){
+				batches[sites[j]].add(chunk.triples[i], answers[0][0], answers[1][0]);
+			}
+		}
+		for(int i = 0; i < batches.size(); i++){
+			if(batches[i].getTripleNum() > 0)
+				send_bytes[i + 1].assign(batches[i].getBytes(), batches[i].getBytes() + batches[i].getSize());
+		}
+		exchangeBytes(send_bytes, this->recv_bytes, this->recv_displs);
+		this->recv_pos = 0;
+
+		return true;
+	}
+
+	//the batches received in a round are handed over in several groups if they do not fit in one
+	virtual void getTriples(TripleWithObjType* _triple_array, int& _triple_num, vector<int>& _global_ids)
+	{
+		//a round may bring no triple to this site
+		while(_triple_num == 0){
+			if(this->recv_pos >= this->p && !this->exchangeRound())
+				return;
+			for(; this->recv_pos < this->p; this->recv_pos++){
+				int size = this->recv_displs[this->recv_pos + 1] - this->recv_displs[this->recv_pos];
+				if(size == 0)
+					continue;
+				const char* src = &this->recv_bytes[0] + this->recv_displs[this->recv_pos];
+				int batch_triple_num = 0;
+				memcpy(&batch_triple_num, src, sizeof(int));
+				if(_triple_num > 0 && _triple_num + batch_triple_num > RDFParser::TRIPLE_NUM_PER_GROUP)
+					break;
+				_triple_num += TripleBatch::unpack(src, size, _triple_array + _triple_num, _global_ids);
+			}
+		}
+	}
+
+	//the rounds left if the build stops early
+	void drain()
+	{
+		while(this->exchangeRound());
+	}
+
+	long long getTripleNum() const
+	{
+		return this->triple_num;
+	}
+	int getEntityNum() const
+	{
+		return this->entity_map.size();
+	}
+	int getLiteralNum() const
+	{
+		return this->literal_map.size();
+	}
+
+private:
+	int rank;
+	int p;
+	FileRange rdf_range;
+	string prefixes;
+	long long triple_num;
+	bool finished;
+	//the strings owned by this rank, and their index in the order of registration
+	GlobalIDMap entity_map, literal_map;
+	vector<int> entity_partitions;
+	//the triples of the last round, by sender
+	vector<char> recv_bytes;
+	vector<int> recv_displs;
+	int recv_pos;
+
+	bool anyLeft(bool _left)
+	{
+		int left = _left ? 1 : 0, any_left = 0;
+		MPI_Allreduce(&left, &any_left, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+		return any_left == 1;
+	}
+
+	int getOwner(const string& _str) const
+	{
+		return Util::BKDRHash(_str.c_str()) % this->p;
+	}
+
+	int getEntityIndex(const string& _str)
+	{
+		int index = getGlobalID(this->entity_map, _str, 0);
+		if(index >= this->entity_partitions.size())
+			this->entity_partitions.resize(index + 1, -1);
+		return index;
+	}
+
+	int getLiteralIndex(const string& _str)
+	{
+		return getGlobalID(this->literal_map, _str, 0);
+	}
+
+	int addQuery(char _kind, const string& _str, GlobalIDMap& _query_map, vector<int>& _query_owners, vector<int>& _query_indexes,
+			vector<int>& _owner_query_nums, vector< vector<char> >& _send_bytes)
+	{
+		string key = _kind + _str;
+		GlobalIDMap::iterator it = _query_map.find(key);
+		if(it != _query_map.end())
+			return it->second;
+
+		int owner = this->getOwner(_str);
+		int query = _query_owners.size();
+		_query_map.insert(make_pair(key, query));
+		_query_owners.push_back(owner);
+		_query_indexes.push_back(_owner_query_nums[owner]++);
+		_send_bytes[owner].push_back(_kind);
+		appendStr(_send_bytes[owner], _str);
+		return query;
+	}
+};
+
+//the internal vertices are kept in a temporary file for the build, one per line
+bool
+buildSiteDatabase(const string& _db_path, const char* _internal_vertices, TripleSource& _source, int _build_thread_num, long long _build_memory)
+{
+	remove("_distributed_gStore_tmp_internal_vertices.txt");
+	ofstream _internal_vertices_fout("_distributed_gStore_tmp_internal_vertices.txt");
+	_internal_vertices_fout << _internal_vertices;
+	_internal_vertices_fout.close();
+	
+	//if(_db_path[0] != '/' && _db_path[0] != '~')  //using relative path
+	//{
+		//_db_path = string("../") + _db_path;
+	//}
+	//the triples are built into the database as they are received, with their global IDs
+	Database _db(_db_path);
+	_db.setBuildThreadNum(_build_thread_num);
+	if(_build_memory > 0)
+		_db.setBuildMemory(_build_memory);
+	bool flag = _db.build(_source, "_distributed_gStore_tmp_internal_vertices.txt");
+	if (flag)
+	{
+		cout << "import RDF file to database done." << endl;
+	}
+	else
+	{
+		cout << "import RDF file to database failed." << endl;
+	}
+	
+	remove("_distributed_gStore_tmp_internal_vertices.txt");
+	return flag;
+}
+
+//--partition: the entities of the RDF file are partitioned among the _site_num sites by rank 0
+//and written to _internal_file, before any rank reads it
+bool
+partitionRDF(const char* _rdf_file, const char* _internal_file, const string& _mode, int _site_num)
+{
+	vector<int> modes;
+	if(_mode == "best"){
+		for(int i = 0; i < GraphPartitioner::MODE_NUM; i++){
+			modes.push_back(i);
+		}
+	}else if(GraphPartitioner::getMode(_mode) != -1){
+		modes.push_back(GraphPartitioner::getMode(_mode));
+	}else{
+		cerr << "Unknown partition mode: " << _mode << endl;
+		return false;
+	}
+
+	ifstream _fin(_rdf_file);
+	if(!_fin){
+		cerr << "Fail to open the RDF data file: " << _rdf_file << endl;
+		return false;
+	}
+	GraphPartitioner _partitioner(_site_num);
+	RDFParser _parser(_fin);
+	TripleWithObjType* triple_array = new TripleWithObjType[RDFParser::TRIPLE_NUM_PER_GROUP];
+	while(true){
+		int parse_triple_num = 0;
+		_parser.parseFile(triple_array, parse_triple_num);
+		if(parse_triple_num == 0)
+			break;
+		for(int i = 0; i < parse_triple_num; i++){
+			_partitioner.addTriple(triple_array[i]);
+		}
+	}
+	delete[] triple_array;
+	_fin.close();
+	printf("%d entities with %lld edges between them are partitioned among %d sites.\n", _partitioner.getVertexNum(), _partitioner.getEdgeNum(), _site_num);
+
+	//each crossing edge is kept by two sites and may give partial matches
+	vector<int> parts, best_parts, sizes;
+	long long best_crossing_num = -1;
+	int best_mode = -1;
+	for(int i = 0; i < modes.size(); i++){
+		_partitioner.partition(modes[i], parts);
+		long long crossing_num = _partitioner.countCrossingEdges(parts);
+		_partitioner.countPartitionSizes(parts, sizes);
+		printf("%s: %lld crossing edges(%.2f%%), %d to %d entities per partition.\n", GraphPartitioner::getModeName(modes[i]), crossing_num,
+				_partitioner.getEdgeNum() == 0 ? 0.0 : 100.0 * crossing_num / _partitioner.getEdgeNum(),
+				*min_element(sizes.begin(), sizes.end()), *max_element(sizes.begin(), sizes.end()));
+		if(best_crossing_num == -1 || crossing_num < best_crossing_num){
+			best_crossing_num = crossing_num;
+			best_mode = modes[i];
+			best_parts.swap(parts);
+		}
+	}
+	if(modes.size() > 1)
+		printf("The %s partitioning is chosen.\n", GraphPartitioner::getModeName(best_mode));
+
+	if(!_partitioner.write(best_parts, _internal_file)){
+		cerr << "Fail to write the internal vertices file: " << _internal_file << endl;
+		return false;
+	}
+	return true;
+}
+
+//[0]./gload [1]data_folder_path  [2]rdf_file_path [3]internal_file_path
 int 
 main(int argc, char * argv[])
 {
 	//chdir(dirname(argv[0]));
 	Util util;
 	//system("clock");
-	int myRank, p, size, i, j, k, l = 0;
+	int myRank, p, size, i;
 	double loadingStart, loadingEnd;
 	MPI_Status status;
 	MPI_Init(&argc, &argv);
@@ -28,7 +755,64 @@ main(int argc, char * argv[])
 	MPI_Comm_rank(MPI_COMM_WORLD,&myRank);
 	MPI_Comm_size(MPI_COMM_WORLD,&p);
 	
-	if(myRank == 0) {
+	int parse_thread_num = 1;
+	bool parallel_load = false;
+	int build_thread_num = 4;
+	long long build_memory = 0;
+	string partition_mode;
+	for(i = 4; i < argc; i++){
+		if(strncmp(argv[i], "--parse-threads=", 16) == 0)
+			parse_thread_num = atoi(argv[i] + 16);
+		else if(strncmp(argv[i], "--build-threads=", 16) == 0)
+			build_thread_num = atoi(argv[i] + 16);
+		else if(strncmp(argv[i], "--build-memory=", 15) == 0)
+			build_memory = atoll(argv[i] + 15) * 1024 * 1024;
+		else if(strcmp(argv[i], "--parallel-load") == 0)
+			parallel_load = true;
+		else if(strncmp(argv[i], "--partition=", 12) == 0)
+			partition_mode = argv[i] + 12;
+	}
+	if(parse_thread_num < 1)
+		parse_thread_num = 1;
+	
+	if(!partition_mode.empty()){
+		int partitioned = 0;
+		if(myRank == 0)
+			partitioned = partitionRDF(argv[2], argv[3], partition_mode, p - 1) ? 1 : 0;
+		MPI_Bcast(&partitioned, 1, MPI_INT, 0, MPI_COMM_WORLD);
+		if(!partitioned){
+			MPI_Finalize();
+			return 0;
+		}
+	}
+	
+	if(parallel_load){
+		loadingStart = MPI_Wtime();
+		ShardLoader _loader(myRank, p);
+		string _site_vertices;
+		_loader.loadInternalVertices(argv[3], _site_vertices);
+		if(!_loader.open(argv[2])){
+			cerr << "Fail to open the RDF data file: " << argv[2] << endl;
+		}
+		
+		//rank 0 reads and routes triples like the sites, but builds no database
+		if(myRank == 0){
+			while(_loader.exchangeRound());
+		}else{
+			buildSiteDatabase(string(argv[1]), _site_vertices.c_str(), _loader, build_thread_num, build_memory);
+			_loader.drain();
+		}
+		
+		long long _counts[3] = {_loader.getTripleNum(), _loader.getEntityNum(), _loader.getLiteralNum()}, _sums[3];
+		MPI_Reduce(_counts, _sums, 3, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+		loadingEnd = MPI_Wtime();
+		printf("%d takes %f s and finish loading data!\n", myRank, loadingEnd - loadingStart); 
+		if(myRank == 0){
+			printf("%lld triples are read by %d ranks.\n", _sums[0], p);
+			printf("The global dictionary has %lld entities and %lld literals.\n", _sums[1], _sums[2]);
+		}
+	}else if(myRank == 0) {
+		loadingStart = MPI_Wtime();
 		string _db_path = string(argv[1]);
 		cout << "gloadD..." << endl;
 		{
@@ -37,12 +821,15 @@ main(int argc, char * argv[])
 			cout << "RDF_data: " << argv[2] << "\t";
 			cout << "internal_file_name: " << argv[3] << "\t";
 			cout << "host number: " << p << "\t";
+			cout << "parse threads: " << parse_thread_num << "\t";
 			cout << endl;
 		}
 		stringstream* _six_tuples_ss = new stringstream[p - 1];		
 		
-		//add internal node flags to B+ tree
-		Tree* tp = new Tree(".", string("internal_nodes_tree.dat"), "build");
+		//one ID per URI/literal for all sites, so that partial matches can be joined on IDs,
+		//and the partition of each internal vertex indexed by its global ID
+		GlobalIDMap _global_entity_map, _global_literal_map;
+		vector<int> _entity_partitions;
 		string buff;
 		string _internal_vertices_file = string(argv[3]);
 		ifstream infile(_internal_vertices_file.c_str());
@@ -50,31 +837,30 @@ main(int argc, char * argv[])
 			cout << "import internal vertices failed." << endl;
 		}
 		
-		int count = 0;
 		while(getline(infile, buff)){
 			vector<string> resVec = Util::split(buff, "\t");
-			char* _val = new char[resVec[1].size()];
-			strcpy(_val, resVec[1].c_str());
-			tp->insert(resVec[0].c_str(), strlen(resVec[0].c_str()), _val, strlen(_val));
-			
+			if(resVec.size() < 2)
+				continue;
 			int partition_id = atoi(resVec[1].c_str());
+			int _gid = getGlobalID(_global_entity_map, resVec[0], 0);
+			if(_gid >= _entity_partitions.size())
+				_entity_partitions.resize(_gid + 1, -1);
+			_entity_partitions[_gid] = partition_id;
+			
 			_six_tuples_ss[partition_id] << resVec[0] << endl;
 		}
 
 		infile.close();
-		tp->save();
 		
 		for(i = 1; i < p; i++){
-			char* _internal_vertices_arr = new char[_six_tuples_ss[i - 1].str().size() + 1];
-			strcpy(_internal_vertices_arr, _six_tuples_ss[i - 1].str().c_str());
-			size = strlen(_internal_vertices_arr);
+			string _internal_vertices_str = _six_tuples_ss[i - 1].str();
+			size = _internal_vertices_str.size() + 1;
 			
 			printf("Sending the internal vertices to site %d.\n", i);
 			MPI_Send(&size, 1, MPI_INT, i, 10, MPI_COMM_WORLD);
-			MPI_Send(_internal_vertices_arr, size, MPI_CHAR, i, 10, MPI_COMM_WORLD);
-			
-			delete[] _internal_vertices_arr;
+			MPI_Send((char*)_internal_vertices_str.c_str(), size, MPI_CHAR, i, 10, MPI_COMM_WORLD);
 		}		
+		delete[] _six_tuples_ss;
 		
 		printf("The internal vertices have been sent!\n");
 		
@@ -84,176 +870,55 @@ main(int argc, char * argv[])
 			exit(0);
 		}
 		
-		RDFParser _parser(_fin);
-		TripleWithObjType* triple_array = new TripleWithObjType[RDFParser::TRIPLE_NUM_PER_GROUP];
-		
-		int _sub_partition_id, _obj_partition_id;
-		bool ret = true, ret1 = true;
-		while(true)
-		{
-			int parse_triple_num = 0;
-
-			_parser.parseFile(triple_array, parse_triple_num);
-
-			printf("parse and communicate %d triples!\n", parse_triple_num);
-			if(parse_triple_num == 0) {
-				for(i = 1; i < p; i++){
-					char* _finished_tag = new char[32];
-					strcpy(_finished_tag, "all tuples have sent ");
-					size = strlen(_finished_tag);
-					
-					MPI_Send(&size, 1, MPI_INT, i, 10, MPI_COMM_WORLD);
-					MPI_Send(_finished_tag, size, MPI_CHAR, i, 10, MPI_COMM_WORLD);
-					
-					delete[] _finished_tag;
-				}
-				break;
-			}
-			
-			for(int i = 0; i < p - 1; i++){
-				_six_tuples_ss[i].str("");
-			}
-
-			/* Process the Triple one by one */
-			for(int i = 0; i < parse_triple_num; i ++)
+		TripleBatchSender _sender(p - 1);
+		long long _triple_num = 0;
+		if(parse_thread_num > 1){
+			_triple_num = parseAndDispatch(_fin, parse_thread_num, _global_entity_map, _global_literal_map, _entity_partitions, _sender, p - 1);
+		}else{
+			RDFParser _parser(_fin);
+			TripleWithObjType* triple_array = new TripleWithObjType[RDFParser::TRIPLE_NUM_PER_GROUP];
+			while(true)
 			{
+				int parse_triple_num = 0;
+
+				_parser.parseFile(triple_array, parse_triple_num);
+
+				printf("parse and communicate %d triples!\n", parse_triple_num);
+				if(parse_triple_num == 0)
+					break;
 				
-				string _sub = triple_array[i].getSubject();
-				string _pre = triple_array[i].getPredicate();
-				string _obj = triple_array[i].getObject();
-				
-				char* val = NULL;
-				int vlen = 0;
-				ret = tp->search(_sub.c_str(), strlen(_sub.c_str()), val, vlen);
-				if(ret == true){
-					_sub_partition_id = atoi(val);
-					
-					_six_tuples_ss[_sub_partition_id] << _sub << '\t' << _pre << '\t' << _obj << "." << endl;
-				}
-				// obj is entity
-				if (triple_array[i].isObjEntity())
-				{
-					char* val1 = NULL;
-					int vlen1 = 0;
-					ret1 = tp->search(_obj.c_str(), strlen(_obj.c_str()), val1, vlen1);
-					if(ret1 == true){
-						_obj_partition_id = atoi(val1);
-						
-						if(_sub_partition_id != _obj_partition_id){
-							_six_tuples_ss[_obj_partition_id] << _sub	<< '\t' << _pre << '\t' << _obj << "." << endl;
-						}
-					}
-				}
-				
-				if(ret == false && ret1 == false){
-					for(j = 1; j < p; j++){
-						_six_tuples_ss[j - 1] << _sub << '\t' << _pre << '\t' << _obj << "." << endl;
-					}
-				}
-			}
-			
-			for(i = 1; i < p; i++){
-				char* _tuple_arr = new char[_six_tuples_ss[i - 1].str().size() + 1];
-				strcpy(_tuple_arr, _six_tuples_ss[i - 1].str().c_str());
-				size = strlen(_tuple_arr);
-				
-				//printf("after parsing %d triples, partition %d has size %d and there are : %s\n", parse_triple_num, i, size, _tuple_arr);
-				
-				MPI_Send(&size, 1, MPI_INT, i, 10, MPI_COMM_WORLD);
-				MPI_Send(_tuple_arr, size, MPI_CHAR, i, 10, MPI_COMM_WORLD);
-				
-				delete[] _tuple_arr;
+				dispatchTriples(triple_array, parse_triple_num, _global_entity_map, _global_literal_map, _entity_partitions, _sender, p - 1);
+				_triple_num += parse_triple_num;
 			}
+			delete[] triple_array;
 		}
-
-		delete[] triple_array;
-		//delete[] _config_name;
+		_sender.finish();
 		_fin.close();
-		infile.close();
-		delete tp;
-		remove("internal_nodes.dat");
+		
+		loadingEnd = MPI_Wtime();
+		printf("%lld triples are sent in %d batches in %f s.\n", _triple_num, _sender.getBatchNum(), loadingEnd - loadingStart);
+		printf("The global dictionary has %d entities and %d literals.\n", (int)_global_entity_map.size(), (int)_global_literal_map.size());
 	}else{
 		loadingStart = MPI_Wtime();
 
-		remove("_distributed_gStore_tmp_internal_vertices.txt");
-		remove("_distributed_gStore_tmp_rdf_triples.n3");
-		
 		MPI_Recv(&size, 1, MPI_INT, 0, 10, MPI_COMM_WORLD, &status);
 		char* _internal_vertices_arr = new char[size];
 		MPI_Recv(_internal_vertices_arr, size, MPI_CHAR, 0, 10, MPI_COMM_WORLD, &status);
 		_internal_vertices_arr[size - 1] = 0;
 		
-		ofstream _internal_vertices_fout("_distributed_gStore_tmp_internal_vertices.txt");
-		_internal_vertices_fout << _internal_vertices_arr;
-		_internal_vertices_fout.close();
-		
-		ofstream _six_tuples_fout("_distributed_gStore_tmp_rdf_triples.n3");
-		if(! _six_tuples_fout) {
-			cerr << "Fail to open: _distributed_gStore_tmp_rdf_triples.n3" << endl;
-			exit(0);
-		}
-		
-		while(true){
-			MPI_Recv(&size, 1, MPI_INT, 0, 10, MPI_COMM_WORLD, &status);
-			char* _tuples = new char[size];
-			MPI_Recv(_tuples, size, MPI_CHAR, 0, 10, MPI_COMM_WORLD, &status);
-			_tuples[size - 1] = 0;
-			
-			//printf("%d recieve %d , %d and %s\n", myRank, size, strcmp(_tuples, "all tuples have sent"), _tuples); 
-			
-			if(strcmp(_tuples, "all tuples have sent") == 0){
-				break;
-			}else{
-				_six_tuples_fout << _tuples;
-			}
-			delete[] _tuples;
-		}
-		_six_tuples_fout.close();
-		
-		printf("%d recieve all all tuples!\n", myRank); 
-		
-		string _db_path = string(argv[1]);
-		//if(_db_path[0] != '/' && _db_path[0] != '~')  //using relative path
-		//{
-			//_db_path = string("../") + _db_path;
-		//}
-		string _rdf = string(argv[2]);
-		//if(_rdf[0] != '/' && _rdf[0] != '~')  //using relative path
-		//{
-			//_rdf = string("../") + _rdf;
-		//}
-		Database _db(_db_path);
-		bool flag = _db.build("_distributed_gStore_tmp_rdf_triples.n3", "_distributed_gStore_tmp_internal_vertices.txt");
-		if (flag)
-		{
-			cout << "import RDF file to database done." << endl;
-		}
-		else
-		{
-			cout << "import RDF file to database failed." << endl;
-		}
-		
-		/*
-		printf("%d begin to load internal vertices!\n", myRank); 
-		
-		//_db.setInternalVertices("_distributed_gStore_tmp_internal_vertices.txt");
-		Database _db1(_db_path);
-        //_db1.load();
-        string _in_file = "_distributed_gStore_tmp_internal_vertices.txt";
-        _db1.loadInternalVertices(_in_file);
-		*/
-		remove("_distributed_gStore_tmp_internal_vertices.txt");
-		remove("_distributed_gStore_tmp_rdf_triples.n3");
+		TripleBatchReceiver _receiver;
+		buildSiteDatabase(string(argv[1]), _internal_vertices_arr, _receiver, build_thread_num, build_memory);
+		_receiver.drain();
+		delete[] _internal_vertices_arr;
 		
 		loadingEnd = MPI_Wtime();
 		double time_cost_value = loadingEnd - loadingStart;
 		
 		printf("%d takes %f s and finish loading data!\n", myRank, time_cost_value); 
-		delete[] _internal_vertices_arr;
 	}
 	
 	MPI_Finalize();
 	
 	//system("clock");
 	return 0;
-}
\ No newline at end of file
+}
@@ -8,6 +8,7 @@
 2. ./gquery --help                                 simplified as -h, equal to 1
 3. ./gquery db_folder query_path                   load query from given path fro given database
 4. ./gquery db_folder                              load the given database and open console
+5. ./gquery db_folder query_path --explain         print the join order chosen for each basic query and the rows estimated
 =============================================================================*/
 
 #include "../Database/Database.h"
@@ -31,6 +32,7 @@ help()
 2. ./gquery --help                                 simplified as -h, equal to 1\n\
 3. ./gquery db_folder query_path                   load query from given path fro given database\n\
 4. ./gquery db_folder                              load the given database and open console\n\
+5. ./gquery db_folder query_path --explain         print the join order chosen for each basic query and the rows estimated\n\
 =============================================================================*/\n");
 }
 
@@ -48,6 +50,20 @@ main(int argc, char * argv[])
 		return 0;
 	}
 	cout << "gquery..." << endl;
+	//the option may be anywhere after the database, and the other arguments keep their places
+	for (int i = 2; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--explain") == 0)
+		{
+			Join::setExplain(true);
+			for (int j = i + 1; j < argc; ++j)
+			{
+				argv[j - 1] = argv[j];
+			}
+			argc--;
+			break;
+		}
+	}
 	if (argc < 2)
 	{
 		cerr << "error: lack of DB_store to be queried" << endl;
@@ -8,516 +8,1432 @@
 2. ./gquery --help                                 simplified as -h, equal to 1
 3. ./gquery db_folder query_path                   load query from given path fro given database
 4. ./gquery db_folder                              load the given database and open console
+5. ./gqueryD db_folder query_path --assembly=distributed
+                                                   join the partial matches among the sites instead of the coordinator
+6. ./gqueryD db_folder query_path --threads=N      join the partial matches with N threads, all cores by default
+7. ./gqueryD db_folder --server=PORT               keep the databases loaded and answer the queries sent to PORT(3305 by default)
+                                                   by gclient, until the stop command
+8. ./gqueryD db_folder --server=PORT --parallel-queries=N
+                                                   answer up to N queries at the same time, 4 by default
+9. ./gqueryD db_folder query_path --bloom-filter   drop the partial matches that can not be joined before sending them,
+                                                   by Bloom filters of the internal vertices merged among the sites
+10. ./gqueryD db_folder query_path --lec           join one representative of each LEC class of partial matches, and only ship
+                                                   the members of the classes in complete matches
+11. ./gqueryD db_folder query_path --explain       print the join order chosen by each site for the local partial matches
 =============================================================================*/
 
 #include "../Database/Database.h"
 #include "../Util/Util.h"
+#include "../Util/PartialResBuffer.h"
+#include "../Util/PartialResJoin.h"
+#include "../Util/PartialResLEC.h"
+#include "../Util/BloomFilter.h"
+#include "../Server/Server.h"
 #include <mpi.h>
 
 using namespace std;
 
 //WARN:cannot support soft links!
 
-void
-help()
+//stream the chunks of LPMs of a site to the coordinator as packed bytes while more are produced,
+//two chunks at most are in flight, and an empty message ends the stream of the site
+class CoordinatorSink : public PartialResSink
 {
-	printf("\
-			/*=============================================================================\n\
-# Filename: gquery.cpp\n\
-# Author: Bookug Lobert\n\
-# Mail: 1181955272@qq.com\n\
-# Last Modified: 2015-10-20 12:23\n\
-# Description: query a database, there are several ways to use this program:\n\
-1. ./gquery                                        print the help message\n\
-2. ./gquery --help                                 simplified as -h, equal to 1\n\
-3. ./gquery db_folder query_path                   load query from given path fro given database\n\
-4. ./gquery db_folder                              load the given database and open console\n\
-=============================================================================*/\n");
+public:
+	CoordinatorSink(int _tag)
+		: PartialResSink(PartialResBuffer::STREAM_ROW_NUM)
+	{
+		this->tag = _tag;
+		this->cur = 0;
+		this->requests[0] = this->requests[1] = MPI_REQUEST_NULL;
+		this->chunk_num = 0;
+		this->row_num = 0;
+		this->byte_num = 0;
+	}
+	virtual void put(PartialResBuffer& _buf)
+	{
+		MPI_Status status;
+		MPI_Wait(&this->requests[this->cur], &status);
+		vector<char>& bytes = this->send_bytes[this->cur];
+		bytes.resize(_buf.getPackedSize());
+		_buf.pack(&bytes[0]);
+		MPI_Isend(&bytes[0], bytes.size(), MPI_BYTE, 0, this->tag, MPI_COMM_WORLD, &this->requests[this->cur]);
+		this->cur ^= 1;
+		
+		this->chunk_num++;
+		this->row_num += _buf.row_num;
+		this->byte_num += bytes.size();
+		_buf.clear();
+	}
+	void finish()
+	{
+		MPI_Status statuses[2];
+		MPI_Waitall(2, this->requests, statuses);
+		MPI_Send(NULL, 0, MPI_BYTE, 0, this->tag, MPI_COMM_WORLD);
+	}
+	
+	int chunk_num;
+	long long row_num;
+	long long byte_num;
+
+private:
+	int tag;
+	int cur;
+	vector<char> send_bytes[2];
+	MPI_Request requests[2];
+};
+
+//start to receive the next chunk from any site into _bytes, without waiting for it if _block is false,
+//return whether the receive is started
+int
+postChunkRecv(vector<char>& _bytes, MPI_Request& _request, int& _src, bool _block, int _tag)
+{
+	MPI_Message message;
+	MPI_Status status;
+	int flag = 1, count = 0;
+	if(_block)
+		MPI_Mprobe(MPI_ANY_SOURCE, _tag, MPI_COMM_WORLD, &message, &status);
+	else
+		MPI_Improbe(MPI_ANY_SOURCE, _tag, MPI_COMM_WORLD, &flag, &message, &status);
+	if(!flag)
+		return 0;
+	
+	MPI_Get_count(&status, MPI_BYTE, &count);
+	_bytes.resize(count);
+	MPI_Imrecv(count == 0 ? NULL : &_bytes[0], count, MPI_BYTE, &message, &_request);
+	_src = status.MPI_SOURCE;
+	return 1;
 }
 
+//hash partition the vertices of the data graph among the sites by their global IDs
 int
-main(int argc, char * argv[])
+getOwnerSite(int _id, int _site_num)
 {
-	//chdir(dirname(argv[0]));
-#ifdef DEBUG
-	Util util;
-#endif
+	return (int)(((unsigned)_id * 2654435761u) % (unsigned)_site_num);
+}
 
-	if (argc == 1 || strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)
-	{
-		help();
-		return 0;
+//fill the dictionary of a buffer of local IDs with the strings of the IDs referred by its rows
+void
+fillPartialResDict(PartialResBuffer& _buf, map<int, string>& _id_str_map)
+{
+	vector<int> referred_ids;
+	_buf.getReferredIDs(referred_ids);
+	for(int i = 0; i < referred_ids.size(); i++){
+		_buf.addDictEntry(referred_ids[i], _id_str_map[referred_ids[i]]);
 	}
-	//cout << "gquery..." << endl;
-	if (argc < 2)
-	{
-		cerr << "error: lack of DB_store to be queried" << endl;
-		return 0;
+}
+
+void
+collectPartialResDict(PartialResBuffer& _buf, map<int, string>& _id_str_map)
+{
+	vector<int> dict_offsets;
+	_buf.getDictOffsets(dict_offsets);
+	for(int i = 0; i < _buf.dict_ids.size(); i++){
+		if(_id_str_map.find(_buf.dict_ids[i]) == _id_str_map.end())
+			_id_str_map.insert(make_pair(_buf.dict_ids[i], string(&_buf.dict_strs[dict_offsets[i]])));
 	}
-	{
-		//cout << "argc: " << argc << "\t";
-		//cout << "DB_store:" << argv[1] << "\t";
-		//cout << endl;
+}
+
+//send the rows of _buf to the coordinator in chunks, each with the strings of its vertices if they are local IDs
+void
+sendPartialRes(const PartialResBuffer& _buf, map<int, string>& _id_str_map, CoordinatorSink& _sink)
+{
+	PartialResBuffer chunk(_buf.var_num);
+	for(int i = 0; i < _buf.row_num; i++){
+		chunk.addPackedRow(_buf.getRow(i), _buf.getTagRow(i));
+		if(chunk.row_num >= _sink.chunk_row_num || i == _buf.row_num - 1){
+			if(_buf.id_mode == PartialResBuffer::LOCAL_ID)
+				fillPartialResDict(chunk, _id_str_map);
+			chunk.id_mode = _buf.id_mode;
+			_sink.put(chunk);
+		}
 	}
-	if (argc >= 3)
-	{
-		int myRank, p, size, i, j, k, l = 0;
-		double partialResStart, partialResEnd;
-		char* queryCharArr;
-		char* partialResArr;
-		int* crossingEdgeHashTable = new int[Util::MAX_CROSSING_EDGE_HASH_SIZE];
-		int* crossingEdgeHashTagTable = new int[Util::MAX_CROSSING_EDGE_HASH_SIZE];
-		memset(crossingEdgeHashTable, 0, Util::MAX_CROSSING_EDGE_HASH_SIZE);
-		memset(crossingEdgeHashTagTable, 0, Util::MAX_CROSSING_EDGE_HASH_SIZE);
+}
+
+//the coordinator: map the local IDs in the dictionary of a buffer from a site to the IDs of the coordinator,
+//by one string lookup per distinct vertex; global IDs are the same in all sites and are joined as they are
+void
+getCoordIDs(const PartialResBuffer& _buf, map<string, int>& URIIDMap, map<int, string>& IDURIMap, int& id_count, vector<int>& _local2coord)
+{
+	vector<int> dict_offsets;
+	_buf.getDictOffsets(dict_offsets);
+	_local2coord.resize(_buf.dict_ids.size());
+	for(int j = 0; j < _buf.dict_ids.size(); j++){
+		string cur_str(&_buf.dict_strs[dict_offsets[j]]);
+		map<string, int>::iterator uri_iter = URIIDMap.find(cur_str);
+		if(uri_iter == URIIDMap.end()){
+			uri_iter = URIIDMap.insert(make_pair(cur_str, id_count)).first;
+			IDURIMap.insert(make_pair(id_count, cur_str));
+			id_count++;
+		}
+		_local2coord[j] = uri_iter->second;
+	}
+}
+
+//the coordinator: the rows of global IDs carry no strings, so the strings of the vertices in the final
+//matches are asked from the sites in one round after the join, and each site answers those it stores;
+//with local IDs the strings are known already and an empty request only lets the sites go on,
+//return the bytes received
+long long
+recvFinalStrings(const MatchRowSet& _final_set, int _var_num, int p, int _tag, int _id_mode, map<int, string>& IDURIMap)
+{
+	vector<int> final_ids;
+	if(_id_mode == PartialResBuffer::GLOBAL_ID){
+		for(int i = 0; i < _final_set.size(); i++){
+			const int* final_row = _final_set.getRow(i);
+			for(int j = 0; j < _var_num; j++){
+				if(final_row[j] >= 0)
+					final_ids.push_back(final_row[j]);
+			}
+		}
+		sort(final_ids.begin(), final_ids.end());
+		final_ids.erase(unique(final_ids.begin(), final_ids.end()), final_ids.end());
+	}
+	final_ids.push_back(0);
+	for(int i = 1; i < p; i++){
+		MPI_Send(&final_ids[0], final_ids.size() - 1, MPI_INT, i, _tag, MPI_COMM_WORLD);
+	}
+	final_ids.pop_back();
+	
+	long long byte_num = 0;
+	if(final_ids.empty())
+		return byte_num;
+	for(int i = 1; i < p; i++){
 		MPI_Status status;
-		MPI_Init(&argc, &argv);
+		int byte_size = 0;
+		MPI_Probe(i, _tag, MPI_COMM_WORLD, &status);
+		MPI_Get_count(&status, MPI_BYTE, &byte_size);
+		vector<char> dict_bytes(byte_size);
+		MPI_Recv(&dict_bytes[0], byte_size, MPI_BYTE, i, _tag, MPI_COMM_WORLD, &status);
+		byte_num += byte_size;
+		
+		PartialResBuffer dict_buf;
+		dict_buf.unpack(&dict_bytes[0]);
+		collectPartialResDict(dict_buf, IDURIMap);
+	}
+	return byte_num;
+}
 
-		MPI_Comm_rank(MPI_COMM_WORLD,&myRank);
-		MPI_Comm_size(MPI_COMM_WORLD,&p);
-        if(myRank == 0) {
-			double schedulingStart, schedulingEnd;
-			
-			string _query_str = Util::getQueryFromFile(argv[2]);
-			queryCharArr = new char[1024];
-			strcpy(queryCharArr, _query_str.c_str());
-			size = strlen(queryCharArr);
-			cout << "query : " << queryCharArr << endl;
-			/*
-			string query_file_str = string(argv[2]);
-			query_file_str = query_file_str.substr(query_file_str.find("/") + 1);
-			query_file_str = "log_" + query_file_str;
-			ofstream log_output(query_file_str.c_str());
-			string partial_res_str;
-			*/
-
-			for(i = 1; i < p; i++){
-				MPI_Send(&size, 1, MPI_INT, i, 10, MPI_COMM_WORLD);
-				MPI_Send(queryCharArr, size, MPI_CHAR, i, 10, MPI_COMM_WORLD);
+//a site: answer the strings of the global IDs asked by the coordinator that are stored in this site
+void
+sendFinalStrings(Database& _db, int _tag)
+{
+	MPI_Status status;
+	int id_num = 0;
+	MPI_Probe(0, _tag, MPI_COMM_WORLD, &status);
+	MPI_Get_count(&status, MPI_INT, &id_num);
+	vector<int> final_ids(id_num + 1);
+	MPI_Recv(&final_ids[0], id_num, MPI_INT, 0, _tag, MPI_COMM_WORLD, &status);
+	final_ids.resize(id_num);
+	if(id_num == 0)
+		return;
+	
+	PartialResBuffer dict_buf;
+	dict_buf.id_mode = PartialResBuffer::GLOBAL_ID;
+	_db.getGlobalIDStrings(final_ids, dict_buf);
+	vector<char> dict_bytes(dict_buf.getPackedSize());
+	dict_buf.pack(&dict_bytes[0]);
+	MPI_Send(&dict_bytes[0], dict_bytes.size(), MPI_BYTE, 0, _tag, MPI_COMM_WORLD);
+}
+
+//a site: after the representatives of its LEC classes are sent, send the members of the classes asked by the coordinator
+void
+sendLECMembers(const PartialResLEC& _lpm_lec, map<int, string>& _id_str_map, int _id_mode, int _tag)
+{
+	MPI_Status status;
+	int class_num = 0;
+	MPI_Probe(0, _tag, MPI_COMM_WORLD, &status);
+	MPI_Get_count(&status, MPI_INT, &class_num);
+	vector<int> class_ids(class_num + 1);
+	MPI_Recv(&class_ids[0], class_num, MPI_INT, 0, _tag, MPI_COMM_WORLD, &status);
+	class_ids.resize(class_num);
+	
+	PartialResBuffer members(_lpm_lec.getVarNum());
+	vector<int> member_nums;
+	_lpm_lec.getMembers(class_ids, members, member_nums);
+	if(_id_mode == PartialResBuffer::LOCAL_ID)
+		fillPartialResDict(members, _id_str_map);
+	members.id_mode = _id_mode;
+	vector<char> member_bytes(members.getPackedSize());
+	members.pack(&member_bytes[0]);
+	
+	member_nums.push_back(0);
+	MPI_Send(&member_nums[0], class_num, MPI_INT, 0, _tag, MPI_COMM_WORLD);
+	MPI_Send(&member_bytes[0], member_bytes.size(), MPI_BYTE, 0, _tag, MPI_COMM_WORLD);
+}
+
+//the coordinator: ask each site for the members of its classes in the complete matches of representatives
+//_rep_set, the members of class _class_ids[i] are the rows _member_begins[i].._member_begins[i+1]-1 of _members
+//in the IDs of the coordinator, return the bytes received
+long long
+recvLECMembers(const MatchRowSet& _rep_set, int p, int _tag, int _id_mode, map<string, int>& URIIDMap, map<int, string>& IDURIMap, int& id_count, vector<int>& _class_ids, vector<int>& _member_begins, PartialResBuffer& _members)
+{
+	int i, j, var_num = _members.var_num, site_num = p - 1;
+	long long byte_num = 0;
+	vector< vector<int> > site_class_ids(p);
+	set<int> class_set;
+	for(i = 0; i < _rep_set.size(); i++){
+		const int* rep_row = _rep_set.getRow(i);
+		for(j = 0; j < var_num; j++){
+			if(PartialResLEC::isClassID(rep_row[j]) && class_set.insert(rep_row[j]).second)
+				site_class_ids[PartialResLEC::getClassSite(rep_row[j], site_num) + 1].push_back(rep_row[j]);
+		}
+	}
+	for(i = 1; i < p; i++){
+		site_class_ids[i].push_back(0);
+		MPI_Send(&site_class_ids[i][0], site_class_ids[i].size() - 1, MPI_INT, i, _tag, MPI_COMM_WORLD);
+		site_class_ids[i].pop_back();
+	}
+	
+	_class_ids.clear();
+	_member_begins.assign(1, 0);
+	vector<int> member_nums, local2coord, coord_ids(var_num);
+	for(i = 1; i < p; i++){
+		MPI_Status status;
+		int class_num = site_class_ids[i].size(), byte_size = 0;
+		member_nums.resize(class_num + 1);
+		MPI_Recv(&member_nums[0], class_num, MPI_INT, i, _tag, MPI_COMM_WORLD, &status);
+		MPI_Probe(i, _tag, MPI_COMM_WORLD, &status);
+		MPI_Get_count(&status, MPI_BYTE, &byte_size);
+		vector<char> member_bytes(byte_size);
+		MPI_Recv(&member_bytes[0], byte_size, MPI_BYTE, i, _tag, MPI_COMM_WORLD, &status);
+		byte_num += byte_size;
+		
+		PartialResBuffer member_buf;
+		member_buf.unpack(&member_bytes[0]);
+		if(_id_mode == PartialResBuffer::LOCAL_ID)
+			getCoordIDs(member_buf, URIIDMap, IDURIMap, id_count, local2coord);
+		for(j = 0; j < member_buf.row_num; j++){
+			const int* row = member_buf.getRow(j);
+			for(int k = 0; k < var_num; k++){
+				coord_ids[k] = row[k] < 0 || _id_mode == PartialResBuffer::GLOBAL_ID ? row[k] : local2coord[member_buf.getDictIndex(row[k])];
 			}
-			partialResStart = MPI_Wtime();
-			printf("The query has been sent!\n");
-			
-			ResultSet _result_set;
-			int PPQueryVertexCount = -1, vec_size = 0, star_tag = 0;
-			QueryTree::QueryForm query_form = QueryTree::Ask_Query;
-			GeneralEvaluation parser_evaluation(NULL, NULL, NULL);
-			vector< vector<int> > _query_adjacent_list;
-			
-			parser_evaluation.onlyParseQuery(_query_str, PPQueryVertexCount, query_form, star_tag, _query_adjacent_list);
+			_members.addPackedRow(&coord_ids[0], member_buf.getTagRow(j));
+		}
+		for(j = 0; j < class_num; j++){
+			_class_ids.push_back(site_class_ids[i][j]);
+			_member_begins.push_back(_member_begins.back() + member_nums[j]);
+		}
+	}
+	
+	return byte_num;
+}
+
+//_send_buf_vec[i] is sent to the i-th site of _comm and cleared, the rows are of global IDs and go
+//without strings, the received rows are appended to _recv_buf
+int
+exchangePartialRes(vector<PartialResBuffer>& _send_buf_vec, PartialResBuffer& _recv_buf, MPI_Comm _comm)
+{
+	int site_num = _send_buf_vec.size(), recv_size = 0;
+	vector<int> send_counts(site_num), send_displs(site_num), recv_counts(site_num), recv_displs(site_num);
+	vector<char> send_bytes;
+	for(int i = 0; i < site_num; i++){
+		send_displs[i] = send_bytes.size();
+		send_counts[i] = _send_buf_vec[i].getPackedSize();
+		send_bytes.resize(send_bytes.size() + send_counts[i]);
+		_send_buf_vec[i].pack(&send_bytes[send_displs[i]]);
+		_send_buf_vec[i].clear();
+	}
+	
+	MPI_Alltoall(&send_counts[0], 1, MPI_INT, &recv_counts[0], 1, MPI_INT, _comm);
+	for(int i = 0; i < site_num; i++){
+		recv_displs[i] = recv_size;
+		recv_size += recv_counts[i];
+	}
+	vector<char> recv_bytes(recv_size);
+	MPI_Alltoallv(&send_bytes[0], &send_counts[0], &send_displs[0], MPI_BYTE, &recv_bytes[0], &recv_counts[0], &recv_displs[0], MPI_BYTE, _comm);
+	
+	for(int i = 0; i < site_num; i++){
+		PartialResBuffer res_buf;
+		res_buf.unpack(&recv_bytes[recv_displs[i]]);
+		for(int j = 0; j < res_buf.row_num; j++){
+			_recv_buf.addPackedRow(res_buf.getRow(j), res_buf.getTagRow(j));
+		}
+	}
+	
+	return send_bytes.size();
+}
+
+//drop the LPMs with an extended vertex matched as internal by no LPM of any site at the same query
+//vertex, which can never be joined; the internal vertices of each query vertex are kept in a Bloom
+//filter of each site, and the filters are merged among the sites, return the number of rows dropped
+int
+pruneByBloomFilter(vector<PartialResBuffer>& lpm_buf_vec, int var_num, MPI_Comm worker_comm)
+{
+	int i, j, k, drop_num = 0;
+	vector<int> internal_num(var_num, 0);
+	for(i = 0; i < lpm_buf_vec.size(); i++){
+		for(j = 0; j < lpm_buf_vec[i].row_num; j++){
+			for(k = 0; k < var_num; k++){
+				if(lpm_buf_vec[i].getTagValue(j, k) == PartialResBuffer::TAG_INTERNAL)
+					internal_num[k]++;
+			}
+		}
+	}
+	//the filters of all sites have the same length since they are built with the same key num
+	MPI_Allreduce(MPI_IN_PLACE, &internal_num[0], var_num, MPI_INT, MPI_SUM, worker_comm);
+	
+	vector<BloomFilter*> filters(var_num);
+	for(k = 0; k < var_num; k++){
+		filters[k] = new BloomFilter(internal_num[k]);
+	}
+	for(i = 0; i < lpm_buf_vec.size(); i++){
+		for(j = 0; j < lpm_buf_vec[i].row_num; j++){
+			const int* row = lpm_buf_vec[i].getRow(j);
+			for(k = 0; k < var_num; k++){
+				if(lpm_buf_vec[i].getTagValue(j, k) == PartialResBuffer::TAG_INTERNAL)
+					filters[k]->addRecord(row[k]);
+			}
+		}
+	}
+	for(k = 0; k < var_num; k++){
+		MPI_Allreduce(MPI_IN_PLACE, filters[k]->getBits(), filters[k]->getLength() / 8, MPI_BYTE, MPI_BOR, worker_comm);
+	}
+	
+	for(i = 0; i < lpm_buf_vec.size(); i++){
+		PartialResBuffer& lpm_buf = lpm_buf_vec[i];
+		PartialResBuffer kept_buf(var_num);
+		kept_buf.id_mode = lpm_buf.id_mode;
+		for(j = 0; j < lpm_buf.row_num; j++){
+			const int* row = lpm_buf.getRow(j);
+			for(k = 0; k < var_num; k++){
+				if(lpm_buf.getTagValue(j, k) == PartialResBuffer::TAG_EXTENDED && !filters[k]->checkRecord(row[k]))
+					break;
+			}
+			if(k == var_num)
+				kept_buf.addPackedRow(row, lpm_buf.getTagRow(j));
+			else
+				drop_num++;
+		}
+		lpm_buf.swap(kept_buf);
+	}
+	
+	for(k = 0; k < var_num; k++){
+		delete filters[k];
+	}
+	return drop_num;
+}
+
+//assemble the LPMs of all sites among the sites themselves, in the same join order and with the same
+//joins as the coordinator, the LPMs of each step are repartitioned by the vertex they are joined on
+void
+distributedAssembly(vector<PartialResBuffer>& lpm_buf_vec, vector< vector<int> >& _query_adjacent_list, int var_num, int thread_num, MPI_Comm worker_comm, MatchRowSet& finalResSet)
+{
+	int worker_num = 0, i, j;
+	long long sizeSum = 0;
+	MPI_Comm_size(worker_comm, &worker_num);
+	
+	PartialResBuffer lpm_arena(var_num);
+	vector< vector<int> > internal_rows(var_num);
+	for(i = 0; i < lpm_buf_vec.size(); i++){
+		for(j = 0; j < lpm_buf_vec[i].row_num; j++){
+			if(lpm_buf_vec[i].isFinalRow(j)){
+				finalResSet.insert(lpm_buf_vec[i].getRow(j));
+				continue;
+			}
+			for(int k = 0; k < var_num; k++){
+				if(lpm_buf_vec[i].getTagValue(j, k) == PartialResBuffer::TAG_INTERNAL)
+					internal_rows[k].push_back(lpm_arena.row_num);
+			}
+			lpm_arena.addPackedRow(lpm_buf_vec[i].getRow(j), lpm_buf_vec[i].getTagRow(j));
+		}
+		lpm_buf_vec[i].clear();
+	}
+	vector<int> res_num_vec(var_num);
+	for(i = 0; i < var_num; i++){
+		res_num_vec[i] = internal_rows[i].size();
+	}
+	MPI_Allreduce(MPI_IN_PLACE, &res_num_vec[0], var_num, MPI_INT, MPI_SUM, worker_comm);
+	
+	vector<int> join_order_vec = Util::findJoinOrder(res_num_vec, _query_adjacent_list);
+	PartialResBuffer cur_res(var_num);
+	for(i = 0; i < internal_rows[join_order_vec[0]].size(); i++){
+		int row_id = internal_rows[join_order_vec[0]][i];
+		cur_res.addPackedRow(lpm_arena.getRow(row_id), lpm_arena.getTagRow(row_id));
+	}
+	
+	vector<int> match_pos_vec(1, join_order_vec[0]), cand_rows;
+	vector<PartialResBuffer> send_buf_vec(worker_num, PartialResBuffer(var_num));
+	PartialResJoin res_join(thread_num);
+	for(i = 1; i < var_num; i++){
+		int match_pos = join_order_vec[i];
+		PartialResJoin::getCandidates(lpm_arena, internal_rows[match_pos], match_pos_vec, cand_rows);
+		match_pos_vec.push_back(match_pos);
+		int cand_num = cand_rows.size();
+		MPI_Allreduce(MPI_IN_PLACE, &cand_num, 1, MPI_INT, MPI_SUM, worker_comm);
+		if(cand_num == 0)
+			continue;
+		
+		//the candidates go to the owner of their vertex at match_pos
+		for(j = 0; j < cand_rows.size(); j++){
+			const int* row = lpm_arena.getRow(cand_rows[j]);
+			send_buf_vec[getOwnerSite(row[match_pos], worker_num)].addPackedRow(row, lpm_arena.getTagRow(cand_rows[j]));
+		}
+		PartialResBuffer cand_res(var_num);
+		sizeSum += exchangePartialRes(send_buf_vec, cand_res, worker_comm);
+		
+		//so do the intermediate results not internal at match_pos, the others stay
+		PartialResBuffer kept_res(var_num);
+		for(j = 0; j < cur_res.row_num; j++){
+			const int* row = cur_res.getRow(j);
+			if(cur_res.getTagValue(j, match_pos) == PartialResBuffer::TAG_INTERNAL)
+				kept_res.addPackedRow(row, cur_res.getTagRow(j));
+			else if(row[match_pos] != -1)
+				send_buf_vec[getOwnerSite(row[match_pos], worker_num)].addPackedRow(row, cur_res.getTagRow(j));
+		}
+		sizeSum += exchangePartialRes(send_buf_vec, kept_res, worker_comm);
+		cur_res.swap(kept_res);
+		
+		vector<int> all_rows(cand_res.row_num);
+		for(j = 0; j < cand_res.row_num; j++){
+			all_rows[j] = j;
+		}
+		res_join.build(cand_res, all_rows, match_pos);
+		res_join.join(cur_res, finalResSet);
+		
+		int cur_res_num = cur_res.row_num;
+		MPI_Allreduce(MPI_IN_PLACE, &cur_res_num, 1, MPI_INT, MPI_SUM, worker_comm);
+		if(cur_res_num == 0)
+			break;
+	}
+	
+	int myRank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &myRank);
+	printf("Client %d exchanges %lld bytes and finds %d final matches.\n", myRank, sizeSum, finalResSet.size());
+}
+
+//the queries are sent to the sites with QUERY_TAG, each with the slot it is evaluated in, and the
+//results of the query in slot i are sent back with RES_TAG + i, so queries in different slots are
+//evaluated and assembled at the same time
+static const int QUERY_TAG = 10;
+static const int RES_TAG = 11;
+
+//send a query to all sites in one message per site, so that queries sent by different threads
+//do not interleave, a query in slot -1 stops the sites
+void
+sendQuery(const string& _query_str, int _slot, int p)
+{
+	vector<char> query_bytes(sizeof(int));
+	memcpy(&query_bytes[0], &_slot, sizeof(int));
+	query_bytes.insert(query_bytes.end(), _query_str.begin(), _query_str.end());
+	for(int i = 1; i < p; i++){
+		MPI_Send(&query_bytes[0], query_bytes.size(), MPI_BYTE, i, QUERY_TAG, MPI_COMM_WORLD);
+	}
+}
+
+//receive the next query from the coordinator, return false if the site is stopped
+bool
+recvQuery(string& _query_str, int& _slot)
+{
+	MPI_Status status;
+	int size = 0;
+	MPI_Probe(0, QUERY_TAG, MPI_COMM_WORLD, &status);
+	MPI_Get_count(&status, MPI_BYTE, &size);
+	vector<char> query_bytes(size);
+	MPI_Recv(&query_bytes[0], size, MPI_BYTE, 0, QUERY_TAG, MPI_COMM_WORLD, &status);
+	
+	memcpy(&_slot, &query_bytes[0], sizeof(int));
+	_query_str.assign(query_bytes.begin() + sizeof(int), query_bytes.end());
+	return _slot >= 0;
+}
+
+//the coordinator: assemble the LPMs of a query sent to the sites at partialResStart,
+//and write the answer of an ASK query or the final matches of a SELECT query to _res_output
+void
+coordinateQuery(const string& _query_str, int p, bool distributed_assembly, bool lec, int thread_num, double partialResStart, int _tag, ostream& _res_output)
+{
+	int size, i, j, k, l = 0;
+	double partialResEnd, schedulingEnd;
+	char* partialResArr;
+	MPI_Status status;
+	
+	ResultSet _result_set;
+	int PPQueryVertexCount = -1, vec_size = 0, star_tag = 0;
+	QueryTree::QueryForm query_form = QueryTree::Ask_Query;
+	GeneralEvaluation parser_evaluation(NULL, NULL, NULL);
+	vector< vector<int> > _query_adjacent_list;
+	
+	parser_evaluation.onlyParseQuery(_query_str, PPQueryVertexCount, query_form, star_tag, _query_adjacent_list);
+	
+	if(query_form == QueryTree::Ask_Query){
+	
+		int fullTag = 0, partialResNum = 0, ask_query_res_tag = 0;
+		unsigned long long sizeSum = 0;
+		fullTag = (1 << PPQueryVertexCount) - 1;
+		printf("PPQueryVertexCount = %d and fullTag = %d\n", PPQueryVertexCount, fullTag);
+		vector<CrossingEdgeMappingVec> intermediate_results_vec(fullTag + 1);
+		for(int i = 0; i < intermediate_results_vec.size(); i++){
+			intermediate_results_vec[i].tag = i;
+		}
+		
+		//ofstream log_output("log.txt");
+		
+		for(int pInt = 1; pInt < p; pInt++){
+			MPI_Recv(&vec_size, 1, MPI_INT, pInt, _tag, MPI_COMM_WORLD, &status);
 			
-			if(query_form == QueryTree::Ask_Query){
+			for(int vecIdx = 0; vecIdx < vec_size; vecIdx++){
 			
-				int fullTag = 0, partialResNum = 0, ask_query_res_tag = 0;
-				unsigned long long sizeSum = 0;
-				fullTag = (1 << PPQueryVertexCount) - 1;
-				printf("PPQueryVertexCount = %d and fullTag = %d\n", PPQueryVertexCount, fullTag);
-				vector<CrossingEdgeMappingVec> intermediate_results_vec(fullTag + 1);
-				for(int i = 0; i < intermediate_results_vec.size(); i++){
-					intermediate_results_vec[i].tag = i;
-				}
+				MPI_Recv(&size, 1, MPI_INT, pInt, _tag, MPI_COMM_WORLD, &status);
+				sizeSum += size;
+				partialResArr = new char[size + 3];
+				MPI_Recv(partialResArr, size, MPI_CHAR, pInt, _tag, MPI_COMM_WORLD, &status);
+				partialResArr[size] = 0;
 				
-				//ofstream log_output("log.txt");
+				//log_output << "++++++++++++ " << pInt << " ++++++++++++" << endl;
+				//log_output << partialResArr << endl;
 				
-				for(int pInt = 1; pInt < p; pInt++){
-					MPI_Recv(&vec_size, 1, MPI_INT, pInt, 10, MPI_COMM_WORLD, &status);
+				string textline(partialResArr);
+				vector<string> resVec = Util::split(textline, "\n");
+				partialResNum += resVec.size();
+				//printf("processs %d : %s\n", pInt, resVec[0].c_str());
+				for(i = 0; i < resVec.size(); i++){
+					//curPartialResSize = resVec[i].length();
+					vector<string> matchVec = Util::split(resVec[i], "\t");
+					if((matchVec.size() % 4) != 1)
+						continue;
+						
+					if(star_tag == 1){
+						ask_query_res_tag = 1;
+						break;
+					}
 					
-					for(int vecIdx = 0; vecIdx < vec_size; vecIdx++){
+					l = 0;
+					for(k = 0; k < matchVec[matchVec.size() - 1].size(); k++)
+					{
+						l = l * 2 + matchVec[matchVec.size() - 1].at(k) - '0';
+					}
 					
-						MPI_Recv(&size, 1, MPI_INT, pInt, 10, MPI_COMM_WORLD, &status);
-						sizeSum += size;
-						partialResArr = new char[size + 3];
-						MPI_Recv(partialResArr, size, MPI_CHAR, pInt, 10, MPI_COMM_WORLD, &status);
-						partialResArr[size] = 0;
-						
-						//log_output << "++++++++++++ " << pInt << " ++++++++++++" << endl;
-						//log_output << partialResArr << endl;
-						
-						string textline(partialResArr);
-						vector<string> resVec = Util::split(textline, "\n");
-						partialResNum += resVec.size();
-						//printf("processs %d : %s\n", pInt, resVec[0].c_str());
-						for(i = 0; i < resVec.size(); i++){
-							//curPartialResSize = resVec[i].length();
-							vector<string> matchVec = Util::split(resVec[i], "\t");
-							if((matchVec.size() % 4) != 1)
-								continue;
-								
-							if(star_tag == 1){
-								ask_query_res_tag = 1;
-								break;
-							}
-							
-							l = 0;
-							for(k = 0; k < matchVec[matchVec.size() - 1].size(); k++)
-							{
-								l = l * 2 + matchVec[matchVec.size() - 1].at(k) - '0';
-							}
-							
-							LEC curLEC;
-							
-							//printf("%s %d maps to tag %d\n", matchVec[matchVec.size() - 1].c_str(), pInt, l); 
-							for(j = matchVec.size() - 2; j >= 0; j -= 4){
-								CrossingEdgeMapping curCrossingEdgeMapping;
-								curCrossingEdgeMapping.tail_query_id = atoi(matchVec[j - 2].c_str());
-								curCrossingEdgeMapping.head_query_id = atoi(matchVec[j - 3].c_str());
-								curCrossingEdgeMapping.mapping_str = matchVec[j] + "\t" + matchVec[j - 1];
-								curCrossingEdgeMapping.fragmentID = pInt;
-								curLEC.CrossingEdgeMappings.push_back(curCrossingEdgeMapping);
-							}
-							intermediate_results_vec[l].LECVec.push_back(curLEC);
-						}
-
-						delete[] partialResArr;
+					LEC curLEC;
+					
+					//printf("%s %d maps to tag %d\n", matchVec[matchVec.size() - 1].c_str(), pInt, l); 
+					for(j = matchVec.size() - 2; j >= 0; j -= 4){
+						CrossingEdgeMapping curCrossingEdgeMapping;
+						curCrossingEdgeMapping.tail_query_id = atoi(matchVec[j - 2].c_str());
+						curCrossingEdgeMapping.head_query_id = atoi(matchVec[j - 3].c_str());
+						curCrossingEdgeMapping.mapping_str = matchVec[j] + "\t" + matchVec[j - 1];
+						curCrossingEdgeMapping.fragmentID = pInt;
+						curLEC.CrossingEdgeMappings.push_back(curCrossingEdgeMapping);
 					}
+					intermediate_results_vec[l].LECVec.push_back(curLEC);
 				}
 
-				partialResEnd = MPI_Wtime();
+				delete[] partialResArr;
+			}
+		}
+
+		partialResEnd = MPI_Wtime();
 
-				// If there no exist partial match, the process terminate
-				double time_cost_value = partialResEnd - partialResStart;
-				printf("Communication cost %f s with %lld size!\n", time_cost_value, sizeSum);
-				printf("There are %d LEC features.\n", partialResNum);
-				//printf("There are %d inner matches.\n", finalPartialResSet.size());
-				
-				schedulingStart = MPI_Wtime();
-				map< int, vector<int> > query_adjacent_list;
+		// If there no exist partial match, the process terminate
+		double time_cost_value = partialResEnd - partialResStart;
+		printf("Communication cost %f s with %lld size!\n", time_cost_value, sizeSum);
+		printf("There are %d LEC features.\n", partialResNum);
+		//printf("There are %d inner matches.\n", finalPartialResSet.size());
+		
+		map< int, vector<int> > query_adjacent_list;
 
-				for(int i = 0; i < intermediate_results_vec.size(); i++){
-					if(intermediate_results_vec[i].LECVec.size() == 0){
-						continue;
+		for(int i = 0; i < intermediate_results_vec.size(); i++){
+			if(intermediate_results_vec[i].LECVec.size() == 0){
+				continue;
+			}
+			for(int j = i + 1; j < intermediate_results_vec.size(); j++){
+				if(intermediate_results_vec[j].LECVec.size() == 0){
+					continue;
+				}
+				if(Util::checkJoinable(intermediate_results_vec[i], intermediate_results_vec[j])){
+					if(query_adjacent_list.count(i) == 0){
+						vector<int> vec1;
+						query_adjacent_list.insert(make_pair(i, vec1));
 					}
-					for(int j = i + 1; j < intermediate_results_vec.size(); j++){
-						if(intermediate_results_vec[j].LECVec.size() == 0){
-							continue;
-						}
-						if(Util::checkJoinable(intermediate_results_vec[i], intermediate_results_vec[j])){
-							if(query_adjacent_list.count(i) == 0){
-								vector<int> vec1;
-								query_adjacent_list.insert(make_pair(i, vec1));
-							}
-							if(query_adjacent_list.count(j) == 0){
-								vector<int> vec1;
-								query_adjacent_list.insert(make_pair(j, vec1));
-							}
-							query_adjacent_list[i].push_back(j);
-							query_adjacent_list[j].push_back(i);
-						}
+					if(query_adjacent_list.count(j) == 0){
+						vector<int> vec1;
+						query_adjacent_list.insert(make_pair(j, vec1));
 					}
+					query_adjacent_list[i].push_back(j);
+					query_adjacent_list[j].push_back(i);
 				}
+			}
+		}
+		
+		for(int i = 0; i < intermediate_results_vec.size(); i++){
+			if(query_adjacent_list.count(i) == 0){
+				continue;
+			}
+			
+			//printf("%d begin to search ! \n", i);
+			queue< vector<int> > bfs_queue;
+			queue<CrossingEdgeMappingVec> res_queue;
+			vector<int> tmp_vec(1, i);
+			bfs_queue.push(tmp_vec);
+			res_queue.push(intermediate_results_vec[i]);
+			while(bfs_queue.size()){
+				vector<int> cur_bfs_state = bfs_queue.front();
+				bfs_queue.pop();
 				
-				for(int i = 0; i < intermediate_results_vec.size(); i++){
-					if(query_adjacent_list.count(i) == 0){
+				CrossingEdgeMappingVec tmpCrossingEdgeMappingVec = res_queue.front();
+				res_queue.pop();
+				
+				int cur_mapping_vec_id = cur_bfs_state[cur_bfs_state.size() - 1];
+				for(int j = 0; j < query_adjacent_list[cur_mapping_vec_id].size(); j++){
+					if(query_adjacent_list[cur_mapping_vec_id][j] <= i || find(cur_bfs_state.begin(), cur_bfs_state.end(), query_adjacent_list[cur_mapping_vec_id][j]) != cur_bfs_state.end())
 						continue;
-					}
 					
-					//printf("%d begin to search ! \n", i);
-					queue< vector<int> > bfs_queue;
-					queue<CrossingEdgeMappingVec> res_queue;
-					vector<int> tmp_vec(1, i);
-					bfs_queue.push(tmp_vec);
-					res_queue.push(intermediate_results_vec[i]);
-					while(bfs_queue.size()){
-						vector<int> cur_bfs_state = bfs_queue.front();
-						bfs_queue.pop();
-						
-						CrossingEdgeMappingVec tmpCrossingEdgeMappingVec = res_queue.front();
-						res_queue.pop();
+					if(Util::checkJoinable(tmpCrossingEdgeMappingVec, intermediate_results_vec[query_adjacent_list[cur_mapping_vec_id][j]])){
+						CrossingEdgeMappingVec newCrossingEdgeMappingVec;
+						Util::HashLECFJoin(newCrossingEdgeMappingVec, tmpCrossingEdgeMappingVec, intermediate_results_vec[query_adjacent_list[cur_mapping_vec_id][j]]);
 						
-						int cur_mapping_vec_id = cur_bfs_state[cur_bfs_state.size() - 1];
-						for(int j = 0; j < query_adjacent_list[cur_mapping_vec_id].size(); j++){
-							if(query_adjacent_list[cur_mapping_vec_id][j] <= i || find(cur_bfs_state.begin(), cur_bfs_state.end(), query_adjacent_list[cur_mapping_vec_id][j]) != cur_bfs_state.end())
-								continue;
+						if(newCrossingEdgeMappingVec.LECVec.size() != 0){
+							vector<int> new_state(cur_bfs_state);
+							new_state.push_back(query_adjacent_list[cur_mapping_vec_id][j]);
+							bfs_queue.push(new_state);
+							res_queue.push(newCrossingEdgeMappingVec);
 							
-							if(Util::checkJoinable(tmpCrossingEdgeMappingVec, intermediate_results_vec[query_adjacent_list[cur_mapping_vec_id][j]])){
-								CrossingEdgeMappingVec newCrossingEdgeMappingVec;
-								Util::HashLECFJoin(newCrossingEdgeMappingVec, tmpCrossingEdgeMappingVec, intermediate_results_vec[query_adjacent_list[cur_mapping_vec_id][j]]);
-								
-								if(newCrossingEdgeMappingVec.LECVec.size() != 0){
-									vector<int> new_state(cur_bfs_state);
-									new_state.push_back(query_adjacent_list[cur_mapping_vec_id][j]);
-									bfs_queue.push(new_state);
-									res_queue.push(newCrossingEdgeMappingVec);
-									
-									if(newCrossingEdgeMappingVec.tag == fullTag){
-										break;
-									}
-								}
+							if(newCrossingEdgeMappingVec.tag == fullTag){
+								break;
 							}
 						}
-						
-						if(res_queue.size() == 0 || res_queue.back().tag == fullTag){
-							break;
-						}
-					}
-					
-					if(res_queue.size() != 0 && res_queue.back().tag == fullTag){
-						ask_query_res_tag = 1; 
-						break;
 					}
 				}
 				
-				schedulingEnd = MPI_Wtime();
-				printf("Total cost %f s!\n", (schedulingEnd - partialResStart));
-				
-				if(ask_query_res_tag)
-					printf("true.\n");
-				else
-					printf("false.\n");
+				if(res_queue.size() == 0 || res_queue.back().tag == fullTag){
+					break;
+				}
+			}
+			
+			if(res_queue.size() != 0 && res_queue.back().tag == fullTag){
+				ask_query_res_tag = 1; 
+				break;
+			}
+		}
+		
+		schedulingEnd = MPI_Wtime();
+		printf("Total cost %f s!\n", (schedulingEnd - partialResStart));
+		
+		if(ask_query_res_tag)
+			printf("true.\n");
+		else
+			printf("false.\n");
+		_res_output << (ask_query_res_tag ? "true" : "false") << endl;
+	}else{
+	
+		map<string, int> URIIDMap;
+		map<int, string> IDURIMap;
+		int id_count = 0, id_mode = -1;
+		int partialResNum = 0, finalResNum = 0, aResNum = 0;
+		unsigned long long sizeSum = 0;
+		MatchRowSet finalResSet(PPQueryVertexCount);
+		
+		//all LPMs in one arena, internal_rows[i] are the LPMs internal at the i-th query vertex
+		PartialResBuffer lpm_arena(PPQueryVertexCount);
+		vector< vector<int> > internal_rows(PPQueryVertexCount);
+		vector<int> coord_ids(PPQueryVertexCount);
+		ofstream log_output("log.txt");
+
+		//the chunks are decoded and indexed in the order they arrive from any site, the next chunk
+		//is received into the other buffer while the current one is decoded
+		vector<char> recv_bytes[2];
+		vector<int> client_res_num(p, 0), client_final_num(p, 0);
+		MPI_Request recv_request = MPI_REQUEST_NULL;
+		int cur_buf = 0, active_num = p - 1, recv_src = -1;
+		if(active_num > 0)
+			postChunkRecv(recv_bytes[cur_buf], recv_request, recv_src, true, _tag);
+		while(active_num > 0){
+			MPI_Wait(&recv_request, &status);
+			int pInt = recv_src, chunk_size = recv_bytes[cur_buf].size();
+			if(chunk_size == 0)
+				active_num--;
+			int recv_posted = 0;
+			if(active_num > 0)
+				recv_posted = postChunkRecv(recv_bytes[1 - cur_buf], recv_request, recv_src, false, _tag);
+			
+			PartialResBuffer lpm_buf;
+			if(chunk_size == 0){
+				printf("There are %d partial results and %d final results in Client %d!\n", client_res_num[pInt], client_final_num[pInt], pInt);
 			}else{
+				sizeSum += chunk_size;
+				lpm_buf.unpack(&recv_bytes[cur_buf][0]);
+			}
 			
-				map<string, int> URIIDMap;
-				map<int, string> IDURIMap;
-				int id_count = 0, cur_id = 0;
-				int partialResNum = 0, finalResNum = 0, aResNum = 0, vec_size = 0;
-				unsigned long long sizeSum = 0;
-				set< vector<int> > finalPartialResSet;
+			if(lpm_buf.var_num != PPQueryVertexCount)
+				lpm_buf.clear();
+			//local IDs and global IDs can not be joined together
+			if(lpm_buf.row_num > 0 && id_mode == -1){
+				id_mode = lpm_buf.id_mode;
+			}else if(lpm_buf.row_num > 0 && id_mode != lpm_buf.id_mode){
+				cerr << "site " << pInt << " sends partial matches of another ID mode, please reload the database with gloadD." << endl;
+				lpm_buf.clear();
+			}
+			
+			if(lpm_buf.row_num > 0){
+				aResNum = 0;
+				finalResNum = finalResSet.size();
+				vector<int> local2coord;
+				if(id_mode == PartialResBuffer::LOCAL_ID)
+					getCoordIDs(lpm_buf, URIIDMap, IDURIMap, id_count, local2coord);
 				
-				vector< PPPartialResVec > partialResVec(PPQueryVertexCount);
-				for(i = 0; i < partialResVec.size(); i++){
-					partialResVec[i].match_pos = i;
-				}
-				ofstream log_output("log.txt");
-
-				for(int pInt = 1; pInt < p; pInt++){
-					MPI_Recv(&vec_size, 1, MPI_INT, pInt, 10, MPI_COMM_WORLD, &status);
-					aResNum = 0;
-					for(int vecIdx = 0; vecIdx < vec_size; vecIdx++){
-						MPI_Recv(&size, 1, MPI_INT, pInt, 10, MPI_COMM_WORLD, &status);
-						sizeSum += size;
-						partialResArr = new char[size + 3];
-						MPI_Recv(partialResArr, size, MPI_CHAR, pInt, 10, MPI_COMM_WORLD, &status);
-						partialResArr[size] = 0;
-						
-						//printf("++++++++++++ %d ++++++++++++\n%s\n", pInt, partialResArr);
-						//log_output << "++++++++++++ " << pInt << " ++++++++++++" << endl;
-						//log_output << partialResArr << endl;
-						//partial_res_str = string(partialResArr);
-						
-						string textline(partialResArr);
-						vector<string> resVec = Util::split(textline, "\n");
-						for(i = 0; i < resVec.size(); i++){
-							//curPartialResSize = resVec[i].length();
-							vector<string> matchVec = Util::split(resVec[i], "\t");
-							if(matchVec.size() != PPQueryVertexCount)
-								continue;
-							PPPartialRes newPPPartialRes;
-							
-							if(star_tag == 1){
-								for(j = 0; j < matchVec.size(); j++){
-									newPPPartialRes.TagVec.push_back('1');
-									if(URIIDMap.count(matchVec[j]) == 0){
-										URIIDMap.insert(make_pair(matchVec[j], id_count));
-										IDURIMap.insert(make_pair(id_count, matchVec[j]));
-										id_count++;
-									}
-									cur_id = URIIDMap[matchVec[j]];
-									newPPPartialRes.MatchVec.push_back(cur_id);
-								}
-								finalPartialResSet.insert(newPPPartialRes.MatchVec);
-								continue;
-							}
-							
-							vector<int> match_pos_vec;
-							for(j = 0; j < matchVec.size(); j++){
-								if(strcmp(matchVec[j].c_str(),"-1") != 0){
-									newPPPartialRes.TagVec.push_back(matchVec[j].at(0));
-									matchVec[j].erase(0, 1);
-
-									if(URIIDMap.count(matchVec[j]) == 0){
-										URIIDMap.insert(make_pair(matchVec[j], id_count));
-										IDURIMap.insert(make_pair(id_count, matchVec[j]));
-										id_count++;
-									}
-									cur_id = URIIDMap[matchVec[j]];
-								}else{
-									newPPPartialRes.TagVec.push_back('2');
-									cur_id = -1;
-								}
-								newPPPartialRes.MatchVec.push_back(cur_id);
-								
-								if('1' == newPPPartialRes.TagVec[newPPPartialRes.TagVec.size() - 1])
-									match_pos_vec.push_back(j);
-							}
-							newPPPartialRes.FragmentID = pInt;
-							newPPPartialRes.ID = partialResNum;
-
-							if(0 == Util::isFinalResult(newPPPartialRes)){
-								for(j = 0; j < match_pos_vec.size(); j++){
-									partialResVec[match_pos_vec[j]].PartialResList.push_back(newPPPartialRes);
-								}
-								aResNum++;
-								partialResNum++;
-							}else{
-								finalPartialResSet.insert(newPPPartialRes.MatchVec);
-								//finalResNum++;
-							}
-						}
-						delete[] partialResArr;
+				for(i = 0; i < lpm_buf.row_num; i++){
+					const int* row = lpm_buf.getRow(i);
+					for(j = 0; j < PPQueryVertexCount; j++){
+						//-1 and the class IDs of PartialResLEC are not in the dictionary
+						coord_ids[j] = row[j] < 0 || id_mode == PartialResBuffer::GLOBAL_ID ? row[j] : local2coord[lpm_buf.getDictIndex(row[j])];
 					}
-					printf("There are %d partial results and %d final results in Client %d!\n", aResNum, finalPartialResSet.size() - finalResNum, pInt);
-					finalResNum = finalPartialResSet.size();
-				}
-
-				partialResEnd = MPI_Wtime();
-
-				// If there no exist partial match, the process terminate
-				double time_cost_value = partialResEnd - partialResStart;
-				printf("Communication cost %f s!\n", time_cost_value);
-				printf("There are %d partial results with %lld size.\n", partialResNum, sizeSum);
-				printf("There are %d inner matches.\n", finalPartialResSet.size());
-				
-				schedulingStart = MPI_Wtime();
-				
-				map< int, vector<int> > partial_res_adjacent_list;
-				//stringstream adj_list_ss;
-
-				for(int i = 0; i < partialResVec.size(); i++){
-					if(partialResVec[i].PartialResList.size() == 0){
+					
+					if(star_tag == 1 || lpm_buf.isFinalRow(i)){
+						finalResSet.insert(&coord_ids[0]);
 						continue;
 					}
-					//adj_list_ss << i << " : ";
-					for(int j = i + 1; j < partialResVec.size(); j++){
-						if(partialResVec[j].PartialResList.size() == 0){
-							continue;
-						}
-						if(Util::checkJoinable(partialResVec[i], partialResVec[j], i, j) != -1){
-							if(partial_res_adjacent_list.count(i) == 0){
-								vector<int> vec1;
-								partial_res_adjacent_list.insert(make_pair(i, vec1));
-							}
-							if(partial_res_adjacent_list.count(j) == 0){
-								vector<int> vec1;
-								partial_res_adjacent_list.insert(make_pair(j, vec1));
-							}
-							partial_res_adjacent_list[i].push_back(j);
-							partial_res_adjacent_list[j].push_back(i);
-							//adj_list_ss << j << "\t";
-						}
-					}
 					
-					//adj_list_ss << endl;
+					for(j = 0; j < PPQueryVertexCount; j++){
+						if(lpm_buf.getTagValue(i, j) == PartialResBuffer::TAG_INTERNAL)
+							internal_rows[j].push_back(lpm_arena.row_num);
+					}
+					lpm_arena.addPackedRow(&coord_ids[0], lpm_buf.getTagRow(i));
+					aResNum++;
+					partialResNum++;
 				}
-				
-				vector<int> join_order_vec = Util::findJoinOrder(partialResVec, _query_adjacent_list);				
-				vector<int> match_pos_vec;
-				int tag = 0;
-				match_pos_vec.push_back(partialResVec[join_order_vec[0]].match_pos);
-				if(0 != partialResVec.size()){
-				
-					stringstream intermediate_strm;
+				client_res_num[pInt] += aResNum;
+				client_final_num[pInt] += finalResSet.size() - finalResNum;
+			}
+			
+			if(active_num > 0 && !recv_posted)
+				postChunkRecv(recv_bytes[1 - cur_buf], recv_request, recv_src, true, _tag);
+			cur_buf = 1 - cur_buf;
+		}
 
-					for(i = 1; i < partialResVec.size(); i++){
-						//cout << "###########  " << partialResVec[i].match_pos << endl;
-						
-						map<int, vector<PPPartialRes> > tmpPartialResMap;
-						for(j = 0; j < partialResVec[join_order_vec[i]].PartialResList.size(); j++){
-							tag = 0;
-							for(k = 0; k < match_pos_vec.size(); k++){
-								if('1' == partialResVec[join_order_vec[i]].PartialResList[j].TagVec[match_pos_vec[k]]){
-									tag = 1;
-									break;
-								}
-							}
-							if(0 == tag){
-								if(tmpPartialResMap.count(partialResVec[join_order_vec[i]].PartialResList[j].MatchVec[partialResVec[join_order_vec[i]].match_pos]) == 0){
-									vector<PPPartialRes> tmpVec;
-									tmpPartialResMap.insert(make_pair(partialResVec[join_order_vec[i]].PartialResList[j].MatchVec[partialResVec[join_order_vec[i]].match_pos], tmpVec));
-								}
-								tmpPartialResMap[partialResVec[join_order_vec[i]].PartialResList[j].MatchVec[partialResVec[join_order_vec[i]].match_pos]].push_back(partialResVec[join_order_vec[i]].PartialResList[j]);
-							}
-						}
-						match_pos_vec.push_back(partialResVec[join_order_vec[i]].match_pos);
-						if(tmpPartialResMap.size() == 0){					
-							continue;
-						}
-						
-						Util::HashJoin_old(finalPartialResSet, partialResVec[join_order_vec[0]].PartialResList, tmpPartialResMap, p, partialResVec[join_order_vec[i]].match_pos);
+		partialResEnd = MPI_Wtime();
 
-						if(partialResVec[join_order_vec[0]].PartialResList.size() == 0){
-							break;
-						}
-					}
+		// If there no exist partial match, the process terminate
+		double time_cost_value = partialResEnd - partialResStart;
+		printf("Communication cost %f s!\n", time_cost_value);
+		printf("There are %d partial results with %lld size.\n", partialResNum, sizeSum);
+		printf("There are %d inner matches.\n", finalResSet.size());
+		
+		
+		//the sites that assemble the LPMs among themselves send only complete matches, unless they
+		//fall back to sending LPMs of local IDs since some site has no global IDs
+		if(!distributed_assembly || id_mode == PartialResBuffer::LOCAL_ID){
+			vector<int> res_num_vec(PPQueryVertexCount);
+			for(i = 0; i < PPQueryVertexCount; i++){
+				res_num_vec[i] = internal_rows[i].size();
+			}
+			vector<int> join_order_vec = Util::findJoinOrder(res_num_vec, _query_adjacent_list);
+			
+			//the intermediate results start from the LPMs internal at the first vertex, then
+			//join the LPMs internal at each following vertex in turn
+			PartialResBuffer cur_res(PPQueryVertexCount);
+			for(i = 0; i < internal_rows[join_order_vec[0]].size(); i++){
+				int row_id = internal_rows[join_order_vec[0]][i];
+				cur_res.addPackedRow(lpm_arena.getRow(row_id), lpm_arena.getTagRow(row_id));
+			}
+			vector<int> match_pos_vec(1, join_order_vec[0]), cand_rows;
+			PartialResJoin res_join(thread_num);
+			for(i = 1; i < PPQueryVertexCount; i++){
+				int match_pos = join_order_vec[i];
+				PartialResJoin::getCandidates(lpm_arena, internal_rows[match_pos], match_pos_vec, cand_rows);
+				match_pos_vec.push_back(match_pos);
+				if(cand_rows.size() == 0){
+					continue;
 				}
 				
-				printf("There are %d final matches.\n", finalPartialResSet.size());
-				schedulingEnd = MPI_Wtime();
-				time_cost_value = schedulingEnd - partialResStart;
-				printf("Total cost %f s!\n", time_cost_value);
-				
-				//log_output << partial_res_str << endl;
-				ofstream res_output("finalRes.txt");
-				set< vector<int> >::iterator iter = finalPartialResSet.begin();
-				while(iter != finalPartialResSet.end()){
-					vector<int> tempVec = *iter;
-					for(l = 0; l < tempVec.size(); l++){
-						res_output << IDURIMap[tempVec[l]] << "\t";
-					}
-					res_output << endl;
-					//total_res_count++;
-					iter++;
+				res_join.build(lpm_arena, cand_rows, match_pos);
+				res_join.join(cur_res, finalResSet);
+				if(cur_res.row_num == 0){
+					break;
 				}
-				res_output.close();
 			}
-			
-		}else{
-			string db_folder = string(argv[1]);
-			Database _db(db_folder);
-			_db.load();
-			printf("Client %d finish loading!\n", myRank);
-			
-			//ofstream log_output_partial("log_partial.txt");
+		}
+		
+		//the complete matches of the LEC representatives are expanded by the members of their classes
+		MatchRowSet expandedResSet(PPQueryVertexCount);
+		const MatchRowSet* final_set = &finalResSet;
+		if(lec){
+			vector<int> class_ids, member_begins;
+			PartialResBuffer members(PPQueryVertexCount);
+			long long member_size = recvLECMembers(finalResSet, p, _tag, id_mode, URIIDMap, IDURIMap, id_count, class_ids, member_begins, members);
+			printf("There are %d complete matches of LEC representatives, with %d members of %d classes in %lld size.\n", finalResSet.size(), members.row_num, (int)class_ids.size(), member_size);
+			PartialResLEC::expand(finalResSet, PPQueryVertexCount, class_ids, member_begins, members, expandedResSet);
+			final_set = &expandedResSet;
+		}
+		
+		long long str_size = recvFinalStrings(*final_set, PPQueryVertexCount, p, _tag, id_mode, IDURIMap);
+		printf("There are %d final matches, with %d strings in %lld size.\n", final_set->size(), (int)IDURIMap.size(), str_size);
+		schedulingEnd = MPI_Wtime();
+		time_cost_value = schedulingEnd - partialResStart;
+		printf("Total cost %f s!\n", time_cost_value);
+		
+		for(i = 0; i < final_set->size(); i++){
+			const int* final_row = final_set->getRow(i);
+			for(l = 0; l < PPQueryVertexCount; l++){
+				_res_output << IDURIMap[final_row[l]] << "\t";
+			}
+			_res_output << endl;
+		}
+	}
+}
+
+//a site: evaluate a query on the local fragment, and send the LPMs, or the final matches
+//assembled among the sites, to the coordinator with _tag; each query is evaluated with its
+//own GeneralEvaluation and Join, so the queries of several threads run on _db at the same time
+void
+answerQuery(Database& _db, const string& _query_str, int myRank, bool distributed_assembly, bool bloom_filter, bool lec, int thread_num, int _tag, MPI_Comm worker_comm)
+{
+	int size;
+	double partialResStart = MPI_Wtime(), partialResEnd;
+	char* partialResArr;
 	
-			MPI_Recv(&size, 1, MPI_INT, 0, 10, MPI_COMM_WORLD, &status);
-			queryCharArr = new char[size];
-			MPI_Recv(queryCharArr, size, MPI_CHAR, 0, 10, MPI_COMM_WORLD, &status);
-			queryCharArr[size - 1] = 0;
+	int var_num = 0, star_tag = 0;
+	QueryTree::QueryForm query_form = QueryTree::Ask_Query;
+	GeneralEvaluation parser_evaluation(NULL, NULL, NULL);
+	vector< vector<int> > _query_adjacent_list;
+	parser_evaluation.onlyParseQuery(_query_str, var_num, query_form, star_tag, _query_adjacent_list);
+	
+	if(query_form == QueryTree::Ask_Query){
+		ResultSet _rs;
+		vector<string> all_lpm_str_vec;
+		vector<string> lpm_str_vec;
+		vector< vector<int> > res_crossing_edges_vec;
+		vector<int> all_crossing_edges_vec;
+		_db.queryCrossingEdge(_query_str, _rs, lpm_str_vec, res_crossing_edges_vec, all_crossing_edges_vec, myRank, stdout);
+		
+		stringstream all_lpm_ss;
+		for(int i = 0; i < lpm_str_vec.size(); i++){
+			all_lpm_ss << lpm_str_vec[i] << endl;
+		}
+		all_lpm_str_vec.push_back(all_lpm_ss.str());
+		
+		partialResEnd = MPI_Wtime();
+		
+		//============================= communication of partial results =============================
+		
+		double time_cost_value = partialResEnd - partialResStart;
+		printf("Finding local partial matches costs %f s in Client %d with vec_size = %d\n", time_cost_value, myRank, (int)all_lpm_str_vec.size());
+		
+		size = all_lpm_str_vec.size();
+		MPI_Send(&size, 1, MPI_INT, 0, _tag, MPI_COMM_WORLD);
+		for(int i = 0; i < all_lpm_str_vec.size(); i++){
+			partialResArr = new char[all_lpm_str_vec[i].size() + 3];
+			strcpy(partialResArr, all_lpm_str_vec[i].c_str());
+			size = strlen(partialResArr);
 			
-			//stringstream log_ss;
+			MPI_Send(&size, 1, MPI_INT, 0, _tag, MPI_COMM_WORLD);
+			MPI_Send(partialResArr, size, MPI_CHAR, 0, _tag, MPI_COMM_WORLD);
 			
-			partialResStart = MPI_Wtime();
-			string _query_str(queryCharArr);
+			delete[] partialResArr;
+		}
+	}else{
+		//the global IDs assigned by gloadD are used only if all sites have them
+		int global_id_tag = _db.hasGlobalIDs() ? 1 : 0;
+		MPI_Allreduce(MPI_IN_PLACE, &global_id_tag, 1, MPI_INT, MPI_MIN, worker_comm);
+		if(distributed_assembly && global_id_tag == 0 && myRank == 1)
+			cerr << "some site has no global IDs, the partial matches are assembled by the coordinator." << endl;
+		if(bloom_filter && global_id_tag == 0 && myRank == 1)
+			cerr << "some site has no global IDs, the partial matches are not pruned by Bloom filters." << endl;
+		
+		CoordinatorSink coord_sink(_tag);
+		distributed_assembly = distributed_assembly && global_id_tag == 1;
+		bloom_filter = bloom_filter && global_id_tag == 1;
+		if(distributed_assembly || bloom_filter || lec){
+			vector<PartialResBuffer> lpm_buf_vec;
+			PartialResVecSink vec_sink(lpm_buf_vec);
+			vec_sink.chunk_row_num = coord_sink.chunk_row_num;
+			_db.queryCrossingEdge(_query_str, vec_sink, global_id_tag == 1, myRank, stdout);
 			
-			ResultSet _rs;
-			vector<string> all_lpm_str_vec;
-			vector<string> lpm_str_vec;
-			vector< vector<int> > res_crossing_edges_vec;
-			vector<int> all_crossing_edges_vec;
-			_db.queryCrossingEdge(_query_str, _rs, lpm_str_vec, res_crossing_edges_vec, all_crossing_edges_vec, myRank, stdout);
+			partialResEnd = MPI_Wtime();
+			printf("Finding local partial matches costs %f s in Client %d with vec_size = %d\n", partialResEnd - partialResStart, myRank, (int)lpm_buf_vec.size());
 			
-			stringstream all_lpm_ss;
-			for(int i = 0; i < lpm_str_vec.size(); i++){
-				all_lpm_ss << lpm_str_vec[i] << endl;
+			if(bloom_filter){
+				int lpm_num = 0;
+				for(int i = 0; i < lpm_buf_vec.size(); i++){
+					lpm_num += lpm_buf_vec[i].row_num;
+				}
+				int drop_num = pruneByBloomFilter(lpm_buf_vec, var_num, worker_comm);
+				printf("Bloom filters drop %d of %d local partial matches in Client %d\n", drop_num, lpm_num, myRank);
 			}
-			all_lpm_str_vec.push_back(all_lpm_ss.str());
-			//printf("After filtering, Client %d remains %d results\n", myRank, commResNum);
-			
-			partialResEnd = MPI_Wtime();
 			
+			//only the representatives of the LEC classes are sent before the coordinator asks for the members
+			if(lec){
+				int site_num = 0, site = 0;
+				MPI_Comm_size(worker_comm, &site_num);
+				MPI_Comm_rank(worker_comm, &site);
+				PartialResLEC lpm_lec(var_num, _query_adjacent_list, site, site_num);
+				map<int, string> id_str_map;
+				for(int i = 0; i < lpm_buf_vec.size(); i++){
+					collectPartialResDict(lpm_buf_vec[i], id_str_map);
+					lpm_lec.add(lpm_buf_vec[i]);
+					lpm_buf_vec[i].clear();
+				}
+				PartialResBuffer reps(var_num);
+				reps.id_mode = global_id_tag == 1 ? PartialResBuffer::GLOBAL_ID : PartialResBuffer::LOCAL_ID;
+				lpm_lec.getRepresentatives(reps);
+				printf("Client %d compresses %d local partial matches into %d LEC classes\n", myRank, lpm_lec.getRowNum(), lpm_lec.getClassNum());
+				sendPartialRes(reps, id_str_map, coord_sink);
+				coord_sink.finish();
+				sendLECMembers(lpm_lec, id_str_map, reps.id_mode, _tag);
+			}else if(!distributed_assembly){
+				//the LPMs left are sent to the coordinator as they are
+				for(int i = 0; i < lpm_buf_vec.size(); i++){
+					if(lpm_buf_vec[i].row_num > 0)
+						coord_sink.put(lpm_buf_vec[i]);
+				}
+				coord_sink.finish();
+			}else{
+				MatchRowSet finalResSet(var_num);
+				map<int, string> id_str_map;
+				distributedAssembly(lpm_buf_vec, _query_adjacent_list, var_num, thread_num, worker_comm, finalResSet);
+				
+				//only the complete matches are sent to the coordinator
+				PartialResBuffer final_buf(var_num);
+				vector<char> full_tags(var_num, '1');
+				for(int i = 0; i < finalResSet.size(); i++){
+					final_buf.addRow(finalResSet.getRow(i), &full_tags[0]);
+				}
+				final_buf.id_mode = PartialResBuffer::GLOBAL_ID;
+				sendPartialRes(final_buf, id_str_map, coord_sink);
+				coord_sink.finish();
+				printf("Assembling partial matches costs %f s in Client %d\n", MPI_Wtime() - partialResEnd, myRank);
+			}
+		}else{
 			//============================= communication of partial results =============================
+			//the LPMs are streamed to the coordinator while they are produced
+			_db.queryCrossingEdge(_query_str, coord_sink, global_id_tag == 1, myRank, stdout);
 			
-			double time_cost_value = partialResEnd - partialResStart;
-			printf("Finding local partial matches costs %f s in Client %d with vec_size = %d\n", time_cost_value, myRank, all_lpm_str_vec.size());
+			partialResEnd = MPI_Wtime();
+			printf("Finding local partial matches costs %f s in Client %d with %lld rows in %d chunks\n", partialResEnd - partialResStart, myRank, coord_sink.row_num, coord_sink.chunk_num);
+			coord_sink.finish();
+		}
+		
+		//the strings of the final matches are looked up after the coordinator joins them
+		sendFinalStrings(_db, _tag);
+	}
+}
+
+//run the queries of different slots on a site at the same time, one thread per slot, each slot
+//with its own duplicate of worker_comm for the distributed assembly
+class SiteQueryScheduler
+{
+public:
+	SiteQueryScheduler(Database& _db, int _slot_num, int _myRank, bool _distributed_assembly, bool _bloom_filter, bool _lec, int _thread_num, MPI_Comm _worker_comm)
+		: db(_db), slots(_slot_num)
+	{
+		this->myRank = _myRank;
+		this->distributed_assembly = _distributed_assembly;
+		this->bloom_filter = _bloom_filter;
+		this->lec = _lec;
+		this->thread_num = _thread_num;
+		for(int i = 0; i < _slot_num; i++){
+			Slot& slot = this->slots[i];
+			slot.scheduler = this;
+			slot.id = i;
+			slot.stopped = false;
+			MPI_Comm_dup(_worker_comm, &slot.comm);
+			pthread_mutex_init(&slot.mutex, NULL);
+			pthread_cond_init(&slot.cond, NULL);
+		}
+		for(int i = 0; i < _slot_num; i++){
+			pthread_create(&this->slots[i].thread, NULL, SiteQueryScheduler::run, &this->slots[i]);
+		}
+	}
+	
+	//wait for the queries submitted before
+	~SiteQueryScheduler()
+	{
+		for(int i = 0; i < this->slots.size(); i++){
+			Slot& slot = this->slots[i];
+			pthread_mutex_lock(&slot.mutex);
+			slot.stopped = true;
+			pthread_cond_signal(&slot.cond);
+			pthread_mutex_unlock(&slot.mutex);
+		}
+		for(int i = 0; i < this->slots.size(); i++){
+			Slot& slot = this->slots[i];
+			pthread_join(slot.thread, NULL);
+			pthread_mutex_destroy(&slot.mutex);
+			pthread_cond_destroy(&slot.cond);
+			MPI_Comm_free(&slot.comm);
+		}
+	}
+	
+	//a slot is reused by the coordinator once its last query ends, but its thread may not be waiting yet
+	void submit(int _slot, const string& _query_str)
+	{
+		Slot& slot = this->slots[_slot];
+		pthread_mutex_lock(&slot.mutex);
+		slot.queries.push(_query_str);
+		pthread_cond_signal(&slot.cond);
+		pthread_mutex_unlock(&slot.mutex);
+	}
+
+private:
+	struct Slot
+	{
+		SiteQueryScheduler* scheduler;
+		int id;
+		MPI_Comm comm;
+		pthread_t thread;
+		pthread_mutex_t mutex;
+		pthread_cond_t cond;
+		queue<string> queries;
+		bool stopped;
+	};
+	
+	Database& db;
+	int myRank;
+	bool distributed_assembly;
+	bool bloom_filter;
+	bool lec;
+	int thread_num;
+	vector<Slot> slots;
+	
+	static void* run(void* _arg)
+	{
+		Slot* slot = (Slot*)_arg;
+		SiteQueryScheduler* scheduler = slot->scheduler;
+		while(true){
+			pthread_mutex_lock(&slot->mutex);
+			while(slot->queries.empty() && !slot->stopped)
+				pthread_cond_wait(&slot->cond, &slot->mutex);
+			if(slot->queries.empty()){
+				pthread_mutex_unlock(&slot->mutex);
+				break;
+			}
+			string _query_str = slot->queries.front();
+			slot->queries.pop();
+			pthread_mutex_unlock(&slot->mutex);
 			
-			size = all_lpm_str_vec.size();
-			MPI_Send(&size, 1, MPI_INT, 0, 10, MPI_COMM_WORLD);
-			for(int i = 0; i < all_lpm_str_vec.size(); i++){
-				partialResArr = new char[all_lpm_str_vec[i].size() + 3];
-				strcpy(partialResArr, all_lpm_str_vec[i].c_str());
-				size = strlen(partialResArr);
-				
-				MPI_Send(&size, 1, MPI_INT, 0, 10, MPI_COMM_WORLD);
-				MPI_Send(partialResArr, size, MPI_CHAR, 0, 10, MPI_COMM_WORLD);
-				
-				//log_ss << " with size " << size;
-				
-				delete[] partialResArr;
+			answerQuery(scheduler->db, _query_str, scheduler->myRank, scheduler->distributed_assembly, scheduler->bloom_filter, scheduler->lec, scheduler->thread_num, RES_TAG + slot->id, slot->comm);
+		}
+		return NULL;
+	}
+};
+
+struct QueryTask;
+
+//the queries in flight on the coordinator, each answered by its own thread in a free slot
+class QuerySlotPool
+{
+public:
+	QuerySlotPool(int _slot_num) : busy(_slot_num, false), started(_slot_num, false), threads(_slot_num)
+	{
+		pthread_mutex_init(&this->mutex, NULL);
+		pthread_cond_init(&this->cond, NULL);
+	}
+	
+	~QuerySlotPool()
+	{
+		this->waitAll();
+		pthread_mutex_destroy(&this->mutex);
+		pthread_cond_destroy(&this->cond);
+	}
+	
+	//wait for a free slot and run _func on _task in it
+	void start(void* (*_func)(void*), QueryTask* _task);
+	void release(int _slot)
+	{
+		pthread_mutex_lock(&this->mutex);
+		this->busy[_slot] = false;
+		pthread_cond_broadcast(&this->cond);
+		pthread_mutex_unlock(&this->mutex);
+	}
+	
+	void waitAll()
+	{
+		for(int i = 0; i < this->threads.size(); i++){
+			if(this->started[i])
+				pthread_join(this->threads[i], NULL);
+			this->started[i] = false;
+		}
+	}
+
+private:
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	vector<bool> busy;
+	vector<bool> started;
+	vector<pthread_t> threads;
+};
+
+struct QueryTask
+{
+	QuerySlotPool* pool;
+	int slot;
+	//the connection of the client, owned by the task
+	Socket* socket;
+	string query_str;
+	int p;
+	bool distributed_assembly;
+	bool lec;
+	int thread_num;
+};
+
+void
+QuerySlotPool::start(void* (*_func)(void*), QueryTask* _task)
+{
+	pthread_mutex_lock(&this->mutex);
+	int slot = -1;
+	while(slot == -1){
+		for(int i = 0; i < this->busy.size(); i++){
+			if(!this->busy[i]){
+				slot = i;
+				break;
+			}
+		}
+		if(slot == -1)
+			pthread_cond_wait(&this->cond, &this->mutex);
+	}
+	this->busy[slot] = true;
+	pthread_mutex_unlock(&this->mutex);
+	
+	//the last thread of the slot has released it and is about to end
+	if(this->started[slot])
+		pthread_join(this->threads[slot], NULL);
+	_task->pool = this;
+	_task->slot = slot;
+	this->started[slot] = (pthread_create(&this->threads[slot], NULL, _func, _task) == 0);
+	if(!this->started[slot]){
+		cerr << "error: fail to create thread. @gqueryD" << endl;
+		_func(_task);
+	}
+}
+
+void*
+answerClient(void* _arg)
+{
+	QueryTask* task = (QueryTask*)_arg;
+	sendQuery(task->query_str, task->slot, task->p);
+	
+	stringstream res_ss;
+	coordinateQuery(task->query_str, task->p, task->distributed_assembly, task->lec, task->thread_num, MPI_Wtime(), RES_TAG + task->slot, res_ss);
+	task->socket->send(res_ss.str());
+	task->socket->close();
+	delete task->socket;
+	
+	task->pool->release(task->slot);
+	delete task;
+	return NULL;
+}
+
+//keep the MPI world and the databases of the sites up, and answer the queries sent to the port
+//by the protocol of Server, until the stop command; up to _slot_num queries are answered at the same time
+void
+serveQueries(const string& _db_name, unsigned short _port, int p, bool distributed_assembly, bool lec, int thread_num, int _slot_num)
+{
+	Socket server_socket;
+	if(!server_socket.create() || !server_socket.bind(_port) || !server_socket.listen()){
+		cerr << "cannot listen to port " << _port << ". @gqueryD" << endl;
+		return;
+	}
+	printf("gqueryD is listening to port %d with %d queries at most at the same time.\n", (int)_port, _slot_num);
+	
+	Server cmd_parser;
+	QuerySlotPool slot_pool(_slot_num);
+	while(true){
+		Socket* new_server_socket = new Socket;
+		server_socket.accept(*new_server_socket);
+		
+		string recv_cmd, ret_msg;
+		if(!new_server_socket->recv(recv_cmd)){
+			cerr << "receive command from client error. @gqueryD" << endl;
+			new_server_socket->close();
+			delete new_server_socket;
+			continue;
+		}
+		
+		Operation operation;
+		bool stop = false;
+		if(!cmd_parser.parser(recv_cmd, operation)){
+			ret_msg = "invalid command.";
+		}else{
+			switch(operation.getCommand()){
+			case CMD_TEST:
+				ret_msg = "OK";
+				break;
+			case CMD_QUERY:
+			{
+				//the query is answered to the client by the thread of its slot
+				QueryTask* task = new QueryTask;
+				task->socket = new_server_socket;
+				task->query_str = operation.getParameter(0);
+				task->p = p;
+				task->distributed_assembly = distributed_assembly;
+				task->lec = lec;
+				task->thread_num = thread_num;
+				cout << "query : " << task->query_str << endl;
+				slot_pool.start(answerClient, task);
+				continue;
+			}
+			case CMD_SHOW:
+				ret_msg = "\n" + _db_name + "\n";
+				break;
+			case CMD_STOP:
+				//the queries in flight are answered first
+				slot_pool.waitAll();
+				ret_msg = "server stopped.";
+				stop = true;
+				break;
+			default:
+				//the databases are loaded by all sites at the start and can not be changed here
+				ret_msg = "this command is not supported by gqueryD.";
 			}
 		}
 		
-		delete[] queryCharArr;
-		delete[] crossingEdgeHashTable;
-		delete[] crossingEdgeHashTagTable;
+		new_server_socket->send(ret_msg);
+		new_server_socket->close();
+		delete new_server_socket;
+		if(stop)
+			break;
+	}
+	server_socket.close();
+	cout << "server stopped." << endl;
+}
+
+void
+help()
+{
+	printf("\
+			/*=============================================================================\n\
+# Filename: gquery.cpp\n\
+# Author: Bookug Lobert\n\
+# Mail: 1181955272@qq.com\n\
+# Last Modified: 2015-10-20 12:23\n\
+# Description: query a database, there are several ways to use this program:\n\
+1. ./gquery                                        print the help message\n\
+2. ./gquery --help                                 simplified as -h, equal to 1\n\
+3. ./gquery db_folder query_path                   load query from given path fro given database\n\
+4. ./gquery db_folder                              load the given database and open console\n\
+5. ./gqueryD db_folder query_path --assembly=distributed\n\
+                                                   join the partial matches among the sites instead of the coordinator\n\
+6. ./gqueryD db_folder query_path --threads=N      join the partial matches with N threads, all cores by default\n\
+7. ./gqueryD db_folder --server=PORT               keep the databases loaded and answer the queries sent to PORT(3305 by default)\n\
+                                                   by gclient, until the stop command\n\
+8. ./gqueryD db_folder --server=PORT --parallel-queries=N\n\
+                                                   answer up to N queries at the same time, 4 by default\n\
+9. ./gqueryD db_folder query_path --bloom-filter   drop the partial matches that can not be joined before sending them,\n\
+                                                   by Bloom filters of the internal vertices merged among the sites\n\
+10. ./gqueryD db_folder query_path --lec           join one representative of each LEC class of partial matches, and only ship\n\
+                                                   the members of the classes in complete matches\n\
+11. ./gqueryD db_folder query_path --explain       print the join order chosen by each site for the local partial matches\n\
+=============================================================================*/\n");
+}
+
+int
+main(int argc, char * argv[])
+{
+	//chdir(dirname(argv[0]));
+#ifdef DEBUG
+	Util util;
+#endif
+
+	if (argc == 1 || strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)
+	{
+		help();
+		return 0;
+	}
+	//cout << "gquery..." << endl;
+	if (argc < 2)
+	{
+		cerr << "error: lack of DB_store to be queried" << endl;
+		return 0;
+	}
+	{
+		//cout << "argc: " << argc << "\t";
+		//cout << "DB_store:" << argv[1] << "\t";
+		//cout << endl;
+	}
+	if (argc >= 3)
+	{
+		int myRank, p, i, thread_level = MPI_THREAD_SINGLE;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &thread_level);
+
+		MPI_Comm_rank(MPI_COMM_WORLD,&myRank);
+		MPI_Comm_size(MPI_COMM_WORLD,&p);
+		
+		//the partial matches are joined by the coordinator, or by the sites in worker_comm
+		bool distributed_assembly = false, bloom_filter = false, lec = false, explain = false;
+		int thread_num = sysconf(_SC_NPROCESSORS_ONLN), server_port = -1, query_slot_num = 4;
+		for(i = 2; i < argc; i++){
+			if(strcmp(argv[i], "--assembly=distributed") == 0)
+				distributed_assembly = true;
+			else if(strcmp(argv[i], "--assembly=centralized") == 0)
+				distributed_assembly = false;
+			else if(strcmp(argv[i], "--bloom-filter") == 0)
+				bloom_filter = true;
+			else if(strcmp(argv[i], "--lec") == 0)
+				lec = true;
+			else if(strcmp(argv[i], "--explain") == 0)
+				explain = true;
+			else if(strncmp(argv[i], "--threads=", 10) == 0)
+				thread_num = atoi(argv[i] + 10);
+			else if(strcmp(argv[i], "--server") == 0)
+				server_port = Socket::DEFAULT_CONNECT_PORT;
+			else if(strncmp(argv[i], "--server=", 9) == 0)
+				server_port = atoi(argv[i] + 9);
+			else if(strncmp(argv[i], "--parallel-queries=", 19) == 0)
+				query_slot_num = atoi(argv[i] + 19);
+		}
+		if(thread_num < 1)
+			thread_num = 1;
+		//the LEC classes are joined by the coordinator
+		if(lec && distributed_assembly){
+			if(myRank == 0)
+				cerr << "the LEC compression is not used with the distributed assembly." << endl;
+			lec = false;
+		}
+		//queries are answered at the same time only by a server, and only if MPI can be called by any thread
+		if(server_port < 0 || query_slot_num < 1)
+			query_slot_num = 1;
+		if(query_slot_num > 1 && thread_level < MPI_THREAD_MULTIPLE){
+			if(myRank == 0)
+				cerr << "MPI_THREAD_MULTIPLE is not supported, the queries are answered one by one." << endl;
+			query_slot_num = 1;
+		}
+		MPI_Comm worker_comm;
+		MPI_Comm_split(MPI_COMM_WORLD, myRank == 0 ? MPI_UNDEFINED : 1, myRank, &worker_comm);
+        if(myRank == 0) {
+			if(distributed_assembly)
+				printf("The partial matches are assembled by the sites.\n");
+			else
+				printf("The partial matches are assembled by the coordinator with %d threads.\n", thread_num);
+			
+			if(server_port >= 0){
+				serveQueries(string(argv[1]), server_port, p, distributed_assembly, lec, thread_num, query_slot_num);
+			}else{
+				string _query_str = Util::getQueryFromFile(argv[2]);
+				cout << "query : " << _query_str << endl;
+				sendQuery(_query_str, 0, p);
+				printf("The query has been sent!\n");
+				
+				ofstream res_output("finalRes.txt");
+				coordinateQuery(_query_str, p, distributed_assembly, lec, thread_num, MPI_Wtime(), RES_TAG, res_output);
+				res_output.close();
+			}
+			sendQuery("", -1, p);
+		}else{
+			string db_folder = string(argv[1]);
+			Database _db(db_folder);
+			_db.load();
+			printf("Client %d finish loading!\n", myRank);
+			if(explain){
+				char label[32];
+				sprintf(label, "Client %d:", myRank);
+				Join::setExplain(true, label);
+			}
+			
+			//the database stays loaded until the coordinator stops the sites
+			string _query_str;
+			int query_slot;
+			if(query_slot_num == 1){
+				while(recvQuery(_query_str, query_slot)){
+					answerQuery(_db, _query_str, myRank, distributed_assembly, bloom_filter, lec, thread_num, RES_TAG + query_slot, worker_comm);
+				}
+			}else{
+				SiteQueryScheduler scheduler(_db, query_slot_num, myRank, distributed_assembly, bloom_filter, lec, thread_num, worker_comm);
+				while(recvQuery(_query_str, query_slot)){
+					scheduler.submit(query_slot, _query_str);
+				}
+			}
+		}
 
+		if(worker_comm != MPI_COMM_NULL)
+			MPI_Comm_free(&worker_comm);
 		MPI_Finalize();
 	}
 	return 0;
@@ -0,0 +1,349 @@
+/*=============================================================================
+# Filename: gupdateD.cpp
+# Last Modified: 2026-10-17
+# Description: insert/remove triples in the databases built by gloadD, without reloading
+1. ./gupdateD db_folder rdf_path internal_path            insert the triples of rdf_path
+2. ./gupdateD db_folder rdf_path internal_path --remove   remove the triples of rdf_path
+a triple goes to the fragments of its subject and object as in gloadD. An entity not listed
+in internal_path is new, it becomes internal to the fragment of the other vertex of its first
+triple, or to the fragment with the fewest internal vertices, and is appended to internal_path
+=============================================================================*/
+
+#include "../Util/Util.h"
+#include "../Util/TripleBatch.h"
+#include "../Database/Database.h"
+#include <mpi.h>
+#include <tr1/unordered_map>
+
+using namespace std;
+
+//internal vertex -> partition ID
+typedef std::tr1::unordered_map<string, int> PartitionMap;
+
+//triples parsed and sent to the sites at a time, insert/delete is much more costly than build
+#define UPDATE_GROUP_SIZE (100 * 1000)
+
+void
+appendInt(vector<char>& _bytes, int _val)
+{
+	const char* p = (const char*)&_val;
+	_bytes.insert(_bytes.end(), p, p + sizeof(int));
+}
+
+int
+readInt(const char*& _p)
+{
+	int val;
+	memcpy(&val, _p, sizeof(int));
+	_p += sizeof(int);
+	return val;
+}
+
+void
+appendStr(vector<char>& _bytes, const string& _str)
+{
+	appendInt(_bytes, _str.size());
+	_bytes.insert(_bytes.end(), _str.begin(), _str.end());
+}
+
+void
+readStr(const char*& _p, string& _str)
+{
+	int len = readInt(_p);
+	_str.assign(_p, len);
+	_p += len;
+}
+
+//the same routing as gloadD, so that a triple is removed from every fragment it was built into
+void
+getTripleSites(int _sub_partition_id, int _obj_partition_id, int _site_num, vector<int>& _sites)
+{
+	_sites.clear();
+	if(_sub_partition_id != -1)
+		_sites.push_back(_sub_partition_id);
+	if(_obj_partition_id != -1 && _obj_partition_id != _sub_partition_id)
+		_sites.push_back(_obj_partition_id);
+	if(_sub_partition_id == -1 && _obj_partition_id == -1){
+		for(int j = 0; j < _site_num; j++){
+			_sites.push_back(j);
+		}
+	}
+}
+
+//the partition of an entity, a new one is assigned and recorded in _new_vertices if _assign
+int
+getPartition(PartitionMap& _partitions, vector<int>& _partition_sizes, const string& _entity, int _neighbor_partition_id,
+		bool _assign, vector< pair<string, int> >& _new_vertices)
+{
+	PartitionMap::iterator it = _partitions.find(_entity);
+	if(it != _partitions.end())
+		return it->second;
+	if(!_assign)
+		return -1;
+
+	int partition_id = _neighbor_partition_id;
+	if(partition_id == -1){
+		partition_id = min_element(_partition_sizes.begin(), _partition_sizes.end()) - _partition_sizes.begin();
+	}
+	_partitions.insert(make_pair(_entity, partition_id));
+	_partition_sizes[partition_id]++;
+	_new_vertices.push_back(make_pair(_entity, partition_id));
+	return partition_id;
+}
+
+//rank 0: the vertices of a group are looked up at all sites, the largest answer wins(a site
+//answers -1 if it does not hold the vertex), and those found nowhere get new global IDs
+void
+lookupGlobalIDs(const TripleWithObjType* _triples, int _triple_num, int* _next_gids, vector<int>& _global_ids)
+{
+	std::tr1::unordered_map<string, int> vertex_indexes[2];
+	vector<int> indexes(2 * _triple_num);
+	vector<int> kinds;
+	vector<char> bytes;
+	appendInt(bytes, 0);
+	for(int i = 0; i < _triple_num; i++){
+		for(int j = 0; j < 2; j++){
+			int kind = (j == 0 || _triples[i].isObjEntity()) ? 0 : 1;
+			const string& str = (j == 0) ? _triples[i].subject : _triples[i].object;
+			std::tr1::unordered_map<string, int>::iterator it = vertex_indexes[kind].find(str);
+			if(it == vertex_indexes[kind].end()){
+				it = vertex_indexes[kind].insert(make_pair(str, (int)kinds.size())).first;
+				kinds.push_back(kind);
+				bytes.push_back(kind);
+				appendStr(bytes, str);
+			}
+			indexes[2 * i + j] = it->second;
+		}
+	}
+	int vertex_num = kinds.size();
+	memcpy(&bytes[0], &vertex_num, sizeof(int));
+
+	int size = bytes.size();
+	MPI_Bcast(&size, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	MPI_Bcast(&bytes[0], size, MPI_CHAR, 0, MPI_COMM_WORLD);
+	vector<int> none(vertex_num, -1), gids(vertex_num, -1);
+	if(vertex_num > 0)
+		MPI_Reduce(&none[0], &gids[0], vertex_num, MPI_INT, MPI_MAX, 0, MPI_COMM_WORLD);
+
+	for(int i = 0; i < vertex_num; i++){
+		if(gids[i] == -1)
+			gids[i] = _next_gids[kinds[i]]++;
+	}
+	_global_ids.resize(2 * _triple_num);
+	for(int i = 0; i < 2 * _triple_num; i++){
+		_global_ids[i] = gids[indexes[i]];
+	}
+}
+
+//the site side of lookupGlobalIDs
+void
+answerGlobalIDs(Database& _db)
+{
+	int size = 0;
+	MPI_Bcast(&size, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	vector<char> bytes(size);
+	MPI_Bcast(&bytes[0], size, MPI_CHAR, 0, MPI_COMM_WORLD);
+
+	const char* p = &bytes[0];
+	int vertex_num = readInt(p);
+	vector<int> gids(vertex_num);
+	string str;
+	for(int i = 0; i < vertex_num; i++){
+		bool is_entity = (*p++ == 0);
+		readStr(p, str);
+		gids[i] = _db.getGlobalID(str, is_entity);
+	}
+	if(vertex_num > 0)
+		MPI_Reduce(&gids[0], NULL, vertex_num, MPI_INT, MPI_MAX, 0, MPI_COMM_WORLD);
+}
+
+//the new vertices are listed like the others, one "vertex\tpartition" per line
+void
+appendInternalVertices(const char* _internal_file, const vector< pair<string, int> >& _new_vertices)
+{
+	if(_new_vertices.empty())
+		return;
+
+	bool line_end = true;
+	ifstream fin(_internal_file, ios::binary | ios::ate);
+	if(fin && fin.tellg() > 0){
+		fin.seekg(-1, ios::end);
+		line_end = (fin.get() == '\n');
+	}
+	fin.close();
+
+	ofstream fout(_internal_file, ios::app);
+	if(!line_end)
+		fout << endl;
+	for(int i = 0; i < _new_vertices.size(); i++){
+		fout << _new_vertices[i].first << "\t" << _new_vertices[i].second << endl;
+	}
+	fout.close();
+}
+
+//[0]./gupdateD [1]data_folder_path  [2]rdf_file_path [3]internal_file_path [4]--remove
+int
+main(int argc, char * argv[])
+{
+	Util util;
+	int myRank, p;
+	double updateStart, updateEnd;
+	MPI_Status status;
+	MPI_Init(&argc, &argv);
+
+	MPI_Comm_rank(MPI_COMM_WORLD, &myRank);
+	MPI_Comm_size(MPI_COMM_WORLD, &p);
+
+	bool remove_mode = (argc > 4 && strcmp(argv[4], "--remove") == 0);
+	int site_num = p - 1;
+	long long triple_num = 0, site_triple_num = 0;
+	updateStart = MPI_Wtime();
+
+	if(myRank == 0){
+		PartitionMap partitions;
+		vector<int> partition_sizes(site_num, 0);
+		string buff;
+		ifstream infile(argv[3]);
+		if(!infile){
+			cout << "import internal vertices failed." << endl;
+		}
+		while(getline(infile, buff)){
+			vector<string> resVec = Util::split(buff, "\t");
+			if(resVec.size() < 2)
+				continue;
+			int partition_id = atoi(resVec[1].c_str());
+			partitions[resVec[0]] = partition_id;
+			if(partition_id >= 0 && partition_id < site_num)
+				partition_sizes[partition_id]++;
+		}
+		infile.close();
+
+		//new global IDs go after the largest ones of all sites
+		int limits[2] = {0, Util::LITERAL_FIRST_ID}, next_gids[2];
+		MPI_Reduce(limits, next_gids, 2, MPI_INT, MPI_MAX, 0, MPI_COMM_WORLD);
+
+		ifstream fin(argv[2]);
+		if(!fin){
+			cerr << "Fail to open the RDF data file: " << argv[2] << endl;
+		}
+		RDFParser parser(fin);
+		TripleWithObjType* triple_array = new TripleWithObjType[UPDATE_GROUP_SIZE];
+		vector< pair<string, int> > new_vertices;
+		vector<int> global_ids, sites;
+		vector<TripleBatch> batches(site_num);
+		vector< vector<char> > internal_bytes(site_num);
+		while(true){
+			int parse_triple_num = 0;
+			if(fin)
+				parser.parseFile(triple_array, parse_triple_num, UPDATE_GROUP_SIZE);
+			MPI_Bcast(&parse_triple_num, 1, MPI_INT, 0, MPI_COMM_WORLD);
+			if(parse_triple_num == 0)
+				break;
+			triple_num += parse_triple_num;
+
+			if(remove_mode)
+				global_ids.assign(2 * parse_triple_num, -1);
+			else
+				lookupGlobalIDs(triple_array, parse_triple_num, next_gids, global_ids);
+
+			for(int i = 0; i < site_num; i++){
+				batches[i].clear();
+				internal_bytes[i].clear();
+			}
+			for(int i = 0; i < parse_triple_num; i++){
+				const TripleWithObjType& triple = triple_array[i];
+				bool obj_entity = triple.isObjEntity();
+				int sub_partition_id = getPartition(partitions, partition_sizes, triple.subject, -1, false, new_vertices);
+				int obj_partition_id = -1;
+				if(obj_entity)
+					obj_partition_id = getPartition(partitions, partition_sizes, triple.object, sub_partition_id, !remove_mode, new_vertices);
+				if(sub_partition_id == -1)
+					sub_partition_id = getPartition(partitions, partition_sizes, triple.subject, obj_partition_id, !remove_mode, new_vertices);
+
+				getTripleSites(sub_partition_id, obj_partition_id, site_num, sites);
+				for(int j = 0; j < sites.size(); j++){
+					batches[sites[j]].add(triple, global_ids[2 * i], global_ids[2 * i + 1]);
+					if(sites[j] == sub_partition_id)
+						appendStr(internal_bytes[sites[j]], triple.subject);
+					if(sites[j] == obj_partition_id)
+						appendStr(internal_bytes[sites[j]], triple.object);
+				}
+			}
+
+			for(int i = 0; i < site_num; i++){
+				MPI_Send((char*)batches[i].getBytes(), batches[i].getSize(), MPI_CHAR, i + 1, 10, MPI_COMM_WORLD);
+				MPI_Send(internal_bytes[i].empty() ? NULL : &internal_bytes[i][0], internal_bytes[i].size(), MPI_CHAR, i + 1, 11, MPI_COMM_WORLD);
+			}
+		}
+		delete[] triple_array;
+		fin.close();
+
+		appendInternalVertices(argv[3], new_vertices);
+		//a crossing edge counts once at each of its two sites
+		long long applied_num = 0;
+		MPI_Reduce(&site_triple_num, &applied_num, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+		updateEnd = MPI_Wtime();
+		printf("%lld triples are read and %s %lld times at %d sites in %f s.\n", triple_num, remove_mode ? "removed" : "inserted", applied_num, site_num, updateEnd - updateStart);
+		printf("%d new vertices are appended to %s.\n", (int)new_vertices.size(), argv[3]);
+	}else{
+		Database _db(argv[1]);
+		_db.load();
+
+		int limits[2];
+		_db.getGlobalIDLimits(limits[0], limits[1]);
+		MPI_Reduce(limits, NULL, 2, MPI_INT, MPI_MAX, 0, MPI_COMM_WORLD);
+
+		TripleWithObjType* triple_array = new TripleWithObjType[UPDATE_GROUP_SIZE];
+		vector<char> bytes;
+		vector<int> global_ids;
+		set<string> internal_vertices;
+		string vertex;
+		while(true){
+			int parse_triple_num = 0;
+			MPI_Bcast(&parse_triple_num, 1, MPI_INT, 0, MPI_COMM_WORLD);
+			if(parse_triple_num == 0)
+				break;
+			if(!remove_mode)
+				answerGlobalIDs(_db);
+
+			int size = 0;
+			MPI_Probe(0, 10, MPI_COMM_WORLD, &status);
+			MPI_Get_count(&status, MPI_CHAR, &size);
+			bytes.resize(size + 1);
+			MPI_Recv(&bytes[0], size, MPI_CHAR, 0, 10, MPI_COMM_WORLD, &status);
+			global_ids.clear();
+			int group_triple_num = TripleBatch::unpack(&bytes[0], size, triple_array, global_ids);
+
+			MPI_Probe(0, 11, MPI_COMM_WORLD, &status);
+			MPI_Get_count(&status, MPI_CHAR, &size);
+			bytes.resize(size + 1);
+			MPI_Recv(&bytes[0], size, MPI_CHAR, 0, 11, MPI_COMM_WORLD, &status);
+			internal_vertices.clear();
+			for(const char* q = &bytes[0]; q < &bytes[0] + size; ){
+				readStr(q, vertex);
+				internal_vertices.insert(vertex);
+			}
+
+			if(group_triple_num == 0)
+				continue;
+			if(remove_mode)
+				_db.remove(triple_array, group_triple_num);
+			else
+				_db.insert(triple_array, group_triple_num, global_ids, internal_vertices);
+			site_triple_num += group_triple_num;
+		}
+		delete[] triple_array;
+
+		if(!_db.saveUpdates()){
+			cerr << "Fail to save the updates of site " << myRank << endl;
+		}
+		MPI_Reduce(&site_triple_num, NULL, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+		updateEnd = MPI_Wtime();
+		printf("%d takes %f s and %s %lld triples!\n", myRank, updateEnd - updateStart, remove_mode ? "removes" : "inserts", site_triple_num);
+	}
+
+	MPI_Finalize();
+	return 0;
+}
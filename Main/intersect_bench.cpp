@@ -0,0 +1,170 @@
+/*=============================================================================
+# Filename: intersect_bench.cpp
+# Last Modified: 2026-10-17
+# Description: compare Util::intersect with ListIntersect on random sorted ID
+lists, for lists of the same size, skewed sizes and several lists at once
+./intersect_bench [list_len] [round_num]
+=============================================================================*/
+
+#include "../Util/Util.h"
+#include "../Util/ListIntersect.h"
+
+using namespace std;
+
+//a sorted list of _len distinct IDs below _range
+static void
+randomList(vector<int>& _list, int _len, int _range)
+{
+	_list.clear();
+	for(int i = 0; i < _len; ++i)
+	{
+		_list.push_back(rand() % _range);
+	}
+	sort(_list.begin(), _list.end());
+	_list.erase(unique(_list.begin(), _list.end()), _list.end());
+}
+
+static double
+curMs()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+static int*
+copyList(const int* _list, int _len)
+{
+	int* copy = new int[_len];
+	memcpy(copy, _list, sizeof(int) * _len);
+	return copy;
+}
+
+//Util::intersect frees its inputs, so each round gets copies, made outside the timing
+static double
+utilIntersect(int*& _res, int& _res_len, const int* _list1, int _len1, const int* _list2, int _len2)
+{
+	int* list1 = copyList(_list1, _len1);
+	int* list2 = copyList(_list2, _len2);
+	double begin = curMs();
+	Util::intersect(_res, _res_len, list1, _len1, list2, _len2);
+	return curMs() - begin;
+}
+
+static double
+benchUtil(const vector<int>& _list1, const vector<int>& _list2, int _round_num, int& _res_len)
+{
+	double time = 0;
+	for(int r = 0; r < _round_num; ++r)
+	{
+		int* res = NULL;
+		time += utilIntersect(res, _res_len, &_list1[0], _list1.size(), &_list2[0], _list2.size());
+		delete[] res;
+	}
+	return time;
+}
+
+static double
+benchLevel(const vector<int>& _list1, const vector<int>& _list2, int _round_num, int& _res_len)
+{
+	vector<int> res(min(_list1.size(), _list2.size()));
+	//the shorter list first, as Util::intersect does
+	const vector<int>& small = _list1.size() <= _list2.size() ? _list1 : _list2;
+	const vector<int>& large = _list1.size() <= _list2.size() ? _list2 : _list1;
+	double begin = curMs();
+	for(int r = 0; r < _round_num; ++r)
+	{
+		_res_len = ListIntersect::intersect(&small[0], small.size(), &large[0], large.size(), &res[0]);
+	}
+	return curMs() - begin;
+}
+
+static void
+benchPair(const char* _name, int _len1, int _len2, int _range, int _round_num)
+{
+	vector<int> list1, list2;
+	randomList(list1, _len1, _range);
+	randomList(list2, _len2, _range);
+	printf("%s: %d x %d IDs below %d, %d rounds\n", _name, (int)list1.size(), (int)list2.size(), _range, _round_num);
+
+	int util_len = 0;
+	double util_time = benchUtil(list1, list2, _round_num, util_len);
+	printf("\t%-10s %9.2f ms\t%d IDs\n", "Util", util_time, util_len);
+
+	int default_level = ListIntersect::getLevel();
+	for(int level = ListIntersect::SCALAR; level <= default_level; ++level)
+	{
+		ListIntersect::setLevel(level);
+		int res_len = 0;
+		double time = benchLevel(list1, list2, _round_num, res_len);
+		printf("\t%-10s %9.2f ms\t%d IDs%s\n", ListIntersect::getLevelName(level), time, res_len,
+				res_len == util_len ? "" : "\tMISMATCH");
+	}
+	ListIntersect::setLevel(default_level);
+}
+
+static void
+benchMulti(int _list_num, int _len, int _range, int _round_num)
+{
+	vector< vector<int> > lists(_list_num);
+	vector<const int*> list_ptrs(_list_num);
+	vector<int> lens(_list_num);
+	for(int i = 0; i < _list_num; ++i)
+	{
+		//one list in ten times shorter, like a selective predicate in a star
+		randomList(lists[i], i == 0 ? _len / 10 : _len, _range);
+		list_ptrs[i] = &lists[i][0];
+		lens[i] = lists[i].size();
+	}
+	printf("k-way: %d lists of about %d IDs below %d, %d rounds\n", _list_num, _len, _range, _round_num);
+
+	//pairwise with Util::intersect, as IDList did before
+	int util_len = 0;
+	double util_time = 0;
+	for(int r = 0; r < _round_num; ++r)
+	{
+		vector<int> cur(lists[0]);
+		for(int i = 1; i < _list_num && !cur.empty(); ++i)
+		{
+			int* res = NULL;
+			int res_len = 0;
+			util_time += utilIntersect(res, res_len, &cur[0], cur.size(), list_ptrs[i], lens[i]);
+			cur.assign(res, res + res_len);
+			delete[] res;
+		}
+		util_len = cur.size();
+	}
+	printf("\t%-10s %9.2f ms\t%d IDs\n", "Util", util_time, util_len);
+
+	vector<int> res(lens[0]);
+	int default_level = ListIntersect::getLevel();
+	for(int level = ListIntersect::SCALAR; level <= default_level; ++level)
+	{
+		ListIntersect::setLevel(level);
+		int res_len = 0;
+		double begin = curMs();
+		for(int r = 0; r < _round_num; ++r)
+		{
+			res_len = ListIntersect::intersect(&list_ptrs[0], &lens[0], _list_num, &res[0]);
+		}
+		printf("\t%-10s %9.2f ms\t%d IDs%s\n", ListIntersect::getLevelName(level), curMs() - begin, res_len,
+				res_len == util_len ? "" : "\tMISMATCH");
+	}
+	ListIntersect::setLevel(default_level);
+}
+
+int
+main(int argc, char * argv[])
+{
+	int len = argc > 1 ? atoi(argv[1]) : 1000000;
+	int round_num = argc > 2 ? atoi(argv[2]) : 20;
+	srand(0);
+	printf("best level supported: %s\n", ListIntersect::getLevelName(ListIntersect::getLevel()));
+
+	benchPair("merge, sparse result", len, len, len * 16, round_num);
+	benchPair("merge, dense result", len, len, len * 2, round_num);
+	benchPair("skewed", len / 100, len, len * 4, round_num * 10);
+	benchMulti(4, len, len * 4, round_num);
+
+	return 0;
+}
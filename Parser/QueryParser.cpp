@@ -7,9 +7,13 @@
 =============================================================================*/
 
 #include "QueryParser.h"
+#include <pthread.h>
 
 using namespace std;
 
+//dfa34_Table_uncompress() rewrites a table shared by all lexers, so queries are parsed one at a time
+static pthread_mutex_t sparql_parse_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 QueryParser::QueryParser()
 {
 	_prefix_map.clear();
@@ -17,6 +21,7 @@ QueryParser::QueryParser()
 
 void QueryParser::SPARQLParse(const string &query, QueryTree &querytree)
 {
+	pthread_mutex_lock(&sparql_parse_mutex);
 	//uncompress before use
 	dfa34_Table_uncompress();
 
@@ -37,7 +42,19 @@ void QueryParser::SPARQLParse(const string &query, QueryTree &querytree)
 	if (printNode(root) > 0)
 		throw "Some errors are found in the SPARQL query request.";
 */
-	parseWorkload(root, querytree);
+	try
+	{
+		parseWorkload(root, querytree);
+	}
+	catch(const char* e)
+	{
+		parser->free(parser);
+		tokens->free(tokens);
+		lex->free(lex);
+		input->close(input);
+		pthread_mutex_unlock(&sparql_parse_mutex);
+		throw;
+	}
 
 	//querytree.print();
 
@@ -45,6 +62,7 @@ void QueryParser::SPARQLParse(const string &query, QueryTree &querytree)
 	tokens->free(tokens);
 	lex->free(lex);
 	input->close(input);
+	pthread_mutex_unlock(&sparql_parse_mutex);
 }
 
 int QueryParser::printNode(pANTLR3_BASE_TREE node, int dep)
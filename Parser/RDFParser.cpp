@@ -12,12 +12,12 @@
 *			......
 *		}		
 */
-string RDFParser::parseFile(TripleWithObjType* _triple_array, int& _triple_num)
+string RDFParser::parseFile(TripleWithObjType* _triple_array, int& _triple_num, int _max_num)
 {
 	string _subject, _predicate, _object, _objectSubType;
 	Type::Type_ID _objectType;
 
-	while (_triple_num < RDFParser::TRIPLE_NUM_PER_GROUP)
+	while (_triple_num < _max_num)
 	{
 		try
 		{
@@ -76,11 +76,16 @@ string RDFParser::parseFile(TripleWithObjType* _triple_array, int& _triple_num)
 *		triple string 1 & 2 will share the common prefix, if you don't want this, create a new RDFParser object.
 *		_RDFParser.parseString(prefix + "\n" + triple string 1 + "\n" + triple string 2, ..); is also acceptable.
 */
-string RDFParser::parseString(string _str, TripleWithObjType* _triple_array, int& _triple_num)
+string RDFParser::parseString(string _str, TripleWithObjType* _triple_array, int& _triple_num, int _max_num)
 {
 	//clear in each time invoking
 	this->_sin.clear();
 	this->_sin << _str;
 	
-	return parseFile(_triple_array, _triple_num);
+	return parseFile(_triple_array, _triple_num, _max_num);
+}
+
+void RDFFileSource::getTriples(TripleWithObjType* _triple_array, int& _triple_num, vector<int>& _global_ids)
+{
+	this->_parser.parseFile(_triple_array, _triple_num);
 }
@@ -3,6 +3,7 @@
 
 #include "../Util/Util.h"
 #include "../Util/Triple.h"
+#include "../Util/TripleBatch.h"
 #include "TurtleParser.h"
 
 using namespace std;
@@ -22,7 +23,20 @@ public:
     //for parseFile
     RDFParser(ifstream& _fin):_TurtleParser(_fin) {}
 
-    string parseFile(TripleWithObjType* _triple_array, int& _triple_num);
-    string parseString(string _str, TripleWithObjType* _triple_array, int& _triple_num);
+    //at most _max_num triples are parsed in one call, and the rest in the next calls of parseFile
+    string parseFile(TripleWithObjType* _triple_array, int& _triple_num, int _max_num = TRIPLE_NUM_PER_GROUP);
+    string parseString(string _str, TripleWithObjType* _triple_array, int& _triple_num, int _max_num = TRIPLE_NUM_PER_GROUP);
+};
+
+//the triples of an RDF file, for Database::build
+class RDFFileSource : public TripleSource
+{
+private:
+    RDFParser _parser;
+
+public:
+    RDFFileSource(ifstream& _fin):_parser(_fin) {}
+
+    virtual void getTriples(TripleWithObjType* _triple_array, int& _triple_num, vector<int>& _global_ids);
 };
 #endif
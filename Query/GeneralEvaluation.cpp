@@ -87,7 +87,7 @@ QueryTree& GeneralEvaluation::getQueryTree()
 	return this->query_tree;
 }
 
-void GeneralEvaluation::getLocalPartialResult(KVstore *_kvstore, string& internal_tag_str, vector<string> &lpm_str_vec)
+void GeneralEvaluation::getLocalPartialResult(KVstore *_kvstore, const MappedBitmap& internal_tags, vector<string> &lpm_str_vec)
 {
 	if (this->semantic_evaluation_result_stack.empty())		return;
 
@@ -152,11 +152,11 @@ void GeneralEvaluation::getLocalPartialResult(KVstore *_kvstore, string& interna
 					{	
 						if(ans_id >= Util::LITERAL_FIRST_ID){
 							lpm_ss << "1" << _kvstore->getLiteralByID(ans_id) << "\t";
-						}else if(internal_tag_str.at(ans_id) == 1){
+						}else if(internal_tags.test(ans_id)){
 							lpm_ss << "1" << _kvstore->getEntityByID(ans_id) << "\t";
 						}else{
 							if(_basicquery.getVarDegree(result_str2id[v]) != 1){
-								lpm_ss << internal_tag_str.at(ans_id) << _kvstore->getEntityByID(ans_id) << "\t";
+								lpm_ss << (internal_tags.test(ans_id) ? '1' : '0') << _kvstore->getEntityByID(ans_id) << "\t";
 							}else{
 								lpm_ss << "1" << _kvstore->getEntityByID(ans_id) << "\t";
 							}
@@ -204,7 +204,7 @@ void GeneralEvaluation::getLocalPartialResult(KVstore *_kvstore, string& interna
 					
 					for (int i = 0; i < var_degree; i++)
 					{
-						if(result_var[j] >= Util::LITERAL_FIRST_ID || internal_tag_str.at(result_var[j]) == '1'){
+						if(result_var[j] >= Util::LITERAL_FIRST_ID || internal_tags.test(result_var[j])){
 							dealed_internal_id_sign[j] = '1';
 						}else{
 							continue;
@@ -218,7 +218,7 @@ void GeneralEvaluation::getLocalPartialResult(KVstore *_kvstore, string& interna
 						}
 						
 						if(result_var[var_id2] != -1){
-							if(result_var[var_id2] < Util::LITERAL_FIRST_ID && internal_tag_str.at(result_var[var_id2]) == '0' && (*iter)->getVarDegree(var_id2) != 1){
+							if(result_var[var_id2] < Util::LITERAL_FIRST_ID && !internal_tags.test(result_var[var_id2]) && (*iter)->getVarDegree(var_id2) != 1){
 								string _tmp_1, _tmp_2;
 								if(result_var[j] < Util::LITERAL_FIRST_ID){
 									_tmp_1 = (this->kvstore)->getEntityByID(result_var[j]);
@@ -260,7 +260,7 @@ void GeneralEvaluation::getLocalPartialResult(KVstore *_kvstore, string& interna
 	//printf("lpm_str == %s\n", lpm_ss.str().c_str());
 }
 
-void GeneralEvaluation::getCrossingEdges(KVstore *_kvstore, string& internal_tag_str, vector<string> &lpm_str_vec, vector< vector<int> >& res_crossing_edges_vec, vector<int>& all_crossing_edges_vec)
+void GeneralEvaluation::getCrossingEdges(KVstore *_kvstore, const MappedBitmap& internal_tags, vector<string> &lpm_str_vec, vector< vector<int> >& res_crossing_edges_vec, vector<int>& all_crossing_edges_vec)
 {
 	if (this->semantic_evaluation_result_stack.empty())		return;
 
@@ -325,12 +325,12 @@ void GeneralEvaluation::getCrossingEdges(KVstore *_kvstore, string& internal_tag
 						if(ans_id >= Util::LITERAL_FIRST_ID){
 							tmp_res_tag_vec[result_str2id[v]] = '1';
 							tmp_res_vec[result_str2id[v]] = _kvstore->getLiteralByID(ans_id);
-						}else if(internal_tag_str.at(ans_id) == 1){
+						}else if(internal_tags.test(ans_id)){
 							tmp_res_tag_vec[result_str2id[v]] = '1';
 							tmp_res_vec[result_str2id[v]] = _kvstore->getEntityByID(ans_id);
 						}else{
 							if(_basicquery.getVarDegree(result_str2id[v]) != 1){
-								tmp_res_tag_vec[result_str2id[v]] = internal_tag_str.at(ans_id);
+								tmp_res_tag_vec[result_str2id[v]] = (internal_tags.test(ans_id) ? '1' : '0');
 								tmp_res_vec[result_str2id[v]] = _kvstore->getEntityByID(ans_id);
 							}else{
 								tmp_res_tag_vec[result_str2id[v]] = '1';
@@ -396,7 +396,173 @@ void GeneralEvaluation::getCrossingEdges(KVstore *_kvstore, string& internal_tag
 	}
 }
 
-void GeneralEvaluation::findCandidate(string& internal_tag_str, vector< vector<int> >& candidates_vec, vector< vector<int> >& candidates_id_vec, vector< vector<int> > &_query_dir_ad, vector< vector<int> > &_query_pre_ad, vector< vector<int> > &_query_ad, set<int> &satellites_set)
+void GeneralEvaluation::getCrossingEdges(KVstore *_kvstore, const MappedBitmap& internal_tags, PartialResSink& lpm_sink)
+{
+	if (this->semantic_evaluation_result_stack.empty())		return;
+
+	TempResultSet *results_id = this->semantic_evaluation_result_stack.top();
+	this->semantic_evaluation_result_stack.pop();
+
+	Varset &proj = this->query_tree.getProjection();
+
+	if (this->query_tree.getQueryForm() == QueryTree::Select_Query)
+	{
+		if (this->query_tree.checkProjectionAsterisk())
+		{
+			for (int i = 0 ; i < (int)results_id->results.size(); i++)
+				proj = proj + results_id->results[i].var;
+		}
+
+		if (this->query_tree.getProjectionModifier() == QueryTree::Modifier_Distinct)
+		{
+			TempResultSet *results_id_distinct = new TempResultSet();
+
+			results_id->doDistinct(proj, *results_id_distinct);
+
+			results_id->release();
+			delete results_id;
+
+			results_id = results_id_distinct;
+		}
+
+		BasicQuery &_basicquery = this->expansion_evaluation_stack[0].sparql_query.getBasicQuery(0);
+		PartialResBuffer lpm_buf;
+
+		for (int i = 0; i < (int)results_id->results.size(); i++)
+		{
+			vector<int> result_str2id = proj.mapTo(results_id->results[i].var);
+			int var_num = result_str2id.size();
+			int size = results_id->results[i].res.size();
+			vector<int> tmp_res_vec(var_num, -1);
+			vector<char> tmp_res_tag_vec(var_num, '2');
+
+			for (int j = 0; j < size; ++j)
+			{
+				if (lpm_buf.var_num != var_num || lpm_buf.row_num >= lpm_sink.chunk_row_num)
+				{
+					if (lpm_buf.row_num > 0)
+					{
+						lpm_sink.put(lpm_buf);
+					}
+					lpm_buf.init(var_num);
+				}
+
+				for (int v = 0; v < var_num; ++v)
+				{
+					if (result_str2id[v] == -1)
+						continue;
+
+					int ans_id = results_id->results[i].res[j][result_str2id[v]];
+					if (ans_id == -1)
+					{
+						tmp_res_tag_vec[result_str2id[v]] = '2';
+						tmp_res_vec[result_str2id[v]] = -1;
+						continue;
+					}
+
+					tmp_res_vec[result_str2id[v]] = ans_id;
+					if (ans_id >= Util::LITERAL_FIRST_ID || _basicquery.getVarDegree(result_str2id[v]) == 1)
+						tmp_res_tag_vec[result_str2id[v]] = '1';
+					else
+						tmp_res_tag_vec[result_str2id[v]] = (internal_tags.test(ans_id) ? '1' : '0');
+				}
+				lpm_buf.addRow(&tmp_res_vec[0], &tmp_res_tag_vec[0]);
+			}
+		}
+
+		if (lpm_buf.row_num > 0)
+		{
+			lpm_sink.put(lpm_buf);
+		}
+	}
+
+	results_id->release();
+	delete results_id;
+}
+
+void GeneralEvaluation::getLocalFullMatches(KVstore *_kvstore, PartialResSink& lpm_sink)
+{
+	if (this->semantic_evaluation_result_stack.empty())		return;
+
+	TempResultSet *results_id = this->semantic_evaluation_result_stack.top();
+	this->semantic_evaluation_result_stack.pop();
+
+	Varset &proj = this->query_tree.getProjection();
+
+	if (this->query_tree.getQueryForm() == QueryTree::Select_Query)
+	{
+		if (this->query_tree.checkProjectionAsterisk())
+		{
+			for (int i = 0 ; i < (int)results_id->results.size(); i++)
+				proj = proj + results_id->results[i].var;
+		}
+
+		if (this->query_tree.getProjectionModifier() == QueryTree::Modifier_Distinct)
+		{
+			TempResultSet *results_id_distinct = new TempResultSet();
+
+			results_id->doDistinct(proj, *results_id_distinct);
+
+			results_id->release();
+			delete results_id;
+
+			results_id = results_id_distinct;
+		}
+
+		int var_num = proj.varset.size();
+		vector<int> tmp_res_vec(var_num, -1);
+		vector<char> tmp_res_tag_vec(var_num, '1');
+		PartialResBuffer lpm_buf(var_num);
+
+		for (int i = 0; i < (int)results_id->results.size(); i++)
+		{
+			vector<int> result_str2id = proj.mapTo(results_id->results[i].var);
+			int size = results_id->results[i].res.size();
+			for (int j = 0; j < size; ++j)
+			{
+				if (lpm_buf.row_num >= lpm_sink.chunk_row_num)
+				{
+					lpm_sink.put(lpm_buf);
+					lpm_buf.init(var_num);
+				}
+
+				for (int v = 0; v < var_num; ++v)
+				{
+					tmp_res_vec[v] = -1;
+					if (result_str2id[v] != -1)
+						tmp_res_vec[v] = results_id->results[i].res[j][result_str2id[v]];
+				}
+				lpm_buf.addRow(&tmp_res_vec[0], &tmp_res_tag_vec[0]);
+			}
+		}
+
+		if (lpm_buf.row_num > 0)
+		{
+			lpm_sink.put(lpm_buf);
+		}
+	}
+
+	results_id->release();
+	delete results_id;
+}
+
+void GeneralEvaluation::fillPartialResDict(KVstore *_kvstore, PartialResBuffer& lpm_buf)
+{
+	vector<int> referred_ids;
+	lpm_buf.getReferredIDs(referred_ids);
+
+	lpm_buf.dict_ids.clear();
+	lpm_buf.dict_strs.clear();
+	for (int i = 0; i < (int)referred_ids.size(); i++)
+	{
+		if (referred_ids[i] >= Util::LITERAL_FIRST_ID)
+			lpm_buf.addDictEntry(referred_ids[i], _kvstore->getLiteralByID(referred_ids[i]));
+		else
+			lpm_buf.addDictEntry(referred_ids[i], _kvstore->getEntityByID(referred_ids[i]));
+	}
+}
+
+void GeneralEvaluation::findCandidate(const MappedBitmap& internal_tags, vector< vector<int> >& candidates_vec, vector< vector<int> >& candidates_id_vec, vector< vector<int> > &_query_dir_ad, vector< vector<int> > &_query_pre_ad, vector< vector<int> > &_query_ad, set<int> &satellites_set)
 {
 	this->query_tree.getGroupPattern().getVarset();
 	if (this->query_tree.getGroupPattern().grouppattern_subject_object_maximal_varset.hasCommonVar(this->query_tree.getGroupPattern().grouppattern_predicate_maximal_varset))
@@ -409,10 +575,10 @@ void GeneralEvaluation::findCandidate(string& internal_tag_str, vector< vector<i
 	this->getBasicQuery(this->query_tree.getGroupPattern());
 
 	this->sparql_query.encodeQuery(this->kvstore, this->getSPARQLQueryVarset());
-	this->strategy.handleCandidate(this->sparql_query, internal_tag_str, candidates_vec, candidates_id_vec, _query_dir_ad, _query_pre_ad, _query_ad, satellites_set);
+	this->strategy.handleCandidate(this->sparql_query, internal_tags, candidates_vec, candidates_id_vec, _query_dir_ad, _query_pre_ad, _query_ad, satellites_set);
 }
 
-void GeneralEvaluation::doQuery(string& internal_tag_str)
+void GeneralEvaluation::doQuery(const MappedBitmap& internal_tags)
 {
 	this->query_tree.getGroupPattern().getVarset();
 	if (this->query_tree.getGroupPattern().grouppattern_subject_object_maximal_varset.hasCommonVar(this->query_tree.getGroupPattern().grouppattern_predicate_maximal_varset))
@@ -428,7 +594,7 @@ void GeneralEvaluation::doQuery(string& internal_tag_str)
 		//cout << "||well-designed||" << endl;
 		//cout << "=================" << endl;
 
-		this->distributed_queryRewriteEncodeRetrieveJoin(0, internal_tag_str);
+		this->distributed_queryRewriteEncodeRetrieveJoin(0, internal_tags);
 		this->semantic_evaluation_result_stack.push(this->expansion_evaluation_stack[0].result);
 	}
 	else
@@ -440,7 +606,7 @@ void GeneralEvaluation::doQuery(string& internal_tag_str)
 		this->getBasicQuery(this->query_tree.getGroupPattern());
 
 		this->sparql_query.encodeQuery(this->kvstore, this->getSPARQLQueryVarset());
-		this->strategy.handle(this->sparql_query, internal_tag_str);
+		this->strategy.handle(this->sparql_query, internal_tags);
 		
 		this->generateEvaluationPlan(this->query_tree.getGroupPattern());
 		this->doEvaluationPlan();
@@ -2654,7 +2820,7 @@ void GeneralEvaluation::queryRewriteEncodeRetrieveJoin(int dep)
 	}
 }
 
-void GeneralEvaluation::distributed_queryRewriteEncodeRetrieveJoin(int dep, string& internal_tag_str)
+void GeneralEvaluation::distributed_queryRewriteEncodeRetrieveJoin(int dep, const MappedBitmap& internal_tags)
 {
 	if (dep == 0)
 	{
@@ -2750,12 +2916,12 @@ void GeneralEvaluation::distributed_queryRewriteEncodeRetrieveJoin(int dep, stri
 			long tv_encode = Util::get_cur_time();
 
 			if (dep > 0){
-				this->strategy.handle(this->expansion_evaluation_stack[dep].sparql_query, internal_tag_str, &this->result_filter);
+				this->strategy.handle(this->expansion_evaluation_stack[dep].sparql_query, internal_tags, &this->result_filter);
 				//printf("dep >>>>>>>>>>>>>>>>>> 0\n");
 			}
 			else{
 				//printf("dep ================== 0\n");
-				this->strategy.handle(this->expansion_evaluation_stack[dep].sparql_query, internal_tag_str);
+				this->strategy.handle(this->expansion_evaluation_stack[dep].sparql_query, internal_tags);
 			}
 			long tv_handle = Util::get_cur_time();
 			//cout << "after Handle, used " << (tv_handle - tv_encode) << "ms." << endl;
@@ -24,6 +24,7 @@
 #include "RegexExpression.h"
 #include "ResultFilter.h"
 #include "../Util/Triple.h"
+#include "../Util/PartialResBuffer.h"
 
 class GeneralEvaluation
 {
@@ -52,9 +53,9 @@ class GeneralEvaluation
 		bool onlyParseQuery(const std::string &_query, int& var_num, QueryTree::QueryForm& query_form, int& star_tag, std::vector< vector<int> > &_query_adjacent_list);
 
 		void doQuery();
-		void doQuery(std::string &internal_tag_str);
+		void doQuery(const MappedBitmap& internal_tags);
 		
-		void findCandidate(string &internal_tag_str, vector< vector<int> >& candidates_vec, vector< vector<int> >& candidates_id_vec, vector< vector<int> > &_query_dir_ad, vector< vector<int> > &_query_pre_ad, vector< vector<int> > &_query_ad, set<int> &satellites_set);
+		void findCandidate(const MappedBitmap& internal_tags, vector< vector<int> >& candidates_vec, vector< vector<int> >& candidates_id_vec, vector< vector<int> > &_query_dir_ad, vector< vector<int> > &_query_pre_ad, vector< vector<int> > &_query_ad, set<int> &satellites_set);
 
 		void getBasicQuery(QueryTree::GroupPattern &grouppattern);
 
@@ -233,9 +234,15 @@ class GeneralEvaluation
 		bool expanseFirstOuterUnionGroupPattern(QueryTree::GroupPattern &grouppattern, std::deque<QueryTree::GroupPattern> &queue);
 		bool checkExpantionRewritingConnectivity(int dep);
 		void queryRewriteEncodeRetrieveJoin(int dep);
-		void distributed_queryRewriteEncodeRetrieveJoin(int dep, string& internal_tag_str);
-		void getLocalPartialResult(KVstore *_kvstore, string& internal_tag_str, vector<string>& lpm_str_vec);
-		void getCrossingEdges(KVstore *_kvstore, string& internal_tag_str, vector<string>& lpm_str_vec, vector< vector<int> >& crossing_edges_vec, vector<int>& all_crossing_edges_vec);
+		void distributed_queryRewriteEncodeRetrieveJoin(int dep, const MappedBitmap& internal_tags);
+		void getLocalPartialResult(KVstore *_kvstore, const MappedBitmap& internal_tags, vector<string>& lpm_str_vec);
+		void getCrossingEdges(KVstore *_kvstore, const MappedBitmap& internal_tags, vector<string>& lpm_str_vec, vector< vector<int> >& crossing_edges_vec, vector<int>& all_crossing_edges_vec);
+		//binary version of getCrossingEdges, rows keep local IDs without strings, the caller remaps them to global IDs
+		//or fills the dictionary of each buffer by fillPartialResDict, see Database::queryCrossingEdge
+		void getCrossingEdges(KVstore *_kvstore, const MappedBitmap& internal_tags, PartialResSink& lpm_sink);
+		//full matches of star queries, all vertices are tagged as internal
+		void getLocalFullMatches(KVstore *_kvstore, PartialResSink& lpm_sink);
+		static void fillPartialResDict(KVstore *_kvstore, PartialResBuffer& lpm_buf);
 
 		bool needOutputAnswer();
 		void setNeedOutputAnswer();
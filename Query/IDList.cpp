@@ -7,6 +7,7 @@
 =============================================================================*/
 
 #include "IDList.h"
+#include "../Util/ListIntersect.h"
 
 using namespace std;
 
@@ -126,118 +127,15 @@ IDList::intersectList(const int* _id_list, int _list_len)
 		return remove_number;
 	}
 
-	//when size is almost the same, intersect O(n)
-	//when one size is small ratio, search in the larger one O(mlogn)
-	//
-	//n>0 m=nk(0<k<1) 
-	//compare n(k+1) and nklogn: k0 = log(n/2)2 requiring that n>2
-	//k<=k0 binary search; k>k0 intersect
-	int method = -1; //0: intersect 1: search in vector 2: search in int*
-	int n = this->id_list.size();
-	double k = 0;
-	if (n < _list_len)
-	{
-		k = (double)n / (double)_list_len;
-		n = _list_len;
-		method = 2;
-	}
-	else
-	{
-		k = (double)_list_len / (double)n;
-		method = 1;
-	}
-	if (n <= 2)
-		method = 0;
-	else
-	{
-		double limit = Util::logarithm(n / 2, 2);
-		if (k > limit)
-			method = 0;
-	}
-
-	int remove_number = 0;
-	switch (method)
-	{
-	case 0:
-	{   //this bracket is needed if vars are defined in case
-		int id_i = 0;
-		int index_move_forward = 0;
-		vector<int>::iterator it = this->id_list.begin();
-		while (it != (this->id_list).end())
-		{
-			int can_id = *it;
-			while ((id_i < _list_len) && (_id_list[id_i] < can_id))
-			{
-				id_i++;
-			}
-
-			if (id_i == _list_len)
-			{
-				break;
-			}
-
-			if (can_id == _id_list[id_i])
-			{
-				(this->id_list)[index_move_forward] = can_id;
-				index_move_forward++;
-				id_i++;
-			}
-
-			it++;
-		}
-		remove_number = this->id_list.size() - index_move_forward;
-		vector<int>::iterator new_end = this->id_list.begin() + index_move_forward;
-		(this->id_list).erase(new_end, this->id_list.end());
-		break;
-	}
-	case 1:
-	{
-		vector<int> new_id_list;
-		for (int i = 0; i < _list_len; ++i)
-		{
-			if (Util::bsearch_vec_uporder(_id_list[i], this->getList()) != -1)
-				new_id_list.push_back(_id_list[i]);
-		}
-		this->id_list = new_id_list;
-		remove_number = n - this->id_list.size();
-		break;
-	}
-	case 2:
-	{
-		vector<int> new_id_list;
-		int m = this->id_list.size(), i;
-		for (i = 0; i < m; ++i)
-		{
-			if (Util::bsearch_int_uporder(this->id_list[i], _id_list, _list_len) != -1)
-				new_id_list.push_back(this->id_list[i]);
-		}
-		this->id_list = new_id_list;
-		remove_number = m - this->id_list.size();
-		break;
-	}
-	default:
-		cerr << "no such method in IDList::intersectList()" << endl;
-		break;
-	}
-
-	return remove_number;
+	//merge or gallop, see Util/ListIntersect.h
+	return ListIntersect::intersect(this->id_list, _id_list, _list_len);
 }
 
 int
 IDList::intersectList(const IDList& _id_list)
 {
-	// copy _id_list to the temp array first.
-	int temp_list_len = _id_list.size();
-	int* temp_list = new int[temp_list_len];
-	//BETTER:not to copy, just achieve here
-	for (int i = 0; i < temp_list_len; i++)
-	{
-		temp_list[i] = _id_list.getID(i);
-	}
-
-	int remove_number = this->intersectList(temp_list, temp_list_len);
-	delete[]temp_list;
-	return remove_number;
+	const vector<int>& other = *(_id_list.getList());
+	return this->intersectList(other.empty() ? NULL : &other[0], other.size());
 }
 
 int
@@ -366,94 +264,17 @@ IDList::intersect(const IDList& _id_list, const int* _list, int _len)
 	IDList* p = new IDList;
 	if (_list == NULL || _len == 0)  //just copy _id_list
 	{
-		int size = _id_list.size();
-		for (int i = 0; i < size; ++i)
-			p->addID(_id_list.getID(i));
+		p->copy(&_id_list);
 		return p;
 	}
 
-	//when size is almost the same, intersect O(n)
-	//when one size is small ratio, search in the larger one O(mlogn)
-	//
-	//n>0 m=nk(0<k<1) 
-	//compare n(k+1) and nklogn: k0 = log(n/2)2 requiring that n>2
-	//k<=k0 binary search; k>k0 intersect
-	int method = -1; //0: intersect 1: search in vector 2: search in int*
-	int n = _id_list.size();
-	double k = 0;
-	if (n < _len)
-	{
-		k = (double)n / (double)_len;
-		n = _len;
-		method = 2;
-	}
-	else
-	{
-		k = (double)_len / (double)n;
-		method = 1;
-	}
-	if (n <= 2)
-		method = 0;
-	else
-	{
-		double limit = Util::logarithm(n / 2, 2);
-		if (k > limit)
-			method = 0;
-	}
-
-	//int remove_number = 0;
-	switch (method)
-	{
-	case 0:
-	{   //this bracket is needed if vars are defined in case
-		int id_i = 0;
-		int num = _id_list.size();
-		for (int i = 0; i < num; ++i)
-		{
-			int can_id = _id_list.getID(i);
-			while ((id_i < _len) && (_list[id_i] < can_id))
-			{
-				id_i++;
-			}
-
-			if (id_i == _len)
-			{
-				break;
-			}
-
-			if (can_id == _list[id_i])
-			{
-				p->addID(can_id);
-				id_i++;
-			}
-		}
-		break;
-	}
-	case 1:
+	//merge or gallop, see Util/ListIntersect.h
+	const vector<int>& src = *(_id_list.getList());
+	if (!src.empty())
 	{
-		for (int i = 0; i < _len; ++i)
-		{
-			if (Util::bsearch_vec_uporder(_list[i], _id_list.getList()) != -1)
-				p->addID(_list[i]);
-		}
-		break;
-	}
-	case 2:
-	{
-		int m = _id_list.size(), i;
-		for (i = 0; i < m; ++i)
-		{
-			int t = _id_list.getID(i);
-			if (Util::bsearch_int_uporder(t, _list, _len) != -1)
-				p->addID(t);
-		}
-		break;
+		p->id_list.resize(src.size());
+		p->id_list.resize(ListIntersect::intersect(&src[0], src.size(), _list, _len, &p->id_list[0]));
 	}
-	default:
-		cerr << "no such method in IDList::intersectList()" << endl;
-		break;
-	}
-
 	return p;
 }
 
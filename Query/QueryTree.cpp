@@ -585,8 +585,9 @@ int QueryTree::checkStar(vector< vector<int> > &_query_adjacent_list)
 {
 	vector<QueryTree::GroupPattern::Pattern> p_vec = this->getGroupPattern().patterns;
 	
+	//the query vertices are numbered as the columns of the partial matches, in the order they appear in the patterns
 	map<string, int> varIDMap;
-	vector<string> var_vec = this->getProjection().varset;
+	vector<string> var_vec = this->getGroupPattern().grouppattern_subject_object_maximal_varset.varset;
 	for(int i = 0; i < var_vec.size(); i++){
 		varIDMap.insert(make_pair(var_vec[i], i));
 		_query_adjacent_list.push_back(vector<int>());
@@ -90,24 +90,26 @@ bool StringIndexFile::randomAccess(int id, string *str)
 	long offset = this->index_table[id].offset;
 	int length = this->index_table[id].length;
 
-	allocBuffer(length);
-
-	fseek(this->value_file, offset, SEEK_SET);
-	fread(this->buffer, sizeof(char), length, this->value_file);
-	this->buffer[length] = '\0';
-
-	*str = string(this->buffer);
+	str->resize(length);
+	if (length > 0 && pread(fileno(this->value_file), &(*str)[0], length, offset) != length)
+	{
+		str->clear();
+		return false;
+	}
 
 	return true;
 }
 
 void StringIndexFile::addRequest(int id, std::string *str)
 {
+	pthread_mutex_lock(&this->request_mutex);
 	this->request.push_back(AccessRequest(id, this->index_table[id].offset, this->index_table[id].length, str));
+	pthread_mutex_unlock(&this->request_mutex);
 }
 
 void StringIndexFile::trySequenceAccess()
 {
+	pthread_mutex_lock(&this->request_mutex);
 	long max_end = 0;
 	for (int i = 0; i < (int)this->request.size(); i++)
 		max_end = max(max_end, this->request[i].offset + long(this->request[i].length));
@@ -194,6 +196,7 @@ void StringIndexFile::trySequenceAccess()
 			this->randomAccess(this->request[i].id, this->request[i].str);
 	}
 	this->request.clear();
+	pthread_mutex_unlock(&this->request_mutex);
 }
 
 
@@ -238,6 +241,12 @@ void StringIndexFile::change(int id, KVstore &kv_store)
 	fwrite(str.c_str(), sizeof(char), this->index_table[id].length, this->value_file);
 }
 
+void StringIndexFile::flush()
+{
+	if (this->value_file != NULL)
+		fflush(this->value_file);
+}
+
 void StringIndexFile::disable(int id)
 {
 	if (id < 0 || id >= this->num)	return ;
@@ -322,11 +331,14 @@ void StringIndex::change(std::vector<int> &ids, KVstore &kv_store, bool is_entit
 			else
 				this->literal.change(ids[i] - Util::LITERAL_FIRST_ID, kv_store);
 		}
+		this->entity.flush();
+		this->literal.flush();
 	}
 	else
 	{
 		for (int i = 0; i < (int)ids.size(); i++)
 			this->predicate.change(ids[i], kv_store);
+		this->predicate.flush();
 	}
 }
 
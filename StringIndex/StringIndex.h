@@ -11,6 +11,7 @@
 
 #include "../KVstore/KVstore.h"
 #include "../Util/Util.h"
+#include <pthread.h>
 
 class StringIndexFile
 {
@@ -50,7 +51,10 @@ class StringIndexFile
 					return this->offset < x.offset;
 				}
 		};
+		//the requests of several threads are added to the same batch, so the batch
+		//and the buffer and the file position of a sequence access are guarded by it
 		std::vector<AccessRequest> request;
+		pthread_mutex_t request_mutex;
 
 	public:
 		StringIndexFile(StringIndexFileType _type, std::string _dir, int _num):type(_type), num(_num), empty_offset(0), index_file(NULL), value_file(NULL),  buffer_size(0), buffer(NULL)
@@ -61,6 +65,7 @@ class StringIndexFile
 				this->loc = _dir + "/literal_";
 			if (this->type == Predicate)
 				this->loc = _dir + "/predicate_";
+			pthread_mutex_init(&this->request_mutex, NULL);
 		}
 		~StringIndexFile()
 		{
@@ -70,6 +75,7 @@ class StringIndexFile
 				fclose(this->value_file);
 			if (this->buffer != NULL)
 				delete[] this->buffer;
+			pthread_mutex_destroy(&this->request_mutex);
 		}
 		void setNum(int _num);
 
@@ -86,11 +92,14 @@ class StringIndexFile
 			}
 		}
 
+		//read by the offset, not the file position, so it runs on several threads at a time
 		bool randomAccess(int id, std::string *str);
 		void addRequest(int id, std::string *str);
 		void trySequenceAccess();
 
 		void change(int id, KVstore &kv_store);
+		//write the changed values out to the file for randomAccess()
+		void flush();
 		void disable(int id);
 };
 
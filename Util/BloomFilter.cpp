@@ -8,63 +8,130 @@
 
 #include "BloomFilter.h"
 
+using namespace std;
+
+const double BloomFilter::DEFAULT_RATE = 0.01;
+
 BloomFilter::BloomFilter()
 {
-	//TODO
+	this->rate = BloomFilter::DEFAULT_RATE;
+	this->init(1024);
 }
 
 BloomFilter::BloomFilter(unsigned _num)
 {
-	//TODO:fix _num to mod 8 == 0
+	this->rate = BloomFilter::DEFAULT_RATE;
+	this->init(_num);
+}
+
+BloomFilter::BloomFilter(unsigned _num, double _rate)
+{
+	this->rate = (_rate > 0 && _rate < 1) ? _rate : BloomFilter::DEFAULT_RATE;
+	this->init(_num);
 }
 
+//the optimal length is -n*ln(rate)/(ln2)^2 bits with length/n*ln2 hash functions
 void
-BloomFilter::init()
+BloomFilter::init(unsigned _num)
 {
+	if(_num == 0)
+		_num = 1;
+	double ln2 = log(2.0);
+	double bits = -(double)_num * log(this->rate) / (ln2 * ln2);
+	if(bits < 64)
+		bits = 64;
+	//fix the length to mod 8 == 0
+	this->length = ((unsigned)ceil(bits) + 7) / 8 * 8;
+	this->hfnum = (unsigned)(this->length / (double)_num * ln2 + 0.5);
+	if(this->hfnum < 1)
+		this->hfnum = 1;
+	if(this->hfnum > Util::HashNum)
+		this->hfnum = Util::HashNum;
+	this->hfptr = Util::hash;
     this->filter = (char *)calloc(this->length/8, sizeof(char));  
-	//TODO:assign hash functions for hfptr
-	//assign the rate of false positive, and then compute the length and hfnum according to key num
 }
 
 BloomFilter::~BloomFilter()
 {
-	//TODO	
+	free(this->filter);
+}
+
+unsigned
+BloomFilter::getIntBit(int _record, unsigned _i) const
+{
+	unsigned h1 = (unsigned)_record * 2654435761u;
+	unsigned h2 = (unsigned)_record;
+	h2 = (h2 ^ (h2 >> 16)) * 0x45d9f3bu;
+	h2 = ((h2 ^ (h2 >> 16)) * 0x45d9f3bu) ^ (h2 >> 16);
+	return (h1 + _i * (h2 | 1)) % this->length;
 }
 
 //NOTICE:there are two ways to change int to string, one digit to one character or just change int* to char*
 //The latter is more efficient because the former consumes space and time:O(32) >= O(lgn)
+//but the hash functions in Util stop at '\0', so int records are hashed by themselves instead
 void
 BloomFilter::addRecord(int _record)
 {
-	//TODO
+	for(unsigned i = 0; i < this->hfnum; i++){
+		unsigned n = this->getIntBit(_record, i);
+		SETBIT(this->filter, n);
+	}
 }
   
 void
 BloomFilter::addRecord(const char* _record, unsigned _len)
 {
-	//TODO
+	string record(_record, _len);
+	for(unsigned i = 0; i < this->hfnum; i++){
+		unsigned n = this->hfptr[i](record.c_str()) % this->length;
+		SETBIT(this->filter, n);
+	}
 }
 
 bool
 BloomFilter::checkRecord(int _record) const
 {
-	//TODO
-	return false;
+	for(unsigned i = 0; i < this->hfnum; i++){
+		unsigned n = this->getIntBit(_record, i);
+		if(!(GETBIT(this->filter, n)))
+			return false;
+	}
+	return true;
 }
   
 bool
 BloomFilter::checkRecord(const char* _record, unsigned _len) const
 {
-	//TODO
-	return false;
+	string record(_record, _len);
+	for(unsigned i = 0; i < this->hfnum; i++){
+		unsigned n = this->hfptr[i](record.c_str()) % this->length;
+		if(!(GETBIT(this->filter, n)))
+			return false;
+	}
+	return true;
+}
+
+unsigned
+BloomFilter::getLength() const
+{
+	return this->length;
+}
+
+char*
+BloomFilter::getBits()
+{
+	return this->filter;
+}
+
+void
+BloomFilter::merge(const BloomFilter& _other)
+{
+	if(_other.length != this->length || _other.hfnum != this->hfnum){
+		cerr << "error: merge Bloom filters of different length. @BloomFilter::merge" << endl;
+		return;
+	}
+	for(unsigned i = 0; i < this->length / 8; i++){
+		this->filter[i] |= _other.filter[i];
+	}
 }
 
-		//if( GETBIT(vector, Util::HFLPHash(ch,strlen(ch))%MAX) ) 
-		//{      
-            //flag++;  
-        //} 
-		//else 
-		//{  
-            //SETBIT(vector,Util::HFLPHash(ch,strlen(ch))%MAX );  
-        //}     
-  
@@ -19,13 +19,22 @@ really better? appropiate if key num small but search too many!
 class BloomFilter
 {
 public:
+	//the default rate of false positive
+	static const double DEFAULT_RATE;
+
     BloomFilter();
     BloomFilter(unsigned _num);    //num of all keys
+    BloomFilter(unsigned _num, double _rate);
     void addRecord(int _record);
 	//NOTICE:we hope a Bstr-like struct here, for the length maybe very large
     void addRecord(const char* _record, unsigned _len);
     bool checkRecord(int _record) const;
     bool checkRecord(const char* _record, unsigned _len) const;
+	//filters of the same length and hfnum, built with the same key num and rate, can be merged by OR
+	//of their bits, i.e. on different machines by MPI_Allreduce with MPI_BOR on getBits()
+	unsigned getLength() const;
+	char* getBits();
+	void merge(const BloomFilter& _other);
 	~BloomFilter();
 private:
 	unsigned length;		//length of total bits, mod 8 == 0
@@ -34,7 +43,11 @@ private:
 	double rate;			//false positive
 	HashFunction* hfptr;    //hash functions pointer array
 
-	void init();
+	void init(unsigned _num);
+	//the _i-th bit of an int record, by double hashing
+	unsigned getIntBit(int _record, unsigned _i) const;
+	BloomFilter(const BloomFilter&);
+	BloomFilter& operator=(const BloomFilter&);
 };
 
 #endif //_UTIL_BLOOMFILTER_H
@@ -0,0 +1,235 @@
+/*=============================================================================
+# Filename: GraphPartitioner.cpp
+# Last Modified: 2026-10-17
+# Description: implement functions in GraphPartitioner.h
+=============================================================================*/
+
+#include "GraphPartitioner.h"
+
+using namespace std;
+
+static const char* MODE_NAMES[GraphPartitioner::MODE_NUM] = {"hash", "ldg", "fennel", "semantic"};
+
+int
+GraphPartitioner::getMode(const string& _name)
+{
+	for(int i = 0; i < GraphPartitioner::MODE_NUM; i++){
+		if(_name == MODE_NAMES[i])
+			return i;
+	}
+	return -1;
+}
+
+const char*
+GraphPartitioner::getModeName(int _mode)
+{
+	if(_mode < 0 || _mode >= GraphPartitioner::MODE_NUM)
+		return "unknown";
+	return MODE_NAMES[_mode];
+}
+
+GraphPartitioner::GraphPartitioner(int _part_num)
+{
+	this->part_num = max(_part_num, 1);
+}
+
+int
+GraphPartitioner::getVertex(const string& _uri)
+{
+	tr1::unordered_map<string, int>::iterator it = this->vertex_map.find(_uri);
+	if(it == this->vertex_map.end()){
+		it = this->vertex_map.insert(make_pair(_uri, (int)this->vertices.size())).first;
+		this->vertices.push_back(_uri);
+	}
+	return it->second;
+}
+
+void
+GraphPartitioner::addTriple(const TripleWithObjType& _triple)
+{
+	int sub = this->getVertex(_triple.getSubject());
+	if(!_triple.isObjEntity())
+		return;
+	int obj = this->getVertex(_triple.getObject());
+	if(sub != obj){
+		this->edge_subs.push_back(sub);
+		this->edge_objs.push_back(obj);
+	}
+}
+
+int
+GraphPartitioner::getVertexNum() const
+{
+	return this->vertices.size();
+}
+
+long long
+GraphPartitioner::getEdgeNum() const
+{
+	return this->edge_subs.size();
+}
+
+int
+GraphPartitioner::getCapacity() const
+{
+	long long n = this->vertices.size();
+	long long capacity = (n * (100 + GraphPartitioner::BALANCE_SLACK_PERCENT) + 100LL * this->part_num - 1) / (100LL * this->part_num);
+	return max((int)capacity, 1);
+}
+
+void
+GraphPartitioner::partition(int _mode, vector<int>& _parts) const
+{
+	_parts.assign(this->vertices.size(), -1);
+	if(_mode == GraphPartitioner::LDG)
+		this->partitionByStream(false, _parts);
+	else if(_mode == GraphPartitioner::FENNEL)
+		this->partitionByStream(true, _parts);
+	else if(_mode == GraphPartitioner::SEMANTIC)
+		this->partitionBySemantics(_parts);
+	else
+		this->partitionByHash(_parts);
+}
+
+void
+GraphPartitioner::partitionByHash(vector<int>& _parts) const
+{
+	for(int i = 0; i < this->vertices.size(); i++){
+		_parts[i] = Util::BKDRHash(this->vertices[i].c_str()) % this->part_num;
+	}
+}
+
+//each vertex is placed once with all its neighbors known, those placed before it are counted in their partitions
+void
+GraphPartitioner::partitionByStream(bool _fennel, vector<int>& _parts) const
+{
+	int n = this->vertices.size();
+	long long m = this->edge_subs.size();
+	vector<long long> offsets(n + 1, 0);
+	for(long long i = 0; i < m; i++){
+		offsets[this->edge_subs[i] + 1]++;
+		offsets[this->edge_objs[i] + 1]++;
+	}
+	for(int i = 0; i < n; i++){
+		offsets[i + 1] += offsets[i];
+	}
+	vector<int> neighbors(2 * m);
+	vector<long long> pos(offsets.begin(), offsets.end() - 1);
+	for(long long i = 0; i < m; i++){
+		neighbors[pos[this->edge_subs[i]]++] = this->edge_objs[i];
+		neighbors[pos[this->edge_objs[i]]++] = this->edge_subs[i];
+	}
+	vector<long long>().swap(pos);
+
+	int capacity = this->getCapacity();
+	//Fennel: the cost of a partition of size s is alpha * s^gamma, with gamma = 1.5
+	double gamma = 1.5;
+	double alpha = n == 0 ? 0 : sqrt((double)this->part_num) * m / pow((double)n, gamma);
+	vector<int> sizes(this->part_num, 0), counts(this->part_num, 0);
+	for(int v = 0; v < n; v++){
+		for(long long j = offsets[v]; j < offsets[v + 1]; j++){
+			int part = _parts[neighbors[j]];
+			if(part != -1)
+				counts[part]++;
+		}
+
+		int best = -1;
+		double best_score = 0;
+		for(int i = 0; i < this->part_num; i++){
+			if(sizes[i] >= capacity)
+				continue;
+			double score;
+			if(_fennel)
+				score = counts[i] - alpha * gamma * sqrt((double)sizes[i]);
+			else
+				score = counts[i] * (1.0 - (double)sizes[i] / capacity);
+			//ties go to the smaller partition
+			if(best == -1 || score > best_score || (score == best_score && sizes[i] < sizes[best])){
+				best = i;
+				best_score = score;
+			}
+		}
+		_parts[v] = best;
+		sizes[best]++;
+		counts.assign(this->part_num, 0);
+	}
+}
+
+//the prefixes are placed from the largest, each on the smallest partition, and a prefix that does not fit
+//in the room left there is spread by the hash of the URIs, or on the smallest partition if that one is full
+void
+GraphPartitioner::partitionBySemantics(vector<int>& _parts) const
+{
+	int n = this->vertices.size();
+	tr1::unordered_map<string, int> prefix_map;
+	vector<int> prefixes(n);
+	vector< pair<int, int> > prefix_sizes;
+	for(int i = 0; i < n; i++){
+		const string& uri = this->vertices[i];
+		size_t end = uri.find_last_of("/#");
+		string prefix = (end == string::npos ? uri : uri.substr(0, end));
+		tr1::unordered_map<string, int>::iterator it = prefix_map.find(prefix);
+		if(it == prefix_map.end()){
+			it = prefix_map.insert(make_pair(prefix, (int)prefix_sizes.size())).first;
+			prefix_sizes.push_back(make_pair(0, it->second));
+		}
+		prefixes[i] = it->second;
+		prefix_sizes[it->second].first++;
+	}
+	sort(prefix_sizes.begin(), prefix_sizes.end(), greater< pair<int, int> >());
+
+	int capacity = this->getCapacity();
+	vector<int> sizes(this->part_num, 0), prefix_parts(prefix_sizes.size(), -1);
+	for(int i = 0; i < prefix_sizes.size(); i++){
+		int smallest = min_element(sizes.begin(), sizes.end()) - sizes.begin();
+		if(sizes[smallest] + prefix_sizes[i].first <= capacity){
+			prefix_parts[prefix_sizes[i].second] = smallest;
+			sizes[smallest] += prefix_sizes[i].first;
+		}
+	}
+	for(int i = 0; i < n; i++){
+		_parts[i] = prefix_parts[prefixes[i]];
+		if(_parts[i] != -1)
+			continue;
+		int part = Util::BKDRHash(this->vertices[i].c_str()) % this->part_num;
+		if(sizes[part] >= capacity)
+			part = min_element(sizes.begin(), sizes.end()) - sizes.begin();
+		_parts[i] = part;
+		sizes[part]++;
+	}
+}
+
+long long
+GraphPartitioner::countCrossingEdges(const vector<int>& _parts) const
+{
+	long long crossing_num = 0;
+	for(long long i = 0; i < this->edge_subs.size(); i++){
+		if(_parts[this->edge_subs[i]] != _parts[this->edge_objs[i]])
+			crossing_num++;
+	}
+	return crossing_num;
+}
+
+void
+GraphPartitioner::countPartitionSizes(const vector<int>& _parts, vector<int>& _sizes) const
+{
+	_sizes.assign(this->part_num, 0);
+	for(int i = 0; i < _parts.size(); i++){
+		_sizes[_parts[i]]++;
+	}
+}
+
+bool
+GraphPartitioner::write(const vector<int>& _parts, const string& _path) const
+{
+	ofstream fout(_path.c_str());
+	if(!fout){
+		cerr << "error, can not open " << _path << ". @GraphPartitioner::write" << endl;
+		return false;
+	}
+	for(int i = 0; i < this->vertices.size(); i++){
+		fout << this->vertices[i] << '\t' << _parts[i] << '\n';
+	}
+	fout.close();
+	return !fout.fail();
+}
@@ -0,0 +1,61 @@
+/*=============================================================================
+# Filename: GraphPartitioner.h
+# Last Modified: 2026-10-17
+# Description: partition the entities of an RDF graph among the sites, and
+write them as the internal vertices file read by gloadD
+=============================================================================*/
+
+#ifndef _UTIL_GRAPHPARTITIONER_H
+#define _UTIL_GRAPHPARTITIONER_H
+
+#include "Util.h"
+#include "Triple.h"
+#include <tr1/unordered_map>
+
+//the entities are numbered in the order they are first met in the triples,
+//which is also the order they are streamed to the LDG and Fennel partitioners
+class GraphPartitioner
+{
+public:
+	//HASH: by the hash of the URI
+	//LDG: linear deterministic greedy, a vertex goes to the partition with most of its neighbors,
+	//weighted by the room left in the partition
+	//FENNEL: a vertex goes to the partition with most of its neighbors, less a cost growing with the partition size
+	//SEMANTIC: the URIs with the same prefix(up to the last '/' or '#') go to the same partition
+	enum { HASH, LDG, FENNEL, SEMANTIC, MODE_NUM };
+	//no partition gets more vertices than this percent over the average, but with HASH
+	static const int BALANCE_SLACK_PERCENT = 10;
+
+	//-1 if _name is not the name of a mode
+	static int getMode(const std::string& _name);
+	static const char* getModeName(int _mode);
+
+	GraphPartitioner(int _part_num);
+	//literals are not partitioned, a triple with a literal object only adds its subject
+	void addTriple(const TripleWithObjType& _triple);
+	int getVertexNum() const;
+	long long getEdgeNum() const;
+	//_parts[i] is the partition of the i-th vertex, from 0 to _part_num - 1
+	void partition(int _mode, std::vector<int>& _parts) const;
+	//the edges between entities of different partitions, which are kept by both sites and give partial matches
+	long long countCrossingEdges(const std::vector<int>& _parts) const;
+	void countPartitionSizes(const std::vector<int>& _parts, std::vector<int>& _sizes) const;
+	//a "URI\tpartition ID" line for each vertex, as read by gloadD and Database::loadInternalVertices
+	bool write(const std::vector<int>& _parts, const std::string& _path) const;
+
+private:
+	int part_num;
+	std::tr1::unordered_map<std::string, int> vertex_map;
+	std::vector<std::string> vertices;
+	//the edges between entities, without self loops
+	std::vector<int> edge_subs;
+	std::vector<int> edge_objs;
+
+	int getVertex(const std::string& _uri);
+	int getCapacity() const;
+	void partitionByHash(std::vector<int>& _parts) const;
+	void partitionByStream(bool _fennel, std::vector<int>& _parts) const;
+	void partitionBySemantics(std::vector<int>& _parts) const;
+};
+
+#endif //_UTIL_GRAPHPARTITIONER_H
@@ -0,0 +1,166 @@
+/*=============================================================================
+# Filename: IDBitmap.cpp
+# Last Modified: 2026-10-17
+# Description: implement functions in IDBitmap.h
+=============================================================================*/
+
+#include "IDBitmap.h"
+
+using namespace std;
+
+IDBitmap::IDBitmap()
+{
+	this->id_num = 0;
+}
+
+void
+IDBitmap::clear()
+{
+	this->id_num = 0;
+	this->keys.clear();
+	this->containers.clear();
+}
+
+int
+IDBitmap::findContainer(unsigned short _key) const
+{
+	vector<unsigned short>::const_iterator it = lower_bound(this->keys.begin(), this->keys.end(), _key);
+	if(it == this->keys.end() || *it != _key)
+		return -1;
+	return it - this->keys.begin();
+}
+
+bool
+IDBitmap::containsLow(const Container& _container, unsigned short _low)
+{
+	if(_container.bits.empty())
+		return binary_search(_container.values.begin(), _container.values.end(), _low);
+	return (_container.bits[_low >> 6] >> (_low & 63)) & 1;
+}
+
+void
+IDBitmap::toBitmap(Container& _container)
+{
+	_container.bits.assign(IDBitmap::BITMAP_WORD_NUM, 0);
+	for(int i = 0; i < _container.values.size(); ++i){
+		_container.bits[_container.values[i] >> 6] |= 1ULL << (_container.values[i] & 63);
+	}
+	vector<unsigned short>().swap(_container.values);
+}
+
+void
+IDBitmap::add(int _id)
+{
+	unsigned short key = (unsigned)_id >> 16, low = _id & 0xFFFF;
+	int pos;
+	if(!this->keys.empty() && this->keys.back() == key){
+		pos = this->keys.size() - 1;
+	}else{
+		pos = lower_bound(this->keys.begin(), this->keys.end(), key) - this->keys.begin();
+		if(pos == this->keys.size() || this->keys[pos] != key){
+			//the containers are swapped into place instead of copied
+			this->keys.insert(this->keys.begin() + pos, key);
+			this->containers.push_back(Container());
+			for(int i = this->containers.size() - 1; i > pos; --i){
+				this->containers[i].values.swap(this->containers[i - 1].values);
+				this->containers[i].bits.swap(this->containers[i - 1].bits);
+				this->containers[i].num = this->containers[i - 1].num;
+			}
+			this->containers[pos].values.clear();
+			this->containers[pos].bits.clear();
+			this->containers[pos].num = 0;
+		}
+	}
+
+	Container& container = this->containers[pos];
+	if(container.bits.empty()){
+		if(container.values.empty() || container.values.back() < low){
+			container.values.push_back(low);
+		}else{
+			vector<unsigned short>::iterator it = lower_bound(container.values.begin(), container.values.end(), low);
+			if(*it == low)
+				return;
+			container.values.insert(it, low);
+		}
+		if(container.values.size() > IDBitmap::ARRAY_MAX_SIZE)
+			IDBitmap::toBitmap(container);
+	}else{
+		unsigned long long& word = container.bits[low >> 6];
+		unsigned long long bit = 1ULL << (low & 63);
+		if(word & bit)
+			return;
+		word |= bit;
+	}
+	container.num++;
+	this->id_num++;
+}
+
+bool
+IDBitmap::contains(int _id) const
+{
+	if(_id < 0)
+		return false;
+	int pos = this->findContainer((unsigned)_id >> 16);
+	return pos != -1 && IDBitmap::containsLow(this->containers[pos], _id & 0xFFFF);
+}
+
+int
+IDBitmap::intersect(const int* _list, int _len, int* _result) const
+{
+	int k = 0, pos = 0, container_num = this->keys.size();
+	//the position in the array of the current container, the IDs of _list only go up
+	int value_pos = 0;
+	for(int i = 0; i < _len && pos < container_num; ++i){
+		int id = _list[i];
+		if(id < 0)
+			continue;
+		unsigned short key = (unsigned)id >> 16, low = id & 0xFFFF;
+		if(this->keys[pos] < key){
+			pos = lower_bound(this->keys.begin() + pos, this->keys.end(), key) - this->keys.begin();
+			value_pos = 0;
+			if(pos == container_num)
+				break;
+		}
+		if(this->keys[pos] != key)
+			continue;
+		const Container& container = this->containers[pos];
+		if(container.bits.empty()){
+			value_pos = lower_bound(container.values.begin() + value_pos, container.values.end(), low) - container.values.begin();
+			if(value_pos < container.values.size() && container.values[value_pos] == low)
+				_result[k++] = id;
+		}else if((container.bits[low >> 6] >> (low & 63)) & 1){
+			_result[k++] = id;
+		}
+	}
+	return k;
+}
+
+void
+IDBitmap::getIDs(vector<int>& _ids) const
+{
+	_ids.clear();
+	_ids.reserve(this->id_num);
+	for(int i = 0; i < this->keys.size(); ++i){
+		int high = (int)this->keys[i] << 16;
+		const Container& container = this->containers[i];
+		if(container.bits.empty()){
+			for(int j = 0; j < container.values.size(); ++j){
+				_ids.push_back(high | container.values[j]);
+			}
+			continue;
+		}
+		for(int j = 0; j < IDBitmap::BITMAP_WORD_NUM; ++j){
+			for(unsigned long long word = container.bits[j]; word != 0; word &= word - 1){
+				_ids.push_back(high | (j << 6) | __builtin_ctzll(word));
+			}
+		}
+	}
+}
+
+void
+IDBitmap::swap(IDBitmap& _other)
+{
+	std::swap(this->id_num, _other.id_num);
+	this->keys.swap(_other.keys);
+	this->containers.swap(_other.containers);
+}
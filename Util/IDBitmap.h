@@ -0,0 +1,62 @@
+/*=============================================================================
+# Filename: IDBitmap.h
+# Last Modified: 2026-10-17
+# Description: a compressed set of non-negative IDs for the candidates of
+the distributed join, split by the high 16 bits of the IDs into containers
+of up to 65536 IDs, each a sorted array of the low 16 bits while it is
+sparse and a bitmap of 8KB once it has more than 4096 IDs
+=============================================================================*/
+
+#ifndef _UTIL_IDBITMAP_H
+#define _UTIL_IDBITMAP_H
+
+#include "Util.h"
+
+class IDBitmap
+{
+public:
+	//a container with more IDs is a bitmap
+	static const int ARRAY_MAX_SIZE = 4096;
+
+	IDBitmap();
+	void clear();
+	int size() const
+	{
+		return this->id_num;
+	}
+	bool empty() const
+	{
+		return this->id_num == 0;
+	}
+
+	//faster if the IDs are added in increasing order
+	void add(int _id);
+	bool contains(int _id) const;
+	//the IDs of _list found in the bitmap, _list is in increasing order, _result has room for _len IDs
+	//and may be _list itself, the number of IDs in it is returned
+	int intersect(const int* _list, int _len, int* _result) const;
+	//all the IDs, in increasing order
+	void getIDs(std::vector<int>& _ids) const;
+	void swap(IDBitmap& _other);
+
+private:
+	static const int BITMAP_WORD_NUM = 65536 / 64;
+	struct Container
+	{
+		//the low 16 bits of the IDs in increasing order, or empty for a bitmap
+		std::vector<unsigned short> values;
+		std::vector<unsigned long long> bits;
+		int num;
+	};
+	int id_num;
+	//the high 16 bits of the IDs in each container, in increasing order
+	std::vector<unsigned short> keys;
+	std::vector<Container> containers;
+
+	//the index of the container, -1 if not found
+	int findContainer(unsigned short _key) const;
+	static bool containsLow(const Container& _container, unsigned short _low);
+	static void toBitmap(Container& _container);
+};
+
+#endif //_UTIL_IDBITMAP_H
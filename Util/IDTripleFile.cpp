@@ -0,0 +1,346 @@
+/*=============================================================================
+# Filename: IDTripleFile.cpp
+# Last Modified: 2026-10-17
+# Description: implement functions in IDTripleFile.h
+=============================================================================*/
+
+#include "IDTripleFile.h"
+
+using namespace std;
+
+//triples per buffer of a writer
+static const int WRITER_TRIPLE_NUM = 256 * 1024;
+
+IDTripleWriter::IDTripleWriter()
+{
+	this->fp = NULL;
+	this->triple_num = 0;
+}
+
+IDTripleWriter::~IDTripleWriter()
+{
+	this->close();
+}
+
+bool
+IDTripleWriter::open(const string& _path)
+{
+	this->close();
+	this->fp = fopen(_path.c_str(), "wb");
+	if(this->fp == NULL){
+		cerr << "IDTripleWriter: Fail to open : " << _path << endl;
+		return false;
+	}
+	this->buffer.reserve(3 * WRITER_TRIPLE_NUM);
+	this->triple_num = 0;
+	return true;
+}
+
+void
+IDTripleWriter::write(const int* _triple)
+{
+	this->buffer.insert(this->buffer.end(), _triple, _triple + 3);
+	this->triple_num++;
+	if(this->buffer.size() >= 3 * WRITER_TRIPLE_NUM)
+		this->flush();
+}
+
+void
+IDTripleWriter::flush()
+{
+	if(!this->buffer.empty())
+		fwrite(&this->buffer[0], sizeof(int), this->buffer.size(), this->fp);
+	this->buffer.clear();
+}
+
+void
+IDTripleWriter::close()
+{
+	if(this->fp == NULL)
+		return;
+	this->flush();
+	fclose(this->fp);
+	this->fp = NULL;
+}
+
+long long
+IDTripleWriter::getTripleNum() const
+{
+	return this->triple_num;
+}
+
+IDTripleReader::IDTripleReader(int _buffer_size)
+{
+	this->fp = NULL;
+	int triple_num = _buffer_size / (3 * sizeof(int));
+	if(triple_num < 1)
+		triple_num = 1;
+	this->buffer.resize(3 * triple_num);
+	this->pos = this->size = 0;
+}
+
+IDTripleReader::~IDTripleReader()
+{
+	this->close();
+}
+
+bool
+IDTripleReader::open(const string& _path)
+{
+	this->close();
+	this->fp = fopen(_path.c_str(), "rb");
+	if(this->fp == NULL){
+		cerr << "IDTripleReader: Fail to open : " << _path << endl;
+		return false;
+	}
+	this->pos = this->size = 0;
+	return true;
+}
+
+bool
+IDTripleReader::read(int* _triple)
+{
+	if(this->pos == this->size){
+		if(this->fp == NULL)
+			return false;
+		this->size = fread(&this->buffer[0], 3 * sizeof(int), this->buffer.size() / 3, this->fp) * 3;
+		this->pos = 0;
+		if(this->size == 0)
+			return false;
+	}
+	_triple[0] = this->buffer[this->pos];
+	_triple[1] = this->buffer[this->pos + 1];
+	_triple[2] = this->buffer[this->pos + 2];
+	this->pos += 3;
+	return true;
+}
+
+void
+IDTripleReader::close()
+{
+	if(this->fp != NULL)
+		fclose(this->fp);
+	this->fp = NULL;
+	this->pos = this->size = 0;
+}
+
+IDListReader::IDListReader()
+{
+	this->key_num = this->val_num = 0;
+	this->sort_list = false;
+	this->has_next = false;
+}
+
+bool
+IDListReader::open(const string& _path, int _key_num, const int* _key_fields, int _val_num, const int* _val_fields, bool _sort_list)
+{
+	this->key_num = _key_num;
+	this->val_num = _val_num;
+	for(int i = 0; i < _key_num; i++){
+		this->key_fields[i] = _key_fields[i];
+	}
+	for(int i = 0; i < _val_num; i++){
+		this->val_fields[i] = _val_fields[i];
+	}
+	this->sort_list = _sort_list;
+	if(!this->reader.open(_path)){
+		this->has_next = false;
+		return false;
+	}
+	this->has_next = this->reader.read(this->next_triple);
+	return true;
+}
+
+bool
+IDListReader::read(int* _key, const int*& _list, int& _list_len)
+{
+	if(!this->has_next)
+		return false;
+	for(int i = 0; i < this->key_num; i++){
+		_key[i] = this->next_triple[this->key_fields[i]];
+	}
+	this->list.clear();
+	int triple[3];
+	while(this->has_next){
+		memcpy(triple, this->next_triple, sizeof(triple));
+		this->has_next = this->reader.read(this->next_triple);
+		//a triple given more than once is listed once
+		if(this->has_next && memcmp(triple, this->next_triple, sizeof(triple)) == 0)
+			continue;
+		for(int i = 0; i < this->val_num; i++){
+			this->list.push_back(triple[this->val_fields[i]]);
+		}
+		bool same_key = this->has_next;
+		for(int i = 0; i < this->key_num && same_key; i++){
+			same_key = (triple[this->key_fields[i]] == this->next_triple[this->key_fields[i]]);
+		}
+		if(!same_key)
+			break;
+	}
+	if(this->sort_list)
+		std::sort(this->list.begin(), this->list.end());
+	_list = &this->list[0];
+	_list_len = this->list.size();
+	return true;
+}
+
+void
+IDListReader::close()
+{
+	this->reader.close();
+	this->has_next = false;
+}
+
+struct IDTriple
+{
+	int ids[3];
+};
+
+//compare the fields in the order given, with the positions of sub, pre and obj being 0, 1 and 2
+class IDTripleLess
+{
+public:
+	IDTripleLess(int _order)
+	{
+		static const int fields[4][3] = {{0, 1, 2}, {2, 1, 0}, {1, 0, 2}, {0, 2, 1}};
+		for(int i = 0; i < 3; i++){
+			this->fields[i] = fields[_order][i];
+		}
+	}
+	bool operator()(const IDTriple& _a, const IDTriple& _b) const
+	{
+		return this->less(_a.ids, _b.ids);
+	}
+	bool less(const int* _a, const int* _b) const
+	{
+		for(int i = 0; i < 3; i++){
+			int field = this->fields[i];
+			if(_a[field] != _b[field])
+				return _a[field] < _b[field];
+		}
+		return false;
+	}
+
+private:
+	int fields[3];
+};
+
+//the heap of the merge keeps the head triple of each run, with the smallest on the top
+class RunHeadGreater
+{
+public:
+	RunHeadGreater(const IDTripleLess& _less, const vector<IDTriple>& _heads)
+		: less(_less), heads(_heads)
+	{
+	}
+	bool operator()(int _a, int _b) const
+	{
+		return this->less(this->heads[_b], this->heads[_a]);
+	}
+
+private:
+	IDTripleLess less;
+	const vector<IDTriple>& heads;
+};
+
+IDTripleSorter::IDTripleSorter(long long _memory)
+{
+	this->memory = _memory;
+	if(this->memory < (long long)sizeof(IDTriple))
+		this->memory = sizeof(IDTriple);
+}
+
+bool
+IDTripleSorter::sort(const string& _in_file, const string& _out_file, int _order)
+{
+	FILE* fin = fopen(_in_file.c_str(), "rb");
+	if(fin == NULL){
+		cerr << "IDTripleSorter: Fail to open : " << _in_file << endl;
+		return false;
+	}
+
+	IDTripleLess less(_order);
+	long long run_triple_num = this->memory / sizeof(IDTriple);
+	//no more memory than the triples need
+	fseek(fin, 0, SEEK_END);
+	long long file_triple_num = ftell(fin) / sizeof(IDTriple);
+	fseek(fin, 0, SEEK_SET);
+	if(file_triple_num + 1 < run_triple_num)
+		run_triple_num = file_triple_num + 1;
+	vector<IDTriple> run;
+	vector<string> run_files;
+	while(true){
+		run.resize(run_triple_num);
+		size_t num = fread(&run[0], sizeof(IDTriple), run_triple_num, fin);
+		if(num == 0 && !run_files.empty())
+			break;
+		run.resize(num);
+		std::sort(run.begin(), run.end(), less);
+
+		//a single run is the sorted file itself
+		bool last = (num < run_triple_num);
+		string run_file = _out_file;
+		if(!last || !run_files.empty()){
+			stringstream ss;
+			ss << _out_file << ".run" << run_files.size();
+			run_file = ss.str();
+			run_files.push_back(run_file);
+		}
+		FILE* fout = fopen(run_file.c_str(), "wb");
+		if(fout == NULL){
+			cerr << "IDTripleSorter: Fail to open : " << run_file << endl;
+			fclose(fin);
+			return false;
+		}
+		if(num > 0)
+			fwrite(&run[0], sizeof(IDTriple), num, fout);
+		fclose(fout);
+		if(last)
+			break;
+	}
+	fclose(fin);
+	vector<IDTriple>().swap(run);
+
+	if(run_files.empty())
+		return true;
+
+	//merge the runs, their buffers share the memory
+	int run_num = run_files.size();
+	long long buffer_size = this->memory / (run_num + 1);
+	if(buffer_size < 64 * 1024)
+		buffer_size = 64 * 1024;
+	if(buffer_size > 64 * 1024 * 1024)
+		buffer_size = 64 * 1024 * 1024;
+	vector<IDTripleReader*> readers(run_num);
+	vector<IDTriple> heads(run_num);
+	vector<int> heap;
+	RunHeadGreater greater(less, heads);
+	for(int i = 0; i < run_num; i++){
+		readers[i] = new IDTripleReader(buffer_size);
+		readers[i]->open(run_files[i]);
+		if(readers[i]->read(heads[i].ids))
+			heap.push_back(i);
+	}
+	make_heap(heap.begin(), heap.end(), greater);
+
+	IDTripleWriter writer;
+	bool flag = writer.open(_out_file);
+	while(flag && !heap.empty()){
+		pop_heap(heap.begin(), heap.end(), greater);
+		int i = heap.back();
+		writer.write(heads[i].ids);
+		if(readers[i]->read(heads[i].ids))
+			push_heap(heap.begin(), heap.end(), greater);
+		else
+			heap.pop_back();
+	}
+	writer.close();
+
+	for(int i = 0; i < run_num; i++){
+		delete readers[i];
+		remove(run_files[i].c_str());
+	}
+	cout << "sort " << writer.getTripleNum() << " triples by merging " << run_num << " runs into " << _out_file << endl;
+
+	return flag;
+}
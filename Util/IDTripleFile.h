@@ -0,0 +1,94 @@
+/*=============================================================================
+# Filename: IDTripleFile.h
+# Last Modified: 2026-10-17
+# Description: ID triples kept as int[3] records(sub, pre, obj) in flat binary
+files while a database is built, and sorted by a multi-way external merge sort,
+so that the tuples of a fragment do not have to fit in memory
+=============================================================================*/
+
+#ifndef _UTIL_IDTRIPLEFILE_H
+#define _UTIL_IDTRIPLEFILE_H
+
+#include "Util.h"
+
+class IDTripleWriter
+{
+public:
+	IDTripleWriter();
+	~IDTripleWriter();
+	bool open(const std::string& _path);
+	void write(const int* _triple);
+	void close();
+	long long getTripleNum() const;
+
+private:
+	FILE* fp;
+	std::vector<int> buffer;
+	long long triple_num;
+
+	void flush();
+};
+
+class IDTripleReader
+{
+public:
+	//_buffer_size is in bytes
+	IDTripleReader(int _buffer_size = 4 * 1024 * 1024);
+	~IDTripleReader();
+	bool open(const std::string& _path);
+	//return false at the end of the file
+	bool read(int* _triple);
+	void close();
+
+private:
+	FILE* fp;
+	std::vector<int> buffer;
+	int pos;
+	int size;
+};
+
+//group the triples of a sorted file by their leading fields, and list the other fields of
+//each triple in a group, just as the id lists kept in KVstore
+class IDListReader
+{
+public:
+	IDListReader();
+	//the file must be sorted on the _key_num fields in _key_fields first, and lists of one
+	//field can be sorted with _sort_list, as they are not in order otherwise
+	bool open(const std::string& _path, int _key_num, const int* _key_fields, int _val_num, const int* _val_fields, bool _sort_list = false);
+	//return false at the end of the file, _list is valid until the next call
+	bool read(int* _key, const int*& _list, int& _list_len);
+	void close();
+
+private:
+	IDTripleReader reader;
+	int key_num;
+	int key_fields[3];
+	int val_num;
+	int val_fields[3];
+	bool sort_list;
+	int next_triple[3];
+	bool has_next;
+	std::vector<int> list;
+};
+
+class IDTripleSorter
+{
+public:
+	//the orders of the fields to sort on
+	static const int SPO = 0;
+	static const int OPS = 1;
+	static const int PSO = 2;
+	static const int SOP = 3;
+	//bytes of triples sorted in memory at a time, each such run is written to a file of its own
+	static const long long DEFAULT_MEMORY = 512LL * 1024 * 1024;
+
+	IDTripleSorter(long long _memory = DEFAULT_MEMORY);
+	//the runs are kept in _out_file.run<i> until they are merged into _out_file
+	bool sort(const std::string& _in_file, const std::string& _out_file, int _order);
+
+private:
+	long long memory;
+};
+
+#endif //_UTIL_IDTRIPLEFILE_H
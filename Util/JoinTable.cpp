@@ -0,0 +1,146 @@
+/*=============================================================================
+# Filename: JoinTable.cpp
+# Last Modified: 2026-10-17
+# Description: implement functions in JoinTable.h
+=============================================================================*/
+
+#include "JoinTable.h"
+
+using namespace std;
+
+JoinTable::JoinTable()
+{
+	this->width = 0;
+	this->row_num = 0;
+}
+
+JoinTable::JoinTable(int _width)
+{
+	this->width = _width;
+	this->row_num = 0;
+}
+
+void
+JoinTable::init(int _width)
+{
+	this->width = _width;
+	this->row_num = 0;
+	this->cells.clear();
+}
+
+void
+JoinTable::clear()
+{
+	this->row_num = 0;
+	this->cells.clear();
+}
+
+//cells only grows by doubling, so the appends of a step do not copy the table each time
+void
+JoinTable::reserveRows(int _row_num)
+{
+	size_t cell_num = (size_t)_row_num * this->width;
+	if(cell_num > this->cells.capacity())
+		this->cells.reserve(max(cell_num, 2 * this->cells.capacity()));
+}
+
+int*
+JoinTable::addRow()
+{
+	this->reserveRows(this->row_num + 1);
+	this->cells.resize(this->cells.size() + this->width, -1);
+	return this->getRow(this->row_num++);
+}
+
+void
+JoinTable::addRow(const int* _row)
+{
+	this->reserveRows(this->row_num + 1);
+	this->cells.insert(this->cells.end(), _row, _row + this->width);
+	this->row_num++;
+}
+
+void
+JoinTable::addRows(const int* _row, int _col, const int* _vals, int _val_num)
+{
+	this->reserveRows(this->row_num + _val_num);
+	for(int i = 0; i < _val_num; i++){
+		this->cells.insert(this->cells.end(), _row, _row + this->width);
+		this->cells[(size_t)this->row_num * this->width + _col] = _vals[i];
+		this->row_num++;
+	}
+}
+
+void
+JoinTable::popRow()
+{
+	this->row_num--;
+	this->cells.resize((size_t)this->row_num * this->width);
+}
+
+void
+JoinTable::select(const vector<int>& _selection)
+{
+	for(int i = 0; i < _selection.size(); i++){
+		if(_selection[i] != i)
+			memmove(this->getRow(i), this->getRow(_selection[i]), sizeof(int) * this->width);
+	}
+	this->row_num = _selection.size();
+	this->cells.resize((size_t)this->row_num * this->width);
+}
+
+void
+JoinTable::append(const JoinTable& _other)
+{
+	this->reserveRows(this->row_num + _other.row_num);
+	this->cells.insert(this->cells.end(), _other.cells.begin(), _other.cells.end());
+	this->row_num += _other.row_num;
+}
+
+struct JoinTableRowLess
+{
+	const JoinTable* table;
+	JoinTableRowLess(const JoinTable* _table)
+	{
+		this->table = _table;
+	}
+	bool operator()(int _a, int _b) const
+	{
+		const int* row_a = this->table->getRow(_a);
+		const int* row_b = this->table->getRow(_b);
+		return lexicographical_compare(row_a, row_a + this->table->getWidth(), row_b, row_b + this->table->getWidth());
+	}
+};
+
+void
+JoinTable::sortUnique()
+{
+	if(this->row_num <= 1)
+		return;
+	vector<int> order(this->row_num);
+	for(int i = 0; i < this->row_num; i++){
+		order[i] = i;
+	}
+	sort(order.begin(), order.end(), JoinTableRowLess(this));
+
+	vector<int> sorted_cells;
+	sorted_cells.reserve(this->cells.size());
+	int sorted_num = 0;
+	for(int i = 0; i < this->row_num; i++){
+		const int* row = this->getRow(order[i]);
+		if(sorted_num > 0 && equal(row, row + this->width, &sorted_cells[(size_t)(sorted_num - 1) * this->width]))
+			continue;
+		sorted_cells.insert(sorted_cells.end(), row, row + this->width);
+		sorted_num++;
+	}
+	this->cells.swap(sorted_cells);
+	this->row_num = sorted_num;
+}
+
+void
+JoinTable::swap(JoinTable& _other)
+{
+	std::swap(this->width, _other.width);
+	std::swap(this->row_num, _other.row_num);
+	this->cells.swap(_other.cells);
+}
@@ -0,0 +1,73 @@
+/*=============================================================================
+# Filename: JoinTable.h
+# Last Modified: 2026-10-17
+# Description: intermediate results of the joins of a site, fixed-width rows
+of vertex IDs(one column per query vertex, -1 if not matched yet) kept
+row-major in one arena, so that a join step appends its rows in batch,
+filters the rows in place and swaps tables without copying
+=============================================================================*/
+
+#ifndef _UTIL_JOINTABLE_H
+#define _UTIL_JOINTABLE_H
+
+#include "Util.h"
+
+class JoinTable
+{
+public:
+	JoinTable();
+	JoinTable(int _width);
+	//the rows are removed
+	void init(int _width);
+	void clear();
+
+	int getWidth() const
+	{
+		return this->width;
+	}
+	int size() const
+	{
+		return this->row_num;
+	}
+	bool empty() const
+	{
+		return this->row_num == 0;
+	}
+	const int* getRow(int _row) const
+	{
+		return &this->cells[(size_t)_row * this->width];
+	}
+	int* getRow(int _row)
+	{
+		return &this->cells[(size_t)_row * this->width];
+	}
+	int get(int _row, int _col) const
+	{
+		return this->cells[(size_t)_row * this->width + _col];
+	}
+
+	//append a row of -1 and return it, valid until the next append
+	int* addRow();
+	//_row can not be a row of this table, which may be moved by the append
+	void addRow(const int* _row);
+	//append a copy of _row for each of the _val_num values, with _col set to the value
+	void addRows(const int* _row, int _col, const int* _vals, int _val_num);
+	//remove the last row
+	void popRow();
+	//keep only the rows in _selection, which are increasing, in place
+	void select(const std::vector<int>& _selection);
+	//append the rows of a table of the same width
+	void append(const JoinTable& _other);
+	//sort the rows in increasing order of their IDs and remove the duplicates
+	void sortUnique();
+	void swap(JoinTable& _other);
+
+private:
+	int width;
+	int row_num;
+	std::vector<int> cells;
+
+	void reserveRows(int _row_num);
+};
+
+#endif //_UTIL_JOINTABLE_H
@@ -0,0 +1,394 @@
+/*=============================================================================
+# Filename: ListIntersect.cpp
+# Last Modified: 2026-10-17
+# Description: implement functions in ListIntersect.h
+=============================================================================*/
+
+#include "ListIntersect.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define LISTINTERSECT_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+//by the mask of the matched lanes of a block: the number of lanes, and the shuffle(SSE) or
+//permutation(AVX2) moving them to the front of the block
+static int mask_counts[256];
+static unsigned char sse_shuffles[16][16];
+static int avx2_permutes[256][8];
+
+static int
+initLevel()
+{
+	for(int mask = 0; mask < 256; mask++){
+		int k = 0;
+		for(int lane = 0; lane < 8; lane++){
+			if(mask & (1 << lane))
+				avx2_permutes[mask][k++] = lane;
+		}
+		mask_counts[mask] = k;
+		for(; k < 8; k++){
+			avx2_permutes[mask][k] = 0;
+		}
+	}
+	for(int mask = 0; mask < 16; mask++){
+		int k = 0;
+		for(int lane = 0; lane < 4; lane++){
+			if(!(mask & (1 << lane)))
+				continue;
+			for(int b = 0; b < 4; b++){
+				sse_shuffles[mask][4 * k + b] = 4 * lane + b;
+			}
+			k++;
+		}
+		for(int b = 4 * k; b < 16; b++){
+			sse_shuffles[mask][b] = 0x80;
+		}
+	}
+
+#ifdef LISTINTERSECT_X86
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2"))
+		return ListIntersect::AVX2;
+	if(__builtin_cpu_supports("sse4.2"))
+		return ListIntersect::SSE;
+#endif
+	return ListIntersect::SCALAR;
+}
+
+//the tables are filled before any level is used
+static const int supported_level = initLevel();
+int ListIntersect::level = supported_level;
+
+int
+ListIntersect::getLevel()
+{
+	return ListIntersect::level;
+}
+
+const char*
+ListIntersect::getLevelName(int _level)
+{
+	if(_level == ListIntersect::AVX2)
+		return "avx2";
+	if(_level == ListIntersect::SSE)
+		return "sse4.2";
+	return "scalar";
+}
+
+void
+ListIntersect::setLevel(int _level)
+{
+	if(_level >= ListIntersect::SCALAR && _level <= supported_level)
+		ListIntersect::level = _level;
+}
+
+//the merge goes on from _list1[_i] and _list2[_j] one ID at a time, the IDs of _list2 before _j
+//do not match the IDs of _list1 from _i
+static int
+mergeScalar(const int* _list1, int _len1, const int* _list2, int _len2, int* _result, int _i, int _j, int _k)
+{
+	while(_i < _len1 && _j < _len2){
+		if(_list1[_i] < _list2[_j])
+			_i++;
+		else if(_list1[_i] > _list2[_j])
+			_j++;
+		else
+			_result[_k++] = _list1[_i++];
+	}
+	return _k;
+}
+
+//the block of _list1 from _i met the blocks of _list2 before _j, and _mask has the lanes matched there,
+//the other lanes can only match from _j on
+static int
+mergeBlockTail(const int* _list1, int _len1, const int* _list2, int _len2, int* _result, int _i, int _j, int _k, int _width, int _mask)
+{
+	for(int lane = 0; lane < _width; lane++, _i++){
+		if(_mask & (1 << lane)){
+			_result[_k++] = _list1[_i];
+			continue;
+		}
+		while(_j < _len2 && _list2[_j] < _list1[_i]){
+			_j++;
+		}
+		if(_j < _len2 && _list2[_j] == _list1[_i])
+			_result[_k++] = _list1[_i];
+	}
+	return mergeScalar(_list1, _len1, _list2, _len2, _result, _i, _j, _k);
+}
+
+//a block of _list1 is compared with the blocks of _list2 until one ends after it, and its matched lanes
+//are written then, so that duplicates in _list2 do not write them twice. The block written is full width
+//but at most as far as the IDs of _list1 read, which fits in _result
+#ifdef LISTINTERSECT_X86
+__attribute__((target("sse4.2")))
+static int
+mergeSSE(const int* _list1, int _len1, const int* _list2, int _len2, int* _result)
+{
+	int i = 0, j = 0, k = 0, mask = 0;
+	while(i + 4 <= _len1 && j + 4 <= _len2){
+		__m128i va = _mm_loadu_si128((const __m128i*)(_list1 + i));
+		__m128i vb = _mm_loadu_si128((const __m128i*)(_list2 + j));
+		__m128i eq = _mm_cmpeq_epi32(va, vb);
+		eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+		eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+		eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+		mask |= _mm_movemask_ps(_mm_castsi128_ps(eq));
+		if(_list1[i + 3] <= _list2[j + 3]){
+			__m128i shuffle = _mm_loadu_si128((const __m128i*)sse_shuffles[mask]);
+			_mm_storeu_si128((__m128i*)(_result + k), _mm_shuffle_epi8(va, shuffle));
+			k += mask_counts[mask];
+			mask = 0;
+			i += 4;
+		}else{
+			j += 4;
+		}
+	}
+	if(i + 4 <= _len1)
+		return mergeBlockTail(_list1, _len1, _list2, _len2, _result, i, j, k, 4, mask);
+	return mergeScalar(_list1, _len1, _list2, _len2, _result, i, j, k);
+}
+
+__attribute__((target("avx2")))
+static int
+mergeAVX2(const int* _list1, int _len1, const int* _list2, int _len2, int* _result)
+{
+	//lane i takes lane i + 1
+	const __m256i rotate = _mm256_set_epi32(0, 7, 6, 5, 4, 3, 2, 1);
+	int i = 0, j = 0, k = 0, mask = 0;
+	while(i + 8 <= _len1 && j + 8 <= _len2){
+		__m256i va = _mm256_loadu_si256((const __m256i*)(_list1 + i));
+		__m256i vb = _mm256_loadu_si256((const __m256i*)(_list2 + j));
+		__m256i eq = _mm256_cmpeq_epi32(va, vb);
+		for(int r = 1; r < 8; r++){
+			vb = _mm256_permutevar8x32_epi32(vb, rotate);
+			eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(va, vb));
+		}
+		mask |= _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+		if(_list1[i + 7] <= _list2[j + 7]){
+			__m256i permute = _mm256_loadu_si256((const __m256i*)avx2_permutes[mask]);
+			_mm256_storeu_si256((__m256i*)(_result + k), _mm256_permutevar8x32_epi32(va, permute));
+			k += mask_counts[mask];
+			mask = 0;
+			i += 8;
+		}else{
+			j += 8;
+		}
+	}
+	if(i + 8 <= _len1)
+		return mergeBlockTail(_list1, _len1, _list2, _len2, _result, i, j, k, 8, mask);
+	return mergeScalar(_list1, _len1, _list2, _len2, _result, i, j, k);
+}
+#endif
+
+//the number of IDs less than _key among the 16 IDs from _list
+typedef int (*CountLessFunc)(const int* _list, int _key);
+
+static int
+countLessScalar(const int* _list, int _key)
+{
+	int num = 0;
+	for(int i = 0; i < 16; i++){
+		num += (_list[i] < _key);
+	}
+	return num;
+}
+
+#ifdef LISTINTERSECT_X86
+__attribute__((target("sse4.2")))
+static int
+countLessSSE(const int* _list, int _key)
+{
+	__m128i key = _mm_set1_epi32(_key);
+	int num = 0;
+	for(int i = 0; i < 16; i += 4){
+		__m128i lt = _mm_cmpgt_epi32(key, _mm_loadu_si128((const __m128i*)(_list + i)));
+		num += mask_counts[_mm_movemask_ps(_mm_castsi128_ps(lt))];
+	}
+	return num;
+}
+
+__attribute__((target("avx2")))
+static int
+countLessAVX2(const int* _list, int _key)
+{
+	__m256i key = _mm256_set1_epi32(_key);
+	__m256i lt0 = _mm256_cmpgt_epi32(key, _mm256_loadu_si256((const __m256i*)_list));
+	__m256i lt1 = _mm256_cmpgt_epi32(key, _mm256_loadu_si256((const __m256i*)(_list + 8)));
+	return mask_counts[_mm256_movemask_ps(_mm256_castsi256_ps(lt0))] + mask_counts[_mm256_movemask_ps(_mm256_castsi256_ps(lt1))];
+}
+#endif
+
+static CountLessFunc
+getCountLess()
+{
+#ifdef LISTINTERSECT_X86
+	if(ListIntersect::getLevel() == ListIntersect::AVX2)
+		return countLessAVX2;
+	if(ListIntersect::getLevel() == ListIntersect::SSE)
+		return countLessSSE;
+#endif
+	return countLessScalar;
+}
+
+//the first position from _from with an ID not less than _key, found by doubling the step and then
+//by a binary search down to a window of 16 IDs, which are compared with _key at once
+static int
+gallopTo(const int* _list, int _len, int _from, int _key, CountLessFunc _count_less)
+{
+	if(_list[_from] >= _key)
+		return _from;
+	int lo = _from, hi = _from + 1, step = 1;
+	while(hi < _len && _list[hi] < _key){
+		lo = hi;
+		step <<= 1;
+		hi = lo + step;
+	}
+	if(hi > _len)
+		hi = _len;
+	//_list[lo] < _key, and _list[hi] >= _key if hi < _len
+	while(hi - lo > 16){
+		int mid = lo + (hi - lo) / 2;
+		if(_list[mid] < _key)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	//the IDs from hi are not less than _key, so the window can go past it
+	if(lo + 17 <= _len)
+		return lo + 1 + _count_less(_list + lo + 1, _key);
+	while(lo + 1 < hi && _list[lo + 1] < _key){
+		lo++;
+	}
+	return lo + 1;
+}
+
+int
+ListIntersect::intersectGallop(const int* _list1, int _len1, const int* _list2, int _len2, int* _result)
+{
+	CountLessFunc count_less = getCountLess();
+	int k = 0;
+	if(_len1 <= _len2){
+		for(int i = 0, j = 0; i < _len1 && j < _len2; i++){
+			j = gallopTo(_list2, _len2, j, _list1[i], count_less);
+			if(j < _len2 && _list2[j] == _list1[i])
+				_result[k++] = _list1[i];
+		}
+	}else{
+		for(int i = 0, j = 0; j < _len2 && i < _len1; j++){
+			if(j > 0 && _list2[j] == _list2[j - 1])
+				continue;
+			i = gallopTo(_list1, _len1, i, _list2[j], count_less);
+			while(i < _len1 && _list1[i] == _list2[j]){
+				_result[k++] = _list1[i++];
+			}
+		}
+	}
+	return k;
+}
+
+int
+ListIntersect::intersectMerge(const int* _list1, int _len1, const int* _list2, int _len2, int* _result)
+{
+#ifdef LISTINTERSECT_X86
+	if(ListIntersect::level == ListIntersect::AVX2)
+		return mergeAVX2(_list1, _len1, _list2, _len2, _result);
+	if(ListIntersect::level == ListIntersect::SSE)
+		return mergeSSE(_list1, _len1, _list2, _len2, _result);
+#endif
+	return mergeScalar(_list1, _len1, _list2, _len2, _result, 0, 0, 0);
+}
+
+int
+ListIntersect::intersect(const int* _list1, int _len1, const int* _list2, int _len2, int* _result)
+{
+	if(_list1 == NULL || _len1 <= 0 || _list2 == NULL || _len2 <= 0)
+		return 0;
+	if(_list1[_len1 - 1] < _list2[0] || _list2[_len2 - 1] < _list1[0])
+		return 0;
+	if((long long)_len1 * ListIntersect::GALLOP_RATIO < _len2 || (long long)_len2 * ListIntersect::GALLOP_RATIO < _len1)
+		return ListIntersect::intersectGallop(_list1, _len1, _list2, _len2, _result);
+	return ListIntersect::intersectMerge(_list1, _len1, _list2, _len2, _result);
+}
+
+int
+ListIntersect::intersect(const int* const* _lists, const int* _lens, int _list_num, int* _result)
+{
+	if(_list_num <= 0)
+		return 0;
+	vector< pair<int, int> > order;
+	for(int i = 0; i < _list_num; i++){
+		order.push_back(make_pair(_lens[i], i));
+	}
+	sort(order.begin(), order.end());
+
+	int num = order[0].first;
+	if(num <= 0)
+		return 0;
+	const int* cur = _lists[order[0].second];
+	if(_list_num == 1){
+		memcpy(_result, cur, sizeof(int) * num);
+		return num;
+	}
+	//the steps write _result and the buffer in turn, so that the last one writes _result
+	vector<int> buffer((_list_num > 2) ? num : 0);
+	for(int i = 1; i < _list_num && num > 0; i++){
+		int* dst = ((_list_num - 1 - i) % 2 == 0) ? _result : &buffer[0];
+		num = ListIntersect::intersect(cur, num, _lists[order[i].second], order[i].first, dst);
+		cur = dst;
+	}
+	return num;
+}
+
+int
+ListIntersect::intersectLeapfrog(const int* const* _lists, const int* _lens, int _list_num, int* _result)
+{
+	if(_list_num <= 0)
+		return 0;
+	int key = INT_MIN;
+	for(int i = 0; i < _list_num; i++){
+		if(_lists[i] == NULL || _lens[i] <= 0)
+			return 0;
+		key = max(key, _lists[i][0]);
+	}
+
+	CountLessFunc count_less = getCountLess();
+	vector<int> pos(_list_num, 0);
+	//the number of lists in a row found at key
+	int agree_num = 0, k = 0;
+	for(int i = 0; ; i = (i + 1) % _list_num){
+		pos[i] = gallopTo(_lists[i], _lens[i], pos[i], key, count_less);
+		if(pos[i] == _lens[i])
+			break;
+		int id = _lists[i][pos[i]];
+		if(id != key){
+			key = id;
+			agree_num = 1;
+			continue;
+		}
+		if(++agree_num < _list_num)
+			continue;
+		_result[k++] = key;
+		if(key == INT_MAX)
+			break;
+		key++;
+		agree_num = 0;
+	}
+	return k;
+}
+
+int
+ListIntersect::intersect(vector<int>& _list1, const int* _list2, int _len2)
+{
+	int len1 = _list1.size();
+	if(len1 == 0)
+		return 0;
+	vector<int> result(len1);
+	int num = ListIntersect::intersect(&_list1[0], len1, _list2, _len2, &result[0]);
+	result.resize(num);
+	_list1.swap(result);
+	return len1 - num;
+}
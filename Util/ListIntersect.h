@@ -0,0 +1,47 @@
+/*=============================================================================
+# Filename: ListIntersect.h
+# Last Modified: 2026-10-17
+# Description: intersection of sorted ID lists, by a merge of blocks of IDs
+compared all against all with SSE4.2 or AVX2, or by galloping over the
+longer list when the sizes are skewed. The instruction set is chosen when
+the program starts, according to the CPU, with a scalar fallback.
+=============================================================================*/
+
+#ifndef _UTIL_LISTINTERSECT_H
+#define _UTIL_LISTINTERSECT_H
+
+#include "Util.h"
+
+//NOTICE:the lists are in increasing order, and the result keeps the elements of the first list
+//found in the second, so the duplicates of the first list are all kept or all removed
+class ListIntersect
+{
+public:
+	enum { SCALAR, SSE, AVX2, LEVEL_NUM };
+	//galloping is used if the longer list is this many times longer than the other
+	static const int GALLOP_RATIO = 32;
+
+	//the level used, the best one supported by the CPU unless set
+	static int getLevel();
+	static const char* getLevelName(int _level);
+	//for benchmarks, a level not supported by the CPU is ignored
+	static void setLevel(int _level);
+
+	//_result has room for _len1 IDs and does not overlap the lists, the number of IDs in it is returned
+	static int intersect(const int* _list1, int _len1, const int* _list2, int _len2, int* _result);
+	static int intersectMerge(const int* _list1, int _len1, const int* _list2, int _len2, int* _result);
+	static int intersectGallop(const int* _list1, int _len1, const int* _list2, int _len2, int* _result);
+	//the elements of the shortest list found in all the others, from the shortest to the longest,
+	//_result has room for the shortest list
+	static int intersect(const int* const* _lists, const int* _lens, int _list_num, int* _result);
+	//the IDs in all the lists, each once, found by leapfrogging: each list in turn gallops to the
+	//largest ID seen, so no list is read past what the others allow, _result has room for the shortest list
+	static int intersectLeapfrog(const int* const* _lists, const int* _lens, int _list_num, int* _result);
+	//keep the elements of _list1 found in _list2, the number removed is returned
+	static int intersect(std::vector<int>& _list1, const int* _list2, int _len2);
+
+private:
+	static int level;
+};
+
+#endif //_UTIL_LISTINTERSECT_H
@@ -0,0 +1,154 @@
+/*=============================================================================
+# Filename: MappedBitmap.cpp
+# Last Modified: 2026-10-17
+# Description: implement functions in MappedBitmap.h
+=============================================================================*/
+
+#include "MappedBitmap.h"
+
+using namespace std;
+
+const char MappedBitmap::MAGIC[4] = {'G', 'B', 'M', 'P'};
+
+MappedBitmap::MappedBitmap()
+{
+	this->bits = NULL;
+	this->bit_num = 0;
+	this->map_addr = NULL;
+	this->map_len = 0;
+}
+
+MappedBitmap::~MappedBitmap()
+{
+	this->unmap();
+}
+
+void
+MappedBitmap::unmap()
+{
+	if(this->map_addr != NULL){
+		munmap(this->map_addr, this->map_len);
+		this->map_addr = NULL;
+		this->map_len = 0;
+	}
+}
+
+void
+MappedBitmap::clear()
+{
+	this->unmap();
+	vector<unsigned char>().swap(this->owned_bits);
+	this->bits = NULL;
+	this->bit_num = 0;
+}
+
+void
+MappedBitmap::own()
+{
+	if(this->map_addr == NULL)
+		return;
+	this->owned_bits.assign(this->bits, this->bits + (this->bit_num + 7) / 8);
+	this->unmap();
+	this->bits = this->owned_bits.empty() ? NULL : &this->owned_bits[0];
+}
+
+bool
+MappedBitmap::load(const string& _path)
+{
+	this->clear();
+	int fd = open(_path.c_str(), O_RDONLY);
+	if(fd == -1){
+		cerr << "error, can not open " << _path << ". @MappedBitmap::load" << endl;
+		return false;
+	}
+	struct stat file_stat;
+	if(fstat(fd, &file_stat) == -1){
+		close(fd);
+		return false;
+	}
+	size_t file_len = file_stat.st_size;
+
+	char header[MappedBitmap::HEADER_SIZE];
+	if(file_len >= MappedBitmap::HEADER_SIZE && pread(fd, header, MappedBitmap::HEADER_SIZE, 0) == MappedBitmap::HEADER_SIZE
+		&& memcmp(header, MappedBitmap::MAGIC, sizeof(MappedBitmap::MAGIC)) == 0){
+		int num;
+		memcpy(&num, header + sizeof(MappedBitmap::MAGIC), sizeof(int));
+		if(num < 0 || file_len < MappedBitmap::HEADER_SIZE + ((size_t)num + 7) / 8){
+			cerr << "error, " << _path << " is truncated. @MappedBitmap::load" << endl;
+			close(fd);
+			return false;
+		}
+		if(num > 0){
+			void* addr = mmap(NULL, file_len, PROT_READ, MAP_PRIVATE, fd, 0);
+			if(addr == MAP_FAILED){
+				cerr << "error, can not map " << _path << ". @MappedBitmap::load" << endl;
+				close(fd);
+				return false;
+			}
+			this->map_addr = addr;
+			this->map_len = file_len;
+			this->bits = (const unsigned char*)addr + MappedBitmap::HEADER_SIZE;
+			this->bit_num = num;
+		}
+		close(fd);
+		return true;
+	}
+	close(fd);
+
+	//older versions wrote a '0' or '1' char per entity
+	ifstream fin(_path.c_str(), ios::binary);
+	string tag_str((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+	this->resize(tag_str.size());
+	for(int i = 0; i < tag_str.size(); i++){
+		if(tag_str[i] == '1')
+			this->set(i);
+	}
+	return true;
+}
+
+bool
+MappedBitmap::save(const string& _path) const
+{
+	string tmp_path = _path + ".tmp";
+	FILE* fp = fopen(tmp_path.c_str(), "wb");
+	if(fp == NULL){
+		cerr << "error, can not open " << tmp_path << ". @MappedBitmap::save" << endl;
+		return false;
+	}
+	size_t byte_num = (this->bit_num + 7) / 8;
+	bool flag = fwrite(MappedBitmap::MAGIC, sizeof(MappedBitmap::MAGIC), 1, fp) == 1
+		&& fwrite(&this->bit_num, sizeof(int), 1, fp) == 1
+		&& (byte_num == 0 || fwrite(this->bits, 1, byte_num, fp) == byte_num);
+	flag = (fclose(fp) == 0) && flag;
+	if(!flag || rename(tmp_path.c_str(), _path.c_str()) != 0){
+		cerr << "error, can not write " << _path << ". @MappedBitmap::save" << endl;
+		remove(tmp_path.c_str());
+		return false;
+	}
+	return true;
+}
+
+void
+MappedBitmap::resize(int _bit_num)
+{
+	this->own();
+	//clear the bits cut off in the last byte kept, so that growing again gives 0
+	if(_bit_num < this->bit_num && (_bit_num & 7) != 0)
+		this->owned_bits[_bit_num >> 3] &= (1 << (_bit_num & 7)) - 1;
+	this->owned_bits.resize((_bit_num + 7) / 8, 0);
+	this->bits = this->owned_bits.empty() ? NULL : &this->owned_bits[0];
+	this->bit_num = _bit_num;
+}
+
+void
+MappedBitmap::set(int _pos, bool _value)
+{
+	if(_pos >= this->bit_num)
+		this->resize(_pos + 1);
+	else
+		this->own();
+	if(_value)
+		this->owned_bits[_pos >> 3] |= 1 << (_pos & 7);
+	else
+		this->owned_bits[_pos >> 3] &= ~(1 << (_pos & 7));
+}
@@ -0,0 +1,59 @@
+/*=============================================================================
+# Filename: MappedBitmap.h
+# Last Modified: 2026-10-17
+# Description: a packed bitmap kept in a file and mapped into memory when it
+is loaded, used for the internal tags of the entities of a site(the
+internal_nodes.dat of a database), one bit per entity ID instead of a char
+=============================================================================*/
+
+#ifndef _UTIL_MAPPEDBITMAP_H
+#define _UTIL_MAPPEDBITMAP_H
+
+#include "Util.h"
+
+class MappedBitmap
+{
+public:
+	//the file is the magic, the int bit num and then the bits, bit i is (1 << (i & 7)) of byte (i >> 3)
+	static const int HEADER_SIZE = 8;
+	static const char MAGIC[4];
+
+	MappedBitmap();
+	~MappedBitmap();
+	//the file is mapped read-only and only copied into memory by the first change,
+	//a file of '0' and '1' chars written by older versions is read into memory
+	bool load(const std::string& _path);
+	//written to a temporary file renamed over _path, so that a mapping of _path stays valid
+	bool save(const std::string& _path) const;
+	void clear();
+
+	int size() const
+	{
+		return this->bit_num;
+	}
+	//false for the positions out of the bitmap, e.g. literal IDs
+	bool test(int _pos) const
+	{
+		return (unsigned)_pos < (unsigned)this->bit_num && ((this->bits[_pos >> 3] >> (_pos & 7)) & 1);
+	}
+	//the new positions are 0
+	void resize(int _bit_num);
+	//the bitmap grows to hold _pos if needed
+	void set(int _pos, bool _value = true);
+
+private:
+	//points into the mapping or to owned_bits
+	const unsigned char* bits;
+	int bit_num;
+	std::vector<unsigned char> owned_bits;
+	void* map_addr;
+	size_t map_len;
+
+	void unmap();
+	//copy the mapped bits into owned_bits before they are changed
+	void own();
+	MappedBitmap(const MappedBitmap&);
+	MappedBitmap& operator=(const MappedBitmap&);
+};
+
+#endif //_UTIL_MAPPEDBITMAP_H
@@ -0,0 +1,284 @@
+/*=============================================================================
+# Filename: PartialResBuffer.cpp
+# Last Modified: 2026-10-17
+# Description: implement functions in PartialResBuffer.h
+=============================================================================*/
+
+#include "PartialResBuffer.h"
+
+using namespace std;
+
+PartialResBuffer::PartialResBuffer()
+{
+	this->init(0);
+}
+
+PartialResBuffer::PartialResBuffer(int _var_num)
+{
+	this->init(_var_num);
+}
+
+void
+PartialResBuffer::init(int _var_num)
+{
+	this->var_num = _var_num;
+	this->clear();
+}
+
+void
+PartialResBuffer::clear()
+{
+	this->row_num = 0;
+	this->id_mode = PartialResBuffer::LOCAL_ID;
+	this->match_ids.clear();
+	this->tag_bits.clear();
+	this->dict_ids.clear();
+	this->dict_strs.clear();
+}
+
+void
+PartialResBuffer::addRow(const int* _ids, const char* _tags)
+{
+	int tag_bytes = this->getTagBytes();
+	this->match_ids.insert(this->match_ids.end(), _ids, _ids + this->var_num);
+	this->tag_bits.resize(this->tag_bits.size() + tag_bytes, 0);
+
+	unsigned char* row_tag = &this->tag_bits[(size_t)this->row_num * tag_bytes];
+	for(int i = 0; i < this->var_num; i++){
+		unsigned char tag = (unsigned char)(_tags[i] - '0') & 3;
+		row_tag[i >> 2] |= tag << ((i & 3) << 1);
+	}
+	this->row_num++;
+}
+
+void
+PartialResBuffer::addPackedRow(const int* _ids, const unsigned char* _tag_row)
+{
+	this->match_ids.insert(this->match_ids.end(), _ids, _ids + this->var_num);
+	this->tag_bits.insert(this->tag_bits.end(), _tag_row, _tag_row + this->getTagBytes());
+	this->row_num++;
+}
+
+const int*
+PartialResBuffer::getRow(int _row) const
+{
+	return &this->match_ids[(size_t)_row * this->var_num];
+}
+
+char
+PartialResBuffer::getTag(int _row, int _var) const
+{
+	return '0' + this->getTagValue(_row, _var);
+}
+
+bool
+PartialResBuffer::isFinalRow(int _row) const
+{
+	for(int i = 0; i < this->var_num; i++){
+		if(this->getTagValue(_row, i) != PartialResBuffer::TAG_INTERNAL)
+			return false;
+	}
+	return true;
+}
+
+void
+PartialResBuffer::appendRows(const PartialResBuffer& _other)
+{
+	this->match_ids.insert(this->match_ids.end(), _other.match_ids.begin(), _other.match_ids.end());
+	this->tag_bits.insert(this->tag_bits.end(), _other.tag_bits.begin(), _other.tag_bits.end());
+	this->row_num += _other.row_num;
+}
+
+void
+PartialResBuffer::swap(PartialResBuffer& _other)
+{
+	std::swap(this->var_num, _other.var_num);
+	std::swap(this->row_num, _other.row_num);
+	std::swap(this->id_mode, _other.id_mode);
+	this->match_ids.swap(_other.match_ids);
+	this->tag_bits.swap(_other.tag_bits);
+	this->dict_ids.swap(_other.dict_ids);
+	this->dict_strs.swap(_other.dict_strs);
+}
+
+void
+PartialResBuffer::getPPPartialRes(int _row, PPPartialRes& _res) const
+{
+	const int* row = this->getRow(_row);
+	_res.MatchVec.assign(row, row + this->var_num);
+	_res.TagVec.resize(this->var_num);
+	for(int i = 0; i < this->var_num; i++){
+		_res.TagVec[i] = this->getTag(_row, i);
+	}
+}
+
+void
+PartialResBuffer::addDictEntry(int _id, const string& _str)
+{
+	this->dict_ids.push_back(_id);
+	this->dict_strs.insert(this->dict_strs.end(), _str.begin(), _str.end());
+	this->dict_strs.push_back('\0');
+}
+
+void
+PartialResBuffer::getReferredIDs(vector<int>& _ids) const
+{
+	_ids.clear();
+	for(size_t i = 0; i < this->match_ids.size(); i++){
+		if(this->match_ids[i] >= 0)
+			_ids.push_back(this->match_ids[i]);
+	}
+	std::sort(_ids.begin(), _ids.end());
+	_ids.erase(std::unique(_ids.begin(), _ids.end()), _ids.end());
+}
+
+int
+PartialResBuffer::getDictIndex(int _id) const
+{
+	if(this->dict_ids.empty())
+		return -1;
+	return Util::bsearch_int_uporder(_id, &this->dict_ids[0], this->dict_ids.size());
+}
+
+void
+PartialResBuffer::getDictOffsets(vector<int>& _offsets) const
+{
+	_offsets.clear();
+	_offsets.reserve(this->dict_ids.size());
+	int pos = 0;
+	for(size_t i = 0; i < this->dict_ids.size(); i++){
+		_offsets.push_back(pos);
+		while(pos < (int)this->dict_strs.size() && this->dict_strs[pos] != '\0')
+			pos++;
+		pos++;
+	}
+}
+
+bool
+PartialResBuffer::remapIDs(const vector<int>& _entity_global_ids, const vector<int>& _literal_global_ids)
+{
+	if(this->id_mode == PartialResBuffer::GLOBAL_ID)
+		return true;
+
+	vector<int> global_ids(this->match_ids.size(), -1);
+	for(size_t i = 0; i < this->match_ids.size(); i++){
+		int id = this->match_ids[i];
+		if(id >= Util::LITERAL_FIRST_ID){
+			id -= Util::LITERAL_FIRST_ID;
+			if(id < (int)_literal_global_ids.size())
+				global_ids[i] = _literal_global_ids[id];
+		}else if(id >= 0 && id < (int)_entity_global_ids.size()){
+			global_ids[i] = _entity_global_ids[id];
+		}
+		if(this->match_ids[i] != -1 && global_ids[i] == -1)
+			return false;
+	}
+
+	this->match_ids.swap(global_ids);
+	this->dict_ids.clear();
+	this->dict_strs.clear();
+	this->id_mode = PartialResBuffer::GLOBAL_ID;
+
+	return true;
+}
+
+void
+PartialResBuffer::getHeader(int* _header) const
+{
+	_header[0] = this->var_num;
+	_header[1] = this->row_num;
+	_header[2] = this->dict_ids.size();
+	_header[3] = this->dict_strs.size();
+	_header[4] = this->id_mode;
+}
+
+void
+PartialResBuffer::setHeader(const int* _header)
+{
+	this->var_num = _header[0];
+	this->row_num = _header[1];
+	this->match_ids.resize((size_t)this->row_num * this->var_num);
+	this->tag_bits.resize((size_t)this->row_num * this->getTagBytes());
+	this->dict_ids.resize(_header[2]);
+	this->dict_strs.resize(_header[3]);
+	this->id_mode = _header[4];
+}
+
+int
+PartialResBuffer::getPackedSize() const
+{
+	return sizeof(int) * (PartialResBuffer::HEADER_SIZE + this->match_ids.size() + this->dict_ids.size())
+		+ this->tag_bits.size() + this->dict_strs.size();
+}
+
+void
+PartialResBuffer::pack(char* _dest) const
+{
+	int header[PartialResBuffer::HEADER_SIZE];
+	this->getHeader(header);
+	memcpy(_dest, header, sizeof(header));
+	_dest += sizeof(header);
+	if(!this->match_ids.empty()){
+		memcpy(_dest, &this->match_ids[0], sizeof(int) * this->match_ids.size());
+		_dest += sizeof(int) * this->match_ids.size();
+	}
+	if(!this->tag_bits.empty()){
+		memcpy(_dest, &this->tag_bits[0], this->tag_bits.size());
+		_dest += this->tag_bits.size();
+	}
+	if(!this->dict_ids.empty()){
+		memcpy(_dest, &this->dict_ids[0], sizeof(int) * this->dict_ids.size());
+		_dest += sizeof(int) * this->dict_ids.size();
+	}
+	if(!this->dict_strs.empty()){
+		memcpy(_dest, &this->dict_strs[0], this->dict_strs.size());
+	}
+}
+
+int
+PartialResBuffer::unpack(const char* _src)
+{
+	int header[PartialResBuffer::HEADER_SIZE];
+	memcpy(header, _src, sizeof(header));
+	this->setHeader(header);
+	const char* pos = _src + sizeof(header);
+	if(!this->match_ids.empty()){
+		memcpy(&this->match_ids[0], pos, sizeof(int) * this->match_ids.size());
+		pos += sizeof(int) * this->match_ids.size();
+	}
+	if(!this->tag_bits.empty()){
+		memcpy(&this->tag_bits[0], pos, this->tag_bits.size());
+		pos += this->tag_bits.size();
+	}
+	if(!this->dict_ids.empty()){
+		memcpy(&this->dict_ids[0], pos, sizeof(int) * this->dict_ids.size());
+		pos += sizeof(int) * this->dict_ids.size();
+	}
+	if(!this->dict_strs.empty()){
+		memcpy(&this->dict_strs[0], pos, this->dict_strs.size());
+		pos += this->dict_strs.size();
+	}
+
+	return pos - _src;
+}
+
+PartialResSink::PartialResSink(int _chunk_row_num)
+{
+	this->chunk_row_num = _chunk_row_num;
+}
+
+PartialResSink::~PartialResSink()
+{
+}
+
+PartialResVecSink::PartialResVecSink(vector<PartialResBuffer>& _buf_vec)
+	: PartialResSink(PartialResBuffer::MAX_ROW_NUM), buf_vec(_buf_vec)
+{
+}
+
+void
+PartialResVecSink::put(PartialResBuffer& _buf)
+{
+	this->buf_vec.push_back(PartialResBuffer());
+	this->buf_vec.back().swap(_buf);
+}
@@ -0,0 +1,123 @@
+/*=============================================================================
+# Filename: PartialResBuffer.h
+# Last Modified: 2026-10-17
+# Description: binary wire format of local partial matches(LPM) exchanged
+between sites in gqueryD. Each row keeps one vertex ID per query vertex and
+a packed 2-bit tag per query vertex(extended, internal or unmatched). Rows
+of local IDs ship the strings of their vertices once in a dictionary
+section, so that the coordinator can map them to its own IDs; rows of
+global IDs ship no strings, and the coordinator looks up only the strings
+of the final answers from the sites.
+=============================================================================*/
+
+#ifndef _UTIL_PARTIALRESBUFFER_H
+#define _UTIL_PARTIALRESBUFFER_H
+
+#include "Util.h"
+
+class PartialResBuffer
+{
+public:
+	//tags of a query vertex in a LPM, the same as the chars in PPPartialRes::TagVec
+	static const unsigned char TAG_EXTENDED = 0;
+	static const unsigned char TAG_INTERNAL = 1;
+	static const unsigned char TAG_UNMATCHED = 2;
+	//IDs in rows are local to the site, or assigned by the global dictionary of gloadD
+	static const int LOCAL_ID = 0;
+	static const int GLOBAL_ID = 1;
+	//length of the int header sent before the sections
+	static const int HEADER_SIZE = 5;
+	//rows per buffer, to keep each MPI message count below INT_MAX
+	static const int MAX_ROW_NUM = 1 << 22;
+	//rows per buffer streamed to the coordinator while more LPMs are produced
+	static const int STREAM_ROW_NUM = 1 << 16;
+
+	int var_num;
+	int row_num;
+	int id_mode;
+	//row-major vertex IDs, row_num * var_num, -1 for unmatched
+	std::vector<int> match_ids;
+	//2 bits per query vertex, getTagBytes() bytes per row
+	std::vector<unsigned char> tag_bits;
+	//dictionary section: sorted IDs and their '\0'-separated strings
+	std::vector<int> dict_ids;
+	std::vector<char> dict_strs;
+
+	PartialResBuffer();
+	PartialResBuffer(int _var_num);
+	void init(int _var_num);
+	void clear();
+
+	int getTagBytes() const
+	{
+		return (2 * this->var_num + 7) / 8;
+	}
+	//_tags are chars of '0', '1' and '2', the same as TagVec
+	void addRow(const int* _ids, const char* _tags);
+	//_tag_row is getTagBytes() bytes of packed tags
+	void addPackedRow(const int* _ids, const unsigned char* _tag_row);
+	const int* getRow(int _row) const;
+	char getTag(int _row, int _var) const;
+	const unsigned char* getTagRow(int _row) const
+	{
+		return &this->tag_bits[(size_t)_row * this->getTagBytes()];
+	}
+	//one of TAG_EXTENDED, TAG_INTERNAL and TAG_UNMATCHED
+	int getTagValue(int _row, int _var) const
+	{
+		return (this->getTagRow(_row)[_var >> 2] >> ((_var & 3) << 1)) & 3;
+	}
+	//whether all query vertices are internal, i.e. the row is a complete match
+	bool isFinalRow(int _row) const;
+	//append the rows of another buffer with the same var_num, the dictionary is not copied
+	void appendRows(const PartialResBuffer& _other);
+	void swap(PartialResBuffer& _other);
+	void getPPPartialRes(int _row, PPPartialRes& _res) const;
+
+	//the strings must be added in the order of increasing IDs
+	void addDictEntry(int _id, const std::string& _str);
+	//collect the distinct IDs referred by rows, sorted and without -1 or other negative IDs(see PartialResLEC.h)
+	void getReferredIDs(std::vector<int>& _ids) const;
+	int getDictIndex(int _id) const;
+	//the start positions of each string in dict_strs
+	void getDictOffsets(std::vector<int>& _offsets) const;
+	//translate local IDs to global IDs, indexed by entity ID and by literal ID - LITERAL_FIRST_ID,
+	//and drop the dictionary; return false and keep local IDs if some ID has no global one
+	bool remapIDs(const std::vector<int>& _entity_global_ids, const std::vector<int>& _literal_global_ids);
+
+	void getHeader(int* _header) const;
+	//resize all sections according to a received header before receiving them
+	void setHeader(const int* _header);
+
+	//the header and all sections in one byte array, for collective communication
+	int getPackedSize() const;
+	void pack(char* _dest) const;
+	//return the number of bytes read from _src
+	int unpack(const char* _src);
+};
+
+//the producers of LPMs hand each buffer to a sink once it has chunk_row_num rows,
+//and the last one when they finish, instead of keeping all of them
+class PartialResSink
+{
+public:
+	PartialResSink(int _chunk_row_num = PartialResBuffer::MAX_ROW_NUM);
+	virtual ~PartialResSink();
+	//_buf is left empty or cleared by the caller
+	virtual void put(PartialResBuffer& _buf) = 0;
+
+	int chunk_row_num;
+};
+
+//keep all buffers, for the callers that need all LPMs at once
+class PartialResVecSink : public PartialResSink
+{
+public:
+	PartialResVecSink(std::vector<PartialResBuffer>& _buf_vec);
+	virtual void put(PartialResBuffer& _buf);
+
+private:
+	std::vector<PartialResBuffer>& buf_vec;
+};
+
+#endif //_UTIL_PARTIALRESBUFFER_H
@@ -0,0 +1,356 @@
+/*=============================================================================
+# Filename: PartialResJoin.cpp
+# Last Modified: 2026-10-17
+# Description: implement functions in PartialResJoin.h
+=============================================================================*/
+
+#include "PartialResJoin.h"
+
+using namespace std;
+
+static inline unsigned
+hashID(int _id)
+{
+	return (unsigned)_id * 2654435761u;
+}
+
+MatchRowSet::MatchRowSet(int _var_num)
+{
+	this->init(_var_num);
+}
+
+void
+MatchRowSet::init(int _var_num)
+{
+	this->var_num = _var_num;
+	this->clear();
+}
+
+void
+MatchRowSet::clear()
+{
+	this->row_num = 0;
+	this->rows.clear();
+	this->slots.clear();
+}
+
+int
+MatchRowSet::size() const
+{
+	return this->row_num;
+}
+
+unsigned
+MatchRowSet::hashRow(const int* _row) const
+{
+	unsigned h = 2166136261u;
+	for(int i = 0; i < this->var_num; i++){
+		h = (h ^ (unsigned)_row[i]) * 16777619u;
+	}
+	return h;
+}
+
+void
+MatchRowSet::rehash(int _slot_num)
+{
+	this->slots.assign(_slot_num, 0);
+	unsigned mask = _slot_num - 1;
+	for(int i = 0; i < this->row_num; i++){
+		unsigned pos = this->hashRow(this->getRow(i)) & mask;
+		while(this->slots[pos] != 0)
+			pos = (pos + 1) & mask;
+		this->slots[pos] = i + 1;
+	}
+}
+
+bool
+MatchRowSet::insert(const int* _row)
+{
+	//keep the load factor below 1/2
+	if(2 * (this->row_num + 1) > (int)this->slots.size())
+		this->rehash(this->slots.empty() ? 64 : 2 * this->slots.size());
+
+	unsigned mask = this->slots.size() - 1;
+	unsigned pos = this->hashRow(_row) & mask;
+	while(this->slots[pos] != 0){
+		if(memcmp(this->getRow(this->slots[pos] - 1), _row, sizeof(int) * this->var_num) == 0)
+			return false;
+		pos = (pos + 1) & mask;
+	}
+	this->rows.insert(this->rows.end(), _row, _row + this->var_num);
+	this->row_num++;
+	this->slots[pos] = this->row_num;
+
+	return true;
+}
+
+const int*
+MatchRowSet::getRow(int _i) const
+{
+	return &this->rows[(size_t)_i * this->var_num];
+}
+
+//the arguments of a thread of PartialResJoin
+struct PartialResJoinTask
+{
+	PartialResJoin* join;
+	int part_begin;
+	int part_end;
+	const PartialResBuffer* res;
+	int row_begin;
+	int row_end;
+	PartialResBuffer new_res;
+	MatchRowSet final_set;
+};
+
+//run _func on each task, the first task in the calling thread
+static void
+runTasks(void* (*_func)(void*), vector<PartialResJoinTask>& _tasks)
+{
+	vector<pthread_t> threads(_tasks.size());
+	vector<char> started(_tasks.size(), 0);
+	for(int i = 1; i < _tasks.size(); i++){
+		if(pthread_create(&threads[i], NULL, _func, &_tasks[i]) == 0){
+			started[i] = 1;
+		}else{
+			cerr << "error: fail to create thread. @PartialResJoin" << endl;
+			_func(&_tasks[i]);
+		}
+	}
+	_func(&_tasks[0]);
+	for(int i = 1; i < _tasks.size(); i++){
+		if(started[i])
+			pthread_join(threads[i], NULL);
+	}
+}
+
+PartialResJoin::PartialResJoin(int _thread_num)
+{
+	this->setThreadNum(_thread_num);
+	this->lpms = NULL;
+	this->match_pos = -1;
+	this->part_bits = 0;
+}
+
+void
+PartialResJoin::setThreadNum(int _thread_num)
+{
+	this->thread_num = _thread_num < 1 ? 1 : _thread_num;
+}
+
+int
+PartialResJoin::getTaskNum(int _row_num) const
+{
+	int task_num = _row_num / PartialResJoin::MIN_ROW_NUM_PER_THREAD;
+	if(task_num > this->thread_num)
+		task_num = this->thread_num;
+	return task_num < 1 ? 1 : task_num;
+}
+
+void
+PartialResJoin::getCandidates(const PartialResBuffer& _lpms, const vector<int>& _internal_rows, const vector<int>& _joined_pos, vector<int>& _cand_rows)
+{
+	_cand_rows.clear();
+	for(int i = 0; i < _internal_rows.size(); i++){
+		int j = 0;
+		for(; j < _joined_pos.size(); j++){
+			if(_lpms.getTagValue(_internal_rows[i], _joined_pos[j]) == PartialResBuffer::TAG_INTERNAL)
+				break;
+		}
+		if(j == _joined_pos.size())
+			_cand_rows.push_back(_internal_rows[i]);
+	}
+}
+
+//the partition is chosen by the high bits of the hash value and the slot by the low bits
+int
+PartialResJoin::getPartition(int _key) const
+{
+	if(this->part_bits == 0)
+		return 0;
+	return hashID(_key) >> (32 - this->part_bits);
+}
+
+int
+PartialResJoin::findSlot(int _key) const
+{
+	int part = this->getPartition(_key), offset = this->part_offsets[part];
+	unsigned mask = this->part_masks[part];
+	unsigned pos = hashID(_key) & mask;
+	while(this->slot_heads[offset + pos] != -1 && this->slot_keys[offset + pos] != _key)
+		pos = (pos + 1) & mask;
+	return offset + pos;
+}
+
+void
+PartialResJoin::buildPartition(int _part)
+{
+	//insert backwards so that each list keeps the order of the candidates
+	const vector<int>& cands = this->part_cands[_part];
+	for(int i = (int)cands.size() - 1; i >= 0; i--){
+		int key = this->lpms->getRow(this->cand_rows[cands[i]])[this->match_pos];
+		int pos = this->findSlot(key);
+		this->slot_keys[pos] = key;
+		this->next_cands[cands[i]] = this->slot_heads[pos];
+		this->slot_heads[pos] = cands[i];
+	}
+}
+
+void*
+PartialResJoin::buildThread(void* _arg)
+{
+	PartialResJoinTask* task = (PartialResJoinTask*)_arg;
+	for(int i = task->part_begin; i < task->part_end; i++){
+		task->join->buildPartition(i);
+	}
+	return NULL;
+}
+
+void
+PartialResJoin::build(const PartialResBuffer& _lpms, const vector<int>& _cand_rows, int _match_pos)
+{
+	this->lpms = &_lpms;
+	this->match_pos = _match_pos;
+	this->cand_rows.assign(_cand_rows.begin(), _cand_rows.end());
+
+	int cand_num = this->cand_rows.size(), task_num = this->getTaskNum(cand_num);
+	this->part_bits = 0;
+	while((1 << this->part_bits) < task_num)
+		this->part_bits++;
+	int part_num = 1 << this->part_bits;
+
+	this->part_cands.assign(part_num, vector<int>());
+	for(int i = 0; i < cand_num; i++){
+		this->part_cands[this->getPartition(_lpms.getRow(this->cand_rows[i])[_match_pos])].push_back(i);
+	}
+	int slot_num = 0;
+	this->part_offsets.resize(part_num);
+	this->part_masks.resize(part_num);
+	for(int i = 0; i < part_num; i++){
+		int part_slot_num = 64;
+		while(part_slot_num < 2 * (int)this->part_cands[i].size())
+			part_slot_num <<= 1;
+		this->part_offsets[i] = slot_num;
+		this->part_masks[i] = part_slot_num - 1;
+		slot_num += part_slot_num;
+	}
+	this->slot_keys.assign(slot_num, -1);
+	this->slot_heads.assign(slot_num, -1);
+	this->next_cands.assign(cand_num, -1);
+
+	//each thread fills the slots of its own partitions
+	vector<PartialResJoinTask> tasks(task_num);
+	for(int i = 0; i < task_num; i++){
+		tasks[i].join = this;
+		tasks[i].part_begin = (long long)part_num * i / task_num;
+		tasks[i].part_end = (long long)part_num * (i + 1) / task_num;
+	}
+	runTasks(PartialResJoin::buildThread, tasks);
+}
+
+int
+PartialResJoin::getCandidateNum() const
+{
+	return this->cand_rows.size();
+}
+
+void
+PartialResJoin::joinRows(const PartialResBuffer& _res, int _begin, int _end, PartialResBuffer& _new_res, MatchRowSet& _final_set) const
+{
+	int var_num = _res.var_num, tag_bytes = _res.getTagBytes();
+	vector<int> ids(var_num);
+	vector<unsigned char> tags(tag_bytes);
+
+	for(int i = _begin; i < _end; i++){
+		const int* row1 = _res.getRow(i);
+		if(_res.getTagValue(i, this->match_pos) == PartialResBuffer::TAG_INTERNAL){
+			_new_res.addPackedRow(row1, _res.getTagRow(i));
+			continue;
+		}
+		if(this->cand_rows.empty())
+			continue;
+
+		for(int c = this->slot_heads[this->findSlot(row1[this->match_pos])]; c != -1; c = this->next_cands[c]){
+			int cand_row = this->cand_rows[c];
+			const int* row2 = this->lpms->getRow(cand_row);
+			bool conflict = false, complete = true;
+			memset(&tags[0], 0, tag_bytes);
+			for(int k = 0; k < var_num; k++){
+				int tag;
+				if(row1[k] != -1 && row2[k] != -1 && row1[k] != row2[k]){
+					conflict = true;
+					break;
+				}else if(row1[k] == -1 && row2[k] != -1){
+					ids[k] = row2[k];
+					tag = this->lpms->getTagValue(cand_row, k);
+				}else if(row1[k] != -1 && row2[k] == -1){
+					ids[k] = row1[k];
+					tag = _res.getTagValue(i, k);
+				}else{
+					ids[k] = row1[k];
+					if(_res.getTagValue(i, k) == PartialResBuffer::TAG_INTERNAL || this->lpms->getTagValue(cand_row, k) == PartialResBuffer::TAG_INTERNAL)
+						tag = PartialResBuffer::TAG_INTERNAL;
+					else
+						tag = PartialResBuffer::TAG_EXTENDED;
+				}
+				if(tag != PartialResBuffer::TAG_INTERNAL)
+					complete = false;
+				tags[k >> 2] |= tag << ((k & 3) << 1);
+			}
+			if(conflict)
+				continue;
+
+			if(complete)
+				_final_set.insert(&ids[0]);
+			else
+				_new_res.addPackedRow(&ids[0], &tags[0]);
+		}
+	}
+}
+
+void*
+PartialResJoin::joinThread(void* _arg)
+{
+	PartialResJoinTask* task = (PartialResJoinTask*)_arg;
+	task->join->joinRows(*task->res, task->row_begin, task->row_end, task->new_res, task->final_set);
+	return NULL;
+}
+
+void
+PartialResJoin::join(PartialResBuffer& _res, MatchRowSet& _final_set)
+{
+	if(_res.row_num == 0)
+		return;
+
+	int task_num = this->getTaskNum(_res.row_num);
+	if(task_num == 1){
+		PartialResBuffer new_res(_res.var_num);
+		new_res.id_mode = _res.id_mode;
+		this->joinRows(_res, 0, _res.row_num, new_res, _final_set);
+		_res.swap(new_res);
+		return;
+	}
+
+	vector<PartialResJoinTask> tasks(task_num);
+	for(int i = 0; i < task_num; i++){
+		tasks[i].join = this;
+		tasks[i].res = &_res;
+		tasks[i].row_begin = (long long)_res.row_num * i / task_num;
+		tasks[i].row_end = (long long)_res.row_num * (i + 1) / task_num;
+		tasks[i].new_res.init(_res.var_num);
+		tasks[i].final_set.init(_res.var_num);
+	}
+	runTasks(PartialResJoin::joinThread, tasks);
+
+	//merge in the order of the chunks, the same order as joining the rows in one thread
+	PartialResBuffer new_res(_res.var_num);
+	new_res.id_mode = _res.id_mode;
+	for(int i = 0; i < task_num; i++){
+		new_res.appendRows(tasks[i].new_res);
+		tasks[i].new_res.clear();
+		for(int j = 0; j < tasks[i].final_set.size(); j++){
+			_final_set.insert(tasks[i].final_set.getRow(j));
+		}
+	}
+	_res.swap(new_res);
+}
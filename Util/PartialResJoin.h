@@ -0,0 +1,89 @@
+/*=============================================================================
+# Filename: PartialResJoin.h
+# Last Modified: 2026-10-17
+# Description: the join kernel of LPM assembly in gqueryD, with the same
+semantics as Util::HashJoin_old. It works on the row-major arena of
+PartialResBuffer instead of PPPartialRes: the candidates are indexed by an
+open-addressing hash table on the vertex they are joined on, the joined rows
+are merged in place and appended to a new arena, and the complete matches
+are de-duplicated by MatchRowSet, a hash set over the packed rows.
+With more than one thread, the hash table is split into partitions built
+by different threads, and the rows to join are split into chunks joined by
+different threads, whose results are merged in the order of the chunks, so
+the results and their order are the same as with one thread.
+=============================================================================*/
+
+#ifndef _UTIL_PARTIALRESJOIN_H
+#define _UTIL_PARTIALRESJOIN_H
+
+#include "Util.h"
+#include "PartialResBuffer.h"
+#include <pthread.h>
+
+//the set of complete matches, var_num IDs per row kept in one arena
+class MatchRowSet
+{
+public:
+	MatchRowSet(int _var_num = 0);
+	void init(int _var_num);
+	void clear();
+	int size() const;
+	//return false if the row exists
+	bool insert(const int* _row);
+	//rows are kept in the order of insertion
+	const int* getRow(int _i) const;
+
+private:
+	int var_num;
+	int row_num;
+	std::vector<int> rows;
+	//index + 1 of the row in each slot, 0 for empty slots
+	std::vector<int> slots;
+	unsigned hashRow(const int* _row) const;
+	void rehash(int _slot_num);
+};
+
+class PartialResJoin
+{
+public:
+	PartialResJoin(int _thread_num = 1);
+	void setThreadNum(int _thread_num);
+	//a thread is not worth starting for fewer rows
+	static const int MIN_ROW_NUM_PER_THREAD = 4096;
+
+	//the rows of _lpms internal at a query vertex(_internal_rows) and not internal at any
+	//vertex joined before(_joined_pos), each LPM is joined once at its first internal vertex
+	static void getCandidates(const PartialResBuffer& _lpms, const std::vector<int>& _internal_rows, const std::vector<int>& _joined_pos, std::vector<int>& _cand_rows);
+
+	//index the rows _cand_rows of _lpms by their vertex at _match_pos, _lpms is
+	//referred but not copied, so it must not change until join() returns
+	void build(const PartialResBuffer& _lpms, const std::vector<int>& _cand_rows, int _match_pos);
+	int getCandidateNum() const;
+	//join every row of _res with the candidates: rows internal at the match position are kept,
+	//the joined rows are kept in _res if incomplete and are inserted into _final_set otherwise
+	void join(PartialResBuffer& _res, MatchRowSet& _final_set);
+
+private:
+	int thread_num;
+	const PartialResBuffer* lpms;
+	int match_pos;
+	//open addressing on the keys, each slot heads a list of candidates linked by next_cands;
+	//the keys are split into 1 << part_bits partitions, each with its own range of slots
+	int part_bits;
+	std::vector<int> part_offsets;
+	std::vector<unsigned> part_masks;
+	std::vector< std::vector<int> > part_cands;
+	std::vector<int> slot_keys;
+	std::vector<int> slot_heads;
+	std::vector<int> cand_rows;
+	std::vector<int> next_cands;
+	int getPartition(int _key) const;
+	int findSlot(int _key) const;
+	void buildPartition(int _part);
+	void joinRows(const PartialResBuffer& _res, int _begin, int _end, PartialResBuffer& _new_res, MatchRowSet& _final_set) const;
+	int getTaskNum(int _row_num) const;
+	static void* buildThread(void* _arg);
+	static void* joinThread(void* _arg);
+};
+
+#endif //_UTIL_PARTIALRESJOIN_H
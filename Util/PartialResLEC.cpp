@@ -0,0 +1,183 @@
+/*=============================================================================
+# Filename: PartialResLEC.cpp
+# Last Modified: 2026-10-17
+# Description: implement functions in PartialResLEC.h
+=============================================================================*/
+
+#include "PartialResLEC.h"
+
+using namespace std;
+
+int
+PartialResLEC::getClassID(int _class, int _site, int _site_num)
+{
+	return -2 - (_class * _site_num + _site);
+}
+
+int
+PartialResLEC::getClassSite(int _class_id, int _site_num)
+{
+	return (-2 - _class_id) % _site_num;
+}
+
+PartialResLEC::PartialResLEC(int _var_num, const vector< vector<int> >& _query_adjacent_list, int _site, int _site_num)
+	: rows(_var_num)
+{
+	this->var_num = _var_num;
+	this->site = _site;
+	this->site_num = _site_num;
+	//without the neighbors of each query vertex no position is private, and each LPM is a class
+	if(_query_adjacent_list.size() == _var_num)
+		this->query_adjacent_list = _query_adjacent_list;
+}
+
+bool
+PartialResLEC::isPrivate(const PartialResBuffer& _lpms, int _row, int _var) const
+{
+	if(_var >= this->query_adjacent_list.size() || _lpms.getTagValue(_row, _var) != PartialResBuffer::TAG_INTERNAL)
+		return false;
+	const vector<int>& neighbors = this->query_adjacent_list[_var];
+	for(int i = 0; i < neighbors.size(); i++){
+		if(neighbors[i] < 0 || neighbors[i] >= this->var_num || _lpms.getTagValue(_row, neighbors[i]) != PartialResBuffer::TAG_INTERNAL)
+			return false;
+	}
+	return true;
+}
+
+void
+PartialResLEC::getKey(const PartialResBuffer& _lpms, int _row, vector<int>& _key) const
+{
+	const int* row = _lpms.getRow(_row);
+	const unsigned char* tag_row = _lpms.getTagRow(_row);
+	_key.assign(tag_row, tag_row + _lpms.getTagBytes());
+	for(int i = 0; i < this->var_num; i++){
+		_key.push_back(this->isPrivate(_lpms, _row, i) ? -1 : row[i]);
+	}
+}
+
+void
+PartialResLEC::add(const PartialResBuffer& _lpms)
+{
+	vector<int> key;
+	for(int i = 0; i < _lpms.row_num; i++){
+		this->getKey(_lpms, i, key);
+		map< vector<int>, int >::iterator class_iter = this->class_map.find(key);
+		if(class_iter == this->class_map.end()){
+			class_iter = this->class_map.insert(make_pair(key, (int)this->members.size())).first;
+			this->members.push_back(vector<int>());
+		}
+		this->members[class_iter->second].push_back(this->rows.row_num);
+		this->rows.addPackedRow(_lpms.getRow(i), _lpms.getTagRow(i));
+	}
+}
+
+int
+PartialResLEC::getVarNum() const
+{
+	return this->var_num;
+}
+
+int
+PartialResLEC::getClassNum() const
+{
+	return this->members.size();
+}
+
+int
+PartialResLEC::getRowNum() const
+{
+	return this->rows.row_num;
+}
+
+void
+PartialResLEC::getRepresentatives(PartialResBuffer& _reps) const
+{
+	vector<int> rep_row(this->var_num);
+	for(int i = 0; i < this->members.size(); i++){
+		int row_id = this->members[i][0];
+		const int* row = this->rows.getRow(row_id);
+		int class_id = PartialResLEC::getClassID(i, this->site, this->site_num);
+		for(int j = 0; j < this->var_num; j++){
+			rep_row[j] = this->isPrivate(this->rows, row_id, j) ? class_id : row[j];
+		}
+		_reps.addPackedRow(&rep_row[0], this->rows.getTagRow(row_id));
+	}
+}
+
+void
+PartialResLEC::getMembers(const vector<int>& _class_ids, PartialResBuffer& _members, vector<int>& _member_nums) const
+{
+	for(int i = 0; i < _class_ids.size(); i++){
+		int class_num = (-2 - _class_ids[i]) / this->site_num;
+		if(PartialResLEC::getClassSite(_class_ids[i], this->site_num) != this->site || class_num >= this->members.size()){
+			_member_nums.push_back(0);
+			continue;
+		}
+		const vector<int>& class_rows = this->members[class_num];
+		for(int j = 0; j < class_rows.size(); j++){
+			_members.addPackedRow(this->rows.getRow(class_rows[j]), this->rows.getTagRow(class_rows[j]));
+		}
+		_member_nums.push_back(class_rows.size());
+	}
+}
+
+void
+PartialResLEC::expand(const MatchRowSet& _rep_set, int _var_num, const vector<int>& _class_ids, const vector<int>& _member_begins, const PartialResBuffer& _members, MatchRowSet& _final_set)
+{
+	map<int, int> class_index;
+	for(int i = 0; i < _class_ids.size(); i++){
+		class_index.insert(make_pair(_class_ids[i], i));
+	}
+
+	vector<int> final_row(_var_num), row_classes, cur_members, firsts, nums;
+	for(int i = 0; i < _rep_set.size(); i++){
+		const int* rep_row = _rep_set.getRow(i);
+		row_classes.clear();
+		bool missing = false;
+		for(int j = 0; j < _var_num && !missing; j++){
+			if(!PartialResLEC::isClassID(rep_row[j]) || find(row_classes.begin(), row_classes.end(), rep_row[j]) != row_classes.end())
+				continue;
+			//a class without members can not be expanded
+			map<int, int>::iterator index_iter = class_index.find(rep_row[j]);
+			if(index_iter == class_index.end() || _member_begins[index_iter->second] == _member_begins[index_iter->second + 1])
+				missing = true;
+			else
+				row_classes.push_back(rep_row[j]);
+		}
+		if(missing)
+			continue;
+
+		//enumerate one member of each class, like an odometer over the classes of the row
+		int class_num = row_classes.size();
+		cur_members.assign(class_num, 0);
+		firsts.resize(class_num);
+		nums.resize(class_num);
+		for(int j = 0; j < class_num; j++){
+			int index = class_index[row_classes[j]];
+			firsts[j] = _member_begins[index];
+			nums[j] = _member_begins[index + 1] - _member_begins[index];
+		}
+		while(true){
+			for(int j = 0; j < _var_num; j++){
+				final_row[j] = rep_row[j];
+			}
+			for(int j = 0; j < class_num; j++){
+				const int* member_row = _members.getRow(firsts[j] + cur_members[j]);
+				for(int k = 0; k < _var_num; k++){
+					if(rep_row[k] == row_classes[j])
+						final_row[k] = member_row[k];
+				}
+			}
+			_final_set.insert(&final_row[0]);
+
+			int j = 0;
+			for(; j < class_num; j++){
+				if(++cur_members[j] < nums[j])
+					break;
+				cur_members[j] = 0;
+			}
+			if(j == class_num)
+				break;
+		}
+	}
+}
@@ -0,0 +1,65 @@
+/*=============================================================================
+# Filename: PartialResLEC.h
+# Last Modified: 2026-10-17
+# Description: LEC(local partial match equivalence class) compression of the
+LPMs of a SELECT query in gqueryD. An internal vertex of an LPM whose
+neighbors in the query are all internal is private: no LPM of another site
+refers to it, so it never decides whether two LPMs can be joined. The LPMs
+of a site with the same tags and the same vertices at the other positions
+form a class, and only one representative of each class is joined, whose
+private positions hold the ID of the class instead of a vertex. The members
+of a class differ only at the private positions, so a complete match of
+representatives is expanded to the final matches by replacing the class IDs
+with the private vertices of each member of each class, and only the members
+of the classes left in complete matches are shipped.
+=============================================================================*/
+
+#ifndef _UTIL_PARTIALRESLEC_H
+#define _UTIL_PARTIALRESLEC_H
+
+#include "Util.h"
+#include "PartialResBuffer.h"
+#include "PartialResJoin.h"
+
+class PartialResLEC
+{
+public:
+	//the class IDs are below -1, the ID of unmatched vertices, and tell the site of the class
+	static int getClassID(int _class, int _site, int _site_num);
+	static int getClassSite(int _class_id, int _site_num);
+	static bool isClassID(int _id)
+	{
+		return _id < -1;
+	}
+	
+	//the classes of the LPMs of site _site, in 0.._site_num-1
+	PartialResLEC(int _var_num, const std::vector< std::vector<int> >& _query_adjacent_list, int _site, int _site_num);
+	//group the rows of _lpms into classes, the LPMs are copied
+	void add(const PartialResBuffer& _lpms);
+	int getVarNum() const;
+	int getClassNum() const;
+	int getRowNum() const;
+	//append the representative of each class to _reps
+	void getRepresentatives(PartialResBuffer& _reps) const;
+	//append the members of the classes _class_ids to _members in turn, and their numbers to _member_nums
+	void getMembers(const std::vector<int>& _class_ids, PartialResBuffer& _members, std::vector<int>& _member_nums) const;
+	
+	//expand the complete matches of representatives _rep_set into _final_set, the members of class
+	//_class_ids[i] are the rows _member_begins[i].._member_begins[i+1]-1 of _members
+	static void expand(const MatchRowSet& _rep_set, int _var_num, const std::vector<int>& _class_ids, const std::vector<int>& _member_begins, const PartialResBuffer& _members, MatchRowSet& _final_set);
+
+private:
+	int var_num;
+	int site;
+	int site_num;
+	std::vector< std::vector<int> > query_adjacent_list;
+	//all LPMs added, members[i] are the rows of the i-th class
+	PartialResBuffer rows;
+	std::vector< std::vector<int> > members;
+	//the tags and the IDs at the positions not private, -1 at the private positions
+	std::map< std::vector<int>, int > class_map;
+	void getKey(const PartialResBuffer& _lpms, int _row, std::vector<int>& _key) const;
+	bool isPrivate(const PartialResBuffer& _lpms, int _row, int _var) const;
+};
+
+#endif //_UTIL_PARTIALRESLEC_H
@@ -7,12 +7,24 @@
 =============================================================================*/
 
 #include "Stream.h"
+#include <pthread.h>
 
 using namespace std;
 
-ResultCmp mycmp;
+static pthread_mutex_t temp_file_mutex = PTHREAD_MUTEX_INITIALIZER;
+static long temp_file_num = 0;
 
-//DEBUG: error when using STL::sort() to sort the Bstr[] units with mycmp, null pointer(Bstr*) 
+//the time alone may be the same for the streams of several queries
+static string
+newTempFileName(const string& _prefix)
+{
+	pthread_mutex_lock(&temp_file_mutex);
+	long num = temp_file_num++;
+	pthread_mutex_unlock(&temp_file_mutex);
+	return Util::tmp_path + _prefix + Util::int2string(Util::get_cur_time()) + "_" + Util::int2string(num) + ".dat";
+}
+
+//DEBUG: error when using STL::sort() to sort the Bstr[] units with cmp, null pointer(Bstr*) 
 //reported sometimes(for example, watdiv_30.db and watdiv_200.db, query/C3.sql). 
 //Notice that sort() uses quick-sorting method when size is large, which usually 
 //performs faster than merge-sorting used by STL::stable_sort() which can ensures the order between same 
@@ -51,8 +63,7 @@ Stream::Stream(std::vector<int>& _keys, std::vector<bool>& _desc, unsigned _rown
     this->rownum = _rownum;
     this->colnum = _colnum;
     this->needSort = _flag;
-    //this->cmp = ResultCmp(this->rownum, _keys);
-    mycmp = ResultCmp(this->rownum, _keys, _desc);
+    this->cmp = ResultCmp(this->rownum, _keys, _desc);
 
     this->record = new Bstr[this->colnum];
     this->record_size = new unsigned[this->colnum];
@@ -109,8 +120,7 @@ Stream::Stream(std::vector<int>& _keys, std::vector<bool>& _desc, unsigned _rown
     //below are for disk
     if(!this->needSort)	   // in disk and need sort
     {
-        string file_name = Util::tmp_path + Util::int2string(Util::get_cur_time());
-        file_name += ".dat";
+        string file_name = newTempFileName("");
 #ifdef DEBUG_STREAM
         fprintf(stderr, "%s\n", file_name.c_str());
 #endif
@@ -125,16 +135,6 @@ Stream::Stream(std::vector<int>& _keys, std::vector<bool>& _desc, unsigned _rown
     //return true;
 }
 
-bool operator < (const Element& _a, const Element& _b)
-{
-    return mycmp(_a.val, _b.val);
-}
-
-bool operator > (const Element& _a, const Element& _b)
-{
-    return !mycmp(_a.val, _b.val);
-}
-
 bool
 Stream::copyToRecord(const char* _str, unsigned _len, unsigned _idx)
 {
@@ -163,7 +163,7 @@ Stream::outputCache()
 {
 	//DEBUG1
     //sort and output to file
-    stable_sort(this->tempst.begin(), this->tempst.end(), mycmp);
+    stable_sort(this->tempst.begin(), this->tempst.end(), this->cmp);
     unsigned size = this->tempst.size();
     for(unsigned i = 0; i < size; ++i)
     {
@@ -242,10 +242,7 @@ Stream::write(const Bstr* _bp)
     {
         if(this->tempfp == NULL)
         {
-            string name = Util::tmp_path + "stream_" + Util::int2string(this->files.size());
-			//NOTICE:name derived from time maybe same
-            //name = Util::tmp_path + Util::int2string(Util::get_cur_time());
-            name += ".dat";
+            string name = newTempFileName("stream_");
 #ifdef DEBUG_STREAM
             fprintf(stderr, "%s\n", name.c_str());
 #endif
@@ -360,8 +357,7 @@ Stream::isEnd()
 void
 Stream::mergeSort()
 {
-    string file_name = Util::tmp_path + Util::int2string(Util::get_cur_time());
-    file_name += ".dat";
+    string file_name = newTempFileName("");
 #ifdef DEBUG_STREAM
     fprintf(stderr, "%s\n", file_name.c_str());
 #endif
@@ -374,7 +370,7 @@ Stream::mergeSort()
 
     unsigned valid = this->sortHeap.size();
     vector<Element>::iterator begin = this->sortHeap.begin();
-    make_heap(begin, begin + valid, greater<Element>());
+    make_heap(begin, begin + valid, ElementGreater(&this->cmp));
     while(valid > 0)
     {
 #ifdef DEBUG_STREAM
@@ -401,7 +397,7 @@ Stream::mergeSort()
 #endif
 
         //pop, read and adjust
-        pop_heap(begin, begin + valid, greater<Element>());
+        pop_heap(begin, begin + valid, ElementGreater(&this->cmp));
         bp = this->sortHeap[valid-1].val;
         bool tillEnd = false;
         for(unsigned i = 0; i < this->colnum; ++i)
@@ -426,7 +422,7 @@ Stream::mergeSort()
             bp[i].setStr(s);
         }
         if(!tillEnd)
-            push_heap(begin, begin + valid, greater<Element>());
+            push_heap(begin, begin + valid, ElementGreater(&this->cmp));
     }
 
     //fseek(fp, 0, SEEK_SET);
@@ -460,7 +456,7 @@ Stream::setEnd()
 		if(this->needSort)
 		{
 			//DEBUG2
-			stable_sort(this->ansMem, this->ansMem + this->rownum, mycmp);
+			stable_sort(this->ansMem, this->ansMem + this->rownum, this->cmp);
 		}
 		return;
     }
@@ -94,7 +94,19 @@ typedef struct StreamElement
 	}
 }Element;
 
-//static bool operator < (const Element& _a, const Element& _b);
+//the order of the heap of the multi-way merge sort, by the ResultCmp of the stream
+struct ElementGreater
+{
+	ResultCmp* cmp;
+	ElementGreater(ResultCmp* _cmp)
+	{
+		this->cmp = _cmp;
+	}
+	bool operator() (const Element& _a, const Element& _b)
+	{
+		return !(*this->cmp)(_a.val, _b.val);
+	}
+};
 
 //BETTER:use mmap part by part to get output
 
@@ -113,7 +125,8 @@ private:
 	std::vector<Bstr*> tempst;
 	unsigned space;			//space used in disk for one file
 
-	//struct ResultCmp cmp;
+	//one per stream, for the streams of several queries may sort at the same time
+	ResultCmp cmp;
 
 	//void* ans;               //FILE* if in disk, Bstr** if in memory
 	Bstr** ansMem;
@@ -0,0 +1,113 @@
+/*=============================================================================
+# Filename: TripleBatch.cpp
+# Last Modified: 2026-10-17
+# Description: implement functions in TripleBatch.h
+=============================================================================*/
+
+#include "TripleBatch.h"
+
+using namespace std;
+
+TripleBatch::TripleBatch()
+{
+	this->clear();
+}
+
+void
+TripleBatch::clear()
+{
+	this->triple_num = 0;
+	this->bytes.assign(sizeof(int), 0);
+}
+
+void
+TripleBatch::addInt(int _val)
+{
+	const char* p = (const char*)&_val;
+	this->bytes.insert(this->bytes.end(), p, p + sizeof(int));
+}
+
+void
+TripleBatch::addStr(const string& _str)
+{
+	this->addInt(_str.size());
+	this->bytes.insert(this->bytes.end(), _str.begin(), _str.end());
+}
+
+void
+TripleBatch::add(const TripleWithObjType& _triple, int _sub_gid, int _obj_gid)
+{
+	this->bytes.push_back((char)_triple.object_type);
+	this->addInt(_sub_gid);
+	this->addInt(_obj_gid);
+	this->addStr(_triple.getSubject());
+	this->addStr(_triple.getPredicate());
+	this->addStr(_triple.getObject());
+	this->triple_num++;
+	memcpy(&this->bytes[0], &this->triple_num, sizeof(int));
+}
+
+int
+TripleBatch::getTripleNum() const
+{
+	return this->triple_num;
+}
+
+int
+TripleBatch::getSize() const
+{
+	return this->bytes.size();
+}
+
+const char*
+TripleBatch::getBytes() const
+{
+	return &this->bytes[0];
+}
+
+void
+TripleBatch::swapOut(vector<char>& _bytes)
+{
+	_bytes.swap(this->bytes);
+	this->clear();
+}
+
+int
+TripleBatch::unpack(const char* _src, int _size, TripleWithObjType* _triple_array, vector<int>& _global_ids)
+{
+	if(_size < (int)sizeof(int))
+		return 0;
+
+	int num = 0, len = 0;
+	memcpy(&num, _src, sizeof(int));
+	const char* p = _src + sizeof(int);
+	for(int i = 0; i < num; i++){
+		TripleWithObjType& triple = _triple_array[i];
+		triple.setObjType((TripleWithObjType::ObjectType)*p);
+		p++;
+		int gids[2];
+		memcpy(gids, p, 2 * sizeof(int));
+		p += 2 * sizeof(int);
+		_global_ids.push_back(gids[0]);
+		_global_ids.push_back(gids[1]);
+
+		memcpy(&len, p, sizeof(int));
+		p += sizeof(int);
+		triple.subject.assign(p, len);
+		p += len;
+		memcpy(&len, p, sizeof(int));
+		p += sizeof(int);
+		triple.predicate.assign(p, len);
+		p += len;
+		memcpy(&len, p, sizeof(int));
+		p += sizeof(int);
+		triple.object.assign(p, len);
+		p += len;
+	}
+
+	return num;
+}
+
+TripleSource::~TripleSource()
+{
+}
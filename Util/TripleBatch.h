@@ -0,0 +1,55 @@
+/*=============================================================================
+# Filename: TripleBatch.h
+# Last Modified: 2026-10-17
+# Description: triples packed in a byte array for the transfer from gloadD to
+the sites, and the interface to build a database from triples handed over in
+groups instead of from an RDF file
+=============================================================================*/
+
+#ifndef _UTIL_TRIPLEBATCH_H
+#define _UTIL_TRIPLEBATCH_H
+
+#include "Util.h"
+#include "Triple.h"
+
+//the layout is: [int triple_num] and then for each triple
+//[char object_type][int sub_gid][int obj_gid][int len][subject][int len][predicate][int len][object]
+//where the gids are the global IDs of the subject and the object, -1 if unknown
+class TripleBatch
+{
+public:
+	TripleBatch();
+
+	void clear();
+	void add(const TripleWithObjType& _triple, int _sub_gid, int _obj_gid);
+	int getTripleNum() const;
+	//the bytes to send, including the header
+	int getSize() const;
+	const char* getBytes() const;
+	//hand the bytes over to _bytes without copying, the batch is empty afterwards
+	void swapOut(std::vector<char>& _bytes);
+
+	//append the triples in _src to _triple_array, and their gid pairs to _global_ids
+	//return the number of triples read
+	static int unpack(const char* _src, int _size, TripleWithObjType* _triple_array, std::vector<int>& _global_ids);
+
+private:
+	std::vector<char> bytes;
+	int triple_num;
+
+	void addInt(int _val);
+	void addStr(const std::string& _str);
+};
+
+//Database::build reads the triples group by group from a source, see RDFFileSource in Parser/RDFParser.h
+class TripleSource
+{
+public:
+	virtual ~TripleSource();
+	//fill at most RDFParser::TRIPLE_NUM_PER_GROUP triples, _triple_num is left 0 when all triples are read
+	//_global_ids gets the gids of the subject and the object of each triple, or stays empty
+	//if the source does not know them
+	virtual void getTriples(TripleWithObjType* _triple_array, int& _triple_num, std::vector<int>& _global_ids) = 0;
+};
+
+#endif //_UTIL_TRIPLEBATCH_H
@@ -1361,28 +1361,38 @@ Util::myfunction0(PPPartialResVec v1, PPPartialResVec v2){
 
 vector<int> 
 Util::findJoinOrder(vector< PPPartialResVec >& partialResVec, vector< vector<int> > _query_adjacent_list){
+	vector<int> _res_num_vec(partialResVec.size());
+	for(int i = 0; i < partialResVec.size(); i++){
+		_res_num_vec[i] = partialResVec[i].PartialResList.size();
+	}
+	
+	return Util::findJoinOrder(_res_num_vec, _query_adjacent_list);
+}
+
+vector<int> 
+Util::findJoinOrder(const vector<int>& _res_num_vec, vector< vector<int> > _query_adjacent_list){
 	vector<int> _join_order_vec, _candidate_vec;
 	set<int> _visited_set;
 	
-	int min_i = 0, min_val = partialResVec[0].PartialResList.size();
-	for(int i = 1; i < partialResVec.size(); i++){
-		if(min_val > partialResVec[i].PartialResList.size()){
+	int min_i = 0, min_val = _res_num_vec[0];
+	for(int i = 1; i < _res_num_vec.size(); i++){
+		if(min_val > _res_num_vec[i]){
 			min_i = i;
-			min_val = partialResVec[i].PartialResList.size();
+			min_val = _res_num_vec[i];
 		}
 	}
 	
 	_visited_set.insert(min_i);
 	_join_order_vec.push_back(min_i);
 	_candidate_vec.insert(_candidate_vec.begin(), _query_adjacent_list[min_i].begin(), _query_adjacent_list[min_i].end());
-	while(_join_order_vec.size() != partialResVec.size()){
+	while(_join_order_vec.size() != _res_num_vec.size()){
 		
 		min_i = 0;
-		min_val = partialResVec[_candidate_vec[min_i]].PartialResList.size();
+		min_val = _res_num_vec[_candidate_vec[min_i]];
 		for(int i = 1; i < _candidate_vec.size(); i++){
-			if(min_val > partialResVec[_candidate_vec[i]].PartialResList.size()){
+			if(min_val > _res_num_vec[_candidate_vec[i]]){
 				min_i = i;
-				min_val = partialResVec[_candidate_vec[i]].PartialResList.size();
+				min_val = _res_num_vec[_candidate_vec[i]];
 			}
 		}
 		
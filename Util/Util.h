@@ -70,8 +70,8 @@ in the sparql query can point to the same node in data graph)
 #define READLINE_ON	1
 #define MULTI_INDEX 1
 //#define SO2P 1
-//#define USE_GROUP_INSERT 1
-//#define USE_GROUP_DELETE 1
+#define USE_GROUP_INSERT 1
+#define USE_GROUP_DELETE 1
 
 //indicate that in debug mode
 //#define DEBUG_STREAM
@@ -189,6 +189,7 @@ public:
 	static const unsigned long long MAX_BUFFER_SIZE = 0xffffffff;		//max buffer size in Storage
 	//0x4fffffff 0x3fffffff
 	static const unsigned STORAGE_BLOCK_SIZE = 1 << 12;	//fixed size of disk-block in B+ tree storage
+	static const unsigned BULK_FILL_PERCENT = 90;	//how full the nodes of a bulk-loaded B+ tree are packed
 	//1 << 16
 	
 	static const int MAX_CROSSING_EDGE_HASH_SIZE = 1 << 30;		//max buffer size in Storage
@@ -285,6 +286,8 @@ public:
 	static int checkJoinable(PPPartialResVec& vec1, PPPartialResVec& vec2, int tag1, int tag2);
 	static void HashLECFJoin(CrossingEdgeMappingVec& final_res, CrossingEdgeMappingVec& res1, CrossingEdgeMappingVec& res2);
 	static std::vector<int> findJoinOrder(std::vector<PPPartialResVec>& textline, std::vector< std::vector<int> > tag);
+	//the same order computed from the number of partial results of each query vertex
+	static std::vector<int> findJoinOrder(const std::vector<int>& res_num_vec, std::vector< std::vector<int> > tag);
 	static std::vector< std::vector<int> > findMultipleJoinOrder(std::map< int, std::vector<int> >& pr_adjacent_list, std::vector<PPPartialResVec>& aPartialResVec, int fullTag);
 	static void HashJoin(std::set< std::vector<int> >& finalPartialResSet, std::vector<PPPartialRes>& res1, std::map<int, std::vector<PPPartialRes> >& res2, int fragmentNum, int matchPos);
 	
@@ -7,6 +7,7 @@
 =============================================================================*/
 
 #include "VSTree.h"
+#include <pthread.h>
 
 using namespace std;
 
@@ -29,10 +30,12 @@ VSTree::VSTree(std::string _store_path)
 
 	this->free_nid_list.clear();
 	this->max_nid_alloc = 0;
+	pthread_mutex_init(&this->retrieve_mutex, NULL);
 }
 
 VSTree::~VSTree()
 {
+	pthread_mutex_destroy(&this->retrieve_mutex);
     delete this->node_buffer;
     delete this->entry_buffer;
 	this->free_nid_list.clear();
@@ -141,26 +144,53 @@ void VSTree::retrieve(SPARQLquery& _query)
 	Util::logging("OUT retrieve");
 }
 
+//the arguments of the threads of buildTree(), each works on [begin, end) of one step
+struct VSTreeBuildTask
+{
+    enum { COUNT_BITS, MAKE_KEYS, SORT_KEYS, MERGE_KEYS, FILL_NODES };
+    int step;
+    int begin;
+    int end;
+    //COUNT_BITS: the sampled entries are begin * sample_stride, ..., (end - 1) * sample_stride
+    int sample_stride;
+    std::vector<int> bit_counts;
+    //MAKE_KEYS: the key of an entry is made of its key_bits, in order
+    const std::vector<int>* key_bits;
+    //MERGE_KEYS: [begin, mid) and [mid, end) of keys are merged
+    int mid;
+    std::vector< std::pair<unsigned long long, int> >* keys;
+    //COUNT_BITS, MAKE_KEYS and FILL_NODES: the entries of the tree, or the entries of the level below.
+    //The leaves take the entries in the order of keys
+    const std::vector<SigEntry>* entries;
+    //FILL_NODES: the k-th node of the level has children [child_begins[k], child_begins[k + 1]), and is filled
+    //to batch[k - batch_first] at file line line_base + k, with its entry kept in node_entries[k]
+    const std::vector<int>* child_begins;
+    const std::vector<int>* fathers;
+    bool is_leaf;
+    int line_base;
+    int child_line_base;
+    int father_line_base;
+    int batch_first;
+    VNode* batch;
+    std::vector<SigEntry>* node_entries;
+};
+
 //build the VSTree from the _entity_signature_file. 
+//NOTICE:the entries are not inserted one by one, which chooses a leaf for each entry from the root down
+//and splits nodes through the node buffer. Instead the entries are sorted by a key made of the signature
+//bits set in about half of them, which splits them best, so that similar signatures fall in the same leaf.
+//Each level is then packed bottom-up, and a node is written out as soon as it is filled.
+//NOTICE:the leaves take the entries in the order of their keys, which is random in the file, so all the
+//signatures and their keys are kept in memory, about (sizeof(SigEntry) + 16) bytes per entity. This is
+//not counted in the build memory of Database, which only bounds the sorts of the id tuples.
 bool 
-VSTree::buildTree(std::string _entry_file_path)
+VSTree::buildTree(std::string _entry_file_path, int _thread_num)
 {
 	Util::logging("IN VSTree::buildTree");
 
-    // create the entry buffer and node buffer.
-    this->entry_buffer = new EntryBuffer(EntryBuffer::DEFAULT_CAPACITY);
+    int thread_num = max(_thread_num, 1);
     this->node_buffer = new LRUCache(LRUCache::DEFAULT_CAPACITY);
 
-    // create the root node.
-    //VNode* rootNodePtr = new VNode();
-	VNode* rootNodePtr = this->createNode();
-    rootNodePtr->setAsRoot(true);
-    rootNodePtr->setAsLeaf(true);
-    //rootNodePtr->setFileLine(this->root_file_line);
-    //this->node_buffer->set(this->root_file_line, rootNodePtr);
-    //this->node_num ++;
-    this->height ++;
-
      //when building a new VSTree,
       //we should first create a new tree node file as the external storage
       //of the node buffer on hard disk.
@@ -172,31 +202,170 @@ VSTree::buildTree(std::string _entry_file_path)
         cerr << "error, can not open file. @VSTree::buildTree" << endl;
         return false;
     }
+    fseek(filePtr, 0, SEEK_END);
+    int entryNum = ftell(filePtr) / sizeof(SigEntry);
+    fseek(filePtr, 0, SEEK_SET);
+    vector<SigEntry> entries(entryNum);
+    if (entryNum > 0 && fread((char *)&entries[0], sizeof(SigEntry), entryNum, filePtr) != (size_t)entryNum)
+    {
+        cerr << "error, can not read the entries. @VSTree::buildTree" << endl;
+        fclose(filePtr);
+        return false;
+    }
+    fclose(filePtr);
+
+    vector<VSTreeBuildTask> tasks;
+    VSTreeBuildTask task = VSTreeBuildTask();
+    task.entries = &entries;
+
+    // choose the bits of the key on a sample of the entries.
+    int sampleNum = min(entryNum, VSTree::BUILD_SAMPLE_NUM);
+    task.step = VSTreeBuildTask::COUNT_BITS;
+    task.sample_stride = sampleNum == 0 ? 1 : entryNum / sampleNum;
+    VSTree::splitBuildTask(task, 0, sampleNum, thread_num, tasks);
+    VSTree::runBuildTasks(tasks);
+    vector< pair<int, int> > bitOrder(Signature::ENTITY_SIG_LENGTH);
+    for (int i = 0; i < Signature::ENTITY_SIG_LENGTH; i++)
+    {
+        int count = 0;
+        for (int j = 0; j < (int)tasks.size(); j++)
+        {
+            count += tasks[j].bit_counts[i];
+        }
+        bitOrder[i] = make_pair(abs(2 * count - sampleNum), i);
+    }
+    sort(bitOrder.begin(), bitOrder.end());
+    vector<int> keyBits;
+    for (int i = 0; i < (int)bitOrder.size() && i < (int)sizeof(unsigned long long) * 8; i++)
+    {
+        keyBits.push_back(bitOrder[i].second);
+    }
 
-     //load the entry file to entry buffer in memory, when the entry buffer is full,
-    //insert them into the tree. 
-    int n;
-    n = this->entry_buffer->fillElemsFromFile(filePtr);
-    while (n != 0)
+    // sort the entries by their keys: each thread sorts a part, then the parts are merged in pairs.
+    vector< pair<unsigned long long, int> > keys(entryNum);
+    task.step = VSTreeBuildTask::MAKE_KEYS;
+    task.key_bits = &keyBits;
+    task.keys = &keys;
+    VSTree::splitBuildTask(task, 0, entryNum, thread_num, tasks);
+    VSTree::runBuildTasks(tasks);
+    task.step = VSTreeBuildTask::SORT_KEYS;
+    VSTree::splitBuildTask(task, 0, entryNum, thread_num, tasks);
+    VSTree::runBuildTasks(tasks);
+    vector<int> parts;
+    for (int i = 0; i < (int)tasks.size(); i++)
+    {
+        parts.push_back(tasks[i].begin);
+    }
+    parts.push_back(entryNum);
+    task.step = VSTreeBuildTask::MERGE_KEYS;
+    while (parts.size() > 2)
     {
-        for (int i = 0; i < n; i++)
+        tasks.clear();
+        vector<int> merged;
+        for (int i = 0; i + 1 < (int)parts.size(); i += 2)
         {
-           SigEntry* entryPtr = this->entry_buffer->getElem(i);
+            merged.push_back(parts[i]);
+            if (i + 2 >= (int)parts.size())
+            {
+                break;
+            }
+            task.begin = parts[i];
+            task.mid = parts[i + 1];
+            task.end = parts[i + 2];
+            tasks.push_back(task);
+        }
+        merged.push_back(entryNum);
+        VSTree::runBuildTasks(tasks);
+        parts.swap(merged);
+    }
 
-		   //the most important part of this function 
-		   //insertEntry one by one 
-           this->insertEntry(*entryPtr);
+    // the children of the nodes of each level, from the leaves up to the root.
+    vector< vector<int> > levels(1);
+    VSTree::spreadChildren(entryNum, (VNode::MAX_CHILD_NUM - 1) * Util::BULK_FILL_PERCENT / 100, levels[0]);
+    while (levels.back().size() > 2)
+    {
+        vector<int> childBegins;
+        VSTree::spreadChildren(levels.back().size() - 1, (VNode::MAX_CHILD_NUM - 1) * Util::BULK_FILL_PERCENT / 100, childBegins);
+        levels.push_back(childBegins);
+    }
+
+    filePtr = fopen(VSTree::tree_node_file_path.c_str(), "wb");
+    if (filePtr == NULL)
+    {
+        cerr << "error, can not open the tree node file. @VSTree::buildTree" << endl;
+        return false;
+    }
 
+    // fill and write the nodes level by level, in the order of their file lines.
+    int batchNum = VSTree::BUILD_BATCH_NUM * thread_num;
+    VNode* batch = new VNode[batchNum];
+    vector<SigEntry> childEntries, nodeEntries;
+    int lineBase = 0;
+    bool flag = true;
+    for (int i = 0; i < (int)levels.size() && flag; i++)
+    {
+        int nodeNum = levels[i].size() - 1;
+        vector<int> fathers;
+        if (i + 1 < (int)levels.size())
+        {
+            for (int j = 0; j + 1 < (int)levels[i + 1].size(); j++)
+            {
+                fathers.insert(fathers.end(), levels[i + 1][j + 1] - levels[i + 1][j], j);
+            }
+        }
+        nodeEntries.resize(nodeNum);
+
+        task.step = VSTreeBuildTask::FILL_NODES;
+        task.entries = (i == 0 ? &entries : &childEntries);
+        task.child_begins = &levels[i];
+        task.fathers = (i + 1 < (int)levels.size() ? &fathers : NULL);
+        task.is_leaf = (i == 0);
+        task.child_line_base = lineBase - (i == 0 ? 0 : (int)childEntries.size());
+        task.line_base = lineBase;
+        task.father_line_base = lineBase + nodeNum;
+        task.batch = batch;
+        task.node_entries = &nodeEntries;
+        for (int first = 0; first < nodeNum && flag; first += batchNum)
+        {
+            int last = min(first + batchNum, nodeNum);
+            task.batch_first = first;
+            VSTree::splitBuildTask(task, first, last, thread_num, tasks);
+            VSTree::runBuildTasks(tasks);
+            if (fwrite((char *)batch, sizeof(VNode), last - first, filePtr) != (size_t)(last - first))
+            {
+                cerr << "error, can not write the tree nodes. @VSTree::buildTree" << endl;
+                flag = false;
+            }
+            for (int j = 0; i == 0 && j < last - first; j++)
+            {
+                this->updateEntityID2FileLineMap(batch + j);
+            }
         }
 
-        n = this->entry_buffer->fillElemsFromFile(filePtr);
+        if (i == 0)
+        {
+            vector<SigEntry>().swap(entries);
+            vector< pair<unsigned long long, int> >().swap(keys);
+        }
+        childEntries.swap(nodeEntries);
+        lineBase += nodeNum;
     }
+    delete[] batch;
+    fclose(filePtr);
+
+    // the root is the last node written.
+    this->height = levels.size();
+    this->node_num = lineBase;
+    this->max_nid_alloc = lineBase;
+    this->root_file_line = lineBase - 1;
+    this->entry_num = entryNum;
+    this->free_nid_list.clear();
 
     //debug
     Util::logging("insert entries to tree done.");
 
     //bool flag = this->node_buffer->flush();
-    bool flag = this->saveTree();
+    flag = flag && this->saveTree();
 
     //debug
     {
@@ -208,15 +377,145 @@ VSTree::buildTree(std::string _entry_file_path)
 
     Util::logging("OUT VSTree::buildTree");
 
-    //debug
-//    {
-//        Util::logging(this->to_str());
-//        Util::logging("\n\n\n");
-//    }
-
     return flag;
 }
 
+void
+VSTree::spreadChildren(int _num, int _max, vector<int>& _begins)
+{
+    int nodeNum = max((_num + _max - 1) / _max, 1);
+    //a node may be full, so no node is left less than half full if all the children fit in one node less
+    while (nodeNum > 1 && _num < nodeNum * VNode::MIN_CHILD_NUM && (_num + nodeNum - 2) / (nodeNum - 1) < VNode::MAX_CHILD_NUM)
+    {
+        nodeNum--;
+    }
+
+    _begins.clear();
+    int begin = 0;
+    for (int i = 0; i < nodeNum; i++)
+    {
+        _begins.push_back(begin);
+        begin += _num / nodeNum + (i < _num % nodeNum ? 1 : 0);
+    }
+    _begins.push_back(_num);
+}
+
+void
+VSTree::splitBuildTask(const VSTreeBuildTask& _task, int _begin, int _end, int _thread_num, vector<VSTreeBuildTask>& _tasks)
+{
+    _tasks.assign(_thread_num, _task);
+    for (int i = 0; i < _thread_num; i++)
+    {
+        _tasks[i].begin = _begin + (long long)(_end - _begin) * i / _thread_num;
+        _tasks[i].end = _begin + (long long)(_end - _begin) * (i + 1) / _thread_num;
+    }
+}
+
+void
+VSTree::runBuildTasks(vector<VSTreeBuildTask>& _tasks)
+{
+    int taskNum = _tasks.size();
+    vector<pthread_t> threads(taskNum);
+    vector<char> started(taskNum, 0);
+    for (int i = 1; i < taskNum; i++)
+    {
+        if (pthread_create(&threads[i], NULL, VSTree::buildThread, &_tasks[i]) == 0)
+        {
+            started[i] = 1;
+        }
+        else
+        {
+            // run it here if no thread can be created.
+            VSTree::buildThread(&_tasks[i]);
+        }
+    }
+    if (taskNum > 0)
+    {
+        VSTree::buildThread(&_tasks[0]);
+    }
+    for (int i = 1; i < taskNum; i++)
+    {
+        if (started[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+    }
+}
+
+void*
+VSTree::buildThread(void* _task)
+{
+    VSTreeBuildTask* task = (VSTreeBuildTask*)_task;
+    const vector<SigEntry>& entries = *(task->entries);
+
+    if (task->step == VSTreeBuildTask::COUNT_BITS)
+    {
+        task->bit_counts.assign(Signature::ENTITY_SIG_LENGTH, 0);
+        for (int i = task->begin; i < task->end; i++)
+        {
+            const EntityBitSet& bitset = entries[(long long)i * task->sample_stride].getEntitySig().entityBitSet;
+            for (int j = 0; j < Signature::ENTITY_SIG_LENGTH; j++)
+            {
+                task->bit_counts[j] += bitset[j];
+            }
+        }
+    }
+    else if (task->step == VSTreeBuildTask::MAKE_KEYS)
+    {
+        const vector<int>& keyBits = *(task->key_bits);
+        for (int i = task->begin; i < task->end; i++)
+        {
+            const EntityBitSet& bitset = entries[i].getEntitySig().entityBitSet;
+            unsigned long long key = 0;
+            for (int j = 0; j < (int)keyBits.size(); j++)
+            {
+                key = (key << 1) | bitset[keyBits[j]];
+            }
+            (*(task->keys))[i] = make_pair(key, i);
+        }
+    }
+    else if (task->step == VSTreeBuildTask::SORT_KEYS)
+    {
+        sort(task->keys->begin() + task->begin, task->keys->begin() + task->end);
+    }
+    else if (task->step == VSTreeBuildTask::MERGE_KEYS)
+    {
+        inplace_merge(task->keys->begin() + task->begin, task->keys->begin() + task->mid, task->keys->begin() + task->end);
+    }
+    else if (task->step == VSTreeBuildTask::FILL_NODES)
+    {
+        const vector<int>& childBegins = *(task->child_begins);
+        for (int i = task->begin; i < task->end; i++)
+        {
+            VNode* nodePtr = task->batch + (i - task->batch_first);
+            *nodePtr = VNode();
+            nodePtr->setAsLeaf(task->is_leaf);
+            nodePtr->setAsRoot(task->fathers == NULL);
+            nodePtr->setFileLine(task->line_base + i);
+            if (task->fathers != NULL)
+            {
+                nodePtr->setFatherFileLine(task->father_line_base + (*(task->fathers))[i]);
+            }
+            for (int j = childBegins[i]; j < childBegins[i + 1]; j++)
+            {
+                if (task->is_leaf)
+                {
+                    nodePtr->addChildEntry(entries[(*(task->keys))[j].second], false);
+                }
+                else
+                {
+                    nodePtr->setChildFileLine(nodePtr->getChildNum(), task->child_line_base + j);
+                    nodePtr->addChildEntry(entries[j], false);
+                }
+            }
+            nodePtr->refreshSignature();
+            (*(task->node_entries))[i] = nodePtr->getEntry();
+        }
+    }
+
+    return NULL;
+}
+
 bool 
 VSTree::deleteTree()
 {
@@ -1495,6 +1794,7 @@ VSTree::retrieveEntity(const EntityBitSet& _entity_bit_set, IDList* _p_id_list)
         Util::logging(_ss.str());
     }
 
+    pthread_mutex_lock(&this->retrieve_mutex);
     const SigEntry& root_entry = (this->getRoot())->getEntry();
     Util::logging("Get Root Entry");
 
@@ -1585,6 +1885,7 @@ VSTree::retrieveEntity(const EntityBitSet& _entity_bit_set, IDList* _p_id_list)
 		//cerr << "child num: " << childNum << "   valid num: " << valid << endl;
 #endif
     }
+    pthread_mutex_unlock(&this->retrieve_mutex);
     Util::logging("OUT retrieveEntity");
 }
 
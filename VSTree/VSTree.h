@@ -14,9 +14,12 @@
 #include "VNode.h"
 #include "LRUCache.h"
 #include "EntryBuffer.h"
+#include <pthread.h>
 
 //NOTICE:R/W more than 4G
 
+struct VSTreeBuildTask;
+
 class VSTree
 {
     friend class VNode;
@@ -24,8 +27,10 @@ public:
     VSTree(std::string _store_path);
     ~VSTree();
     int getHeight()const;
-	 //build the VSTree from the _entity_signature_file. 
-    bool buildTree(std::string _entity_signature_file);
+	//bulk-build the VSTree from the _entity_signature_file with _thread_num threads:
+	//the entries are clustered by a key drawn from their signatures and packed into leaves,
+	//then the levels above are built bottom-up and the node file is written sequentially
+    bool buildTree(std::string _entity_signature_file, int _thread_num = 1);
     bool deleteTree();
 
     //Incrementally update bitset of _entity_id conduct OR operation on Entry(_entity_id)'s EntityBitSet with _bitset
@@ -61,6 +66,9 @@ private:
 	int height;
 
 	LRUCache* node_buffer;
+	//the nodes got by a retrieval may swap out the others in node_buffer,
+	//so the retrievals of several threads are serialized
+	pthread_mutex_t retrieve_mutex;
 	EntryBuffer* entry_buffer;
 	map<int, int> entityID2FileLineMap; // record the mapping from entityID to their node's file line.
 
@@ -100,6 +108,19 @@ private:
 	//delete node and update the LRUCache and file storage
 	void removeNode(VNode* _vp);
 
+	//the number of entries sampled to choose the bits of the clustering key in buildTree()
+	static const int BUILD_SAMPLE_NUM = 1 << 20;
+	//the number of nodes filled by each thread of buildTree() before they are written out
+	static const int BUILD_BATCH_NUM = 64;
+	//spread _num children evenly over as few nodes of at most _max children as possible,
+	//_begins[i] is the first child of the i-th node, and the last element is _num
+	static void spreadChildren(int _num, int _max, std::vector<int>& _begins);
+	//divide [_begin, _end) of _task evenly into _thread_num tasks
+	static void splitBuildTask(const VSTreeBuildTask& _task, int _begin, int _end, int _thread_num, std::vector<VSTreeBuildTask>& _tasks);
+	//run each of _tasks on a thread of its own, the calling thread taking the first one
+	static void runBuildTasks(std::vector<VSTreeBuildTask>& _tasks);
+	static void* buildThread(void* _task);
+
 	std::string to_str();
 };
 